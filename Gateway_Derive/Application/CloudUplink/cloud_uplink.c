@@ -0,0 +1,269 @@
+/**
+ * @file      cloud_uplink.c
+ * @author    Your Name
+ * @brief     云端上行任务
+ *
+ * @par 内部实现机制:
+ *      - 请求通过一个很短的消息队列投递。`s_pending[]` 按请求类型标记，保证同一时刻队列中
+ *        每类请求最多只有一个，监督者每个周期都可以放心地调用 `CloudUplink_RequestReport()`，
+ *        而不会因为模组响应慢而堆积请求。
+ *      - `s_inflight_start_tick` 非0表示上报进行中，其值为开始时的系统节拍。
+ *        监督者据此计算已耗时，判断是否继续代上行任务签到。
+ */
+
+#include "cloud_uplink.h"
+#include "huawei_iot_app.h"
+#include "cmsis_os2.h"
+#include "task_monitor.h"
+#include "system_monitor.h"
+#include "sample_trace.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Private defines -----------------------------------------------------------*/
+
+#define UPLINK_TASK_STACK_SIZE 4096
+#define UPLINK_TASK_PRIORITY   osPriorityBelowNormal // 低于主任务，保证监督循环不被上报拖慢
+#define UPLINK_QUEUE_LENGTH    4
+
+// 空闲时等待请求的超时，必须小于 App_Main_Task 的监督周期 (2000ms)，以确保签到总能及时进行
+#define UPLINK_IDLE_CHECKIN_MS 1000
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief 上行请求类型
+ */
+typedef enum {
+    UPLINK_REQ_GATEWAY_REPORT, ///< 上报所有脏设备的属性
+    UPLINK_REQ_MODEM_STATS,    ///< 上报网关自身的AT命令时延统计
+    UPLINK_REQ_SYSTEM_STATS,   ///< 上报网关自身的任务/堆统计
+    UPLINK_REQ_SAMPLE_LATENCY, ///< 上报各传感器节点的端到端样本时延统计
+    UPLINK_REQ_COUNT
+} uplink_request_e;
+
+typedef struct {
+    uplink_request_e type;
+    uint32_t enqueue_tick; ///< 请求投递时的系统节拍，用于统计排队时延和样本的端到端时延
+} uplink_request_t;
+
+/* Private variables ---------------------------------------------------------*/
+
+static AT_Handler_t *s_at_handler = NULL;
+static osThreadId_t s_uplink_task_handle = NULL;
+static osMessageQueueId_t s_uplink_queue = NULL;
+
+static volatile bool s_enabled = false;            // 云连接是否可用
+static volatile bool s_pending[UPLINK_REQ_COUNT];  // 队列中是否已有一个该类型的请求
+static volatile uint32_t s_inflight_start_tick = 0; // 0: 空闲; 非0: 上报开始时的节拍
+
+static CloudUplink_Stats_t s_stats = {0};
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void CloudUplink_Task(void *argument);
+static bool uplink_request(uplink_request_e type);
+static AT_Status_t publish_system_stats(void);
+
+/* Public functions ----------------------------------------------------------*/
+
+void CloudUplink_Init(AT_Handler_t *at_handler)
+{
+    s_at_handler = at_handler;
+    s_stats.last_status = AT_OK;
+
+    s_uplink_queue = osMessageQueueNew(UPLINK_QUEUE_LENGTH, sizeof(uplink_request_t), NULL);
+    if (s_uplink_queue == NULL) {
+        printf("[Uplink] Queue Create Failed\r\n");
+        return;
+    }
+
+    const osThreadAttr_t task_attributes = {
+        .name = "CloudUplinkTask",
+        .stack_size = UPLINK_TASK_STACK_SIZE,
+        .priority = (osPriority_t) UPLINK_TASK_PRIORITY,
+    };
+    s_uplink_task_handle = osThreadNew(CloudUplink_Task, NULL, &task_attributes);
+    if (s_uplink_task_handle == NULL) {
+        printf("[Uplink] Task Create Failed\r\n");
+        return;
+    }
+    printf("[Uplink] Task Create OK\r\n");
+}
+
+bool CloudUplink_RequestReport(void)
+{
+    return uplink_request(UPLINK_REQ_GATEWAY_REPORT);
+}
+
+bool CloudUplink_RequestModemStats(void)
+{
+    return uplink_request(UPLINK_REQ_MODEM_STATS);
+}
+
+bool CloudUplink_RequestSystemStats(void)
+{
+    return uplink_request(UPLINK_REQ_SYSTEM_STATS);
+}
+
+bool CloudUplink_RequestSampleLatency(void)
+{
+    return uplink_request(UPLINK_REQ_SAMPLE_LATENCY);
+}
+
+void CloudUplink_Resume(void)
+{
+    s_enabled = true;
+}
+
+void CloudUplink_Pause(void)
+{
+    s_enabled = false;
+}
+
+bool CloudUplink_IsBusy(void)
+{
+    return s_inflight_start_tick != 0;
+}
+
+void CloudUplink_Supervise(void)
+{
+    uint32_t start = s_inflight_start_tick;
+    if (start == 0) {
+        return; // 空闲时由上行任务自行签到
+    }
+
+    uint32_t elapsed = osKernelGetTickCount() - start;
+    if (elapsed < CLOUD_UPLINK_INFLIGHT_DEADLINE_MS) {
+        TaskMonitor_CheckIn(TASK_ID_CLOUD_UPLINK);
+    } else {
+        printf("[Uplink] Report in flight for %lu ms, exceeding deadline. Not checking in.\r\n",
+               (unsigned long)elapsed);
+    }
+}
+
+void CloudUplink_GetStats(CloudUplink_Stats_t *out_stats)
+{
+    if (out_stats) {
+        memcpy(out_stats, &s_stats, sizeof(CloudUplink_Stats_t));
+    }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief 云端上行任务
+ * @details
+ *      阻塞等待上报请求。请求到达且云连接可用时，执行一次网关上报，并记录耗时和结果。
+ *      无论是否有请求，每次醒来都会签到。
+ * @param argument RTOS 传入的参数，未使用。
+ */
+static void CloudUplink_Task(void *argument)
+{
+    (void)argument;
+
+    printf("[Uplink] Task Started\r\n");
+
+    for (;;) {
+        uplink_request_t req;
+        osStatus_t status = osMessageQueueGet(s_uplink_queue, &req, NULL, UPLINK_IDLE_CHECKIN_MS);
+
+        // [WATCHDOG] 空闲或刚取到请求时自行签到，上报期间由监督者代签
+        TaskMonitor_CheckIn(TASK_ID_CLOUD_UPLINK);
+
+        if (status != osOK) {
+            continue;
+        }
+        s_pending[req.type] = false;
+
+        if (!s_enabled) {
+            continue; // 云连接不可用，丢弃请求，脏数据留待重连后上报
+        }
+
+        uint32_t start = osKernelGetTickCount();
+        s_inflight_start_tick = (start != 0) ? start : 1; // 0 保留为"空闲"
+
+        AT_Status_t result = AT_ERROR;
+        switch (req.type) {
+        case UPLINK_REQ_GATEWAY_REPORT:
+            SampleTrace_BeginReport(req.enqueue_tick);
+            result = HuaweiIoT_PublishGatewayReport(s_at_handler);
+            break;
+        case UPLINK_REQ_MODEM_STATS:
+            result = HuaweiIoT_PublishModemStats(s_at_handler);
+            break;
+        case UPLINK_REQ_SYSTEM_STATS:
+            result = publish_system_stats();
+            break;
+        case UPLINK_REQ_SAMPLE_LATENCY:
+            result = HuaweiIoT_PublishSampleLatency(s_at_handler);
+            break;
+        default:
+            break;
+        }
+
+        uint32_t duration = osKernelGetTickCount() - start;
+        s_inflight_start_tick = 0;
+
+        s_stats.last_status = result;
+        s_stats.last_duration_ms = duration;
+        if (duration > s_stats.max_duration_ms) {
+            s_stats.max_duration_ms = duration;
+        }
+        if (result == AT_OK) {
+            s_stats.reports_ok++;
+        } else {
+            s_stats.reports_failed++;
+        }
+
+        if (duration > 1000) {
+            printf("[Uplink] Report took %lu ms (queued %lu ms), status %d.\r\n",
+                   (unsigned long)duration, (unsigned long)(start - req.enqueue_tick), result);
+        }
+
+        TaskMonitor_CheckIn(TASK_ID_CLOUD_UPLINK);
+    }
+}
+
+/**
+ * @brief 投递一个上行请求 (非阻塞)
+ * @details 该类型已有请求在排队时直接合并。
+ * @return bool true: 请求已投递或已合并; false: 队列已满
+ */
+static bool uplink_request(uplink_request_e type)
+{
+    if (s_uplink_queue == NULL) {
+        return false;
+    }
+
+    // 已有请求在排队，本次直接合并
+    if (s_pending[type]) {
+        return true;
+    }
+
+    uplink_request_t req = {
+        .type = type,
+        .enqueue_tick = osKernelGetTickCount(),
+    };
+
+    s_pending[type] = true;
+    if (osMessageQueuePut(s_uplink_queue, &req, 0, 0) != osOK) {
+        s_pending[type] = false;
+        s_stats.requests_dropped++;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 读取系统监控的最新快照并上报
+ */
+static AT_Status_t publish_system_stats(void)
+{
+    static SystemMonitor_Snapshot_t snapshot; // 约0.5KB，不放在上行任务的栈上
+
+    if (!SystemMonitor_GetSnapshot(&snapshot)) {
+        return AT_ERROR; // 监控任务尚未完成第一个周期
+    }
+    return HuaweiIoT_PublishSystemStats(s_at_handler, &snapshot);
+}
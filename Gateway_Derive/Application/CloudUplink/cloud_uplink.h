@@ -0,0 +1,121 @@
+/**
+ * @file      cloud_uplink.h
+ * @author    Your Name
+ * @brief     云端上行任务 - 头文件
+ * @version   1.0
+ * @date      2025-07-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @par 模块功能:
+ *      - 提供一个独立的上行任务 (`CloudUplinkTask`)，从请求队列中取出上报请求，
+ *        调用 `HuaweiIoT_PublishGatewayReport` 完成实际的 AT+HMPUB 发送。
+ *      - 主任务 (`App_Main_Task`) 只负责投递请求，不再被最长15秒的AT命令阻塞，
+ *        其监督循环因此可以严格按周期运行。
+ *      - 记录正在进行中 (in-flight) 的上报及其开始时间，供监督者判断上行任务是"忙"还是"卡死"。
+ *
+ * @par 看门狗策略:
+ *      上行任务空闲时，每次等待队列超时都会自行签到 (`TASK_ID_CLOUD_UPLINK`)。
+ *      上报进行中时，任务阻塞在AT命令上无法签到，此时由监督者调用 `CloudUplink_Supervise()`，
+ *      只要本次上报尚未超过 `CLOUD_UPLINK_INFLIGHT_DEADLINE_MS`，就代其签到；
+ *      一旦超过，停止代签，看门狗将最终复位系统。
+ */
+
+#ifndef __CLOUD_UPLINK_H
+#define __CLOUD_UPLINK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "at_handler.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 单次上报允许的最长耗时 (ms)
+ * @details 一次网关上报可能包含多条 AT+HMPUB，每条最长15秒。
+ *          超过此时间仍未返回，即认为上行任务已卡死。
+ */
+#define CLOUD_UPLINK_INFLIGHT_DEADLINE_MS 60000
+
+/**
+ * @brief 上行任务的统计信息
+ */
+typedef struct {
+    uint32_t reports_ok;       ///< 成功完成的上报次数
+    uint32_t reports_failed;   ///< 失败的上报次数
+    uint32_t requests_dropped; ///< 因队列满而丢弃的请求数
+    uint32_t last_duration_ms; ///< 最近一次上报的耗时
+    uint32_t max_duration_ms;  ///< 历史最长上报耗时
+    AT_Status_t last_status;   ///< 最近一次上报的结果
+} CloudUplink_Stats_t;
+
+/**
+ * @brief 初始化上行模块，创建请求队列和上行任务
+ * @details 应在 `App_Main_Init()` 中调用一次。任务创建后处于暂停状态，
+ *          需在云连接建立后调用 `CloudUplink_Resume()`。
+ * @param at_handler 上报使用的AT处理器实例指针
+ */
+void CloudUplink_Init(AT_Handler_t *at_handler);
+
+/**
+ * @brief 请求一次网关上报 (非阻塞)
+ * @details 若已有一个上报请求在队列中等待，则直接合并，不重复投递。
+ * @return bool true: 请求已投递或已合并; false: 队列已满
+ */
+bool CloudUplink_RequestReport(void);
+
+/**
+ * @brief 请求一次AT命令时延统计上报 (非阻塞)
+ * @details 与网关上报共用上行任务和队列，同样只保留一个未处理的请求。
+ * @return bool true: 请求已投递或已合并; false: 队列已满
+ */
+bool CloudUplink_RequestModemStats(void);
+
+/**
+ * @brief 请求一次任务/堆统计上报 (非阻塞)
+ * @details 上报系统监控最近一个周期的快照 (见 system_monitor.h)，同样只保留一个未处理的请求。
+ * @return bool true: 请求已投递或已合并; false: 队列已满
+ */
+bool CloudUplink_RequestSystemStats(void);
+
+/**
+ * @brief 请求一次样本端到端时延统计上报 (非阻塞)
+ * @details 上报各传感器节点从采集到云端确认的分阶段时延 (见 sample_trace.h)，同样只保留一个未处理的请求。
+ * @return bool true: 请求已投递或已合并; false: 队列已满
+ */
+bool CloudUplink_RequestSampleLatency(void);
+
+/**
+ * @brief 允许上行任务处理上报请求 (云连接建立后调用)
+ */
+void CloudUplink_Resume(void);
+
+/**
+ * @brief 禁止上行任务开始新的上报 (断线重连前调用)
+ * @note  此函数不会打断正在进行中的上报，调用者应通过 `CloudUplink_IsBusy()`
+ *        等待其结束后，再释放AT处理器等资源。
+ */
+void CloudUplink_Pause(void);
+
+/**
+ * @brief 查询当前是否有上报正在进行中
+ */
+bool CloudUplink_IsBusy(void);
+
+/**
+ * @brief 由监督者周期性调用，在上报进行中且未超时的情况下，代上行任务签到
+ */
+void CloudUplink_Supervise(void);
+
+/**
+ * @brief 获取上行任务的统计信息快照
+ */
+void CloudUplink_GetStats(CloudUplink_Stats_t *out_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CLOUD_UPLINK_H */
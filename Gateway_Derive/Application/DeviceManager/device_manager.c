@@ -137,6 +137,25 @@ bool DeviceManager_UpdateExternalSensorData(uint16_t lora_id, const ExternalSens
     return success;
 }
 
+/**
+ * @brief 处理节点的心跳
+ */
+bool DeviceManager_UpdateHeartbeat(uint16_t lora_id)
+{
+    bool has_data = false;
+    osMutexAcquire(g_device_list_mutex, osWaitForever);
+
+    int index = find_device_index(lora_id);
+    if (index != -1) {
+        // is_online 只在收到数据后置位，此时属性中才有该设备的读数
+        has_data = g_device_list[index].is_online;
+        g_device_list[index].last_seen_ts = osKernelGetTickCount();
+    }
+
+    osMutexRelease(g_device_list_mutex);
+    return has_data;
+}
+
 /**
  * @brief 获取指定设备的完整信息
  */
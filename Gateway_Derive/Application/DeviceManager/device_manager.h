@@ -78,6 +78,16 @@ bool DeviceManager_UpdateControlNodeData(uint16_t lora_id, const ControlNodeProp
  */
 bool DeviceManager_UpdateExternalSensorData(uint16_t lora_id, const ExternalSensorProperties_t* data);
 
+/**
+ * @brief 处理节点的心跳
+ * @details 按例外上报的传感器节点在读数没有变化时只发送心跳，表示"读数与上一次完整上报相同"。
+ *          这里只刷新在线状态和最后通信时间，属性保持不变，也不设置脏标记 (云端已有这些值)。
+ * @note  这是一个线程安全的函数。
+ * @param lora_id   发送心跳的设备的LoRa ID
+ * @return bool - true: 网关已有该设备的数据; false: 设备ID未找到，或网关尚未收到过该设备的数据 (例如网关重启后)
+ */
+bool DeviceManager_UpdateHeartbeat(uint16_t lora_id);
+
 /**
  * @brief 获取指定设备的完整信息
  * @note  这是一个线程安全的函数。
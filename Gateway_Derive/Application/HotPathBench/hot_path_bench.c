@@ -0,0 +1,192 @@
+/**
+ * @file      hot_path_bench.c
+ * @author    Your Name
+ * @brief     网关固件热点函数的微基准测试用例
+ */
+
+#include "hot_path_bench.h"
+#include <string.h>
+#include "main.h"
+#include "lora_protocol.h"
+#include "device_manager.h"
+#include "huawei_iot_app.h"
+#include "iot_json_writer.h"
+
+#ifndef MICRO_BENCH_HOST
+extern IWDG_HandleTypeDef hiwdg;
+#endif
+
+/* Private defines -----------------------------------------------------------*/
+#define BENCH_ITER_SHORT   1000U  ///< 几百个周期以内的用例
+#define BENCH_ITER_LONG    200U   ///< 生成JSON等上万个周期的用例
+
+/* Private Types -------------------------------------------------------------*/
+
+/** 一帧预先生成好的LoRa数据帧及其解析结果 */
+typedef struct {
+    uint8_t               raw[LORA_MAX_RAW_PACKET];
+    size_t                raw_len;
+    lora_parsed_message_t parsed;
+} bench_frame_t;
+
+/* Private Variables ---------------------------------------------------------*/
+
+static bench_frame_t s_internal_frame;
+static bench_frame_t s_external_frame;
+static bench_frame_t s_control_frame;
+
+static managed_device_t s_internal_device;
+static managed_device_t s_external_device;
+
+static char s_json_buf[1024]; // 与AT发送缓冲区大小相同
+
+/** 转义用例的输入: 64字节，含引号和反斜杠 (与云端命令中出现的字符相当) */
+static const char s_escape_input[] = "Greenhouse \"A\" north, probe \\2\\ at 30cm, row #7 {\"ok\":true}.....";
+
+/* Private Functions (Setup) -------------------------------------------------*/
+
+static void build_frame(bench_frame_t *frame, uint8_t sender, uint8_t msg_type, const void *payload, size_t len)
+{
+    int n = generate_lora_frame(LORA_HOST_ADDRESS, sender, msg_type, 1, payload, len, frame->raw, sizeof(frame->raw));
+    frame->raw_len = (n > 0) ? (size_t)n : 0;
+    (void)parse_lora_frame(frame->raw, frame->raw_len, &frame->parsed);
+}
+
+static void setup_frames(void)
+{
+    const sensor_internal_data_payload_t internal = {
+        .greenhouse_temp_int = 25, .greenhouse_temp_dec = 67,
+        .greenhouse_humid_int = 63, .greenhouse_humid_dec = 40,
+        .soil_moisture_int = 34, .soil_moisture_dec = 12,
+        .soil_temp_int = 19, .soil_temp_dec = 5,
+        .soil_ec = 512, .soil_ph_int = 6, .soil_ph_dec = 80,
+        .soil_nitrogen = 48, .soil_phosphorus = 23, .soil_potassium = 117,
+        .soil_salinity = 210, .soil_tds = 256, .soil_fertility = 300,
+        .light_intensity = 10250,
+        .voc_concentration = 120, .co2_concentration = 612,
+        .battery_level = 87, .battery_voltage_x10 = 39,
+    };
+    const sensor_external_data_payload_t external = {
+        .temperature_int = 18, .temperature_dec = 25,
+        .humidity_int = 55, .humidity_dec = 10,
+        .air_pressure = 101325, .light_intensity = 32000,
+        .altitude = 52, .latitude_e6 = 30657000, .longitude_e6 = 104066000,
+        .battery_level = 92, .battery_voltage_x10 = 40,
+    };
+    const control_data_payload_t control = {
+        .fanStatus = true, .growLightStatus = false, .pumpStatus = true, .fanSpeed = 60, .pumpSpeed = 40,
+    };
+
+    build_frame(&s_internal_frame, DEVICE_TYPE_SENSOR_Internal, MSG_TYPE_REPORT_SENSOR, &internal, sizeof(internal));
+    build_frame(&s_external_frame, DEVICE_TYPE_SENSOR_External, MSG_TYPE_REPORT_SENSOR, &external, sizeof(external));
+    build_frame(&s_control_frame, DEVICE_TYPE_CONTROL, MSG_TYPE_CMD_REPORT_CONFIG, &control, sizeof(control));
+
+    s_internal_device.lora_id = DEVICE_TYPE_SENSOR_Internal;
+    s_internal_device.cloud_device_id = "Internal_Sensor_1";
+    s_internal_device.device_type = DEVICE_TYPE_INTERNAL_SENSOR;
+    lora_model_parse_sensor_data_internal(&s_internal_frame.parsed, &s_internal_device.properties.internal_sensor);
+
+    s_external_device.lora_id = DEVICE_TYPE_SENSOR_External;
+    s_external_device.cloud_device_id = "External_Sensor_1";
+    s_external_device.device_type = DEVICE_TYPE_EXTERNAL_SENSOR;
+    lora_model_parse_sensor_data_external(&s_external_frame.parsed, &s_external_device.properties.external_sensor);
+}
+
+/* Private Functions (Cases) -------------------------------------------------*/
+
+static uint32_t bench_crc16(void *ctx)
+{
+    const bench_frame_t *frame = ctx;
+    size_t len = frame->raw_len - 2; // 不含帧尾的CRC
+    (void)crc16_modbus(frame->raw, len);
+    return (uint32_t)len;
+}
+
+static uint32_t bench_parse_frame(void *ctx)
+{
+    const bench_frame_t *frame = ctx;
+    lora_parsed_message_t msg;
+    (void)parse_lora_frame(frame->raw, frame->raw_len, &msg);
+    return (uint32_t)frame->raw_len;
+}
+
+static uint32_t bench_parse_internal(void *ctx)
+{
+    const bench_frame_t *frame = ctx;
+    InternalSensorProperties_t data;
+    (void)lora_model_parse_sensor_data_internal(&frame->parsed, &data);
+    return frame->parsed.payload_len;
+}
+
+static uint32_t bench_parse_external(void *ctx)
+{
+    const bench_frame_t *frame = ctx;
+    ExternalSensorProperties_t data;
+    (void)lora_model_parse_sensor_data_external(&frame->parsed, &data);
+    return frame->parsed.payload_len;
+}
+
+static uint32_t bench_parse_control(void *ctx)
+{
+    const bench_frame_t *frame = ctx;
+    ControlNodeProperties_t data;
+    (void)lora_model_parse_control_data(&frame->parsed, &data);
+    return frame->parsed.payload_len;
+}
+
+static uint32_t bench_report_json(void *ctx)
+{
+    return HuaweiIoT_WriteDeviceReport(s_json_buf, sizeof(s_json_buf), (const managed_device_t *)ctx);
+}
+
+static uint32_t bench_json_escape(void *ctx)
+{
+    JsonWriter_t w;
+    JsonWriter_Init(&w, s_json_buf, sizeof(s_json_buf));
+    JsonWriter_String(&w, (const char *)ctx);
+    return w.pos;
+}
+
+static uint32_t bench_device_lookup(void *ctx)
+{
+    managed_device_t device;
+    (void)DeviceManager_GetDevice((uint16_t)(uintptr_t)ctx, &device);
+    return sizeof(device);
+}
+
+/* 用例表: 名称是跨版本比较的键，只在表尾追加 */
+static const MicroBench_Case_t s_cases[] = {
+    {"crc16_modbus/internal_frame",  bench_crc16,          &s_internal_frame, BENCH_ITER_SHORT},
+    {"parse_lora_frame/internal",    bench_parse_frame,    &s_internal_frame, BENCH_ITER_SHORT},
+    {"parse_lora_frame/external",    bench_parse_frame,    &s_external_frame, BENCH_ITER_SHORT},
+    {"parse_sensor_data_internal",   bench_parse_internal, &s_internal_frame, BENCH_ITER_SHORT},
+    {"parse_sensor_data_external",   bench_parse_external, &s_external_frame, BENCH_ITER_SHORT},
+    {"parse_control_data",           bench_parse_control,  &s_control_frame,  BENCH_ITER_SHORT},
+    {"report_json/internal",         bench_report_json,    &s_internal_device, BENCH_ITER_LONG},
+    {"report_json/external",         bench_report_json,    &s_external_device, BENCH_ITER_LONG},
+    {"json_escape/64",               bench_json_escape,    (void *)s_escape_input, BENCH_ITER_SHORT},
+    {"device_lookup/last",           bench_device_lookup,  (void *)(uintptr_t)DEVICE_TYPE_SENSOR_External, BENCH_ITER_SHORT},
+};
+
+/* Public Functions ----------------------------------------------------------*/
+
+/**
+ * @brief 运行网关的全部热点函数用例 (实现)
+ */
+void HotPathBench_Run(void)
+{
+    const size_t count = sizeof(s_cases) / sizeof(s_cases[0]);
+
+    MicroBench_Init();
+    setup_frames();
+
+    MicroBench_Begin(HOT_PATH_BENCH_SUITE);
+    for (size_t i = 0; i < count; i++)
+    {
+        MicroBench_Run(HOT_PATH_BENCH_SUITE, &s_cases[i]);
+#ifndef MICRO_BENCH_HOST
+        HAL_IWDG_Refresh(&hiwdg); // 全部用例约需1~2秒，逐个喂狗留出余量
+#endif
+    }
+    MicroBench_End(HOT_PATH_BENCH_SUITE, count);
+}
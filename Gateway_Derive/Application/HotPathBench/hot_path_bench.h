@@ -0,0 +1,40 @@
+/**
+ * @file      hot_path_bench.h
+ * @author    Your Name
+ * @brief     网关固件热点函数的微基准测试用例 - 头文件
+ * @version   1.0
+ * @date      2025-07-27
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @par 模块功能:
+ *      用 MicroBench (见 micro_bench.h) 测量LoRa接收和云端上报路径上的函数:
+ *      - crc16_modbus                         LoRa帧校验 (目标板上为硬件CRC)
+ *      - parse_lora_frame                     帧头解析 + CRC校验
+ *      - lora_model_parse_sensor_data_*       传感器载荷解包和定点数转换
+ *      - lora_model_parse_control_data        控制节点状态解包
+ *      - HuaweiIoT_WriteDeviceReport          单个子设备的上报JSON (含AT转义)
+ *      - JsonWriter_String                    JSON字符串的转义循环
+ *      - DeviceManager_GetDevice              设备表查找 (find_device_index) 加互斥锁和拷贝
+ *      用例名是跨版本比较的键，修改被测函数时不要改名；新增用例追加在表尾。
+ *
+ * @par 使用说明:
+ *      目标板: 在编译选项中定义 `MICRO_BENCH_ENABLE=1`，App_Main_Init 末尾会运行一次全部用例。
+ *      主机:   Tools/HostBench 的 `make hot_path_bench && ./hot_path_bench`。
+ *      结果的格式见 micro_bench.h。
+ */
+
+#ifndef HOT_PATH_BENCH_H
+#define HOT_PATH_BENCH_H
+
+#include "micro_bench.h"
+
+#define HOT_PATH_BENCH_SUITE  "gateway"  ///< 输出中的用例组名
+
+/**
+ * @brief 运行网关的全部热点函数用例并打印结果
+ * @note  依赖 DeviceManager_Init 和 MX_CRC_Init 已经完成；目标板上每个用例之间会喂一次看门狗。
+ */
+void HotPathBench_Run(void);
+
+#endif // HOT_PATH_BENCH_H
@@ -6,12 +6,16 @@
 #include "cmsis_os2.h"
 #include "main.h"              // 包含 main.h 以便使用 GPIO 定义 (LED_Pin, LED_GPIO_Port)
 #include "iot_config.h"        // 包含新的配置文件
-#include "cJSON.h"             // 引入 cJSON 库
 #include "device_properties.h" // 1. 引入新创建的设备属性库
 #include "FreeRTOS.h"
 #include "device_manager.h" // 需要访问设备管理器
 #include "lora_app.h"       // 引入LoRa应用层，用于发送数据
 #include "lora_protocol.h"  // 引入LoRa协议层，用于封装数据帧
+#include "iot_json_writer.h" // 流式JSON写入器，用于直接在AT发送缓冲区中生成上报负载
+#include "iot_json_parser.h" // 就地JSON分词器，用于解析云端下发的命令
+#include "mem_arena.h"       // 线性内存池，用于上报/命令处理中的临时内存
+#include "at_stats.h"        // AT命令时延统计，作为网关自身的属性上报
+#include "sample_trace.h"    // 样本端到端时延追踪：上报流程记录发送和确认时刻
 
 // The URC handling logic (callback table, init function) has been moved to main.c,
 // as the user has a more advanced implementation there.
@@ -42,21 +46,80 @@ static uint8_t s_lora_tx_buffer[LORA_MAX_RAW_PACKET] = {0}; // LoRa发送缓冲
 
 // --- Command Dispatcher Implementation ---
 
-// 定义命令处理函数的函数指针类型 (修正：使用 const cJSON*)
-typedef void (*command_handler_t)(const cJSON *paras);
-
 /* Private Type Definitions --------------------------------------------------*/
 
 /**
  * @brief 命令表条目结构体
- *        用于将云端下发的命令名称字符串与本地的处理函数进行绑定。
+ *        用于将云端下发的命令名称字符串与本地的处理函数进行绑定，
+ *        并声明该命令在 `paras` 中参数的名称和类型，由分发器统一提取和校验。
  */
 typedef struct
 {
-    const char *command_name;  ///< 命令名称 (来自云端物模型定义)
-    command_handler_t handler; ///< 指向该命令处理函数的指针
+    const char *command_name;        ///< 命令名称 (来自云端物模型定义)
+    const char *param_name;          ///< `paras` 中的参数名 (CMD_PARAM_UINT16_RANGE: 下限的参数名)
+    const char *param2_name;         ///< CMD_PARAM_UINT16_RANGE: 上限的参数名；其他类型为 NULL
+    command_param_type_e param_type; ///< 参数类型
+    command_handler_t handler;       ///< 指向该命令处理函数的指针
 } command_entry_t;
 
+/**
+ * @brief 在AT发送缓冲区中就地构建的 AT+HMPUB 命令帧
+ * @note  数据模式下 (IOT_HMPUB_DATA_MODE) 负载写入独立的负载缓冲区，发送缓冲区中只有命令头。
+ */
+typedef struct
+{
+    char *tx;          ///< AT发送缓冲区 (由 AT_BeginCommand 获得)
+    uint16_t capacity; ///< 发送缓冲区可用大小
+    uint16_t len_pos;  ///< 长度参数预留区在缓冲区中的偏移
+    JsonWriter_t json; ///< 负载写入器，输出位置紧跟在起始引号之后
+    bool async;        ///< 是否通过异步窗口发送 (由 hmpub_begin_async 开始)
+    const char *topic; ///< [数据模式] 发布的Topic，命令头在负载写完后才生成
+} hmpub_frame_t;
+
+/**
+ * @brief 一条在途网关上报消息的上下文，发布结果回调中据此清除脏标记
+ */
+typedef struct
+{
+    uint16_t device_ids[MAX_MANAGED_DEVICES]; ///< 本条消息成功后即可清除脏标记的设备
+    uint8_t device_count;
+    SampleTrace_t traces[SAMPLE_TRACE_MAX_DEVICES]; ///< 本条消息中各传感器样本的时间戳，成功后据此记录端到端时延
+    uint8_t trace_count;
+    uint8_t entry_count;  ///< 本条消息中的设备条目数 (含拆分设备的部分条目)
+    uint16_t payload_len; ///< 负载的逻辑长度
+    volatile bool in_use; ///< 发布结果返回前为 true
+} report_frame_ctx_t;
+
+/* Private Defines -----------------------------------------------------------*/
+
+#define TOPIC_GATEWAY_REPORT "$oc/devices/" IOT_DEVICE_ID "/sys/gateway/sub_devices/properties/report"
+#define TOPIC_EVENTS_UP      "$oc/devices/" IOT_DEVICE_ID "/sys/events/up"
+#define TOPIC_PROPERTIES_REPORT "$oc/devices/" IOT_DEVICE_ID "/sys/properties/report"
+
+#define HMPUB_LEN_FIELD_WIDTH 5     // 长度参数的预留宽度 (uint16_t 最多5位)
+#define HMPUB_TIMEOUT_MS      15000 // 发布命令的超时时间
+#define HMPUB_RESULT_PREFIX   "+HMPUB" // 发布结果URC的前缀 ("+HMPUB OK" / "+HMPUB ERR:<code>")
+
+#define REPORT_ARENA_SIZE     2048  // 单次网关上报的临时内存 (上行任务使用)
+#define COMMAND_ARENA_SIZE    2048  // 单条云端命令处理的临时内存 (AT接收任务使用)
+
+/* Private Variables ---------------------------------------------------------*/
+
+// 临时内存池：每次上报/每条命令处理结束后整体归零，不占用也不碎片化 FreeRTOS 堆
+static uint8_t s_report_arena_buf[REPORT_ARENA_SIZE];
+static uint8_t s_command_arena_buf[COMMAND_ARENA_SIZE];
+static MemArena_t s_report_arena;
+static MemArena_t s_command_arena;
+
+#if IOT_HMPUB_DATA_MODE
+// 数据模式的负载缓冲区：在持有AT命令锁期间写入，命令返回前DMA已将其发完，因此一块即可
+static char s_hmpub_payload[IOT_MAX_PUBLISH_PAYLOAD_LEN];
+#endif
+
+// 在途上报消息的上下文，由发布结果回调 (AT接收任务) 释放，因此不能放在上报内存池中
+static report_frame_ctx_t s_report_frames[AT_ASYNC_WINDOW_SIZE];
+static volatile bool s_report_publish_failed = false; // 本轮上报中是否有消息发布失败
+
 /* Private Function Prototypes ---------------------------------------------*/
 // 为保持代码可读性，所有私有函数在使用前都进行了定义，此处无需前置声明。
 
@@ -71,13 +134,14 @@ typedef struct
  *        3. 调用 `LoRa_APP_Send` 将打包好的帧放入发送队列。
  * @param command_payload 指向要发送的指令负载的指针
  * @param payload_length 指令负载的长度
+ * @return bool 指令帧成功放入发送队列时返回 true
  */
-static void send_lora_command(const uint8_t *command_payload, uint8_t payload_length)
+static bool send_lora_command(const uint8_t *command_payload, uint8_t payload_length)
 {
     if (command_payload == NULL || payload_length == 0)
     {
         printf("[LoRa] Invalid command data to send.\r\n");
-        return;
+        return false;
     }
 
     uint32_t random_seq_num = 0;
@@ -115,6 +179,7 @@ static void send_lora_command(const uint8_t *command_payload, uint8_t payload_le
         else
         {
             printf("[LoRa CMD] Send failed. TX queue might be full.\r\n");
+            return false;
         }
 
         // [FIX] 关键修复：添加延时以避免总线竞争
@@ -122,11 +187,11 @@ static void send_lora_command(const uint8_t *command_payload, uint8_t payload_le
         // 而此时LoRa任务可能正在通过SPI与芯片通信。这会导致底层DMA或总线资源冲突。
         // 此延时给予LoRa任务足够的时间来完成SPI操作，从而错开总线访问高峰。
         osDelay(200);
+        return true;
     }
-    else
-    {
-        printf("[LoRa CMD] Frame generation failed.\r\n");
-    }
+
+    printf("[LoRa CMD] Frame generation failed.\r\n");
+    return false;
 }
 
 static void update_hardware_from_properties(void)
@@ -146,41 +211,17 @@ static void update_hardware_from_properties(void)
  * @details
  *        根据云端下发的布尔值参数 `status` 控制风扇（或示例中的LED）。
  *        此函数是命令分发表 `command_table` 的一个成员。
- * @param paras cJSON对象，包含了命令的所有参数
+ * @param param 已由分发器提取并校验过的 `status` 参数
+ * @return command_result_e LoRa指令未能放入发送队列时返回 CMD_RESULT_FAILED
  */
-static void handle_setFanStatus(const cJSON *paras)
+static command_result_e handle_setFanStatus(command_param_t param)
 {
-    if (!cJSON_IsObject(paras))
-    {
-        printf("[CMD_HANDLER] 'paras' is not an object for setFanStatus.\r\n");
-        return;
-    }
-
-    const cJSON *status_item = cJSON_GetObjectItem(paras, "status");
-    uint8_t cmd[2]; // 使用局部变量构建指令负载
-
-    if (cJSON_IsTrue(status_item))
-    {
-        printf("[ACTION] Updating 'fanStatus' property to: ON\r\n");
-        g_controlNodeProps.fanStatus = true;
-        cmd[0] = CONTROLLER_DEVICE_TYPE_STATUS_FAN;
-        cmd[1] = 0x01; // 1 for ON
-    }
-    else if (cJSON_IsFalse(status_item))
-    {
-        printf("[ACTION] Updating 'fanStatus' property to: OFF\r\n");
-        g_controlNodeProps.fanStatus = false;
-        cmd[0] = CONTROLLER_DEVICE_TYPE_STATUS_FAN;
-        cmd[1] = 0x00; // 0 for OFF
-    }
-    else
-    {
-        printf("[CMD_HANDLER] 'status' not found or not a boolean in setFanStatus.\r\n");
-        return; // 参数错误，不发送指令
-    }
+    printf("[ACTION] Updating 'fanStatus' property to: %s\r\n", param.b ? "ON" : "OFF");
+    g_controlNodeProps.fanStatus = param.b;
 
+    uint8_t cmd[2] = {CONTROLLER_DEVICE_TYPE_STATUS_FAN, param.b ? 0x01 : 0x00};
     // 将构建好的指令通过LoRa发送出去
-    send_lora_command(cmd, sizeof(cmd));
+    return send_lora_command(cmd, sizeof(cmd)) ? CMD_RESULT_OK : CMD_RESULT_FAILED;
 }
 
 /**
@@ -188,229 +229,520 @@ static void handle_setFanStatus(const cJSON *paras)
  * @details
  *        根据云端下发的布尔值参数 `status` 控制植物生长灯。
  *        此函数是命令分发表 `command_table` 的一个成员。
- * @param paras cJSON对象，包含了命令的所有参数
+ * @param param 已由分发器提取并校验过的 `status` 参数
+ * @return command_result_e LoRa指令未能放入发送队列时返回 CMD_RESULT_FAILED
  */
-static void handle_setGrowLightStatus(const cJSON *paras)
+static command_result_e handle_setGrowLightStatus(command_param_t param)
 {
-    if (!cJSON_IsObject(paras))
-    {
-        printf("[CMD_HANDLER] 'paras' is not an object for setGrowLightStatus.\r\n");
-        return;
-    }
+    printf("[ACTION] Updating 'growLightStatus' property to: %s\r\n", param.b ? "ON" : "OFF");
+    g_controlNodeProps.growLightStatus = param.b;
 
-    const cJSON *status_item = cJSON_GetObjectItem(paras, "status");
-    uint8_t cmd[2]; // 使用局部变量构建指令负载
+    uint8_t cmd[2] = {CONTROLLER_DEVICE_TYPE_STATUS_LIGHT, param.b ? 0x01 : 0x00};
+    return send_lora_command(cmd, sizeof(cmd)) ? CMD_RESULT_OK : CMD_RESULT_FAILED;
+}
 
-    if (cJSON_IsTrue(status_item))
-    {
-        printf("[ACTION] Updating 'growLightStatus' property to: ON\r\n");
-        g_controlNodeProps.growLightStatus = true;
-        cmd[0] = CONTROLLER_DEVICE_TYPE_STATUS_LIGHT;
-        cmd[1] = 0x01; // 1 for ON
-    }
-    else if (cJSON_IsFalse(status_item))
+/**
+ * @brief "setPumpStatus" 命令的处理函数
+ * @details
+ *        根据云端下发的布尔值参数 `status` 控制水泵。
+ *        此函数是命令分发表 `command_table` 的一个成员。
+ * @param param 已由分发器提取并校验过的 `status` 参数
+ * @return command_result_e LoRa指令未能放入发送队列时返回 CMD_RESULT_FAILED
+ */
+static command_result_e handle_setPumpStatus(command_param_t param)
+{
+    printf("[ACTION] Updating 'PumpStatus' property to: %s\r\n", param.b ? "ON" : "OFF");
+    g_controlNodeProps.pumpStatus = param.b;
+
+    uint8_t cmd[2] = {CONTROLLER_DEVICE_TYPE_STATUS_PUMP, param.b ? 0x01 : 0x00};
+    return send_lora_command(cmd, sizeof(cmd)) ? CMD_RESULT_OK : CMD_RESULT_FAILED;
+}
+
+/**
+ * @brief "setFanSpeed" 命令的处理函数
+ * @details
+ *        根据云端下发的整数参数 `speed` 控制风扇速度。
+ *        此函数是命令分发表 `command_table` 的一个成员。
+ * @param param 已由分发器提取并校验过的 `speed` 参数
+ * @return command_result_e LoRa指令未能放入发送队列时返回 CMD_RESULT_FAILED
+ */
+static command_result_e handle_setFanSpeed(command_param_t param)
+{
+    printf("[ACTION] Updating 'FanSpeed' property to: %d\r\n", param.u8);
+    g_controlNodeProps.fanSpeed = param.u8;
+
+    uint8_t cmd[2] = {CONTROLLER_DEVICE_TYPE_SPEED_FAN, param.u8};
+    return send_lora_command(cmd, sizeof(cmd)) ? CMD_RESULT_OK : CMD_RESULT_FAILED;
+}
+
+/**
+ * @brief "setPumpSpeed" 命令的处理函数
+ * @details
+ *        根据云端下发的整数参数 `speed` 控制水泵速度。
+ *        此函数是命令分发表 `command_table` 的一个成员。
+ * @param param 已由分发器提取并校验过的 `speed` 参数
+ * @return command_result_e LoRa指令未能放入发送队列时返回 CMD_RESULT_FAILED
+ */
+static command_result_e handle_setPumpSpeed(command_param_t param)
+{
+    printf("[ACTION] Updating 'PumpSpeed' property to: %d\r\n", param.u8);
+    g_controlNodeProps.pumpSpeed = param.u8;
+
+    uint8_t cmd[2] = {CONTROLLER_DEVICE_TYPE_SPEED_PUMP, param.u8};
+    return send_lora_command(cmd, sizeof(cmd)) ? CMD_RESULT_OK : CMD_RESULT_FAILED;
+}
+
+/**
+ * @brief 向大棚传感器节点登记一个配置项
+ * @details 传感器节点只在上报后收听，配置项由 LoRa 应用层暂存到该节点下一次上报时发出。
+ * @param cmd 一个或多个配置项 [配置项(1) + 值(uint16 小端)]
+ * @param len cmd 的长度
+ * @return command_result_e 下行队列已满时返回 CMD_RESULT_FAILED
+ */
+static command_result_e queue_sensor_config(const uint8_t *cmd, uint8_t len)
+{
+    if (!LoRa_APP_QueueDownlink(DEVICE_TYPE_SENSOR_Internal, cmd, len))
     {
-        printf("[ACTION] Updating 'growLightStatus' property to: OFF\r\n");
-        g_controlNodeProps.growLightStatus = false;
-        cmd[0] = CONTROLLER_DEVICE_TYPE_STATUS_LIGHT;
-        cmd[1] = 0x00; // 0 for OFF
+        printf("[LoRa CMD] Downlink queue full, sensor config dropped.\r\n");
+        return CMD_RESULT_FAILED;
     }
-    else
+    return CMD_RESULT_OK;
+}
+
+/**
+ * @brief "setSampleInterval" 命令的处理函数
+ * @details 设置大棚传感器节点自适应采样的最短间隔 (读数快速变化时使用) 和最长间隔 (读数稳定、电量低时使用)。
+ *          两个值在同一帧下行中发出，节点一起校验：分开下发时，单独的一个值可能与节点当前的另一个值矛盾而被丢弃。
+ *          网关按与节点相同的范围 (lora_protocol.h 中的 SAMPLING_LIMIT_xxx) 先行校验，
+ *          越界的值不会下发，云端立即得到 result_code 1，而不是等节点静默丢弃。
+ * @param param 已由分发器提取并校验过 (min <= max) 的 `min`、`max` 参数
+ * @return command_result_e 值越界时返回 CMD_RESULT_INVALID_PARAM，下行队列已满时返回 CMD_RESULT_FAILED
+ */
+static command_result_e handle_setSampleInterval(command_param_t param)
+{
+    if (param.range.min < SAMPLING_LIMIT_MIN_S || param.range.max > SAMPLING_LIMIT_MAX_S)
     {
-        printf("[CMD_HANDLER] 'status' not found or not a boolean in setGrowLightStatus.\r\n");
-        return; // 参数错误，不发送指令
+        printf("[CMD_HANDLER] Sampling interval %u-%u s out of range (%u-%u s).\r\n", param.range.min,
+               param.range.max, (unsigned int)SAMPLING_LIMIT_MIN_S, (unsigned int)SAMPLING_LIMIT_MAX_S);
+        return CMD_RESULT_INVALID_PARAM;
     }
 
-    // 将构建好的指令通过LoRa发送出去
-    send_lora_command(cmd, sizeof(cmd));
+    printf("[ACTION] Queueing sampling interval: %u-%u s\r\n", param.range.min, param.range.max);
+
+    uint8_t cmd[2 * SENSOR_CONFIG_ITEM_SIZE];
+    cmd[0] = SENSOR_CONFIG_SAMPLE_MIN_S;
+    lora_model_pack_u16le(&cmd[1], param.range.min);
+    cmd[SENSOR_CONFIG_ITEM_SIZE] = SENSOR_CONFIG_SAMPLE_MAX_S;
+    lora_model_pack_u16le(&cmd[SENSOR_CONFIG_ITEM_SIZE + 1], param.range.max);
+    return queue_sensor_config(cmd, sizeof(cmd));
 }
 
 /**
- * @brief "setPumpStatus" 命令的处理函数
+ * @brief "requestBackfill" 命令的处理函数
+ * @details 请大棚传感器节点补发最近一段时间内记录在其Flash中的样本 (例如网关或网络中断之后)。
+ *          补发的样本目前只在网关上打印 (见 lora_app.c 的 receive_backfill)，尚不上传到云端。
+ * @param param 已由分发器提取并校验过的 `minutes` 参数
+ * @return command_result_e 下行队列已满时返回 CMD_RESULT_FAILED
+ */
+static command_result_e handle_requestBackfill(command_param_t param)
+{
+    printf("[ACTION] Queueing backfill of the last %u min\r\n", param.u16);
+
+    uint8_t cmd[SENSOR_CONFIG_ITEM_SIZE];
+    cmd[0] = SENSOR_CONFIG_BACKFILL_FROM_MIN;
+    lora_model_pack_u16le(&cmd[1], param.u16);
+    return queue_sensor_config(cmd, sizeof(cmd));
+}
+
+/* Private Constants ---------------------------------------------------------*/
+
+/**
+ * @brief 命令分发表
  * @details
- *        根据云端下发的布尔值参数 `status` 控制水泵。
- *        此函数是命令分发表 `command_table` 的一个成员。
- * @param paras cJSON对象，包含了命令的所有参数
+ *        一个静态常量数组，是命令分发机制的核心。
+ *        要扩展新的云端命令，只需：
+ *        1. 实现一个新的 handle_xxx 函数。
+ *        2. 在此表中新增一行，声明命令字符串、参数名 (第二个参数名只用于 CMD_PARAM_UINT16_RANGE)、
+ *           参数类型和处理函数。
+ * @note  表项必须按 command_name 的字典序 (strcmp) 排列，分发器使用二分查找。
+ *        HuaweiIoT_Init() 会在启动时检查顺序。
+ */
+static const command_entry_t command_table[] = {
+    {"requestBackfill",    "minutes", NULL,  CMD_PARAM_UINT16,       handle_requestBackfill},
+    {"setFanSpeed",        "speed",   NULL,  CMD_PARAM_UINT8,        handle_setFanSpeed},
+    {"setFanStatus",       "status",  NULL,  CMD_PARAM_BOOL,         handle_setFanStatus},
+    {"setGrowLightStatus", "status",  NULL,  CMD_PARAM_BOOL,         handle_setGrowLightStatus},
+    {"setPumpSpeed",       "speed",   NULL,  CMD_PARAM_UINT8,        handle_setPumpSpeed},
+    {"setPumpStatus",      "status",  NULL,  CMD_PARAM_BOOL,         handle_setPumpStatus},
+    {"setSampleInterval",  "min",     "max", CMD_PARAM_UINT16_RANGE, handle_setSampleInterval},
+};
+
+// 自动计算命令表的大小
+#define COMMAND_TABLE_SIZE (sizeof(command_table) / sizeof(command_table[0]))
+
+// 一条下行命令JSON最多使用的token数 (典型命令约12个)
+#define HMREC_MAX_TOKENS 32
+
+// 命令响应负载，按 command_result_e 索引 (已转义；各项的逻辑长度相同)
+static const char *const s_result_payloads[] = {
+    [CMD_RESULT_OK]            = "{\\\"result_code\\\":0}",
+    [CMD_RESULT_INVALID_PARAM] = "{\\\"result_code\\\":1}",
+    [CMD_RESULT_FAILED]        = "{\\\"result_code\\\":2}",
+};
+#define RESULT_PAYLOAD_LEN 17 // {"result_code":N}
+
+/**
+ * @brief 在已排序的命令表中二分查找命令
+ * @param name 命令名称 (不要求以 '\0' 结尾)
+ * @param len  命令名称的长度
+ * @return const command_entry_t* 找到的表项，未找到时返回 NULL
  */
-static void handle_setPumpStatus(const cJSON *paras)
+static const command_entry_t *find_command(const char *name, size_t len)
 {
-    if (!cJSON_IsObject(paras))
+    int low = 0;
+    int high = (int)COMMAND_TABLE_SIZE - 1;
+
+    while (low <= high)
     {
-        printf("[CMD_HANDLER] 'paras' is not an object for setPumpStatus.\r\n");
-        return;
+        int mid = (low + high) / 2;
+        const char *entry = command_table[mid].command_name;
+        int cmp = strncmp(name, entry, len);
+        if (cmp == 0 && entry[len] != '\0')
+        {
+            cmp = -1; // name 是 entry 的前缀
+        }
+
+        if (cmp == 0)
+            return &command_table[mid];
+        if (cmp < 0)
+            high = mid - 1;
+        else
+            low = mid + 1;
     }
+    return NULL;
+}
 
-    const cJSON *status_item = cJSON_GetObjectItem(paras, "status");
-    uint8_t cmd[2]; // 使用局部变量构建指令负载
+/**
+ * @brief 把一个值 token 转换为 0-65535 的整数
+ */
+static bool get_uint16(const char *js, const JsonToken_t *token, uint16_t *out)
+{
+    int32_t value;
+    if (!JsonParser_GetInt(js, token, &value) || value < 0 || value > UINT16_MAX)
+    {
+        return false;
+    }
+    *out = (uint16_t)value;
+    return true;
+}
 
-    if (cJSON_IsTrue(status_item))
+/**
+ * @brief 从 paras 对象中提取命令声明的参数，并转换为对应的类型
+ * @return bool 参数存在且类型、范围均合法时返回 true
+ */
+static bool extract_command_param(const char *js, const JsonToken_t *tokens, int count, int paras_index,
+                                  const command_entry_t *entry, command_param_t *out)
+{
+    int value_index = JsonParser_FindKey(js, tokens, count, paras_index, entry->param_name);
+    if (value_index < 0)
     {
-        printf("[ACTION] Updating 'PumpStatus' property to: ON\r\n");
-        g_controlNodeProps.pumpStatus = true;
-        cmd[0] = CONTROLLER_DEVICE_TYPE_STATUS_PUMP;
-        cmd[1] = 0x01; // 1 for ON
+        return false;
     }
-    else if (cJSON_IsFalse(status_item))
+
+    switch (entry->param_type)
+    {
+    case CMD_PARAM_BOOL:
+        return JsonParser_GetBool(js, &tokens[value_index], &out->b);
+
+    case CMD_PARAM_UINT8:
     {
-        printf("[ACTION] Updating 'PumpStatus' property to: OFF\r\n");
-        g_controlNodeProps.growLightStatus = false;
-        cmd[0] = CONTROLLER_DEVICE_TYPE_STATUS_PUMP;
-        cmd[1] = 0x00; // 0 for OFF
+        int32_t value;
+        if (!JsonParser_GetInt(js, &tokens[value_index], &value) || value < 0 || value > UINT8_MAX)
+        {
+            return false;
+        }
+        out->u8 = (uint8_t)value;
+        return true;
     }
-    else
+
+    case CMD_PARAM_UINT16:
+        return get_uint16(js, &tokens[value_index], &out->u16);
+
+    case CMD_PARAM_UINT16_RANGE:
     {
-        printf("[CMD_HANDLER] 'status' not found or not a boolean in setPumpStatus.\r\n");
-        return; // 参数错误，不发送指令
+        int max_index = JsonParser_FindKey(js, tokens, count, paras_index, entry->param2_name);
+        return max_index >= 0 && get_uint16(js, &tokens[value_index], &out->range.min) &&
+               get_uint16(js, &tokens[max_index], &out->range.max) && out->range.min <= out->range.max;
     }
 
-    // 将构建好的指令通过LoRa发送出去
-    send_lora_command(cmd, sizeof(cmd));
+    default:
+        return false;
+    }
 }
 
+/* Private Functions (HMPUB Framing) -----------------------------------------*/
+
 /**
- * @brief "setFanSpeed" 命令的处理函数
+ * @brief 在已获得的AT发送缓冲区中写入 AT+HMPUB 命令头，并初始化JSON写入器
  * @details
- *        根据云端下发的整数参数 `speed` 控制风扇速度。
- *        此函数是命令分发表 `command_table` 的一个成员。
- * @param paras cJSON对象，包含了命令的所有参数
+ *        写入 `AT+HMPUB=1,"<topic>",` 后，为长度参数预留 HMPUB_LEN_FIELD_WIDTH 个字符，
+ *        再写入 `,"` (长度之后的逗号和负载的起始引号)，然后将剩余空间交给JSON写入器。
+ * @return bool 缓冲区放不下命令头时返回 false
  */
-static void handle_setFanSpeed(const cJSON *paras)
+static bool hmpub_open(hmpub_frame_t *frame, const char *topic)
 {
-    if (!cJSON_IsObject(paras))
+#if IOT_HMPUB_DATA_MODE
+    // 数据模式：负载不转义，也不必为长度参数预留位置
+    frame->topic = topic;
+    JsonWriter_InitRaw(&frame->json, s_hmpub_payload, sizeof(s_hmpub_payload));
+    return true;
+#else
+    int header_len = snprintf(frame->tx, frame->capacity, "AT+HMPUB=1,\"%s\",", topic);
+    // 头部 + 长度预留 + 逗号 + 起始引号 + 结束引号，至少还要能放下一个 "{}"
+    if (header_len < 0 || header_len + HMPUB_LEN_FIELD_WIDTH + 3 + 2 > frame->capacity)
     {
-        printf("[CMD_HANDLER] 'paras' is not an object for setFanSpeed.\r\n");
-        return;
+        return false;
     }
 
-    const cJSON *speed_item = cJSON_GetObjectItem(paras, "speed");
-    uint8_t cmd[2]; // 使用局部变量构建指令负载
+    frame->len_pos = (uint16_t)header_len;
+    uint16_t payload_pos = frame->len_pos + HMPUB_LEN_FIELD_WIDTH;
+    frame->tx[payload_pos++] = ',';
+    frame->tx[payload_pos++] = '"';
+
+    // 末尾留1字节给负载的结束引号
+    JsonWriter_Init(&frame->json, frame->tx + payload_pos, frame->capacity - payload_pos - 1);
+    return true;
+#endif
+}
 
-    if (cJSON_IsNumber(speed_item))
+/**
+ * @brief 放弃一条已开始的 AT+HMPUB 命令，释放命令锁 (异步帧同时归还窗口名额)
+ */
+static void hmpub_abort(AT_Handler_t *handler, hmpub_frame_t *frame)
+{
+    if (frame->async)
     {
-        uint8_t speed = (uint8_t)speed_item->valuedouble;
-        printf("[ACTION] Updating 'FanSpeed' property to: %d\r\n", speed);
-        g_controlNodeProps.fanSpeed = speed;
-        cmd[0] = CONTROLLER_DEVICE_TYPE_SPEED_FAN;
-        cmd[1] = speed;
+        AT_AbortAsyncCommand(handler);
     }
     else
     {
-        printf("[CMD_HANDLER] 'speed' not found or not a number in setFanSpeed.\r\n");
-        return; // 参数错误，不发送指令
+        AT_AbortCommand(handler);
     }
-
-    // 将构建好的指令通过LoRa发送出去
-    send_lora_command(cmd, sizeof(cmd));
 }
 
 /**
- * @brief "setPumpSpeed" 命令的处理函数
- * @details
- *        根据云端下发的整数参数 `speed` 控制水泵速度。
- *        此函数是命令分发表 `command_table` 的一个成员。
- * @param paras cJSON对象，包含了命令的所有参数
+ * @brief 开始在AT发送缓冲区中就地构建一条 AT+HMPUB 命令 (同步发送)
+ * @details 成功返回后，AT命令锁处于持有状态，必须以 `hmpub_finish` 或 `hmpub_abort` 结束。
+ * @param handler AT处理器实例指针
+ * @param topic   发布的Topic
+ * @param frame   输出：帧上下文
+ * @return AT_Status_t AT_OK 表示可以开始写入JSON
  */
-static void handle_setPumpSpeed(const cJSON *paras)
+static AT_Status_t hmpub_begin(AT_Handler_t *handler, const char *topic, hmpub_frame_t *frame)
 {
-    if (!cJSON_IsObject(paras))
+    frame->async = false;
+    frame->tx = AT_BeginCommand(handler, HMPUB_TIMEOUT_MS, &frame->capacity);
+    if (frame->tx == NULL)
     {
-        printf("[CMD_HANDLER] 'paras' is not an object for setPumpSpeed.\r\n");
-        return;
+        return AT_TIMEOUT;
     }
+    if (!hmpub_open(frame, topic))
+    {
+        hmpub_abort(handler, frame);
+        return AT_BUFFER_FULL;
+    }
+    return AT_OK;
+}
 
-    const cJSON *speed_item = cJSON_GetObjectItem(paras, "speed");
-    uint8_t cmd[2]; // 使用局部变量构建指令负载
-
-    if (cJSON_IsNumber(speed_item))
+/**
+ * @brief 同 `hmpub_begin`，但命令将通过AT层的异步窗口发送
+ * @details 窗口已满时先等待最早的在途发布返回结果。必须以 `hmpub_finish_async` 或 `hmpub_abort` 结束。
+ */
+static AT_Status_t hmpub_begin_async(AT_Handler_t *handler, const char *topic, hmpub_frame_t *frame)
+{
+    frame->async = true;
+    frame->tx = AT_BeginAsyncCommand(handler, HMPUB_TIMEOUT_MS, &frame->capacity);
+    if (frame->tx == NULL)
     {
-        uint8_t speed = (uint8_t)speed_item->valuedouble;
-        printf("[ACTION] Updating 'PumpSpeed' property to: %d\r\n", speed);
-        g_controlNodeProps.pumpSpeed = speed;
-        cmd[0] = CONTROLLER_DEVICE_TYPE_SPEED_PUMP;
-        cmd[1] = speed;
+        return AT_TIMEOUT;
     }
-    else
+    if (!hmpub_open(frame, topic))
     {
-        printf("[CMD_HANDLER] 'speed' not found or not a number in setPumpSpeed.\r\n");
-        return; // 参数错误，不发送指令
+        hmpub_abort(handler, frame);
+        return AT_BUFFER_FULL;
     }
-
-    // 将构建好的指令通过LoRa发送出去
-    send_lora_command(cmd, sizeof(cmd));
+    return AT_OK;
 }
 
-/* Private Constants ---------------------------------------------------------*/
-
 /**
- * @brief 命令分发表
+ * @brief 填入负载的逻辑长度，完成 AT+HMPUB 命令的构建
  * @details
- *        一个静态常量数组，是命令分发机制的核心。
- *        要扩展新的云端命令，只需：
- *        1. 实现一个新的 handle_xxx 函数。
- *        2. 在此表中新增一行，将命令字符串和新的处理函数关联起来。
+ *        长度在JSON写完后才确定，因此先把实际的数字写到预留位置，
+ *        再把 `,"<json>` 整体左移紧贴其后，最后补上结束引号。
+ * @return uint16_t 命令长度 (不含 "\r\n")；负载超出缓冲区时返回0 (此时已放弃本条命令)
  */
-static const command_entry_t command_table[] = {
-    {"setFanStatus", handle_setFanStatus},
-    {"setGrowLightStatus", handle_setGrowLightStatus},
-    {"setPumpStatus", handle_setPumpStatus},
-    {"setFanSpeed", handle_setFanSpeed},
-    {"setPumpSpeed", handle_setPumpSpeed}
-};
-
-// 自动计算命令表的大小
-#define COMMAND_TABLE_SIZE (sizeof(command_table) / sizeof(command_table[0]))
+static uint16_t hmpub_seal(AT_Handler_t *handler, hmpub_frame_t *frame)
+{
+    if (!JsonWriter_IsOk(&frame->json))
+    {
+        printf("[HMPUB] Payload does not fit in buffer (%u bytes).\r\n", frame->json.size);
+        hmpub_abort(handler, frame);
+        return 0;
+    }
 
-/* Private Functions (Helpers) ---------------------------------------------*/
+#if IOT_HMPUB_DATA_MODE
+    // 数据模式：长度已知，直接生成命令头
+    int header_len = snprintf(frame->tx, frame->capacity, "AT+HMPUB=1,\"%s\",%u", frame->topic, frame->json.logical_len);
+    if (header_len < 0 || header_len >= frame->capacity)
+    {
+        hmpub_abort(handler, frame);
+        return 0;
+    }
+    return (uint16_t)header_len;
+#else
+    char len_str[HMPUB_LEN_FIELD_WIDTH + 1];
+    int len_digits = snprintf(len_str, sizeof(len_str), "%u", frame->json.logical_len);
+
+    char *len_field = frame->tx + frame->len_pos;
+    uint16_t tail_len = 2 + frame->json.pos; // 逗号 + 起始引号 + 已转义的JSON
+    memcpy(len_field, len_str, len_digits);
+    memmove(len_field + len_digits, len_field + HMPUB_LEN_FIELD_WIDTH, tail_len);
+
+    uint16_t cmd_len = frame->len_pos + len_digits + tail_len;
+    frame->tx[cmd_len++] = '"';
+    return cmd_len;
+#endif
+}
 
 /**
- * @brief 为cJSON库提供基于FreeRTOS的内存分配函数
- * @param size 要分配的内存大小
- * @return void* 指向分配内存的指针
+ * @brief 完成并同步发送 AT+HMPUB 命令
+ * @return AT_Status_t 命令执行结果；负载超出缓冲区时返回 AT_BUFFER_FULL
  */
-static void *cjson_malloc_rtos(size_t size)
+static AT_Status_t hmpub_finish(AT_Handler_t *handler, hmpub_frame_t *frame)
 {
-    return pvPortMalloc(size);
+    uint16_t cmd_len = hmpub_seal(handler, frame);
+    if (cmd_len == 0)
+    {
+        return AT_BUFFER_FULL;
+    }
+#if IOT_HMPUB_DATA_MODE
+    AT_TxSegment_t payload = {.data = s_hmpub_payload, .len = frame->json.pos};
+    return AT_ExecuteDataCommand(handler, cmd_len, &payload, 1, IOT_HMPUB_DATA_PROMPT, HMPUB_TIMEOUT_MS, NULL, 0);
+#else
+    return AT_ExecuteCommand(handler, cmd_len, HMPUB_TIMEOUT_MS, NULL, 0);
+#endif
 }
 
 /**
- * @brief 为cJSON库提供基于FreeRTOS的内存释放函数
- * @param ptr 指向要释放内存的指针
+ * @brief 完成并异步发送 AT+HMPUB 命令，命令帧发送完毕后即返回
+ * @return AT_Status_t AT_OK: 已发送，发布结果稍后通过 `callback` 通知；其他: 未发送，回调不会被调用
  */
-static void cjson_free_rtos(void *ptr)
+static AT_Status_t hmpub_finish_async(AT_Handler_t *handler, hmpub_frame_t *frame, at_async_callback_t callback, void *ctx)
 {
-    vPortFree(ptr);
+    uint16_t cmd_len = hmpub_seal(handler, frame);
+    if (cmd_len == 0)
+    {
+        return AT_BUFFER_FULL;
+    }
+#if IOT_HMPUB_DATA_MODE
+    AT_TxSegment_t payload = {.data = s_hmpub_payload, .len = frame->json.pos};
+    return AT_ExecuteAsyncDataCommand(handler, cmd_len, &payload, 1, IOT_HMPUB_DATA_PROMPT, HMPUB_RESULT_PREFIX,
+                                      HMPUB_TIMEOUT_MS, callback, ctx, NULL);
+#else
+    return AT_ExecuteAsyncCommand(handler, cmd_len, HMPUB_RESULT_PREFIX, HMPUB_TIMEOUT_MS, callback, ctx, NULL);
+#endif
 }
 
-/* Public Functions ----------------------------------------------------------*/
+/* Private Functions (Connection Script) -------------------------------------*/
 
-void HuaweiIoT_Init(void)
+/**
+ * @brief 判定 AT+MIPCALL? 的响应中是否带有有效的IP地址
+ */
+static bool mipcall_has_ip(const char *response)
 {
-    cJSON_Hooks hooks = {
-        .malloc_fn = cjson_malloc_rtos,
-        .free_fn = cjson_free_rtos};
-    cJSON_InitHooks(&hooks);
+    return strstr(response, ".") != NULL && strstr(response, "0.0.0.0") == NULL;
 }
 
-// --- Main Parser and Dispatcher ---
+/**
+ * @brief 云平台连接脚本的步骤下标
+ */
+enum
+{
+    CONNECT_STEP_QUERY_PDP,    // 查询PDP上下文
+    CONNECT_STEP_RESET_MQTT,   // [快速路径] 复用PDP，仅断开残留的MQTT会话
+    CONNECT_STEP_RESUME_MQTT,  // [快速路径] 直接重新建立MQTT连接
+    CONNECT_STEP_TEARDOWN_PDP, // [完整路径] 快速路径失败，关闭失效的PDP
+    CONNECT_STEP_ACTIVATE_PDP, // [完整路径] 激活PDP
+    CONNECT_STEP_WAIT_IP,      // [完整路径] 轮询确认获得IP
+    CONNECT_STEP_CONNECT_MQTT, // [完整路径] 建立MQTT连接
+    CONNECT_STEP_COUNT
+};
 
-void HuaweiIoT_ParseHMREC(AT_Handler_t *at_handler, const char *hprec_str)
+#define HMCON_CMD "AT+HMCON=0,60,\"" IOT_SERVER_ADDRESS "\",\"" IOT_SERVER_PORT "\",\"" IOT_DEVICE_ID "\",\"" IOT_DEVICE_PASSWORD "\",0"
+
+/**
+ * @brief 云平台连接脚本
+ * @details
+ *        - **快速路径**: 模组未重启时 (例如仅MQTT断开或MCU单独复位)，PDP上下文通常仍然有效。
+ *          此时跳过 去激活/激活/轮询IP 这几步，只重建MQTT会话，省下十几秒。
+ *        - **完整路径**: PDP未激活，或在快速路径上建链失败 (PDP已失效) 时，
+ *          关闭PDP后重新拨号，与原先的连接流程一致。
+ */
+static const AT_ScriptStep_t s_connect_script[CONNECT_STEP_COUNT] = {
+    [CONNECT_STEP_QUERY_PDP] = {
+        .name = "QueryPDP", .cmd = "AT+MIPCALL?", .timeout_ms = 5000, .attempts = 1,
+        .match = mipcall_has_ip,
+        .on_success = CONNECT_STEP_RESET_MQTT, .on_failure = CONNECT_STEP_ACTIVATE_PDP},
+    [CONNECT_STEP_RESET_MQTT] = {
+        .name = "ResetMQTT", .cmd = "AT+HMDIS", .timeout_ms = 5000, .attempts = 1,
+        .on_success = AT_SCRIPT_NEXT, .on_failure = AT_SCRIPT_NEXT}, // 会话可能本来就已断开
+    [CONNECT_STEP_RESUME_MQTT] = {
+        .name = "ResumeMQTT", .cmd = HMCON_CMD, .timeout_ms = 30000, .attempts = 1,
+        .on_success = AT_SCRIPT_DONE, .on_failure = CONNECT_STEP_TEARDOWN_PDP},
+    [CONNECT_STEP_TEARDOWN_PDP] = {
+        .name = "TeardownPDP", .cmd = "AT+MIPCALL=0", .timeout_ms = 8000, .attempts = 1,
+        .on_success = AT_SCRIPT_NEXT, .on_failure = AT_SCRIPT_NEXT},
+    [CONNECT_STEP_ACTIVATE_PDP] = {
+        .name = "ActivatePDP", .cmd = "AT+MIPCALL=1", .timeout_ms = 8000, .attempts = 2, .retry_delay_ms = 1000,
+        .on_success = AT_SCRIPT_NEXT, .on_failure = AT_SCRIPT_ABORT},
+    [CONNECT_STEP_WAIT_IP] = {
+        .name = "WaitIP", .cmd = "AT+MIPCALL?", .timeout_ms = 2000, .attempts = 15, .retry_delay_ms = 1000,
+        .match = mipcall_has_ip,
+        .on_success = AT_SCRIPT_NEXT, .on_failure = AT_SCRIPT_ABORT},
+    [CONNECT_STEP_CONNECT_MQTT] = {
+        .name = "ConnectMQTT", .cmd = HMCON_CMD, .timeout_ms = 30000, .attempts = 1,
+        .on_success = AT_SCRIPT_DONE, .on_failure = AT_SCRIPT_ABORT},
+};
+
+static AT_ScriptResult_t s_last_connect_result; // 最近一次连接脚本的执行结果
+
+/* Public Functions ----------------------------------------------------------*/
+
+void HuaweiIoT_Init(void)
 {
-    if (!at_handler)
+    MemArena_Init(&s_report_arena, "Report", s_report_arena_buf, sizeof(s_report_arena_buf));
+    MemArena_Init(&s_command_arena, "Command", s_command_arena_buf, sizeof(s_command_arena_buf));
+
+    // 命令分发使用二分查找，检查命令表是否按字典序排列
+    for (size_t i = 1; i < COMMAND_TABLE_SIZE; i++)
     {
-        printf("[ERROR] Invalid AT handler.\r\n");
-        return;
+        if (strcmp(command_table[i - 1].command_name, command_table[i].command_name) >= 0)
+        {
+            printf("[ERROR] command_table is not sorted at '%s'.\r\n", command_table[i].command_name);
+        }
     }
+}
 
-    printf("\r\n[URC] Parsing HMREC with dispatcher: %s\r\n", hprec_str);
+// --- Main Parser and Dispatcher ---
 
-    // --- 修正：将所有局部变量声明移到函数顶部 ---
-    cJSON *root = NULL;
+/**
+ * @brief 解析并分发一条 "+HMREC" 命令 (在命令内存池的作用域内执行)
+ */
+static void parse_hmrec(AT_Handler_t *at_handler, const char *hprec_str)
+{
     char request_id[48] = {0};
-    const cJSON *command_name_item = NULL;
-    const cJSON *paras_item = NULL;
-    int handler_found = 0;
-    char escaped_payload[] = "{\\\"result_code\\\":0}";
-    uint16_t logical_len = 17;
+    command_param_t param;
+    command_result_e result;
 
     // 1. 提取 Request ID
     const char *request_id_key = "request_id=";
@@ -427,7 +759,7 @@ void HuaweiIoT_ParseHMREC(AT_Handler_t *at_handler, const char *hprec_str)
     }
 
     int req_id_len = p_request_id_end - p_request_id_start;
-    if (req_id_len <= 0 || req_id_len >= sizeof(request_id))
+    if (req_id_len <= 0 || (size_t)req_id_len >= sizeof(request_id))
     { /* ... error handling ... */
         return;
     }
@@ -435,65 +767,108 @@ void HuaweiIoT_ParseHMREC(AT_Handler_t *at_handler, const char *hprec_str)
     request_id[req_id_len] = '\0';
     printf("[URC] Request ID: %s\r\n", request_id);
 
-    // 2. 定位并解析 JSON 负载
-    const char *p_json_start = strchr(hprec_str, '{');
-    if (!p_json_start)
+    // 2. 定位并就地解析 JSON 负载 (token 数组取自命令内存池，根对象闭合后即停止)
+    const char *js = strchr(hprec_str, '{');
+    if (!js)
     { /* ... error handling ... */
         return;
     }
 
-    root = cJSON_Parse(p_json_start);
-    if (root == NULL)
+    JsonToken_t *tokens = MemArena_Alloc(&s_command_arena, sizeof(JsonToken_t) * HMREC_MAX_TOKENS);
+    if (tokens == NULL)
+    {
+        printf("[JSON] No memory for tokens.\r\n");
+        return;
+    }
+
+    size_t js_len = strlen(js);
+    int token_count = JsonParser_Parse(js, (js_len < UINT16_MAX) ? (uint16_t)js_len : UINT16_MAX - 1,
+                                       tokens, HMREC_MAX_TOKENS);
+    if (token_count <= 0 || tokens[0].type != JSON_TOKEN_OBJECT)
     {
-        printf("[cJSON] Failed to parse JSON.\r\n");
+        printf("[JSON] Failed to parse JSON (err: %d).\r\n", token_count);
         return;
     }
 
-    // 3. 提取命令名称和参数
-    command_name_item = cJSON_GetObjectItem(root, "command_name");
-    paras_item = cJSON_GetObjectItem(root, "paras");
+    // 3. 提取命令名称
+    int name_index = JsonParser_FindKey(js, tokens, token_count, 0, "command_name");
+    if (name_index < 0 || tokens[name_index].type != JSON_TOKEN_STRING)
+    {
+        printf("[JSON] command_name not found or not a string.\r\n");
+        return;
+    }
+    const char *command_name = js + tokens[name_index].start;
+    int command_name_len = tokens[name_index].end - tokens[name_index].start;
+    printf("[DISPATCHER] Received command: %.*s\r\n", command_name_len, command_name);
 
-    if (!cJSON_IsString(command_name_item) || (command_name_item->valuestring == NULL))
+    // 4. 在命令表中查找处理函数
+    const command_entry_t *entry = find_command(command_name, command_name_len);
+    if (entry == NULL)
     {
-        printf("[cJSON] command_name not found or not a string.\r\n");
-        goto end;
+        printf("[DISPATCHER] Warning: No handler found for command '%.*s'.\r\n", command_name_len, command_name);
+        return;
     }
-    printf("[DISPATCHER] Received command: %s\r\n", command_name_item->valuestring);
+    printf("[DISPATCHER] Found handler for '%s'. Executing...\r\n", entry->command_name);
 
-    // 4. 在命令表中查找并执行处理函数
-    for (int i = 0; i < COMMAND_TABLE_SIZE; i++)
+    // 5. 按命令声明的类型提取参数，然后执行处理函数
+    int paras_index = JsonParser_FindKey(js, tokens, token_count, 0, "paras");
+    if (extract_command_param(js, tokens, token_count, paras_index, entry, &param))
     {
-        if (strcmp(command_name_item->valuestring, command_table[i].command_name) == 0)
+        result = entry->handler(param);
+        if (result == CMD_RESULT_OK)
         {
-            printf("[DISPATCHER] Found handler for '%s'. Executing...\r\n", command_table[i].command_name);
-            command_table[i].handler(paras_item);
-            handler_found = 1;
             // 成功处理命令后，根据新的属性值更新硬件状态
             update_hardware_from_properties();
-
-            // [MODIFIED] 只有在成功找到并执行处理函数后，才发送响应
-            printf("[ACTION] Preparing command response...\r\n");
-            HuaweiIoT_PublishCommandResponse(at_handler, request_id, escaped_payload, logical_len);
-            
-            break;
         }
     }
-    if (!handler_found)
+    else
+    {
+        printf("[CMD_HANDLER] '%s%s%s' not found or invalid in %s.\r\n", entry->param_name,
+               entry->param2_name ? "/" : "", entry->param2_name ? entry->param2_name : "", entry->command_name);
+        result = CMD_RESULT_INVALID_PARAM;
+    }
+
+    // 6. 只要找到了对应的处理函数，就向云端发送响应 (result_code 即 command_result_e 的值)
+    printf("[ACTION] Preparing command response (result_code %d)...\r\n", (int)result);
+    HuaweiIoT_PublishCommandResponse(at_handler, request_id, s_result_payloads[result], RESULT_PAYLOAD_LEN);
+}
+
+void HuaweiIoT_ParseHMREC(AT_Handler_t *at_handler, const char *hprec_str)
+{
+    if (!at_handler)
     {
-        printf("[DISPATCHER] Warning: No handler found for command '%s'.\r\n", command_name_item->valuestring);
+        printf("[ERROR] Invalid AT handler.\r\n");
+        return;
     }
 
-    // 5. 响应命令 (逻辑已被移至上面的循环内部，在找到并执行handler后进行)
+    printf("\r\n[URC] Parsing HMREC with dispatcher: %s\r\n", hprec_str);
+
+    // 本条命令处理中的所有临时内存都来自命令内存池，处理结束后整体归零
+    MemArena_Begin(&s_command_arena);
+    parse_hmrec(at_handler, hprec_str);
+    MemArena_End(&s_command_arena);
+}
 
-end:
-    cJSON_Delete(root);
+/**
+ * @brief 命令响应的发布结果回调 (在AT接收任务中调用)
+ */
+static void on_command_response_published(uint16_t tag, AT_Status_t status, void *ctx)
+{
+    (void)ctx;
+    if (status != AT_OK)
+    {
+        printf("[CMD-RESP] Response #%u not delivered (Status: %d).\r\n", tag, status);
+    }
 }
 
 /**
  * @brief 构建并发送对云端命令的响应 (非阻塞)
  * @details
  *        此函数构建一个标准的AT+HMPUB命令来响应云平台。
- *        它使用非阻塞的 AT_SendRaw 函数来发送命令，避免阻塞URC处理流程。
+ *        它使用非阻塞的 AT_SendRawAsync 函数来发送命令，避免阻塞URC处理流程；
+ *        发布结果由 `on_command_response_published` 打印。
+ *        没有空闲的在途记录时放弃发送：不登记结果的 AT+HMPUB 会让它的 "+HMPUB" 结果被配给下一条在途的发布。
+ *        本函数在AT接收任务中执行，在途记录只能由该任务释放，因此不能在此等待空闲记录。
  * @param at_handler AT处理器实例指针
  * @param request_id 从云端命令中提取的请求ID
  * @param escaped_payload 已经转义好的JSON负载 (例如 "{\\\"result_code\\\":0}")
@@ -502,29 +877,40 @@ end:
  */
 AT_Status_t HuaweiIoT_PublishCommandResponse(AT_Handler_t *at_handler, const char *request_id, const char *escaped_payload, uint16_t logical_len)
 {
-    // 使用栈上静态缓冲区，避免动态内存分配的开销和风险
-    char topic[256];
-    char full_command[512];
+    // 格式化缓冲区取自命令内存池 (不占用AT接收任务的栈，也不走堆)，函数返回前归还
+    const size_t topic_size = 256;
+    const size_t command_size = 512;
+    size_t arena_mark = MemArena_Mark(&s_command_arena);
+    char *topic = MemArena_Alloc(&s_command_arena, topic_size);
+    char *full_command = MemArena_Alloc(&s_command_arena, command_size);
+    if (topic == NULL || full_command == NULL)
+    {
+        printf("[CMD-RESP] No memory for command response.\r\n");
+        MemArena_Release(&s_command_arena, arena_mark);
+        return AT_BUFFER_FULL;
+    }
 
     // 构建Topic
-    snprintf(topic, sizeof(topic), "$oc/devices/%s/sys/commands/response/request_id=%s", IOT_DEVICE_ID, request_id);
+    snprintf(topic, topic_size, "$oc/devices/%s/sys/commands/response/request_id=%s", IOT_DEVICE_ID, request_id);
 
     // 构建完整的AT命令
-    snprintf(full_command, sizeof(full_command), "AT+HMPUB=1,\"%s\",%d,\"%s\"\r\n", topic, logical_len, escaped_payload);
+    snprintf(full_command, command_size, "AT+HMPUB=1,\"%s\",%d,\"%s\"\r\n", topic, logical_len, escaped_payload);
 
     printf("[CMD-RESP] Sending (non-blocking): %s", full_command); // full_command 已包含 \r\n，故此处不用
 
-    // --- 核心修改：使用非阻塞的 AT_SendRaw 发送命令 ---
-    // AT_Status_t status = AT_SendBasicCommand(at_handler, full_command, 10000); // 旧的阻塞方式
-    AT_Status_t status = AT_SendRaw(at_handler, full_command); // 新的非阻塞方式
-
-    if (status != AT_OK)
+    // --- 核心修改：使用非阻塞的 AT_SendRawAsync 发送命令 ---
+    // 登记发布结果URC，使其不会被当作在途上报消息的结果；发布结果由回调打印
+    AT_Status_t status = AT_SendRawAsync(at_handler, full_command, HMPUB_RESULT_PREFIX, HMPUB_TIMEOUT_MS, on_command_response_published, NULL);
+    if (status == AT_BUFFER_FULL)
+    {
+        printf("[CMD-RESP] No free result slot, command response dropped.\r\n");
+    }
+    else if (status != AT_OK)
     {
         printf("[CMD-RESP] Failed to send command response.\r\n");
     }
-    // 注意：因为是非阻塞发送，这里无法知道云平台是否真正成功收到了响应。
-    // 但它解决了命令处理延迟的问题。
 
+    MemArena_Release(&s_command_arena, arena_mark);
     return status;
 }
 
@@ -551,64 +937,23 @@ AT_Status_t HuaweiIoT_InitModule(AT_Handler_t *at_handler)
 /**
  * @brief 连接到华为云平台
  * @details
- *        此函数实现了一套健壮的、包含完整错误处理的连接流程。
- *        1. **环境清理**: 首先检查GPRS(IP)的连接状态。如果已连接或状态未知，则会先尝试断开MQTT，
- *           然后强制去激活GPRS，确保后续的连接在一个干净的环境中进行。
- *        2. **IP激活 (轮询机制)**: 发送 `AT+MIPCALL=1` 指令后，并不会依赖其返回值来判断结果。
- *           而是采用轮询机制，在15秒内每秒发送一次 `AT+MIPCALL?` 来主动查询。
- *           直到查询结果中包含一个合法的IP地址，才认为GPRS激活成功。这种方式可以完美避开时序问题。
- *        3. **MQTT连接**: GPRS激活成功后，最后才使用 `AT+HMCON` 指令发起MQTT连接。
+ *        执行连接脚本 s_connect_script，结果保存在 s_last_connect_result 中 (见 HuaweiIoT_GetLastConnectResult)：
+ *        1. **查询PDP**: 发送 `AT+MIPCALL?`，响应中带有合法IP地址时走快速路径，否则走完整路径。
+ *        2. **快速路径** (PDP仍然有效，模组已驻网)：`AT+HMDIS` 断开残留的MQTT会话 (失败也继续)，
+ *           然后直接 `AT+HMCON` 重建MQTT连接。建链失败说明PDP已失效，转入完整路径。
+ *        3. **完整路径**: `AT+MIPCALL=0` 关闭失效的PDP (仅从快速路径转入时)，`AT+MIPCALL=1` 重新拨号，
+ *           再每秒轮询一次 `AT+MIPCALL?` (最多15次) 直到获得IP，最后 `AT+HMCON` 建立MQTT连接。
  * @param at_handler AT处理器实例指针
  * @return AT_Status_t 最终连接成功返回 AT_OK, 否则返回 AT_ERROR 或其他错误码。
  */
 AT_Status_t HuaweiIoT_ConnectCloud(AT_Handler_t *at_handler)
 {
-    char cmd_buf[512];
-    char res_buf[128];
+    printf("\r\n--- Running Cloud Connection Script ---\r\n");
 
-    // 1. 确保网络环境干净
-    printf("\r\n--- Checking IP Status ---\r\n");
-    if (AT_SendCommand(at_handler, "AT+MIPCALL?", 5000, res_buf, sizeof(res_buf)) == AT_OK && strstr(res_buf, "+MIPCALL: 0") == NULL)
-    {
-        printf("  > IP context active. Deactivating for a clean start...\r\n");
-        AT_SendBasicCommand(at_handler, "AT+HMDIS", 5000);     // 先断开MQTT
-        AT_SendBasicCommand(at_handler, "AT+MIPCALL=0", 8000); // 再关闭PDP
-    }
+    bool ok = AT_Script_Run(at_handler, s_connect_script, CONNECT_STEP_COUNT, &s_last_connect_result);
+    AT_Script_PrintResult(s_connect_script, &s_last_connect_result);
 
-    // 2. 激活PDP，获取IP
-    printf("\r\n--- Activating IP Connection ---\r\n");
-    if (AT_SendBasicCommand(at_handler, "AT+MIPCALL=1", 8000) != AT_OK)
-    {
-        printf("  > Module failed to accept IP activation command.\r\n");
-        return AT_ERROR;
-    }
-    // 轮询确认IP地址
-    bool ip_obtained = false;
-    for (int i = 0; i < 15; i++)
-    {
-        osDelay(1000);
-        if (AT_SendCommand(at_handler, "AT+MIPCALL?", 2000, res_buf, sizeof(res_buf)) == AT_OK && strstr(res_buf, ".") != NULL && strstr(res_buf, "0.0.0.0") == NULL)
-        {
-            printf("  > IP Address Obtained: %s\r\n", res_buf);
-            ip_obtained = true;
-            break;
-        }
-    }
-    if (!ip_obtained)
-    {
-        printf("  > Failed to obtain IP Address. Halting.\r\n");
-        return AT_ERROR;
-    }
-
-    // 3. 连接到华为云 (使用单一的 HMCON 命令)
-    printf("\r\n--- Connecting to Huawei Cloud ---\r\n");
-    snprintf(cmd_buf, sizeof(cmd_buf), "AT+HMCON=0,60,\"%s\",\"%s\",\"%s\",\"%s\",0",
-             IOT_SERVER_ADDRESS,
-             IOT_SERVER_PORT,
-             IOT_DEVICE_ID,
-             IOT_DEVICE_PASSWORD);
-
-    if (AT_SendBasicCommand(at_handler, cmd_buf, 30000) != AT_OK)
+    if (!ok)
     {
         printf("  > Failed to connect to Huawei Cloud.\r\n");
         return AT_ERROR;
@@ -618,77 +963,62 @@ AT_Status_t HuaweiIoT_ConnectCloud(AT_Handler_t *at_handler)
     return AT_OK;
 }
 
+void HuaweiIoT_GetLastConnectResult(AT_ScriptResult_t *out_result)
+{
+    if (out_result)
+    {
+        memcpy(out_result, &s_last_connect_result, sizeof(AT_ScriptResult_t));
+    }
+}
+
 AT_Status_t HuaweiIoT_DisconnectFromCloud(AT_Handler_t *at_handler)
 {
     printf("[INFO] Disconnecting from cloud...\r\n");
     return AT_SendBasicCommand(at_handler, "AT+HMDIS", 5000);
 }
 
-// [BUGFIX] 使用健壮的cJSON生成逻辑，并修复错误处理
+/**
+ * @brief 上报所有子设备为 "ONLINE" 状态 (实现)
+ * @details JSON负载由写入器直接生成到AT发送缓冲区中，不再经过cJSON树、转义拷贝和snprintf三道工序。
+ */
 AT_Status_t HuaweiIoT_PublishAllSubDevicesOnline(AT_Handler_t *at_handler)
 {
     if (at_handler == NULL)
         return AT_ERROR;
 
-    cJSON *root = cJSON_CreateObject();
-    if (!root)
-        return AT_ERROR;
-
-    cJSON *services = cJSON_AddArrayToObject(root, "services");
-    cJSON *service = cJSON_CreateObject();
-    cJSON_AddItemToArray(services, service);
-    cJSON_AddStringToObject(service, "service_id", "$sub_device_manager");
-    cJSON_AddStringToObject(service, "event_type", "sub_device_update_status");
-    cJSON *paras = cJSON_AddObjectToObject(service, "paras");
-    cJSON *device_statuses = cJSON_AddArrayToObject(paras, "device_statuses");
+    hmpub_frame_t frame;
+    AT_Status_t status = hmpub_begin(at_handler, TOPIC_EVENTS_UP, &frame);
+    if (status != AT_OK)
+        return status;
+
+    JsonWriter_t *w = &frame.json;
+    JsonWriter_BeginObject(w);
+    JsonWriter_Key(w, "services");
+    JsonWriter_BeginArray(w);
+    JsonWriter_BeginObject(w);
+    JsonWriter_KeyString(w, "service_id", "$sub_device_manager");
+    JsonWriter_KeyString(w, "event_type", "sub_device_update_status");
+    JsonWriter_Key(w, "paras");
+    JsonWriter_BeginObject(w);
+    JsonWriter_Key(w, "device_statuses");
+    JsonWriter_BeginArray(w);
 
     // 从配置中心读取子设备列表并构建JSON
-    for (int i = 0; i < DEVICE_CONFIG_COUNT; i++)
+    for (size_t i = 0; i < DEVICE_CONFIG_COUNT; i++)
     {
-        cJSON *dev = cJSON_CreateObject();
-        if (dev)
-        {
-            cJSON_AddStringToObject(dev, "device_id", DEVICE_CONFIG_TABLE[i].cloud_id);
-            cJSON_AddStringToObject(dev, "status", "ONLINE");
-            cJSON_AddItemToArray(device_statuses, dev);
-        }
-    }
-
-    char *logical_payload = cJSON_PrintUnformatted(root);
-    cJSON_Delete(root);
-    if (!logical_payload)
-        return AT_ERROR;
-
-    // --- 步骤: 手动转义JSON payload ---
-    size_t logical_len = strlen(logical_payload);
-    char *escaped_payload = pvPortMalloc(logical_len * 2 + 1); // 为转义分配足够空间
-    if (escaped_payload == NULL)
-    {
-        vPortFree(logical_payload);
-        return AT_ERROR;
-    }
-    char *p_in = logical_payload;
-    char *p_out = escaped_payload;
-    while (*p_in)
-    {
-        if (*p_in == '"' || *p_in == '\\')
-        {
-            *p_out++ = '\\';
-        }
-        *p_out++ = *p_in++;
+        JsonWriter_BeginObject(w);
+        JsonWriter_KeyString(w, "device_id", DEVICE_CONFIG_TABLE[i].cloud_id);
+        JsonWriter_KeyString(w, "status", "ONLINE");
+        JsonWriter_EndObject(w);
     }
-    *p_out = '\0';
 
-    // --- 步骤: 构建并发送 AT+HMPUB 命令 ---
-    char at_cmd[1024];
-    snprintf(at_cmd, sizeof(at_cmd), "AT+HMPUB=1,\"$oc/devices/%s/sys/events/up\",%d,\"%s\"",
-             IOT_DEVICE_ID, logical_len, escaped_payload);
+    JsonWriter_EndArray(w);  // device_statuses
+    JsonWriter_EndObject(w); // paras
+    JsonWriter_EndObject(w); // service
+    JsonWriter_EndArray(w);  // services
+    JsonWriter_EndObject(w); // root
 
-    AT_Status_t status = AT_SendCommand(at_handler, at_cmd, 15000, NULL, 0);
-
-    vPortFree(logical_payload);
-    vPortFree(escaped_payload);
-    return status;
+    return hmpub_finish(at_handler, &frame);
 }
 
 AT_Status_t HuaweiIoT_PublishSubDeviceStatus(AT_Handler_t *at_handler, const char *sub_device_id, const char *status)
@@ -708,144 +1038,285 @@ AT_Status_t HuaweiIoT_Subscribe(AT_Handler_t *at_handler, const char *topic)
     return AT_OK;
 }
 
+/* Private Functions (Report Builders) ---------------------------------------*/
+
 /**
- * @brief (内部私有) 根据设备信息构建对应的 a service cJSON 对象
+ * @brief 上报负载中单个子设备的 services 数组内容的写入函数类型
  */
-static int build_service_json(const managed_device_t *device, cJSON *services_array)
+typedef void (*service_writer_t)(JsonWriter_t *w, const managed_device_t *device);
+
+/**
+ * @brief 开始写入一个 service 对象: {"service_id":"xxx","properties":{
+ */
+static void write_service_begin(JsonWriter_t *w, const char *service_id)
 {
-    cJSON *service = cJSON_CreateObject();
-    if (service == NULL)
-        return NULL;
+    JsonWriter_BeginObject(w);
+    JsonWriter_KeyString(w, "service_id", service_id); // 对应物模型中的服务ID
+    JsonWriter_Key(w, "properties");
+    JsonWriter_BeginObject(w);
+}
 
-    cJSON *properties = cJSON_CreateObject();
-    if (properties == NULL)
-    {
-        cJSON_Delete(service);
-        return NULL;
-    }
-    cJSON_AddItemToObject(service, "properties", properties);
+/**
+ * @brief 结束写入一个 service 对象
+ */
+static void write_service_end(JsonWriter_t *w)
+{
+    JsonWriter_EndObject(w); // properties
+    JsonWriter_EndObject(w); // service
+}
+
+/**
+ * @brief 写入传感器节点的 "device" 服务 (电池信息)
+ */
+static void write_battery_service(JsonWriter_t *w, const CommonDeviceProperties_t *common)
+{
+    write_service_begin(w, "device");
+    JsonWriter_KeyUint(w, "batteryLevel", common->batteryLevel);
+    JsonWriter_KeyFixed(w, "batteryVoltage", common->batteryVoltage, 1);
+    write_service_end(w);
+}
+
+/**
+ * @brief 内部传感器的主要环境数据属性
+ */
+static void write_internal_env_properties(JsonWriter_t *w, const InternalSensorProperties_t *data)
+{
+    JsonWriter_KeyFixed(w, "greenhouseTemperature", data->greenhouseTemperature, 2);
+    JsonWriter_KeyFixed(w, "greenhouseHumidity", data->greenhouseHumidity, 2);
+    JsonWriter_KeyFixed(w, "soilMoisture", data->soilMoisture, 2);
+    JsonWriter_KeyUint(w, "lightIntensity", data->lightIntensity);
+    JsonWriter_KeyFixed(w, "soilTemperature", data->soilTemperature, 1);
+    JsonWriter_KeyUint(w, "vocConcentration", data->vocConcentration);
+    JsonWriter_KeyUint(w, "co2Concentration", data->co2Concentration);
+}
+
+/**
+ * @brief 内部传感器的土壤详细数据属性
+ */
+static void write_internal_soil_properties(JsonWriter_t *w, const InternalSensorProperties_t *data)
+{
+    JsonWriter_KeyFixed(w, "soilPh", data->soilPh, 1);
+    JsonWriter_KeyUint(w, "soilEc", data->soilEc);
+    JsonWriter_KeyUint(w, "soilNitrogen", data->soilNitrogen);
+    JsonWriter_KeyUint(w, "soilPhosphorus", data->soilPhosphorus);
+    JsonWriter_KeyUint(w, "soilPotassium", data->soilPotassium);
+    JsonWriter_KeyUint(w, "soilSalinity", data->soilSalinity);
+    JsonWriter_KeyUint(w, "soilTds", data->soilTds);
+    JsonWriter_KeyUint(w, "soilFertility", data->soilFertility);
+}
+
+/**
+ * @brief 内部传感器 全量: 一个 "sensor" 服务包含全部属性，外加电池信息
+ */
+static void write_internal_full_services(JsonWriter_t *w, const managed_device_t *device)
+{
+    const InternalSensorProperties_t *data = &device->properties.internal_sensor;
+
+    write_service_begin(w, "sensor");
+    write_internal_env_properties(w, data);
+    write_internal_soil_properties(w, data);
+    write_service_end(w);
+
+    write_battery_service(w, &data->common);
+}
 
+/**
+ * @brief 内部传感器 拆分第1部分: 主要环境数据
+ */
+static void write_internal_env_services(JsonWriter_t *w, const managed_device_t *device)
+{
+    write_service_begin(w, "sensor");
+    write_internal_env_properties(w, &device->properties.internal_sensor);
+    write_service_end(w);
+}
+
+/**
+ * @brief 内部传感器 拆分第2部分: 土壤详细数据和电池状态
+ */
+static void write_internal_soil_services(JsonWriter_t *w, const managed_device_t *device)
+{
+    const InternalSensorProperties_t *data = &device->properties.internal_sensor;
+
+    write_service_begin(w, "sensor");
+    write_internal_soil_properties(w, data);
+    write_service_end(w);
+
+    write_battery_service(w, &data->common);
+}
+
+/**
+ * @brief 其他设备: 全量上报的 services 内容
+ */
+static void write_standard_services(JsonWriter_t *w, const managed_device_t *device)
+{
     switch (device->device_type)
     {
-    case DEVICE_TYPE_INTERNAL_SENSOR:
-    {
-        cJSON_AddStringToObject(service, "service_id", "sensor"); // 对应您物模型中的服务ID
-        const InternalSensorProperties_t *data = &device->properties.internal_sensor;
-        // Greenhouse Env
-        cJSON_AddNumberToObject(properties, "greenhouseTemperature", data->greenhouseTemperature);
-        cJSON_AddNumberToObject(properties, "greenhouseHumidity", data->greenhouseHumidity);
-        // Soil
-        cJSON_AddNumberToObject(properties, "soilMoisture", round(data->soilMoisture * 10.0) / 10.0);
-        cJSON_AddNumberToObject(properties, "soilTemperature", round(data->soilTemperature * 10.0) / 10.0);
-        cJSON_AddNumberToObject(properties, "soilPh", round(data->soilPh * 10.0) / 10.0);
-        cJSON_AddNumberToObject(properties, "soilEc", data->soilEc);
-        cJSON_AddNumberToObject(properties, "soilNitrogen", data->soilNitrogen);
-        cJSON_AddNumberToObject(properties, "soilPhosphorus", data->soilPhosphorus);
-        cJSON_AddNumberToObject(properties, "soilPotassium", data->soilPotassium);
-        cJSON_AddNumberToObject(properties, "soilSalinity", data->soilSalinity);
-        cJSON_AddNumberToObject(properties, "soilTds", data->soilTds);
-        cJSON_AddNumberToObject(properties, "soilFertility", data->soilFertility);
-        // Light
-        cJSON_AddNumberToObject(properties, "lightIntensity", data->lightIntensity);
-        // Air
-        cJSON_AddNumberToObject(properties, "vocConcentration", data->vocConcentration);
-        cJSON_AddNumberToObject(properties, "co2Concentration", data->co2Concentration);
-        break;
-    }
     case DEVICE_TYPE_EXTERNAL_SENSOR:
     {
-        cJSON_AddStringToObject(service, "service_id", "sensor"); // 对应您物模型中的服务ID
         const ExternalSensorProperties_t *data = &device->properties.external_sensor;
-        cJSON_AddNumberToObject(properties, "outdoorTemperature", data->outdoorTemperature);
-        cJSON_AddNumberToObject(properties, "outdoorHumidity", data->outdoorHumidity);
-        cJSON_AddNumberToObject(properties, "outdoorLightIntensity", data->outdoorLightIntensity);
-        cJSON_AddNumberToObject(properties, "airPressure", data->airPressure);
-        cJSON_AddNumberToObject(properties, "altitude", data->altitude);
-        cJSON_AddStringToObject(properties, "location", data->location);
+        write_service_begin(w, "sensor");
+        JsonWriter_KeyFixed(w, "outdoorTemperature", data->outdoorTemperature, 2);
+        JsonWriter_KeyFixed(w, "outdoorHumidity", data->outdoorHumidity, 2);
+        JsonWriter_KeyUint(w, "outdoorLightIntensity", data->outdoorLightIntensity);
+        JsonWriter_KeyFixed(w, "airPressure", data->airPressure, 2);
+        JsonWriter_KeyFixed(w, "altitude", data->altitude, 2);
+        JsonWriter_KeyString(w, "location", data->location);
+        write_service_end(w);
+
+        // 只有传感器节点有电池信息，为它们添加 "device" service
+        write_battery_service(w, &data->common);
         break;
     }
     case DEVICE_TYPE_CONTROL_NODE:
     {
-        cJSON_AddStringToObject(service, "service_id", "control"); // 对应您物模型中的服务ID
         const ControlNodeProperties_t *data = &device->properties.control;
-        cJSON_AddBoolToObject(properties, "fanStatus", data->fanStatus);
-        cJSON_AddBoolToObject(properties, "growLightStatus", data->growLightStatus);
-        cJSON_AddBoolToObject(properties, "pumpStatus", data->pumpStatus);
-        cJSON_AddNumberToObject(properties, "fanSpeed", data->fanSpeed);
-        cJSON_AddNumberToObject(properties, "pumpSpeed", data->pumpSpeed);
+        write_service_begin(w, "control");
+        JsonWriter_KeyBool(w, "fanStatus", data->fanStatus);
+        JsonWriter_KeyBool(w, "growLightStatus", data->growLightStatus);
+        JsonWriter_KeyBool(w, "pumpStatus", data->pumpStatus);
+        JsonWriter_KeyUint(w, "fanSpeed", data->fanSpeed);
+        JsonWriter_KeyUint(w, "pumpSpeed", data->pumpSpeed);
+        write_service_end(w);
         break;
     }
     default:
-    {
-        // 未知类型，释放内存并返回NULL
-        cJSON_Delete(service);
-        return NULL;
-    }
+        // 未知类型，不写入任何 service
+        printf("[Upload] WARN: Unknown device type %d for %s.\r\n", device->device_type, device->cloud_device_id);
+        break;
     }
+}
 
-    cJSON_AddItemToArray(services_array, service);
+/**
+ * @brief 单个设备在网关上报中的布局
+ * @details
+ *        优先使用 `full` 将设备作为一个整体写入；只有当该设备单独占用一整条消息
+ *        都放不下时，才依次使用 `parts` 将其拆分到多条消息中。
+ */
+typedef struct
+{
+    service_writer_t full;     ///< 整设备一次写入
+    service_writer_t parts[2]; ///< 拆分写法 (按顺序)
+    uint8_t part_count;        ///< 拆分部分的数量，0 表示不可拆分
+} report_layout_t;
+
+static const report_layout_t s_internal_sensor_layout = {
+    .full = write_internal_full_services,
+    .parts = {write_internal_env_services, write_internal_soil_services},
+    .part_count = 2,
+};
 
-    // 只有传感器节点有电池信息，为它们添加 "device" service
-    // device->device_type == DEVICE_TYPE_INTERNAL_SENSOR || 
-    if (device->device_type == DEVICE_TYPE_EXTERNAL_SENSOR)
-    {
-        service = cJSON_CreateObject();
-        if (service == NULL)
-            return NULL;
+static const report_layout_t s_standard_layout = {
+    .full = write_standard_services,
+    .part_count = 0,
+};
 
-        properties = cJSON_CreateObject();
-        if (properties == NULL)
-        {
-            cJSON_Delete(service);
-            return NULL;
-        }
-        cJSON_AddItemToObject(service, "properties", properties);
+static const report_layout_t *get_report_layout(DeviceType_e type)
+{
+    return (type == DEVICE_TYPE_INTERNAL_SENSOR) ? &s_internal_sensor_layout : &s_standard_layout;
+}
 
-        switch (device->device_type)
-        {
-        case DEVICE_TYPE_INTERNAL_SENSOR:
+/**
+ * @brief 在 "devices" 数组中写入一个设备条目: {"device_id":"xxx","services":[...]}
+ */
+static void write_device_entry(JsonWriter_t *w, const managed_device_t *device, service_writer_t write_services)
+{
+    JsonWriter_BeginObject(w);
+    JsonWriter_KeyString(w, "device_id", device->cloud_device_id);
+    JsonWriter_Key(w, "services");
+    JsonWriter_BeginArray(w);
+    write_services(w, device);
+    JsonWriter_EndArray(w);
+    JsonWriter_EndObject(w);
+}
+
+/**
+ * @brief 检查在当前位置闭合 "devices" 数组和根对象后，消息是否仍在上限之内
+ * @note  闭合操作写在写入器的一个副本上，不影响原写入器，之后的写入会直接覆盖这些字节。
+ */
+static bool report_frame_fits(const JsonWriter_t *w)
+{
+    JsonWriter_t probe = *w;
+    JsonWriter_EndArray(&probe);  // devices
+    JsonWriter_EndObject(&probe); // root
+    return JsonWriter_IsOk(&probe) && probe.logical_len <= IOT_MAX_PUBLISH_PAYLOAD_LEN;
+}
+
+/**
+ * @brief 取一个空闲的上报消息上下文
+ * @note  调用前已占用一个异步窗口名额，而上下文数等于窗口大小，因此总能取到。
+ */
+static report_frame_ctx_t *acquire_report_frame(void)
+{
+    for (uint8_t i = 0; i < AT_ASYNC_WINDOW_SIZE; i++)
+    {
+        if (!s_report_frames[i].in_use)
         {
-            cJSON_AddStringToObject(service, "service_id", "device"); // 对应您物模型中的服务ID
-            const InternalSensorProperties_t *data = &device->properties.internal_sensor;
-            cJSON_AddNumberToObject(properties, "batteryLevel", data->common.batteryLevel);
-            cJSON_AddNumberToObject(properties, "batteryVoltage", round(data->common.batteryVoltage * 10.0) / 10.0);
-            break;
+            s_report_frames[i].in_use = true;
+            s_report_frames[i].device_count = 0;
+            s_report_frames[i].trace_count = 0;
+            s_report_frames[i].entry_count = 0;
+            return &s_report_frames[i];
         }
-        case DEVICE_TYPE_EXTERNAL_SENSOR:
+    }
+    return NULL;
+}
+
+/**
+ * @brief 网关上报消息的发布结果回调 (在AT接收任务中调用)
+ * @details 成功时清除本条消息中完整设备的脏标记，并记录其中样本的端到端时延；
+ *          失败时这些设备保持脏标记，留待下个周期重试。
+ */
+static void on_report_published(uint16_t tag, AT_Status_t status, void *ctx)
+{
+    report_frame_ctx_t *frame_ctx = (report_frame_ctx_t *)ctx;
+
+    if (status == AT_OK)
+    {
+        printf("[Upload] SUCCESS #%u: %d device entries in one message (%u bytes).\r\n", tag, frame_ctx->entry_count, frame_ctx->payload_len);
+        for (uint8_t i = 0; i < frame_ctx->device_count; i++)
         {
-            cJSON_AddStringToObject(service, "service_id", "device"); // 对应您物模型中的服务ID
-            const ExternalSensorProperties_t *data = &device->properties.external_sensor;
-            cJSON_AddNumberToObject(properties, "batteryLevel", data->common.batteryLevel);
-            cJSON_AddNumberToObject(properties, "batteryVoltage", round(data->common.batteryVoltage * 10.0) / 10.0);
-            break;
+            DeviceManager_ClearDirtyFlag(frame_ctx->device_ids[i]);
         }
-        default:
+        for (uint8_t i = 0; i < frame_ctx->trace_count; i++)
         {
-            // 未知类型，释放内存并返回NULL
-            cJSON_Delete(service);
-            return NULL;
+            SampleTrace_Complete(&frame_ctx->traces[i]);
         }
-        }
-        cJSON_AddItemToArray(services_array, service);
     }
-    return 1;
+    else
+    {
+        printf("[Upload] FAILED #%u: %d device entries (Status: %d). Will retry.\r\n", tag, frame_ctx->entry_count, status);
+        s_report_publish_failed = true;
+    }
+
+    frame_ctx->in_use = false;
 }
 
-AT_Status_t HuaweiIoT_PublishGatewayReport(AT_Handler_t *handler)
+/**
+ * @brief 执行一次网关上报 (在上报内存池的作用域内执行)
+ * @details
+ *        每条消息经串口发送完毕后即开始构建下一条，最多 AT_ASYNC_WINDOW_SIZE 条同时等待发布结果，
+ *        上报总耗时由 "消息数 x 往返时延" 降为约 "消息数 x 串口发送时间 + 1个往返时延"。
+ *        返回前等待所有在途消息的结果，因此返回值仍反映整轮上报的成败。
+ */
+static AT_Status_t publish_gateway_report(AT_Handler_t *handler)
 {
-    if (handler == NULL)
-        return AT_ERROR;
-
     int search_index = 0;
-    managed_device_t current_device;
-    uint16_t dirty_device_ids[MAX_MANAGED_DEVICES];
     uint8_t dirty_count = 0;
     AT_Status_t final_status = AT_OK; // 用于跟踪整个上报周期的最终状态
 
+    // 设备快照和ID列表都取自上报内存池，不占用上行任务的栈
+    managed_device_t *device_data = MemArena_Alloc(&s_report_arena, sizeof(managed_device_t));
+    uint16_t *dirty_device_ids = MemArena_Alloc(&s_report_arena, sizeof(uint16_t) * MAX_MANAGED_DEVICES);
+    if (device_data == NULL || dirty_device_ids == NULL)
+    {
+        printf("[Upload] No memory for report.\r\n");
+        return AT_BUFFER_FULL;
+    }
+
     // 步骤 1: 查找所有脏设备
-    while ((search_index = DeviceManager_FindNextDirtyDevice(search_index, &current_device)) != -1)
+    while ((search_index = DeviceManager_FindNextDirtyDevice(search_index, device_data)) != -1)
     {
-        dirty_device_ids[dirty_count++] = current_device.lora_id;
+        dirty_device_ids[dirty_count++] = device_data->lora_id;
         search_index++;
     }
 
@@ -853,186 +1324,398 @@ AT_Status_t HuaweiIoT_PublishGatewayReport(AT_Handler_t *handler)
     {
         return AT_OK;
     }
-    
+
     printf("[Upload] Found %d dirty devices to report.\r\n", dirty_count);
 
-    // 步骤 2: 遍历脏设备，根据类型选择上报策略
-    for (uint8_t i = 0; i < dirty_count; i++)
+    // 步骤 2: 将脏设备尽可能多地打包进每一条消息，放不下时才开始新的一条
+    uint8_t next = 0;          // 下一个待写入的脏设备
+    uint8_t next_part = 0;     // 0: 尝试整设备写入; n: 正在拆分写入，下一个写第n部分
+    uint8_t publish_count = 0;
+    s_report_publish_failed = false;
+
+    // 上一轮若在等待结果时超时 (或AT处理器被重建)，其上下文可能未被回调释放；窗口为空时统一回收
+    if (AT_GetAsyncInFlight(handler) == 0)
     {
-        managed_device_t device_data;
-        if (!DeviceManager_GetDevice(dirty_device_ids[i], &device_data))
+        for (uint8_t i = 0; i < AT_ASYNC_WINDOW_SIZE; i++)
         {
-            continue;
+            s_report_frames[i].in_use = false;
         }
+    }
 
-        // --- 策略分歧点 ---
-        if (device_data.device_type == DEVICE_TYPE_INTERNAL_SENSOR)
+    while (next < dirty_count && !s_report_publish_failed)
+    {
+        // 拆分设备的后续部分依赖前面部分的发布结果：先等在途消息全部返回，失败则不再继续
+        if (next_part > 1)
         {
-            // --- 策略A: 针对内部传感器，分两次上报 ---
-            printf("[Upload] Internal Sensor requires 2-part report for %s\r\n", device_data.cloud_device_id);
-            AT_Status_t status1 = AT_ERROR, status2 = AT_ERROR;
-            
-            // --- Packet 1: 主要环境数据 ---
+            AT_WaitAsyncIdle(handler, HMPUB_TIMEOUT_MS * 2);
+            if (s_report_publish_failed)
             {
-                cJSON *root = cJSON_CreateObject();
-                cJSON *devices = cJSON_AddArrayToObject(root, "devices");
-                cJSON *device = cJSON_CreateObject();
-                cJSON_AddItemToArray(devices, device);
-                cJSON_AddStringToObject(device, "device_id", device_data.cloud_device_id);
-                cJSON *services = cJSON_AddArrayToObject(device, "services");
-                cJSON *service = cJSON_CreateObject();
-                cJSON_AddItemToArray(services, service);
-                cJSON_AddStringToObject(service, "service_id", "sensor");
-                cJSON *properties = cJSON_AddObjectToObject(service, "properties");
-                
-                const InternalSensorProperties_t *data = &device_data.properties.internal_sensor;
-                cJSON_AddNumberToObject(properties, "greenhouseTemperature", data->greenhouseTemperature);
-                cJSON_AddNumberToObject(properties, "greenhouseHumidity", data->greenhouseHumidity);
-                cJSON_AddNumberToObject(properties, "soilMoisture", data->soilMoisture);
-                cJSON_AddNumberToObject(properties, "lightIntensity", data->lightIntensity);
-                cJSON_AddNumberToObject(properties, "soilTemperature", round(data->soilTemperature * 10.0) / 10.0);
-                cJSON_AddNumberToObject(properties, "vocConcentration", data->vocConcentration);
-                cJSON_AddNumberToObject(properties, "co2Concentration", data->co2Concentration);
-
-                char *payload = cJSON_PrintUnformatted(root);
-                cJSON_Delete(root);
-                
-                if (payload) {
-                    size_t logical_len = strlen(payload);
-                    char *escaped_payload = pvPortMalloc(logical_len * 2 + 1);
-                    if (escaped_payload) {
-                        char *p_in = payload;
-                        char *p_out = escaped_payload;
-                        while (*p_in) {
-                            if (*p_in == '"' || *p_in == '\\') *p_out++ = '\\';
-                            *p_out++ = *p_in++;
-                        }
-                        *p_out = '\0';
-                        
-                        char at_cmd[2048];
-                        snprintf(at_cmd, sizeof(at_cmd), "AT+HMPUB=1,\"$oc/devices/%s/sys/gateway/sub_devices/properties/report\",%d,\"%s\"", IOT_DEVICE_ID, logical_len, escaped_payload);
-                        status1 = AT_SendCommand(handler, at_cmd, 15000, NULL, 0);
-                        vPortFree(escaped_payload);
-                    }
-                    vPortFree(payload);
-                }
+                break;
             }
+        }
 
-            osDelay(500);
+        hmpub_frame_t frame;
+        AT_Status_t status = hmpub_begin_async(handler, TOPIC_GATEWAY_REPORT, &frame);
+        if (status != AT_OK)
+        {
+            final_status = status;
+            break;
+        }
 
-            // --- Packet 2: 土壤详细数据和电池状态 ---
+        report_frame_ctx_t *frame_ctx = acquire_report_frame();
+        if (frame_ctx == NULL)
+        {
+            hmpub_abort(handler, &frame);
+            final_status = AT_BUFFER_FULL;
+            break;
+        }
+
+        JsonWriter_t *w = &frame.json;
+        JsonWriter_BeginObject(w);
+        JsonWriter_Key(w, "devices");
+        JsonWriter_BeginArray(w);
+
+        while (next < dirty_count)
+        {
+            if (!DeviceManager_GetDevice(dirty_device_ids[next], device_data))
             {
-                cJSON *root = cJSON_CreateObject();
-                cJSON *devices = cJSON_AddArrayToObject(root, "devices");
-                cJSON *device = cJSON_CreateObject();
-                cJSON_AddItemToArray(devices, device);
-                cJSON_AddStringToObject(device, "device_id", device_data.cloud_device_id);
-                cJSON *services = cJSON_AddArrayToObject(device, "services");
-
-                // Service 1: sensor (soil properties)
-                cJSON *svc_sensor = cJSON_CreateObject();
-                cJSON_AddItemToArray(services, svc_sensor);
-                cJSON_AddStringToObject(svc_sensor, "service_id", "sensor");
-                cJSON *props_sensor = cJSON_AddObjectToObject(svc_sensor, "properties");
-                const InternalSensorProperties_t *data = &device_data.properties.internal_sensor;
-                cJSON_AddNumberToObject(props_sensor, "soilPh", round(data->soilPh * 10.0) / 10.0);
-                cJSON_AddNumberToObject(props_sensor, "soilEc", data->soilEc);
-                cJSON_AddNumberToObject(props_sensor, "soilNitrogen", data->soilNitrogen);
-                cJSON_AddNumberToObject(props_sensor, "soilPhosphorus", data->soilPhosphorus);
-                cJSON_AddNumberToObject(props_sensor, "soilPotassium", data->soilPotassium);
-                cJSON_AddNumberToObject(props_sensor, "soilSalinity", data->soilSalinity);
-                cJSON_AddNumberToObject(props_sensor, "soilTds", data->soilTds);
-                cJSON_AddNumberToObject(props_sensor, "soilFertility", data->soilFertility);
-
-                // Service 2: device (battery properties)
-                cJSON *svc_device = cJSON_CreateObject();
-                cJSON_AddItemToArray(services, svc_device);
-                cJSON_AddStringToObject(svc_device, "service_id", "device");
-                cJSON *props_device = cJSON_AddObjectToObject(svc_device, "properties");
-                cJSON_AddNumberToObject(props_device, "batteryLevel", data->common.batteryLevel);
-                cJSON_AddNumberToObject(props_device, "batteryVoltage", round(data->common.batteryVoltage * 10.0) / 10.0);
-
-                char *payload = cJSON_PrintUnformatted(root);
-                cJSON_Delete(root);
-
-                if (payload) {
-                    size_t logical_len = strlen(payload);
-                    char *escaped_payload = pvPortMalloc(logical_len * 2 + 1);
-                    if (escaped_payload) {
-                        char *p_in = payload;
-                        char *p_out = escaped_payload;
-                        while (*p_in) {
-                            if (*p_in == '"' || *p_in == '\\') *p_out++ = '\\';
-                            *p_out++ = *p_in++;
-                        }
-                        *p_out = '\0';
-
-                        char at_cmd[2048];
-                        snprintf(at_cmd, sizeof(at_cmd), "AT+HMPUB=1,\"$oc/devices/%s/sys/gateway/sub_devices/properties/report\",%d,\"%s\"", IOT_DEVICE_ID, logical_len, escaped_payload);
-                        status2 = AT_SendCommand(handler, at_cmd, 15000, NULL, 0);
-                        vPortFree(escaped_payload);
+                next++;
+                next_part = 0;
+                continue;
+            }
+
+            const report_layout_t *layout = get_report_layout(device_data->device_type);
+            service_writer_t writer = (next_part == 0) ? layout->full : layout->parts[next_part - 1];
+
+            JsonWriter_t mark = *w;
+            write_device_entry(w, device_data, writer);
+            if (report_frame_fits(w))
+            {
+                frame_ctx->entry_count++;
+                if (next_part == 0 || next_part == layout->part_count)
+                {
+                    // 设备的全部数据都已写入 (拆分设备的前几部分已在之前的消息中成功发出)
+                    frame_ctx->device_ids[frame_ctx->device_count++] = device_data->lora_id;
+                    if (frame_ctx->trace_count < SAMPLE_TRACE_MAX_DEVICES &&
+                        SampleTrace_Take(device_data->lora_id, &frame_ctx->traces[frame_ctx->trace_count]))
+                    {
+                        frame_ctx->trace_count++;
                     }
-                    vPortFree(payload);
+                    next++;
+                    next_part = 0;
                 }
+                else
+                {
+                    next_part++;
+                }
+                continue;
             }
 
-            // --- 统一处理结果 ---
-            if (status1 == AT_OK && status2 == AT_OK) {
-                printf("[Upload] SUCCESS for 2-part report: %s.\r\n", device_data.cloud_device_id);
-                DeviceManager_ClearDirtyFlag(device_data.lora_id);
-            } else {
-                printf("[Upload] FAILED for 2-part report: %s (Status1: %d, Status2: %d). Will retry.\r\n", device_data.cloud_device_id, status1, status2);
-                final_status = AT_ERROR;
+            // 放不下：回滚本条目
+            *w = mark;
+            if (frame_ctx->entry_count > 0)
+            {
+                break; // 先发出已打包的内容，剩下的放到下一条消息
             }
+
+            // 即使独占一条消息也放不下
+            if (next_part == 0 && layout->part_count > 0)
+            {
+                printf("[Upload] %s does not fit in one message, splitting into %d parts.\r\n", device_data->cloud_device_id, layout->part_count);
+                next_part = 1;
+                continue;
+            }
+
+            printf("[Upload] FAILED: %s does not fit in a single message. Skipped.\r\n", device_data->cloud_device_id);
+            final_status = AT_BUFFER_FULL;
+            next++;
+            next_part = 0;
         }
-        else 
+
+        if (frame_ctx->entry_count == 0)
         {
-            // --- 策略B: 其他设备，单次全量上报 ---
-            printf("[Upload] Standard report for device: %s\r\n", device_data.cloud_device_id);
-            cJSON *root = cJSON_CreateObject();
-            cJSON *devices = cJSON_AddArrayToObject(root, "devices");
-            cJSON *device = cJSON_CreateObject();
-            cJSON_AddItemToArray(devices, device);
-            cJSON_AddStringToObject(device, "device_id", device_data.cloud_device_id);
-            cJSON *services = cJSON_AddArrayToObject(device, "services");
-            
-            build_service_json(&device_data, services);
-
-            char *payload = cJSON_PrintUnformatted(root);
-            cJSON_Delete(root);
-
-            if (payload) {
-                size_t logical_len = strlen(payload);
-                char *escaped_payload = pvPortMalloc(logical_len * 2 + 1);
-                if (escaped_payload) {
-                    char *p_in = payload;
-                    char *p_out = escaped_payload;
-                    while (*p_in) {
-                        if (*p_in == '"' || *p_in == '\\') *p_out++ = '\\';
-                        *p_out++ = *p_in++;
-                    }
-                    *p_out = '\0';
-
-                    char at_cmd[2048];
-                    snprintf(at_cmd, sizeof(at_cmd), "AT+HMPUB=1,\"$oc/devices/%s/sys/gateway/sub_devices/properties/report\",%d,\"%s\"", IOT_DEVICE_ID, logical_len, escaped_payload);
-                    AT_Status_t status = AT_SendCommand(handler, at_cmd, 15000, NULL, 0);
-                    
-                    if (status == AT_OK) {
-                        printf("[Upload] SUCCESS for device %s.\r\n", device_data.cloud_device_id);
-                        DeviceManager_ClearDirtyFlag(device_data.lora_id);
-                    } else {
-                        printf("[Upload] FAILED for device %s. Will retry.\r\n", device_data.cloud_device_id);
-                        final_status = AT_ERROR;
-                    }
-                    vPortFree(escaped_payload);
-                }
-                vPortFree(payload);
-            }
+            frame_ctx->in_use = false;
+            hmpub_abort(handler, &frame);
+            break;
+        }
+
+        JsonWriter_EndArray(w);  // devices
+        JsonWriter_EndObject(w); // root
+
+        frame_ctx->payload_len = w->logical_len;
+        // 发布结果可能在 hmpub_finish_async 返回之前就已到达，发送时刻须在交给AT层之前记下
+        uint32_t send_tick = osKernelGetTickCount();
+        for (uint8_t i = 0; i < frame_ctx->trace_count; i++)
+        {
+            frame_ctx->traces[i].send_tick = send_tick;
+        }
+        status = hmpub_finish_async(handler, &frame, on_report_published, frame_ctx);
+        publish_count++;
+
+        if (status != AT_OK)
+        {
+            printf("[Upload] FAILED to publish %d device entries (Status: %d). Will retry.\r\n", frame_ctx->entry_count, status);
+            frame_ctx->in_use = false;
+            final_status = AT_ERROR;
+            // 模组或网络异常时后续消息大概率同样失败，剩余设备保持脏标记，留待下个周期重试
+            break;
         }
-        
-        // 在两次上报之间短暂延时，避免冲击模组
-        osDelay(500);
     }
-    
+
+    // 步骤 3: 等待所有在途消息的发布结果
+    if (AT_WaitAsyncIdle(handler, HMPUB_TIMEOUT_MS * 2) != AT_OK)
+    {
+        printf("[Upload] Timed out waiting for publish results.\r\n");
+        final_status = AT_TIMEOUT;
+    }
+    if (s_report_publish_failed && final_status == AT_OK)
+    {
+        final_status = AT_ERROR;
+    }
+
+    printf("[Upload] Report cycle finished: %d devices, %d publish(es).\r\n", dirty_count, publish_count);
     return final_status;
 }
+
+AT_Status_t HuaweiIoT_PublishGatewayReport(AT_Handler_t *handler)
+{
+    if (handler == NULL)
+        return AT_ERROR;
+
+    MemArena_Begin(&s_report_arena);
+    AT_Status_t status = publish_gateway_report(handler);
+    MemArena_End(&s_report_arena);
+    return status;
+}
+
+/**
+ * @brief 把一个子设备的完整上报条目写入缓冲区 (实现)
+ * @details 与网关上报使用同一套写入函数和同一种转义方式 (取决于 IOT_HMPUB_DATA_MODE)。
+ */
+uint16_t HuaweiIoT_WriteDeviceReport(char *buf, uint16_t size, const managed_device_t *device)
+{
+    JsonWriter_t w;
+#if IOT_HMPUB_DATA_MODE
+    JsonWriter_InitRaw(&w, buf, size);
+#else
+    JsonWriter_Init(&w, buf, size);
+#endif
+    write_device_entry(&w, device, get_report_layout(device->device_type)->full);
+    return JsonWriter_IsOk(&w) ? w.pos : 0;
+}
+
+/* Public Functions (Diagnostics) --------------------------------------------*/
+
+/**
+ * @brief 检查在当前位置闭合 (额外的 nested 层对象以及) properties/service/services/根对象后，消息是否仍在上限之内
+ */
+static bool diagnostics_fits(const JsonWriter_t *w, uint8_t nested)
+{
+    JsonWriter_t probe = *w;
+    for (uint8_t i = 0; i < nested; i++)
+    {
+        JsonWriter_EndObject(&probe);
+    }
+    JsonWriter_EndObject(&probe); // properties
+    JsonWriter_EndObject(&probe); // service
+    JsonWriter_EndArray(&probe);  // services
+    JsonWriter_EndObject(&probe); // root
+    return JsonWriter_IsOk(&probe) && probe.logical_len <= IOT_MAX_PUBLISH_PAYLOAD_LEN;
+}
+
+/**
+ * @brief 上报网关自身的AT命令时延统计 (实现)
+ * @details 每类命令一个属性，属性名为去掉 "AT+" 的命令前缀；放不下的命令直接省略，不拆分成多条消息。
+ */
+AT_Status_t HuaweiIoT_PublishModemStats(AT_Handler_t *at_handler)
+{
+    if (at_handler == NULL)
+        return AT_ERROR;
+
+    hmpub_frame_t frame;
+    AT_Status_t status = hmpub_begin(at_handler, TOPIC_PROPERTIES_REPORT, &frame);
+    if (status != AT_OK)
+        return status;
+
+    JsonWriter_t *w = &frame.json;
+    JsonWriter_BeginObject(w);
+    JsonWriter_Key(w, "services");
+    JsonWriter_BeginArray(w);
+    write_service_begin(w, "ModemStats");
+
+    AT_CmdStats_t stats;
+    uint8_t omitted = 0;
+    for (uint8_t i = 0; AT_Stats_GetCommand(i, &stats); i++)
+    {
+        const char *name = (strncmp(stats.key, "AT+", 3) == 0) ? stats.key + 3 : stats.key;
+
+        JsonWriter_t mark = *w;
+        JsonWriter_Key(w, name);
+        JsonWriter_BeginObject(w);
+        JsonWriter_KeyUint(w, "n", stats.count);
+        JsonWriter_KeyUint(w, "err", stats.errors);
+        JsonWriter_KeyUint(w, "tmo", stats.timeouts);
+        JsonWriter_KeyUint(w, "rty", stats.retries);
+        JsonWriter_KeyUint(w, "p50", LatencyHist_Percentile(&stats.latency, 50));
+        JsonWriter_KeyUint(w, "p95", LatencyHist_Percentile(&stats.latency, 95));
+        JsonWriter_KeyUint(w, "max", stats.latency.max_ms);
+        JsonWriter_EndObject(w);
+
+        if (!diagnostics_fits(w, 0))
+        {
+            *w = mark; // 放不下：回滚本条目
+            omitted++;
+        }
+    }
+
+    write_service_end(w);
+    JsonWriter_EndArray(w);  // services
+    JsonWriter_EndObject(w); // root
+
+    if (omitted > 0)
+    {
+        printf("[Upload] Modem stats: %d command(s) omitted (payload limit).\r\n", omitted);
+    }
+    return hmpub_finish(at_handler, &frame);
+}
+
+/**
+ * @brief 上报各传感器节点的样本端到端时延统计 (实现)
+ * @details 每个节点一个对象，每个阶段一个 [p50, p95, max] 数组；放不下的节点直接省略。
+ */
+AT_Status_t HuaweiIoT_PublishSampleLatency(AT_Handler_t *at_handler)
+{
+    static SampleTrace_DeviceStats_t stats; // 约0.4KB，不放在上行任务的栈上
+
+    if (at_handler == NULL)
+        return AT_ERROR;
+
+    hmpub_frame_t frame;
+    AT_Status_t status = hmpub_begin(at_handler, TOPIC_PROPERTIES_REPORT, &frame);
+    if (status != AT_OK)
+        return status;
+
+    JsonWriter_t *w = &frame.json;
+    JsonWriter_BeginObject(w);
+    JsonWriter_Key(w, "services");
+    JsonWriter_BeginArray(w);
+    write_service_begin(w, "SampleLatency");
+
+    uint8_t omitted = 0;
+    for (uint8_t i = 0; SampleTrace_GetDevice(i, &stats); i++)
+    {
+        char name[12];
+        snprintf(name, sizeof(name), "node_%02X", stats.lora_id);
+
+        JsonWriter_t mark = *w;
+        JsonWriter_Key(w, name);
+        JsonWriter_BeginObject(w);
+        JsonWriter_KeyUint(w, "n", stats.samples);
+        JsonWriter_KeyUint(w, "ack", stats.completed);
+        JsonWriter_KeyUint(w, "sup", stats.superseded);
+        for (uint8_t s = 0; s < SAMPLE_STAGE_COUNT; s++)
+        {
+            const LatencyHist_t *hist = &stats.stage[s];
+            if (hist->count == 0)
+            {
+                continue;
+            }
+            JsonWriter_Key(w, SampleTrace_StageName((SampleTrace_Stage_t)s));
+            JsonWriter_BeginArray(w);
+            JsonWriter_Uint(w, LatencyHist_Percentile(hist, 50));
+            JsonWriter_Uint(w, LatencyHist_Percentile(hist, 95));
+            JsonWriter_Uint(w, hist->max_ms);
+            JsonWriter_EndArray(w);
+        }
+        JsonWriter_EndObject(w);
+
+        if (!diagnostics_fits(w, 0))
+        {
+            *w = mark; // 放不下：回滚本条目
+            omitted++;
+        }
+    }
+
+    write_service_end(w);
+    JsonWriter_EndArray(w);  // services
+    JsonWriter_EndObject(w); // root
+
+    if (omitted > 0)
+    {
+        printf("[Upload] Sample latency: %d node(s) omitted (payload limit).\r\n", omitted);
+    }
+    return hmpub_finish(at_handler, &frame);
+}
+
+/**
+ * @brief 上报网关自身的任务/堆统计 (实现)
+ * @details 堆统计和总CPU占用率在前，随后每个任务一个对象；放不下的任务直接省略。
+ */
+AT_Status_t HuaweiIoT_PublishSystemStats(AT_Handler_t *at_handler, const SystemMonitor_Snapshot_t *snapshot)
+{
+    if (at_handler == NULL || snapshot == NULL)
+        return AT_ERROR;
+
+    hmpub_frame_t frame;
+    AT_Status_t status = hmpub_begin(at_handler, TOPIC_PROPERTIES_REPORT, &frame);
+    if (status != AT_OK)
+        return status;
+
+    // 总CPU占用率 = 1 - 空闲任务的占用率
+    uint16_t load_permille = 0;
+    for (uint8_t i = 0; i < snapshot->task_count; i++)
+    {
+        if (strcmp(snapshot->tasks[i].name, "IDLE") == 0)
+        {
+            load_permille = 1000 - snapshot->tasks[i].cpu_permille;
+            break;
+        }
+    }
+
+    JsonWriter_t *w = &frame.json;
+    JsonWriter_BeginObject(w);
+    JsonWriter_Key(w, "services");
+    JsonWriter_BeginArray(w);
+    write_service_begin(w, "SystemStats");
+
+    JsonWriter_KeyFixed(w, "cpu_load", load_permille / 10.0, 1);
+    JsonWriter_KeyUint(w, "heap_free", snapshot->heap_free);
+    JsonWriter_KeyUint(w, "heap_min", snapshot->heap_min_ever);
+    JsonWriter_KeyUint(w, "heap_largest", snapshot->heap_largest_block);
+    JsonWriter_KeyUint(w, "heap_blocks", snapshot->heap_free_blocks);
+    JsonWriter_KeyFixed(w, "heap_frag", snapshot->heap_frag_permille / 10.0, 1);
+
+    JsonWriter_Key(w, "tasks");
+    JsonWriter_BeginObject(w);
+    uint8_t omitted = 0;
+    for (uint8_t i = 0; i < snapshot->task_count; i++)
+    {
+        const SystemMonitor_TaskStats_t *task = &snapshot->tasks[i];
+
+        JsonWriter_t mark = *w;
+        JsonWriter_Key(w, task->name);
+        JsonWriter_BeginObject(w);
+        JsonWriter_KeyFixed(w, "cpu", task->cpu_permille / 10.0, 1);
+        JsonWriter_KeyUint(w, "sw", task->switches);
+        JsonWriter_KeyUint(w, "hwm", task->stack_hwm_bytes);
+        JsonWriter_KeyUint(w, "prio", task->priority);
+        JsonWriter_EndObject(w);
+
+        if (!diagnostics_fits(w, 1))
+        {
+            *w = mark; // 放不下：回滚本条目
+            omitted++;
+        }
+    }
+    JsonWriter_EndObject(w); // tasks
+
+    write_service_end(w);
+    JsonWriter_EndArray(w);  // services
+    JsonWriter_EndObject(w); // root
+
+    if (omitted > 0)
+    {
+        printf("[Upload] System stats: %d task(s) omitted (payload limit).\r\n", omitted);
+    }
+    return hmpub_finish(at_handler, &frame);
+}
@@ -11,22 +11,58 @@
  *      - 封装连接到华为云物联网平台所需的业务流程。
  *      - 封装上报所有子设备状态的业务逻辑。
  *      - 提供一个命令分发器，用于解析云端下发的命令并调用相应的处理函数。
- *      - 提供cJSON库的内存管理钩子初始化。
+ *        命令在原始URC字符串上就地解析，不分配堆内存。
+ *      - 上报和命令处理中的临时内存从两个专用内存池 (MemArena) 分配。
  */
 
 #ifndef __HUAWEI_IOT_APP_H
 #define __HUAWEI_IOT_APP_H
 
 #include "at_handler.h"
-#include "cJSON.h"
+#include "at_script.h"
 #include "iot_config.h"
 #include "device_properties.h"
+#include "device_manager.h"
+#include "system_monitor.h"
+
+/**
+ * @brief 云端命令参数的类型
+ */
+typedef enum {
+    CMD_PARAM_BOOL,   ///< JSON true/false
+    CMD_PARAM_UINT8,  ///< 0-255 的整数
+    CMD_PARAM_UINT16, ///< 0-65535 的整数
+    CMD_PARAM_UINT16_RANGE ///< 两个 0-65535 的整数 (下限、上限)，下限不大于上限
+} command_param_type_e;
+
+/**
+ * @brief 已提取并校验过的命令参数值
+ */
+typedef union {
+    bool b;
+    uint8_t u8;
+    uint16_t u16;
+    struct {
+        uint16_t min;
+        uint16_t max;
+    } range;
+} command_param_t;
+
+/**
+ * @brief 命令的执行结果，其值即命令响应中的 result_code
+ */
+typedef enum {
+    CMD_RESULT_OK = 0,        ///< 命令已执行 (或已登记，等待下发)
+    CMD_RESULT_INVALID_PARAM, ///< 参数缺失、类型错误或超出范围，命令未执行
+    CMD_RESULT_FAILED         ///< 参数合法，但命令未能执行 (例如LoRa发送队列或下行队列已满)
+} command_result_e;
 
 /**
  * @brief 命令处理函数的函数指针类型
- * @param paras 指向cJSON对象的指针，该对象包含了从云端下发的命令参数。
+ * @param param 由分发器按命令表声明的类型从 `paras` 中提取出的参数值。
+ * @return command_result_e 命令的执行结果
  */
-typedef void (*command_handler_t)(const cJSON *paras);
+typedef command_result_e (*command_handler_t)(command_param_t param);
 
 /**
  * @brief 华为云应用层函数返回状态码
@@ -49,7 +85,8 @@ typedef enum {
 /**
  * @brief 初始化华为云物联网应用模块
  * @details
- *        此函数为cJSON库配置基于FreeRTOS的内存管理函数(pvPortMalloc/vPortFree)。
+ *        此函数初始化上报和命令处理使用的临时内存池，
+ *        并检查命令分发表是否按命令名称排序。
  *        它必须在系统启动初期、在调用任何其他华为云应用函数之前被调用一次。
  */
 void HuaweiIoT_Init(void);
@@ -57,17 +94,24 @@ void HuaweiIoT_Init(void);
 /**
  * @brief 执行连接云平台的完整业务序列
  * @details
- *        此函数包含了检查网络、激活IP、连接MQTT等一系列操作。
- *        它被设计为可重入的，用于系统首次连接及后续的断线重连。
+ *        此函数通过AT脚本引擎执行检查网络、激活IP、连接MQTT等一系列操作。
+ *        若模组的PDP上下文仍然有效，则走快速路径，只重建MQTT会话；否则走完整的拨号流程。
+ *        它被设计为可重入的，用于系统首次连接及后续的断线重连。每一步的耗时会被记录并打印。
  * @param at_handler AT处理器实例指针
  * @return AT_Status_t AT命令执行的状态
  */
 AT_Status_t HuaweiIoT_ConnectCloud(AT_Handler_t *at_handler);
 
+/**
+ * @brief 获取最近一次连接云平台的执行结果 (走了哪些步骤、每步的尝试次数和耗时)
+ * @param out_result 用于存储结果的结构体指针
+ */
+void HuaweiIoT_GetLastConnectResult(AT_ScriptResult_t *out_result);
+
 /**
  * @brief 上报所有在 iot_config.h 中定义的子设备为"ONLINE"状态
  * @details
- *        此函数会动态构建一个符合华为云物模型规范的JSON负载，
+ *        此函数会将符合华为云物模型规范的JSON负载直接写入AT发送缓冲区，
  *        然后通过AT命令将其发布到云平台。
  * @param at_handler AT处理器实例指针
  * @return AT_Status_t AT命令执行的状态
@@ -78,8 +122,9 @@ AT_Status_t HuaweiIoT_PublishAllSubDevicesOnline(AT_Handler_t *at_handler);
  * @brief 解析并处理来自模块的 "+HMREC" (云端下发命令) URC
  * @details
  *        此函数被注册为URC回调，专门用于处理华为云的命令下发。
- *        它会解析URC，提取命令名称和参数，然后通过内部的命令分发器
- *        找到并执行对应的处理函数，最后调用响应函数将执行结果返回给云平台。
+ *        它会在URC字符串上就地分词 (固定大小的栈上token数组，不使用堆)，
+ *        在已排序的命令表中二分查找命令，按声明的类型提取参数后执行对应的处理函数，
+ *        最后调用响应函数将执行结果返回给云平台。
  * @param at_handler AT处理器实例指针
  * @param hprec_str  模块上报的完整URC字符串
  */
@@ -103,16 +148,67 @@ AT_Status_t HuaweiIoT_PublishCommandResponse(AT_Handler_t *at_handler, const cha
  * @details
  *        此函数是网关数据上报的核心。它会：
  *        1. 在 DeviceManager 中查找所有带有"脏"标记的子设备。
- *        2. 如果找到，它会构建一个符合华为云网关上报规范的复杂JSON对象。
- *        3. 将所有脏设备的数据填充到JSON中。
- *        4. 发送包含此JSON的AT命令到正确的网关Topic。
- *        5. 如果发送成功，则清除所有已上报设备的"脏"标记。
+ *        2. 如果找到，它会按照华为云网关上报规范，将设备数据以JSON形式
+ *           直接流式写入AT发送缓冲区 (不使用堆内存，也不需要额外的转义拷贝)。
+ *        3. 尽可能多的设备被打包进同一条消息的 "devices" 数组，直到达到
+ *           IOT_MAX_PUBLISH_PAYLOAD_LEN 才开始下一条；单个设备独占一条消息
+ *           仍放不下时，才按服务拆分到多条消息中。
+ *        4. 消息通过AT层的异步窗口发送：一条经串口发送完毕后即开始构建下一条，最多
+ *           AT_ASYNC_WINDOW_SIZE 条同时等待发布结果 ("+HMPUB OK")。某条消息发布成功后，
+ *           清除其中已完整上报设备的"脏"标记。函数在所有在途消息返回结果后才返回。
  * @param handler AT处理器实例指针
  * @return AT_Status_t
  *         - AT_OK: 成功发送上报，或没有需要上报的数据。
- *         - AT_ERROR: 发送失败。
- *         - AT_MALLOC_FAILED: JSON对象内存分配失败。
+ *         - AT_ERROR: 发送失败，或有消息的发布结果为失败。
+ *         - AT_TIMEOUT: 等待发布结果超时。
+ *         - AT_BUFFER_FULL: 负载超出AT发送缓冲区的容量。
  */
 AT_Status_t HuaweiIoT_PublishGatewayReport(AT_Handler_t *handler);
 
+/**
+ * @brief 把一个子设备的完整上报条目 {"device_id":"xxx","services":[...]} 写入缓冲区，不发送
+ * @details 与 HuaweiIoT_PublishGatewayReport 写入的内容逐字节相同 (不拆分)，
+ *          用于微基准测试 (见 micro_bench.h) 和调试时查看上报内容。
+ * @param buf 输出缓冲区 (不保证以 '\0' 结尾)
+ * @param size 输出缓冲区大小
+ * @param device 设备 (通常来自 DeviceManager_GetDevice)
+ * @return uint16_t 写入的字节数；缓冲区放不下时返回 0
+ */
+uint16_t HuaweiIoT_WriteDeviceReport(char *buf, uint16_t size, const managed_device_t *device);
+
+/**
+ * @brief 把AT命令时延统计 (见 at_stats.h) 作为网关自身的 "ModemStats" 服务属性上报
+ * @details
+ *        每类命令一个属性，属性名为去掉 "AT+" 的命令前缀，值为
+ *        {"n":次数,"err":错误,"tmo":超时,"rty":重发,"p50":中位时延,"p95":95%时延,"max":最长时延} (时延单位ms)。
+ *        用于在云端观察各命令的真实时延分布，据此校准超时时间。同步发送，应在上行任务中调用。
+ * @param at_handler AT处理器实例指针
+ * @return AT_Status_t 发布结果
+ */
+AT_Status_t HuaweiIoT_PublishModemStats(AT_Handler_t *at_handler);
+
+/**
+ * @brief 把各传感器节点的样本端到端时延统计 (见 sample_trace.h) 作为网关自身的 "SampleLatency" 服务属性上报
+ * @details
+ *        每个节点一个属性，属性名为 "node_<LoRa ID>"，值为
+ *        {"n":样本数,"ack":已确认,"sup":被覆盖,"node"/"ingest"/"wait"/"queue"/"publish"/"e2e":[p50,p95,max]} (单位ms)，
+ *        没有样本的阶段省略。同步发送，应在上行任务中调用。
+ * @param at_handler AT处理器实例指针
+ * @return AT_Status_t 发布结果
+ */
+AT_Status_t HuaweiIoT_PublishSampleLatency(AT_Handler_t *at_handler);
+
+/**
+ * @brief 把系统监控的任务/堆统计 (见 system_monitor.h) 作为网关自身的 "SystemStats" 服务属性上报
+ * @details
+ *        属性包括总CPU占用率 "cpu_load" (%)、堆统计 "heap_free"/"heap_min"/"heap_largest"/"heap_blocks"
+ *        和碎片率 "heap_frag" (%)，以及 "tasks" 对象：每个任务一个属性，属性名为任务名，值为
+ *        {"cpu":占用率(%),"sw":切入次数,"hwm":堆栈高水位(字节),"prio":优先级}，统计口径为最近一个监控周期。
+ *        同步发送，应在上行任务中调用。
+ * @param at_handler AT处理器实例指针
+ * @param snapshot 系统监控快照
+ * @return AT_Status_t 发布结果
+ */
+AT_Status_t HuaweiIoT_PublishSystemStats(AT_Handler_t *at_handler, const SystemMonitor_Snapshot_t *snapshot);
+
 #endif /* __HUAWEI_IOT_APP_H */ 
@@ -46,6 +46,36 @@
  */
 #define IOT_DEVICE_PASSWORD     "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"
 
+/**
+ * @brief 是否以模组的数据模式发布消息
+ *        0: 负载转义后嵌在 `AT+HMPUB=1,"<topic>",<len>,"<json>"` 命令行中 (调试日志中验证过的用法)，
+ *           整条命令受AT发送缓冲区 (1KB) 限制。
+ *        1: 先发 `AT+HMPUB=1,"<topic>",<len>`，负载以原始JSON直接从负载缓冲区发出，
+ *           不转义、不拷贝，单条消息可达 IOT_MAX_PUBLISH_PAYLOAD_LEN。需确认模组固件支持该用法。
+ */
+#ifndef IOT_HMPUB_DATA_MODE
+#define IOT_HMPUB_DATA_MODE          0
+#endif
+
+/**
+ * @brief 数据模式下，模组是否先回 '>' 提示符再接收负载
+ *        0: 命令头和负载作为一次DMA链表传输连续发出。
+ */
+#ifndef IOT_HMPUB_DATA_PROMPT
+#define IOT_HMPUB_DATA_PROMPT        1
+#endif
+
+/**
+ * @brief 单条 AT+HMPUB 消息负载的最大逻辑长度 (未转义的JSON字节数)
+ *        网关上报会把尽可能多的子设备打包进同一条消息，直到达到此上限
+ *        (或AT发送缓冲区放满) 才开始下一条。
+ */
+#if IOT_HMPUB_DATA_MODE
+#define IOT_MAX_PUBLISH_PAYLOAD_LEN  4096
+#else
+#define IOT_MAX_PUBLISH_PAYLOAD_LEN  1024
+#endif
+
 
 //==============================================================================
 // 2. 子设备配置中心
@@ -0,0 +1,303 @@
+/**
+ * @file iot_json_parser.c
+ * @brief 零堆分配的就地JSON分词器 (jsmn 风格) - 实现
+ */
+
+#include "iot_json_parser.h"
+#include <string.h>
+
+#define JSON_TOKEN_OPEN 0xFFFF ///< 尚未闭合的容器的 end 值
+
+/* Private Functions ---------------------------------------------------------*/
+
+/**
+ * @brief 分配一个新的 token 并挂到当前父节点下
+ */
+static JsonToken_t *alloc_token(JsonToken_t *tokens, uint16_t max_tokens, int *count, int super)
+{
+    if (*count >= max_tokens)
+    {
+        return NULL;
+    }
+
+    JsonToken_t *tok = &tokens[(*count)++];
+    tok->type = JSON_TOKEN_UNDEFINED;
+    tok->parent = (int16_t)super;
+    tok->start = 0;
+    tok->end = 0;
+    tok->size = 0;
+
+    if (super != -1)
+    {
+        tokens[super].size++;
+    }
+    return tok;
+}
+
+static bool is_primitive_char(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+           c == '-' || c == '+' || c == '.' || c == 'E';
+}
+
+/* Public Functions ----------------------------------------------------------*/
+
+int JsonParser_Parse(const char *js, uint16_t len, JsonToken_t *tokens, uint16_t max_tokens)
+{
+    int count = 0;
+    int super = -1; // 当前父节点 (容器或刚解析完的键)
+
+    if (js == NULL || tokens == NULL || len >= JSON_TOKEN_OPEN)
+    {
+        return JSON_PARSE_ERROR_INVAL;
+    }
+
+    for (uint16_t pos = 0; pos < len && js[pos] != '\0'; pos++)
+    {
+        char c = js[pos];
+        switch (c)
+        {
+        case '{':
+        case '[':
+        {
+            // 对象中的值必须先有键
+            if (super != -1 && tokens[super].type == JSON_TOKEN_OBJECT)
+            {
+                return JSON_PARSE_ERROR_INVAL;
+            }
+            JsonToken_t *tok = alloc_token(tokens, max_tokens, &count, super);
+            if (tok == NULL)
+            {
+                return JSON_PARSE_ERROR_NOMEM;
+            }
+            tok->type = (c == '{') ? JSON_TOKEN_OBJECT : JSON_TOKEN_ARRAY;
+            tok->start = pos;
+            tok->end = JSON_TOKEN_OPEN;
+            super = count - 1;
+            break;
+        }
+
+        case '}':
+        case ']':
+        {
+            uint8_t type = (c == '}') ? JSON_TOKEN_OBJECT : JSON_TOKEN_ARRAY;
+            if (count == 0)
+            {
+                return JSON_PARSE_ERROR_INVAL;
+            }
+
+            // 从最后一个 token 向上找到最近的未闭合容器
+            int i = count - 1;
+            while (i != -1 && tokens[i].end != JSON_TOKEN_OPEN)
+            {
+                i = tokens[i].parent;
+            }
+            if (i == -1 || tokens[i].type != type)
+            {
+                return JSON_PARSE_ERROR_INVAL;
+            }
+            tokens[i].end = pos + 1;
+            super = tokens[i].parent;
+
+            if (super == -1)
+            {
+                return count; // 根元素已闭合
+            }
+            break;
+        }
+
+        case '"':
+        {
+            uint16_t start = pos + 1;
+            for (pos = start; pos < len && js[pos] != '\0' && js[pos] != '"'; pos++)
+            {
+                if (js[pos] == '\\' && pos + 1 < len)
+                {
+                    pos++; // 跳过被转义的字符
+                }
+            }
+            if (pos >= len || js[pos] != '"')
+            {
+                return JSON_PARSE_ERROR_PART;
+            }
+
+            JsonToken_t *tok = alloc_token(tokens, max_tokens, &count, super);
+            if (tok == NULL)
+            {
+                return JSON_PARSE_ERROR_NOMEM;
+            }
+            tok->type = JSON_TOKEN_STRING;
+            tok->start = start;
+            tok->end = pos;
+            break;
+        }
+
+        case ':':
+            // 刚解析的字符串是键，之后的值挂在键下面
+            if (count == 0 || tokens[count - 1].type != JSON_TOKEN_STRING)
+            {
+                return JSON_PARSE_ERROR_INVAL;
+            }
+            super = count - 1;
+            break;
+
+        case ',':
+            // 一个键值对结束，回到所在的对象
+            if (super != -1 && tokens[super].type != JSON_TOKEN_OBJECT && tokens[super].type != JSON_TOKEN_ARRAY)
+            {
+                super = tokens[super].parent;
+            }
+            break;
+
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+            break;
+
+        default:
+        {
+            if (!is_primitive_char(c) || (super != -1 && tokens[super].type == JSON_TOKEN_OBJECT))
+            {
+                return JSON_PARSE_ERROR_INVAL;
+            }
+            uint16_t start = pos;
+            while (pos + 1 < len && is_primitive_char(js[pos + 1]))
+            {
+                pos++;
+            }
+
+            JsonToken_t *tok = alloc_token(tokens, max_tokens, &count, super);
+            if (tok == NULL)
+            {
+                return JSON_PARSE_ERROR_NOMEM;
+            }
+            tok->type = JSON_TOKEN_PRIMITIVE;
+            tok->start = start;
+            tok->end = pos + 1;
+            break;
+        }
+        }
+    }
+
+    // 输入结束时仍有未闭合的容器
+    for (int i = 0; i < count; i++)
+    {
+        if (tokens[i].end == JSON_TOKEN_OPEN)
+        {
+            return JSON_PARSE_ERROR_PART;
+        }
+    }
+    return count;
+}
+
+int JsonParser_Skip(const JsonToken_t *tokens, int count, int index)
+{
+    // 每访问一个 token 就消耗一个"待访问"名额，并为它的子元素增加名额
+    uint16_t pending = 1;
+    while (pending > 0 && index < count)
+    {
+        pending += tokens[index].size;
+        pending--;
+        index++;
+    }
+    return index;
+}
+
+int JsonParser_FindKey(const char *js, const JsonToken_t *tokens, int count, int obj_index, const char *key)
+{
+    if (obj_index < 0 || obj_index >= count || tokens[obj_index].type != JSON_TOKEN_OBJECT)
+    {
+        return -1;
+    }
+
+    int i = obj_index + 1;
+    for (uint16_t n = 0; n < tokens[obj_index].size && i < count; n++)
+    {
+        int value = i + 1;
+        if (tokens[i].size == 1 && value < count && JsonParser_TokenEquals(js, &tokens[i], key))
+        {
+            return value;
+        }
+        i = JsonParser_Skip(tokens, count, i); // 跳过整个键值对
+    }
+    return -1;
+}
+
+bool JsonParser_TokenEquals(const char *js, const JsonToken_t *token, const char *str)
+{
+    size_t len = token->end - token->start;
+    return strlen(str) == len && memcmp(js + token->start, str, len) == 0;
+}
+
+bool JsonParser_GetBool(const char *js, const JsonToken_t *token, bool *out)
+{
+    if (token->type != JSON_TOKEN_PRIMITIVE)
+    {
+        return false;
+    }
+    if (JsonParser_TokenEquals(js, token, "true"))
+    {
+        *out = true;
+        return true;
+    }
+    if (JsonParser_TokenEquals(js, token, "false"))
+    {
+        *out = false;
+        return true;
+    }
+    return false;
+}
+
+bool JsonParser_GetInt(const char *js, const JsonToken_t *token, int32_t *out)
+{
+    if (token->type != JSON_TOKEN_PRIMITIVE)
+    {
+        return false;
+    }
+
+    uint16_t pos = token->start;
+    bool negative = false;
+    if (js[pos] == '-')
+    {
+        negative = true;
+        pos++;
+    }
+    if (pos >= token->end || js[pos] < '0' || js[pos] > '9')
+    {
+        return false;
+    }
+
+    int64_t value = 0;
+    for (; pos < token->end && js[pos] >= '0' && js[pos] <= '9'; pos++)
+    {
+        value = value * 10 + (js[pos] - '0');
+        if (value > (int64_t)INT32_MAX + 1)
+        {
+            return false;
+        }
+    }
+
+    // 允许小数部分 (截断)，但不接受指数
+    if (pos < token->end && js[pos] == '.')
+    {
+        for (pos++; pos < token->end && js[pos] >= '0' && js[pos] <= '9'; pos++)
+        {
+        }
+    }
+    if (pos != token->end)
+    {
+        return false;
+    }
+
+    if (negative)
+    {
+        value = -value;
+    }
+    if (value > INT32_MAX || value < INT32_MIN)
+    {
+        return false;
+    }
+    *out = (int32_t)value;
+    return true;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file iot_json_parser.h
+ * @author Your Name
+ * @brief 零堆分配的就地JSON分词器 (jsmn 风格)
+ * @version 1.0
+ * @date 2025-07-14
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @par 模块功能:
+ *      - 在原始字符串上就地解析JSON，不复制、不修改源字符串，也不分配任何内存。
+ *      - 解析结果是一个由调用者提供的 token 数组，每个 token 只记录类型和在源字符串中的起止位置。
+ *      - token 按文档顺序排列，容器的子元素紧跟在容器之后。对象中键是对象的子元素，值是键的子元素。
+ *      - 提供按键查找、布尔/整数提取等辅助函数，供云端命令解析使用。
+ *
+ * @par 使用说明:
+ *      解析时间与输入长度成正比，token 数组用尽时返回 JSON_PARSE_ERROR_NOMEM，
+ *      因此在URC回调等对时间敏感的上下文中也可以安全使用。
+ */
+
+#ifndef __IOT_JSON_PARSER_H
+#define __IOT_JSON_PARSER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief token 类型
+ */
+typedef enum {
+    JSON_TOKEN_UNDEFINED = 0,
+    JSON_TOKEN_OBJECT,
+    JSON_TOKEN_ARRAY,
+    JSON_TOKEN_STRING,    ///< 不含引号，转义序列保持原样
+    JSON_TOKEN_PRIMITIVE  ///< 数字、true、false、null
+} JsonTokenType_e;
+
+/**
+ * @brief 解析错误码 (JsonParser_Parse 的负返回值)
+ */
+#define JSON_PARSE_ERROR_NOMEM  (-1) ///< token 数组不够用
+#define JSON_PARSE_ERROR_INVAL  (-2) ///< 非法字符或括号不匹配
+#define JSON_PARSE_ERROR_PART   (-3) ///< 输入不完整
+
+/**
+ * @brief 一个JSON token，描述源字符串中的一段区间 [start, end)
+ */
+typedef struct {
+    uint8_t  type;   ///< JsonTokenType_e
+    int16_t  parent; ///< 父 token 的下标，根为 -1
+    uint16_t start;  ///< 起始偏移
+    uint16_t end;    ///< 结束偏移 (不含)
+    uint16_t size;   ///< 子元素个数 (对象为键的个数)
+} JsonToken_t;
+
+/**
+ * @brief 解析JSON文本
+ * @details 根元素闭合后立即停止，忽略其后的任何内容 (例如URC末尾的引号和换行)。
+ * @param js         JSON文本 (遇到 '\0' 也会停止)
+ * @param len        最多解析的字节数
+ * @param tokens     输出的 token 数组
+ * @param max_tokens token 数组的容量
+ * @return int       成功时返回使用的 token 数，失败时返回 JSON_PARSE_ERROR_*
+ */
+int JsonParser_Parse(const char *js, uint16_t len, JsonToken_t *tokens, uint16_t max_tokens);
+
+/**
+ * @brief 返回下标为 index 的 token 之后第一个不属于它的 token (即下一个兄弟) 的下标
+ */
+int JsonParser_Skip(const JsonToken_t *tokens, int count, int index);
+
+/**
+ * @brief 在对象中按键名查找值
+ * @param obj_index 对象 token 的下标
+ * @return int 值 token 的下标，未找到或 obj_index 不是对象时返回 -1
+ */
+int JsonParser_FindKey(const char *js, const JsonToken_t *tokens, int count, int obj_index, const char *key);
+
+/**
+ * @brief 判断 token 的内容是否与给定字符串完全相同
+ */
+bool JsonParser_TokenEquals(const char *js, const JsonToken_t *token, const char *str);
+
+/**
+ * @brief 提取布尔值 (token 必须是 true 或 false)
+ */
+bool JsonParser_GetBool(const char *js, const JsonToken_t *token, bool *out);
+
+/**
+ * @brief 提取整数值
+ * @note  带小数部分的数字会被截断 (例如 50.0 -> 50)，带指数或超出 int32 范围时返回 false。
+ */
+bool JsonParser_GetInt(const char *js, const JsonToken_t *token, int32_t *out);
+
+#endif /* __IOT_JSON_PARSER_H */
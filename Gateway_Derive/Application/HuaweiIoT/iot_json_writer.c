@@ -0,0 +1,307 @@
+/**
+ * @file iot_json_writer.c
+ * @brief 单遍、零堆分配的流式JSON生成器 - 实现
+ *
+ * @par 转义规则:
+ *      `AT+HMPUB` 的负载被包在一对双引号中，因此负载里的每个 `"` 和 `\` 都必须
+ *      在前面再加一个 `\`。本模块在输出每个"逻辑字符"时直接完成这一步：
+ *      逻辑字符计入 `logical_len`，实际写入缓冲区的是转义后的1~2个字节。
+ *      以 `JsonWriter_InitRaw` 初始化的写入器跳过这一步，输出原始JSON。
+ */
+
+#include "iot_json_writer.h"
+#include <string.h>
+
+/* Private Constants ---------------------------------------------------------*/
+
+static const uint32_t s_pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+#define JSON_WRITER_MAX_DECIMALS ((uint8_t)(sizeof(s_pow10) / sizeof(s_pow10[0]) - 1))
+
+/* Private Functions ---------------------------------------------------------*/
+
+/**
+ * @brief 输出一个逻辑字符 (必要时添加AT转义)
+ */
+static void jw_putc(JsonWriter_t *w, char c)
+{
+    if (w->overflow)
+    {
+        return;
+    }
+
+    uint16_t need = (!w->raw && (c == '"' || c == '\\')) ? 2 : 1;
+    if ((uint32_t)w->pos + need > w->size)
+    {
+        w->overflow = true;
+        return;
+    }
+
+    if (need == 2)
+    {
+        w->buf[w->pos++] = '\\';
+    }
+    w->buf[w->pos++] = c;
+    w->logical_len++;
+}
+
+/**
+ * @brief 输出一段不含需要JSON转义字符的文本 (键名、数字等)
+ */
+static void jw_puts(JsonWriter_t *w, const char *s)
+{
+    while (*s)
+    {
+        jw_putc(w, *s++);
+    }
+}
+
+/**
+ * @brief 输出一个带引号的JSON字符串，并对内容做JSON转义
+ * @note  控制字符 (包括 CR/LF) 会被丢弃，因为它们会截断AT命令行。
+ */
+static void jw_put_quoted(JsonWriter_t *w, const char *s)
+{
+    jw_putc(w, '"');
+    if (s)
+    {
+        for (; *s; s++)
+        {
+            unsigned char c = (unsigned char)*s;
+            if (c < 0x20)
+            {
+                continue;
+            }
+            if (c == '"' || c == '\\')
+            {
+                jw_putc(w, '\\');
+            }
+            jw_putc(w, (char)c);
+        }
+    }
+    jw_putc(w, '"');
+}
+
+/**
+ * @brief 输出一个无符号整数的十进制表示
+ */
+static void jw_put_u64(JsonWriter_t *w, uint64_t v)
+{
+    char digits[20];
+    uint8_t n = 0;
+    do
+    {
+        digits[n++] = (char)('0' + (v % 10));
+        v /= 10;
+    } while (v != 0);
+
+    while (n > 0)
+    {
+        jw_putc(w, digits[--n]);
+    }
+}
+
+/**
+ * @brief 在写入一个值 (或容器) 之前，根据上下文补充逗号
+ */
+static void jw_before_value(JsonWriter_t *w)
+{
+    if (w->after_key)
+    {
+        w->after_key = false;
+        return;
+    }
+    if (w->depth > 0)
+    {
+        uint16_t bit = (uint16_t)(1U << (w->depth - 1));
+        if (w->has_items & bit)
+        {
+            jw_putc(w, ',');
+        }
+        w->has_items |= bit;
+    }
+}
+
+static void jw_open(JsonWriter_t *w, char c)
+{
+    jw_before_value(w);
+    if (w->depth >= JSON_WRITER_MAX_DEPTH)
+    {
+        w->overflow = true;
+        return;
+    }
+    jw_putc(w, c);
+    w->depth++;
+    w->has_items &= (uint16_t)~(1U << (w->depth - 1));
+}
+
+static void jw_close(JsonWriter_t *w, char c)
+{
+    if (w->depth == 0)
+    {
+        w->overflow = true;
+        return;
+    }
+    jw_putc(w, c);
+    w->depth--;
+}
+
+/* Public Functions ----------------------------------------------------------*/
+
+void JsonWriter_Init(JsonWriter_t *w, char *buf, uint16_t size)
+{
+    memset(w, 0, sizeof(JsonWriter_t));
+    w->buf = buf;
+    w->size = size;
+    w->overflow = (buf == NULL);
+}
+
+void JsonWriter_InitRaw(JsonWriter_t *w, char *buf, uint16_t size)
+{
+    JsonWriter_Init(w, buf, size);
+    w->raw = true;
+}
+
+void JsonWriter_BeginObject(JsonWriter_t *w)
+{
+    jw_open(w, '{');
+}
+
+void JsonWriter_EndObject(JsonWriter_t *w)
+{
+    jw_close(w, '}');
+}
+
+void JsonWriter_BeginArray(JsonWriter_t *w)
+{
+    jw_open(w, '[');
+}
+
+void JsonWriter_EndArray(JsonWriter_t *w)
+{
+    jw_close(w, ']');
+}
+
+void JsonWriter_Key(JsonWriter_t *w, const char *key)
+{
+    jw_before_value(w);
+    jw_put_quoted(w, key);
+    jw_putc(w, ':');
+    w->after_key = true;
+}
+
+void JsonWriter_String(JsonWriter_t *w, const char *value)
+{
+    jw_before_value(w);
+    jw_put_quoted(w, value);
+}
+
+void JsonWriter_Int(JsonWriter_t *w, int32_t value)
+{
+    jw_before_value(w);
+    if (value < 0)
+    {
+        jw_putc(w, '-');
+        jw_put_u64(w, (uint64_t)(-(int64_t)value));
+    }
+    else
+    {
+        jw_put_u64(w, (uint64_t)value);
+    }
+}
+
+void JsonWriter_Uint(JsonWriter_t *w, uint32_t value)
+{
+    jw_before_value(w);
+    jw_put_u64(w, value);
+}
+
+void JsonWriter_Bool(JsonWriter_t *w, bool value)
+{
+    jw_before_value(w);
+    jw_puts(w, value ? "true" : "false");
+}
+
+void JsonWriter_Fixed(JsonWriter_t *w, double value, uint8_t decimals)
+{
+    jw_before_value(w);
+
+    // 与 cJSON 一致：NaN/Inf 无法用JSON表示，输出 null
+    if (value != value || value > 1e15 || value < -1e15)
+    {
+        jw_puts(w, "null");
+        return;
+    }
+
+    if (decimals > JSON_WRITER_MAX_DECIMALS)
+    {
+        decimals = JSON_WRITER_MAX_DECIMALS;
+    }
+
+    bool negative = (value < 0);
+    double magnitude = negative ? -value : value;
+    uint32_t scale = s_pow10[decimals];
+
+    // 先整体放大并四舍五入，再拆分整数和小数部分，避免浮点格式化
+    uint64_t scaled = (uint64_t)(magnitude * scale + 0.5);
+    uint64_t int_part = scaled / scale;
+    uint32_t frac_part = (uint32_t)(scaled % scale);
+
+    // 去掉小数部分末尾的0
+    while (decimals > 0 && (frac_part % 10) == 0)
+    {
+        frac_part /= 10;
+        decimals--;
+    }
+
+    if (negative && (int_part != 0 || frac_part != 0))
+    {
+        jw_putc(w, '-');
+    }
+    jw_put_u64(w, int_part);
+
+    if (decimals > 0)
+    {
+        jw_putc(w, '.');
+        // 小数部分需要补齐前导0，例如 0.05 的 frac_part 为 5、decimals 为 2
+        for (uint32_t div = s_pow10[decimals - 1]; div > 0; div /= 10)
+        {
+            jw_putc(w, (char)('0' + (frac_part / div) % 10));
+        }
+    }
+}
+
+void JsonWriter_KeyString(JsonWriter_t *w, const char *key, const char *value)
+{
+    JsonWriter_Key(w, key);
+    JsonWriter_String(w, value);
+}
+
+void JsonWriter_KeyInt(JsonWriter_t *w, const char *key, int32_t value)
+{
+    JsonWriter_Key(w, key);
+    JsonWriter_Int(w, value);
+}
+
+void JsonWriter_KeyUint(JsonWriter_t *w, const char *key, uint32_t value)
+{
+    JsonWriter_Key(w, key);
+    JsonWriter_Uint(w, value);
+}
+
+void JsonWriter_KeyBool(JsonWriter_t *w, const char *key, bool value)
+{
+    JsonWriter_Key(w, key);
+    JsonWriter_Bool(w, value);
+}
+
+void JsonWriter_KeyFixed(JsonWriter_t *w, const char *key, double value, uint8_t decimals)
+{
+    JsonWriter_Key(w, key);
+    JsonWriter_Fixed(w, value, decimals);
+}
+
+bool JsonWriter_IsOk(const JsonWriter_t *w)
+{
+    return !w->overflow && w->depth == 0 && !w->after_key;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file iot_json_writer.h
+ * @author Your Name
+ * @brief 单遍、零堆分配的流式JSON生成器 (直接输出AT转义格式)
+ * @version 1.1
+ * @date 2025-07-20
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @par 模块功能:
+ *      - 将JSON负载一次性写入调用者提供的缓冲区 (通常就是AT处理器的DMA发送缓冲区)。
+ *      - 写入时即完成 `AT+HMPUB` 所需的引号/反斜杠转义，无需再做一次转义拷贝。
+ *      - 边写边统计未转义JSON的"逻辑长度"，即 `AT+HMPUB` 的长度参数。
+ *      - 自动处理对象/数组内的逗号分隔，调用者只需按顺序写入键和值。
+ *      - 不使用 malloc，也不使用浮点 printf，栈占用只有一个 `JsonWriter_t`。
+ *
+ * @par 使用说明:
+ *      缓冲区空间不足时，写入器进入"溢出"状态并忽略后续所有写入，
+ *      最后调用 `JsonWriter_IsOk()` 统一检查即可，无需逐次判断返回值。
+ *
+ * @par V1.1 (2025-07-20)
+ *      - 新增 `JsonWriter_InitRaw`：输出不做AT转义的原始JSON，用于模组数据模式发布 (负载不嵌入命令行)。
+ */
+
+#ifndef __IOT_JSON_WRITER_H
+#define __IOT_JSON_WRITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define JSON_WRITER_MAX_DEPTH 16 ///< 支持的最大嵌套深度
+
+/**
+ * @brief 流式JSON写入器上下文
+ * @note  所有成员由 JsonWriter_* 函数维护，调用者只读即可。
+ */
+typedef struct {
+    char*    buf;           ///< 输出缓冲区 (写入的是AT转义后的字节)
+    uint16_t size;          ///< 输出缓冲区的可用大小
+    uint16_t pos;           ///< 已写入的字节数 (转义后)
+    uint16_t logical_len;   ///< 未转义JSON的长度 (AT+HMPUB 的长度参数)
+    uint8_t  depth;         ///< 当前嵌套深度
+    bool     overflow;      ///< 缓冲区溢出或嵌套错误标记
+    bool     after_key;     ///< 刚写完一个键，下一个值前不需要逗号
+    uint16_t has_items;     ///< 位图: bit d 表示第 d 层容器中已经有元素
+    bool     raw;           ///< 输出原始JSON (不做AT转义，pos 与 logical_len 相等)
+} JsonWriter_t;
+
+/**
+ * @brief 初始化写入器
+ * @param w    写入器上下文
+ * @param buf  输出缓冲区
+ * @param size 输出缓冲区大小
+ */
+void JsonWriter_Init(JsonWriter_t* w, char* buf, uint16_t size);
+
+/**
+ * @brief 初始化写入器，输出原始JSON (不做AT转义)
+ * @param w    写入器上下文
+ * @param buf  输出缓冲区
+ * @param size 输出缓冲区大小
+ */
+void JsonWriter_InitRaw(JsonWriter_t* w, char* buf, uint16_t size);
+
+void JsonWriter_BeginObject(JsonWriter_t* w);
+void JsonWriter_EndObject(JsonWriter_t* w);
+void JsonWriter_BeginArray(JsonWriter_t* w);
+void JsonWriter_EndArray(JsonWriter_t* w);
+
+/**
+ * @brief 写入对象的键 (之后必须紧跟一个值或容器)
+ */
+void JsonWriter_Key(JsonWriter_t* w, const char* key);
+
+void JsonWriter_String(JsonWriter_t* w, const char* value);
+void JsonWriter_Int(JsonWriter_t* w, int32_t value);
+void JsonWriter_Uint(JsonWriter_t* w, uint32_t value);
+void JsonWriter_Bool(JsonWriter_t* w, bool value);
+
+/**
+ * @brief 以定点小数形式写入一个浮点数
+ * @details 按 `decimals` 位小数四舍五入后输出，并去掉末尾多余的0
+ *          (例如 25.50 -> 25.5, 3.00 -> 3)，与 cJSON 的输出风格保持一致。
+ * @param decimals 保留的小数位数 (0-6)
+ */
+void JsonWriter_Fixed(JsonWriter_t* w, double value, uint8_t decimals);
+
+// --- 常用的 "键 + 值" 组合写法 ---
+void JsonWriter_KeyString(JsonWriter_t* w, const char* key, const char* value);
+void JsonWriter_KeyInt(JsonWriter_t* w, const char* key, int32_t value);
+void JsonWriter_KeyUint(JsonWriter_t* w, const char* key, uint32_t value);
+void JsonWriter_KeyBool(JsonWriter_t* w, const char* key, bool value);
+void JsonWriter_KeyFixed(JsonWriter_t* w, const char* key, double value, uint8_t decimals);
+
+/**
+ * @brief 检查写入是否完整 (未溢出且所有容器均已闭合)
+ */
+bool JsonWriter_IsOk(const JsonWriter_t* w);
+
+#endif /* __IOT_JSON_WRITER_H */
@@ -18,6 +18,10 @@
  *          向`TaskMonitor`模块"签到"（Check-In）。这使得主任务能够监控其健康状况。
  *          即使在没有LoRa信号的情况下，任务也会因信号量超时而被唤醒并执行签到，从而向系统
  *          证明自己并未"卡死"。
+ *
+ *      4.  **样本追踪**: DIO0中断中记下接收完成的时刻。传感器帧带有采样追踪尾部时，用该时刻减去
+ *          估算的空中时间和节点上报的 采集->射频 时长，换算出样本在网关时钟上的采集时刻，
+ *          连同接收时刻一起登记到 `SampleTrace` (见 sample_trace.h)。
  */
 
 #include "lora_app.h"
@@ -25,6 +29,7 @@
 #include "LoRa.h"
 #include "lora_protocol.h"
 #include "device_manager.h"
+#include "sample_trace.h"
 #include <stdio.h>
 #include <string.h>
 #include "../../Middlewares/TaskMonitor/task_monitor.h"
@@ -60,29 +65,62 @@ extern SPI_HandleTypeDef hspi2;
 #define EVT_FLAG_LORA_RX_DONE (1U << 0) // 接收完成标志
 #define EVT_FLAG_LORA_TX_REQ  (1U << 1) // 发送请求标志
 
+// 传感器节点的下行暂存
+#define LORA_DOWNLINK_SLOTS       2  // 同时有待发下行的节点数
+#define LORA_DOWNLINK_MAX_PAYLOAD 24 // 每个节点暂存的载荷上限
+#define LORA_DOWNLINK_MAX_ITEMS   (LORA_DOWNLINK_MAX_PAYLOAD / SENSOR_CONFIG_ITEM_SIZE)
+#define LORA_DOWNLINK_REPEAT      3  // 配置类的配置项随节点的上报重复发送的次数
+
 // 发送请求消息结构体
 typedef struct {
     uint8_t buffer[LORA_MAX_PAYLOAD_SIZE];
     uint8_t length;
 } lora_tx_request_t;
 
+// 等待节点上报后发出的下行配置
+typedef struct {
+    uint8_t node_addr;
+    uint8_t length;    // 0 表示空闲
+    uint8_t payload[LORA_DOWNLINK_MAX_PAYLOAD];
+    uint8_t repeat[LORA_DOWNLINK_MAX_ITEMS]; // 各配置项剩余的发送次数
+} lora_downlink_t;
+
 osThreadId_t s_lora_app_task_handle; 
 static osMutexId_t s_lora_access_mutex;       // LoRa 硬件访问互斥锁
 static osEventFlagsId_t s_lora_event_flags;   // 用于唤醒任务的事件标志组
 static osMessageQueueId_t s_lora_tx_queue;    // LoRa 发送消息队列
 
 static LoRa s_lora_handle; // LoRa 驱动句柄
+static volatile uint32_t s_rx_done_tick; // 最近一次接收完成中断的时刻 (系统节拍)
 
 // LoRa 数据接收缓冲区
 static uint8_t s_lora_rx_buffer[LORA_MAX_RAW_PACKET];
 
+// 传感器节点的下行暂存 (由 s_lora_access_mutex 保护)
+static lora_downlink_t s_downlinks[LORA_DOWNLINK_SLOTS];
+static uint8_t s_downlink_seq;
+
+// 传感器节点最近一次完整上报的序号 (帧头 seq_num)，用于核对心跳和发现丢失的上报 (只在 LoRa 任务中访问)
+static struct {
+    uint8_t  node_addr;
+    uint8_t  report_seq;
+    bool     valid;
+} s_report_seqs[MAX_MANAGED_DEVICES];
+
 // ============================================================================
 // Private Function Prototypes
 // ============================================================================
 
 static void LoRa_APP_Task(void *argument);
-static void process_received_packet(uint8_t *data, uint8_t len);
+static void process_received_packet(uint8_t *data, uint8_t len, uint32_t rx_tick);
 static bool lora_send_packet(const uint8_t* data, uint8_t len);
+static uint32_t lora_airtime_ms(uint8_t len);
+static void trace_sensor_sample(const lora_parsed_message_t *msg, size_t body_len, uint32_t rx_tick);
+static bool queue_downlink(uint8_t node_addr, const uint8_t *payload, uint8_t len);
+static void send_pending_downlink(uint8_t node_addr);
+static void record_report_seq(uint8_t node_addr, uint8_t report_seq);
+static void check_heartbeat(const lora_parsed_message_t *msg);
+static void receive_backfill(const lora_parsed_message_t *msg);
 
 // ============================================================================
 // Public Function Implementations
@@ -147,6 +185,25 @@ bool LoRa_APP_Send(const uint8_t *data, uint8_t len)
     return true;
 }
 
+/**
+ * @brief 为一个传感器节点登记一条下行配置
+ */
+bool LoRa_APP_QueueDownlink(uint8_t node_addr, const uint8_t *payload, uint8_t len)
+{
+    if (payload == NULL || len == 0 || len > LORA_DOWNLINK_MAX_PAYLOAD || len % SENSOR_CONFIG_ITEM_SIZE != 0) {
+        return false;
+    }
+    if (osMutexAcquire(s_lora_access_mutex, 1000) != osOK) {
+        return false;
+    }
+
+    bool ok = queue_downlink(node_addr, payload, len);
+
+    osMutexRelease(s_lora_access_mutex);
+    printf("[LoRa] Downlink for 0x%02X %s (%u bytes).\r\n", node_addr, ok ? "queued" : "rejected", len);
+    return ok;
+}
+
 /**
  * @brief 初始化 LoRa 应用层 OS 对象
  */
@@ -208,6 +265,9 @@ void LoRa_DIO0_ISR(uint16_t GPIO_Pin)
         // 在ISR中调用 printf 是非重入和不安全的，可能导致死锁，是导致系统重启的根源。
         // printf("[LoRa-DBG] ISR: DIO0 Triggered!\r\n");
         
+        // 记下接收完成的时刻，用于样本的端到端时延追踪
+        s_rx_done_tick = osKernelGetTickCount();
+
         // 设置接收完成标志位，唤醒 LoRa 任务进行数据处理
         // 此函数在中断上下文中是安全的
         osEventFlagsSet(s_lora_event_flags, EVT_FLAG_LORA_RX_DONE);
@@ -286,7 +346,7 @@ static void LoRa_APP_Task(void *argument)
                         printf("\r\n");
                         // ------------------------------------
 
-                        process_received_packet(s_lora_rx_buffer, received_len);
+                        process_received_packet(s_lora_rx_buffer, received_len, s_rx_done_tick);
                     }
                 }
 
@@ -336,8 +396,9 @@ static bool lora_send_packet(const uint8_t* data, uint8_t len)
  * @brief 处理接收到的完整 LoRa 数据包
  * @param data 指向原始数据包的指针
  * @param len 数据包的长度
+ * @param rx_tick 接收完成中断的时刻
  */
-static void process_received_packet(uint8_t *data, uint8_t len)
+static void process_received_packet(uint8_t *data, uint8_t len, uint32_t rx_tick)
 {
     lora_parsed_message_t parsed_msg;
     
@@ -364,18 +425,24 @@ static void process_received_packet(uint8_t *data, uint8_t len)
                 if (device_info.device_type == DEVICE_TYPE_INTERNAL_SENSOR)
                 {
                     InternalSensorProperties_t sensor_data;
-                    if (lora_model_parse_sensor_data_internal(&parsed_msg, &sensor_data)) {
-                       DeviceManager_UpdateInternalSensorData(parsed_msg.sender_addr, &sensor_data);
+                    if (lora_model_parse_sensor_data_internal(&parsed_msg, &sensor_data) &&
+                        DeviceManager_UpdateInternalSensorData(parsed_msg.sender_addr, &sensor_data)) {
+                        record_report_seq(parsed_msg.sender_addr, parsed_msg.seq_num);
+                        trace_sensor_sample(&parsed_msg, sizeof(sensor_internal_data_payload_t), rx_tick);
                     }
                 }
                 else if (device_info.device_type == DEVICE_TYPE_EXTERNAL_SENSOR)
                 {
                     ExternalSensorProperties_t sensor_data;
-                    if (lora_model_parse_sensor_data_external(&parsed_msg, &sensor_data)) {
-                        DeviceManager_UpdateExternalSensorData(parsed_msg.sender_addr, &sensor_data);
+                    if (lora_model_parse_sensor_data_external(&parsed_msg, &sensor_data) &&
+                        DeviceManager_UpdateExternalSensorData(parsed_msg.sender_addr, &sensor_data)) {
+                        trace_sensor_sample(&parsed_msg, sizeof(sensor_external_data_payload_t), rx_tick);
                     }
                 }
             }
+
+            // 节点在上报后短暂收听，此时发出暂存的下行
+            send_pending_downlink(parsed_msg.sender_addr);
             break;
         }
 
@@ -390,8 +457,15 @@ static void process_received_packet(uint8_t *data, uint8_t len)
 
         case MSG_TYPE_HEARTBEAT:
         {
-            // 收到心跳包，可以调用一个函数来更新节点的 is_online 状态和 last_seen_ts
-            // 例如: DeviceManager_UpdateHeartbeat(parsed_msg.sender_addr);
+            // 心跳表示节点的读数与其最近一次完整上报相同；节点同样在心跳后短暂收听
+            check_heartbeat(&parsed_msg);
+            send_pending_downlink(parsed_msg.sender_addr);
+            break;
+        }
+
+        case MSG_TYPE_REPORT_LOG:
+        {
+            receive_backfill(&parsed_msg);
             break;
         }
 
@@ -399,4 +473,231 @@ static void process_received_packet(uint8_t *data, uint8_t len)
             // 未知消息类型，忽略
             break;
     }
-} 
\ No newline at end of file
+} 
+
+/**
+ * @brief 配置项随节点的上报发送的次数
+ * @details 设置采样间隔是幂等的 (节点对相同的配置不做处理)，重复发送以防丢失；
+ *          补发和完整上报是一次性的请求，重复发送会让节点从头再做一遍，因此只发送一次，
+ *          丢失时由下一次心跳核对 (或云端再次下发命令) 重新请求。
+ */
+static uint8_t downlink_item_repeat(uint8_t item)
+{
+    switch (item) {
+        case SENSOR_CONFIG_REQUEST_REPORT:
+        case SENSOR_CONFIG_BACKFILL_FROM_MIN:
+        case SENSOR_CONFIG_BACKFILL_TO_MIN:
+            return 1;
+        default:
+            return LORA_DOWNLINK_REPEAT;
+    }
+}
+
+/**
+ * @brief 为节点登记一条下行配置，优先追加到该节点已有的暂存，其次使用空闲位置
+ * @details 每个配置项的发送次数由 downlink_item_repeat() 决定，与同一帧中的其他配置项无关。
+ * @note **调用此函数前必须已获取 `s_lora_access_mutex`**
+ * @param len 载荷长度，SENSOR_CONFIG_ITEM_SIZE 的整数倍
+ * @return true 已登记; false 没有空闲位置或暂存已满
+ */
+static bool queue_downlink(uint8_t node_addr, const uint8_t *payload, uint8_t len)
+{
+    lora_downlink_t *slot = NULL;
+    for (uint8_t i = 0; i < LORA_DOWNLINK_SLOTS; i++) {
+        if (s_downlinks[i].length != 0 && s_downlinks[i].node_addr == node_addr) {
+            slot = &s_downlinks[i];
+            break;
+        }
+        if (s_downlinks[i].length == 0 && slot == NULL) {
+            slot = &s_downlinks[i];
+        }
+    }
+
+    if (slot == NULL) {
+        return false;
+    }
+    if (slot->length == 0 || slot->node_addr != node_addr) {
+        slot->node_addr = node_addr;
+        slot->length = 0;
+    }
+    if (slot->length + len > LORA_DOWNLINK_MAX_PAYLOAD) {
+        return false;
+    }
+
+    for (uint8_t pos = 0; pos < len; pos += SENSOR_CONFIG_ITEM_SIZE) {
+        slot->repeat[(slot->length + pos) / SENSOR_CONFIG_ITEM_SIZE] = downlink_item_repeat(payload[pos]);
+    }
+    memcpy(&slot->payload[slot->length], payload, len);
+    slot->length += len;
+    return true;
+}
+
+/**
+ * @brief 记录传感器节点最近一次完整上报的序号
+ * @details 序号不连续说明中间的上报丢失了，只打印出来：补发的历史样本还不能上传到云端 (见 receive_backfill)，
+ *          自动请求补发只会白白占用节点的射频时间。
+ * @note **调用此函数前必须已获取 `s_lora_access_mutex`**
+ * @param node_addr 节点地址
+ * @param report_seq 完整上报的帧头 seq_num
+ */
+static void record_report_seq(uint8_t node_addr, uint8_t report_seq)
+{
+    for (uint8_t i = 0; i < MAX_MANAGED_DEVICES; i++) {
+        if (!s_report_seqs[i].valid || s_report_seqs[i].node_addr == node_addr) {
+            if (s_report_seqs[i].valid && report_seq != (uint8_t)(s_report_seqs[i].report_seq + 1U)) {
+                printf("[LoRa] Reports #%u-#%u of 0x%02X lost.\r\n", (uint8_t)(s_report_seqs[i].report_seq + 1U),
+                       (uint8_t)(report_seq - 1U), node_addr);
+            }
+            s_report_seqs[i].node_addr = node_addr;
+            s_report_seqs[i].report_seq = report_seq;
+            s_report_seqs[i].valid = true;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 核对传感器节点的心跳
+ * @details 心跳带有节点最近一次完整上报的序号。网关没有这次上报时 (上报丢失，或网关重启后还没有数据)，
+ *          登记一条 SENSOR_CONFIG_REQUEST_REPORT 下行，请节点在下一个周期发送完整数据。
+ *          该下行只发送一次：丢失时下一次心跳会再次发现不一致。
+ * @note **调用此函数前必须已获取 `s_lora_access_mutex`**
+ * @param msg 已解析的心跳帧
+ */
+static void check_heartbeat(const lora_parsed_message_t *msg)
+{
+    bool has_data = DeviceManager_UpdateHeartbeat(msg->sender_addr);
+
+    sensor_heartbeat_payload_t heartbeat;
+    if (msg->payload_len < sizeof(heartbeat)) {
+        return; // 不带载荷的心跳只刷新在线状态
+    }
+    memcpy(&heartbeat, msg->payload, sizeof(heartbeat));
+
+    bool current = false;
+    for (uint8_t i = 0; i < MAX_MANAGED_DEVICES && s_report_seqs[i].valid; i++) {
+        if (s_report_seqs[i].node_addr == msg->sender_addr) {
+            current = (s_report_seqs[i].report_seq == heartbeat.report_seq);
+            if (!current) {
+                // 缺失的上报已由下面的 REQUEST_REPORT 请求，之后的完整上报 (序号 report_seq + 1) 不再视为丢失
+                s_report_seqs[i].report_seq = heartbeat.report_seq;
+            }
+            break;
+        }
+    }
+
+    if (!has_data || !current) {
+        const uint8_t request[SENSOR_CONFIG_ITEM_SIZE] = {SENSOR_CONFIG_REQUEST_REPORT, 0, 0};
+        bool ok = queue_downlink(msg->sender_addr, request, sizeof(request));
+        printf("[LoRa] Report #%u of 0x%02X missing, %s.\r\n", heartbeat.report_seq, msg->sender_addr,
+               ok ? "requesting it" : "request rejected");
+    }
+}
+
+/**
+ * @brief 处理传感器节点补发的历史样本
+ * @details 样本的采集时刻 = 接收时刻 - age_s。设备属性只保存最新值，历史样本不写入 DeviceManager。
+ *          网关没有与云端同步的时钟，还不能给历史样本带上 event_time 上传，目前只打印收到的时间段；
+ *          因此网关不会自动请求补发，补发只由云端的 requestBackfill 命令触发。
+ * @param msg 已解析的补发帧 (MSG_TYPE_REPORT_LOG)
+ */
+static void receive_backfill(const lora_parsed_message_t *msg)
+{
+    uint8_t count = msg->payload_len / sizeof(sensor_log_record_t);
+    if (count == 0) {
+        return;
+    }
+
+    sensor_log_record_t first;
+    sensor_log_record_t last;
+    memcpy(&first, msg->payload, sizeof(first));
+    memcpy(&last, &msg->payload[(count - 1U) * sizeof(sensor_log_record_t)], sizeof(last));
+    printf("[LoRa] Backfill from 0x%02X: %u samples, %lu-%lu s old.\r\n", msg->sender_addr, count,
+           (unsigned long)last.age_s, (unsigned long)first.age_s);
+}
+
+/**
+ * @brief 向刚上报的传感器节点发出暂存的下行配置 (如果有)
+ * @details 发出后各配置项的剩余次数减一，已发完的配置项从暂存中移除。
+ * @note **调用此函数前必须已获取 `s_lora_access_mutex`**
+ * @param node_addr 刚上报的节点地址
+ */
+static void send_pending_downlink(uint8_t node_addr)
+{
+    for (uint8_t i = 0; i < LORA_DOWNLINK_SLOTS; i++) {
+        lora_downlink_t *slot = &s_downlinks[i];
+        if (slot->length == 0 || slot->node_addr != node_addr) {
+            continue;
+        }
+
+        uint8_t frame[LORA_HEADER_SIZE + LORA_DOWNLINK_MAX_PAYLOAD + LORA_CHECKSUM_SIZE];
+        int frame_len = generate_lora_frame(node_addr, LORA_HOST_ADDRESS, MSG_TYPE_CMD_SET_CONFIG, s_downlink_seq++,
+                                            slot->payload, slot->length, frame, sizeof(frame));
+
+        uint8_t kept = 0;
+        for (uint8_t pos = 0; pos < slot->length; pos += SENSOR_CONFIG_ITEM_SIZE) {
+            uint8_t item = pos / SENSOR_CONFIG_ITEM_SIZE;
+            if (--slot->repeat[item] != 0) {
+                memmove(&slot->payload[kept], &slot->payload[pos], SENSOR_CONFIG_ITEM_SIZE);
+                slot->repeat[kept / SENSOR_CONFIG_ITEM_SIZE] = slot->repeat[item];
+                kept += SENSOR_CONFIG_ITEM_SIZE;
+            }
+        }
+        slot->length = kept;
+
+        if (frame_len > 0) {
+            lora_send_packet(frame, (uint8_t)frame_len);
+            printf("[LoRa] Downlink sent to 0x%02X (%u items left).\r\n", node_addr,
+                   (unsigned)(kept / SENSOR_CONFIG_ITEM_SIZE));
+        }
+        return;
+    }
+}
+
+/**
+ * @brief 登记一个已写入 DeviceManager 的传感器样本
+ * @details 帧中带有追踪尾部时，采集时刻 = 接收完成时刻 - 空中时间 - 节点测得的 采集->射频 时长。
+ * @param msg 已解析的传感器数据帧
+ * @param body_len 传感器载荷结构体的长度
+ * @param rx_tick 接收完成中断的时刻
+ */
+static void trace_sensor_sample(const lora_parsed_message_t *msg, size_t body_len, uint32_t rx_tick)
+{
+    lora_trace_trailer_t trailer;
+    if (lora_model_parse_trace_trailer(msg, body_len, &trailer) && trailer.trace_id != 0) {
+        uint8_t frame_len = (uint8_t)(LORA_HEADER_SIZE + msg->payload_len + LORA_CHECKSUM_SIZE);
+        uint32_t acq_tick = rx_tick - lora_airtime_ms(frame_len) - trailer.acq_age_ms;
+        SampleTrace_OnSample(msg->sender_addr, trailer.trace_id, trailer.acq_age_ms, acq_tick, rx_tick);
+    } else {
+        SampleTrace_OnSample(msg->sender_addr, 0, 0, rx_tick, rx_tick);
+    }
+}
+
+/**
+ * @brief 按当前的射频参数估算一个数据包的空中时间 (Semtech SX127x 数据手册的公式)
+ * @details 显式报头、CRC开启 (与 LoRa_init 的配置一致)；符号时长超过16ms时驱动会开启低速率优化。
+ * @param len 数据包的字节数
+ * @return uint32_t 空中时间 (毫秒，向上取整)
+ */
+static uint32_t lora_airtime_ms(uint8_t len)
+{
+    static const uint32_t bw_hz[] = {7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000};
+
+    uint32_t sf = s_lora_handle.spredingFactor;
+    uint32_t bw = (s_lora_handle.bandWidth < sizeof(bw_hz) / sizeof(bw_hz[0])) ? bw_hz[s_lora_handle.bandWidth] : 125000;
+    uint32_t cr = s_lora_handle.crcRate;                          // 1..4 对应 4/5..4/8
+    uint32_t symbol_us = (uint32_t)(((uint64_t)1000000U << sf) / bw);
+    uint32_t de = (symbol_us > 16000U) ? 1U : 0U;
+
+    // 负载符号数 = 8 + max(ceil((8*PL - 4*SF + 28 + 16*CRC - 20*IH) / (4*(SF - 2*DE))) * (CR + 4), 0)
+    int32_t numerator = 8 * (int32_t)len - 4 * (int32_t)sf + 28 + 16;
+    int32_t denominator = 4 * ((int32_t)sf - 2 * (int32_t)de);
+    uint32_t payload_symbols = 8;
+    if (numerator > 0) {
+        payload_symbols += (uint32_t)((numerator + denominator - 1) / denominator) * (cr + 4U);
+    }
+
+    // 前导码时长 = (前导码长度 + 4.25) 个符号，这里以四分之一符号为单位计算
+    uint32_t quarter_symbols = (s_lora_handle.preamble + payload_symbols) * 4U + 17U;
+    return (uint32_t)(((uint64_t)quarter_symbols * symbol_us / 4U + 999U) / 1000U);
+}
@@ -54,6 +54,24 @@ void LoRa_APP_Init(void);
  */
 bool LoRa_APP_Send(const uint8_t *data, uint8_t len);
 
+/**
+ * @brief 为一个传感器节点登记一条下行配置 (MSG_TYPE_CMD_SET_CONFIG)
+ * @details
+ *  - 传感器节点大部分时间在休眠，只在每次上报 (或心跳) 后的短暂接收窗口内收听，
+ *    因此载荷先暂存，收到该节点的上报或心跳后立即发出。
+ *  - 节点不回复确认。采样间隔等配置会在该节点之后的 LORA_DOWNLINK_REPEAT 次上报后各发一次
+ *    (节点对相同的配置不做处理)；REQUEST_REPORT、BACKFILL_xxx 等一次性请求只发送一次。
+ *  - 同一节点在发出前的多次登记依次拼接在同一帧中，节点按顺序应用。
+ * @param node_addr 目标节点的LoRa地址
+ * @param payload   配置载荷 (格式见 lora_protocol.h 中的 SENSOR_CONFIG_xxx)
+ * @param len       载荷长度 (SENSOR_CONFIG_ITEM_SIZE 的整数倍)
+ * @return bool
+ *         - true: 登记成功
+ *         - false: 参数错误、没有空闲的暂存位置或暂存空间不足
+ * @note 此函数是线程安全的，但不能在中断中调用。
+ */
+bool LoRa_APP_QueueDownlink(uint8_t node_addr, const uint8_t *payload, uint8_t len);
+
 /**
  * @brief LoRa DIO0 引脚的外部中断服务函数 (EXTI ISR)
  * @details
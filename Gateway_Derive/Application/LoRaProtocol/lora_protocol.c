@@ -351,8 +351,9 @@ bool lora_model_parse_sensor_data_internal(const lora_parsed_message_t *parsed_m
         return false;
     }
 
-    // 3. 检查载荷长度是否与定义的传输结构体完全匹配
-    if (parsed_msg->payload_len != sizeof(sensor_internal_data_payload_t))
+    // 3. 检查载荷长度是否与定义的传输结构体匹配 (允许其后带有采样追踪尾部)
+    if (parsed_msg->payload_len != sizeof(sensor_internal_data_payload_t) &&
+        parsed_msg->payload_len != sizeof(sensor_internal_data_payload_t) + sizeof(lora_trace_trailer_t))
     {
         return false;
     }
@@ -411,6 +412,34 @@ bool lora_model_parse_sensor_data_internal(const lora_parsed_message_t *parsed_m
     return true; // 解析成功
 }
 
+/**
+ * @brief 从传感器数据帧中提取可选的采样追踪尾部
+ *
+ * @param parsed_msg 指向已解析的消息结构体 (输入)
+ * @param body_len 数据帧中传感器载荷结构体的长度 (尾部紧随其后)
+ * @param trailer 指向用于存储追踪尾部的结构体 (输出)
+ * @return bool 帧中带有追踪尾部时返回 true；否则返回 false，trailer 被清零
+ */
+bool lora_model_parse_trace_trailer(const lora_parsed_message_t *parsed_msg, size_t body_len,
+                                    lora_trace_trailer_t *trailer)
+{
+    if (trailer == NULL)
+    {
+        return false;
+    }
+    memset(trailer, 0, sizeof(lora_trace_trailer_t));
+
+    if (parsed_msg == NULL || parsed_msg->payload_len != body_len + sizeof(lora_trace_trailer_t))
+    {
+        return false;
+    }
+
+    const uint8_t *p = parsed_msg->payload + body_len;
+    trailer->trace_id = lora_model_unpack_u16le(p);
+    trailer->acq_age_ms = lora_model_unpack_u32le(p + 2);
+    return true;
+}
+
 /**
  * @brief 从已解析的消息中提取传感器数据并转换为应用层结构体 (ExternalSensorProperties_t)
  *
@@ -433,8 +462,9 @@ bool lora_model_parse_sensor_data_external(const lora_parsed_message_t *parsed_m
         return false;
     }
 
-    // 3. 检查载荷长度是否与定义的传输结构体完全匹配
-    if (parsed_msg->payload_len != sizeof(sensor_external_data_payload_t))
+    // 3. 检查载荷长度是否与定义的传输结构体匹配 (允许其后带有采样追踪尾部)
+    if (parsed_msg->payload_len != sizeof(sensor_external_data_payload_t) &&
+        parsed_msg->payload_len != sizeof(sensor_external_data_payload_t) + sizeof(lora_trace_trailer_t))
     {
         return false;
     }
@@ -0,0 +1,232 @@
+/**
+ * @file      sample_trace.c
+ * @author    Your Name
+ * @brief     传感器样本的端到端时延追踪
+ *
+ * @par 内部实现机制:
+ *      - 每个设备一个槽位，保存累计统计和最新的待上报样本。槽位在设备第一次上报时按LoRa ID分配。
+ *      - 样本由LoRa任务登记、由上行任务取出、由AT接收任务 (发布结果回调) 确认，全部由一个互斥锁保护。
+ *      - 待上报样本以 (trace_id, update_tick) 识别：确认的副本与槽位中的样本不一致时，
+ *        说明等待确认期间已有新样本到达，只记录时延，不清除新样本。
+ */
+
+#include "sample_trace.h"
+#include "cmsis_os2.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+typedef struct {
+    SampleTrace_DeviceStats_t stats;
+    SampleTrace_t pending; ///< 最新的待上报样本
+    bool has_pending;      ///< pending 是否有效
+    bool taken;            ///< pending 是否已被某一轮上报取走 (取走后被覆盖不算 superseded)
+} trace_slot_t;
+
+/* Private variables ---------------------------------------------------------*/
+
+static osMutexId_t s_trace_mutex = NULL;
+static trace_slot_t s_slots[SAMPLE_TRACE_MAX_DEVICES];
+static uint8_t s_slot_count = 0;
+static uint32_t s_untracked = 0;            // 因槽位已满而未追踪的样本数
+static uint32_t s_report_enqueue_tick = 0;  // 当前这一轮上报的请求投递时刻
+
+static const char *const s_stage_names[SAMPLE_STAGE_COUNT] = {
+    "node", "ingest", "wait", "queue", "publish", "e2e",
+};
+
+/* Private function prototypes -----------------------------------------------*/
+
+static trace_slot_t *find_slot(uint16_t lora_id, bool create);
+static uint32_t elapsed_between(uint32_t from, uint32_t to);
+
+/* Public functions ----------------------------------------------------------*/
+
+void SampleTrace_Init(void)
+{
+    if (s_trace_mutex == NULL) {
+        s_trace_mutex = osMutexNew(NULL);
+    }
+}
+
+void SampleTrace_OnSample(uint16_t lora_id, uint16_t trace_id, uint32_t node_ms,
+                          uint32_t acq_tick, uint32_t rx_tick)
+{
+    if (s_trace_mutex == NULL) {
+        return;
+    }
+    uint32_t now = osKernelGetTickCount();
+
+    osMutexAcquire(s_trace_mutex, osWaitForever);
+    trace_slot_t *slot = find_slot(lora_id, true);
+    if (slot == NULL) {
+        s_untracked++;
+        osMutexRelease(s_trace_mutex);
+        return;
+    }
+
+    if (slot->has_pending && !slot->taken) {
+        slot->stats.superseded++;
+    }
+    slot->stats.samples++;
+    slot->stats.last_trace_id = trace_id;
+
+    SampleTrace_t *t = &slot->pending;
+    memset(t, 0, sizeof(*t));
+    t->lora_id = lora_id;
+    t->trace_id = trace_id;
+    t->node_ms = node_ms;
+    t->acq_tick = acq_tick;
+    t->rx_tick = rx_tick;
+    t->update_tick = now;
+    slot->has_pending = true;
+    slot->taken = false;
+    osMutexRelease(s_trace_mutex);
+}
+
+void SampleTrace_BeginReport(uint32_t enqueue_tick)
+{
+    s_report_enqueue_tick = enqueue_tick;
+}
+
+bool SampleTrace_Take(uint16_t lora_id, SampleTrace_t *out)
+{
+    if (s_trace_mutex == NULL) {
+        return false;
+    }
+
+    bool found = false;
+    osMutexAcquire(s_trace_mutex, osWaitForever);
+    trace_slot_t *slot = find_slot(lora_id, false);
+    if (slot != NULL && slot->has_pending) {
+        *out = slot->pending;
+        // 请求早于样本到达 (样本到达时已有请求在排队) 时，样本没有等待请求的时间
+        out->enqueue_tick = ((int32_t)(s_report_enqueue_tick - out->update_tick) > 0)
+                            ? s_report_enqueue_tick : out->update_tick;
+        out->send_tick = out->enqueue_tick;
+        slot->taken = true;
+        found = true;
+    }
+    osMutexRelease(s_trace_mutex);
+    return found;
+}
+
+void SampleTrace_Complete(const SampleTrace_t *trace)
+{
+    if (s_trace_mutex == NULL) {
+        return;
+    }
+    uint32_t ack = osKernelGetTickCount();
+
+    osMutexAcquire(s_trace_mutex, osWaitForever);
+    trace_slot_t *slot = find_slot(trace->lora_id, false);
+    if (slot != NULL) {
+        LatencyHist_t *stage = slot->stats.stage;
+        if (trace->trace_id != 0) {
+            LatencyHist_Add(&stage[SAMPLE_STAGE_NODE], trace->node_ms);
+            LatencyHist_Add(&stage[SAMPLE_STAGE_E2E], elapsed_between(trace->acq_tick, ack));
+        }
+        LatencyHist_Add(&stage[SAMPLE_STAGE_INGEST], elapsed_between(trace->rx_tick, trace->update_tick));
+        LatencyHist_Add(&stage[SAMPLE_STAGE_WAIT], elapsed_between(trace->update_tick, trace->enqueue_tick));
+        LatencyHist_Add(&stage[SAMPLE_STAGE_QUEUE], elapsed_between(trace->enqueue_tick, trace->send_tick));
+        LatencyHist_Add(&stage[SAMPLE_STAGE_PUBLISH], elapsed_between(trace->send_tick, ack));
+        slot->stats.completed++;
+
+        if (slot->has_pending &&
+            slot->pending.trace_id == trace->trace_id &&
+            slot->pending.update_tick == trace->update_tick) {
+            slot->has_pending = false;
+        }
+    }
+    osMutexRelease(s_trace_mutex);
+}
+
+uint8_t SampleTrace_GetDeviceCount(void)
+{
+    return s_slot_count;
+}
+
+bool SampleTrace_GetDevice(uint8_t index, SampleTrace_DeviceStats_t *out)
+{
+    if (s_trace_mutex == NULL) {
+        return false;
+    }
+
+    bool found = false;
+    osMutexAcquire(s_trace_mutex, osWaitForever);
+    if (index < s_slot_count) {
+        *out = s_slots[index].stats;
+        found = true;
+    }
+    osMutexRelease(s_trace_mutex);
+    return found;
+}
+
+const char *SampleTrace_StageName(SampleTrace_Stage_t stage)
+{
+    return (stage < SAMPLE_STAGE_COUNT) ? s_stage_names[stage] : "?";
+}
+
+/**
+ * @brief 打印时延统计
+ * @details 逐个设备取快照后再打印 (单个快照约0.4KB，放在静态区，不占监控任务的栈)。
+ */
+void SampleTrace_Dump(void)
+{
+    static SampleTrace_DeviceStats_t stats;
+
+    for (uint8_t i = 0; SampleTrace_GetDevice(i, &stats); i++) {
+        printf("[Trace] node 0x%02X: %lu sample(s), %lu acked, %lu superseded, last id %u\r\n",
+               stats.lora_id, (unsigned long)stats.samples, (unsigned long)stats.completed,
+               (unsigned long)stats.superseded, stats.last_trace_id);
+        printf("[Trace]   %-8s %6s %6s %6s %6s %6s\r\n", "stage", "n", "avg", "p50", "p95", "max");
+        for (uint8_t s = 0; s < SAMPLE_STAGE_COUNT; s++) {
+            const LatencyHist_t *hist = &stats.stage[s];
+            if (hist->count == 0) {
+                continue;
+            }
+            printf("[Trace]   %-8s %6lu %6lu %6lu %6lu %6lu\r\n",
+                   s_stage_names[s], (unsigned long)hist->count,
+                   (unsigned long)LatencyHist_Mean(hist),
+                   (unsigned long)LatencyHist_Percentile(hist, 50),
+                   (unsigned long)LatencyHist_Percentile(hist, 95),
+                   (unsigned long)hist->max_ms);
+        }
+    }
+    if (s_untracked > 0) {
+        printf("[Trace] %lu sample(s) untracked (more than %d devices).\r\n",
+               (unsigned long)s_untracked, SAMPLE_TRACE_MAX_DEVICES);
+    }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief [内部] 按LoRa ID查找设备槽位，必要时分配一个新槽位 (调用前须持有锁)
+ */
+static trace_slot_t *find_slot(uint16_t lora_id, bool create)
+{
+    for (uint8_t i = 0; i < s_slot_count; i++) {
+        if (s_slots[i].stats.lora_id == lora_id) {
+            return &s_slots[i];
+        }
+    }
+    if (!create || s_slot_count >= SAMPLE_TRACE_MAX_DEVICES) {
+        return NULL;
+    }
+
+    trace_slot_t *slot = &s_slots[s_slot_count++];
+    memset(slot, 0, sizeof(*slot));
+    slot->stats.lora_id = lora_id;
+    return slot;
+}
+
+/**
+ * @brief [内部] 两个节拍之间的时长；时间戳顺序颠倒 (估算误差) 时记为0
+ */
+static uint32_t elapsed_between(uint32_t from, uint32_t to)
+{
+    int32_t diff = (int32_t)(to - from);
+    return (diff > 0) ? (uint32_t)diff : 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file      sample_trace.h
+ * @author    Your Name
+ * @brief     传感器样本的端到端时延追踪 - 头文件
+ * @version   1.0
+ * @date      2025-07-24
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @par 模块功能:
+ *      跟踪每个传感器样本从节点开始采集到云端确认 ("+HMPUB OK") 的全过程，按设备、按阶段累计时延直方图，
+ *      用于回答"云端看到的数据有多旧、时间花在了哪一段"。
+ *
+ * @par 时间戳来源:
+ *      节点在传感器数据帧末尾附加追踪尾部 (见 lora_protocol.h 的 `lora_trace_trailer_t`)：
+ *      采样序号，以及从开始采集到交给射频发送所经过的时长 (节点本地时钟)。节点与网关没有共同的时钟，
+ *      网关用 "DIO0接收完成时刻 - 估算的空中时间 - 节点上报的时长" 换算出采集开始时刻。
+ *      网关侧的时刻均为系统节拍 (ms)：
+ *      - rx:      DIO0 接收完成中断
+ *      - update:  样本写入 DeviceManager
+ *      - enqueue: 覆盖该样本的上报请求投递到上行队列 (样本晚于请求到达时取样本到达时刻)
+ *      - send:    包含该样本的 AT+HMPUB 交给AT层发送
+ *      - ack:     发布结果回调收到 "+HMPUB OK"
+ *
+ * @par 阶段划分:
+ *      NODE (采集→射频, 节点测得) | INGEST (rx→update) | WAIT (update→enqueue) |
+ *      QUEUE (enqueue→send) | PUBLISH (send→ack) | E2E (采集→ack, 含空中时间)
+ *      不带追踪尾部的旧固件帧照常处理，只是没有 NODE 和 E2E 两个阶段。
+ *
+ * @par 样本的归属:
+ *      每个设备只保留最新的一个待上报样本。上报前被新样本覆盖的样本计入 superseded，不进入直方图；
+ *      发布失败的样本保持待上报状态，下一轮重发成功后，其时延包含重试耗费的时间。
+ */
+
+#ifndef __SAMPLE_TRACE_H
+#define __SAMPLE_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "latency_hist.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// --- Public Configuration ---
+
+#define SAMPLE_TRACE_MAX_DEVICES  4  // 追踪的设备数上限 (超出的设备只计入 untracked)
+
+// --- Public Types ---
+
+/**
+ * @brief 时延阶段
+ */
+typedef enum {
+    SAMPLE_STAGE_NODE,    ///< 节点: 开始采集 -> 交给射频发送
+    SAMPLE_STAGE_INGEST,  ///< 网关: 接收完成 -> 写入 DeviceManager
+    SAMPLE_STAGE_WAIT,    ///< 网关: 写入 DeviceManager -> 上报请求投递
+    SAMPLE_STAGE_QUEUE,   ///< 网关: 上报请求投递 -> AT+HMPUB 发送
+    SAMPLE_STAGE_PUBLISH, ///< 模组/云端: AT+HMPUB 发送 -> "+HMPUB OK"
+    SAMPLE_STAGE_E2E,     ///< 端到端: 开始采集 -> "+HMPUB OK"
+    SAMPLE_STAGE_COUNT
+} SampleTrace_Stage_t;
+
+/**
+ * @brief 一个样本沿途的时间戳 (系统节拍)
+ */
+typedef struct {
+    uint16_t lora_id;      ///< 设备的LoRa ID
+    uint16_t trace_id;     ///< 节点的采样序号；0 表示未追踪 (帧中没有追踪尾部)
+    uint32_t node_ms;      ///< 节点测得的 采集->射频 时长
+    uint32_t acq_tick;     ///< 换算到网关时钟的采集开始时刻
+    uint32_t rx_tick;      ///< 接收完成时刻
+    uint32_t update_tick;  ///< 写入 DeviceManager 的时刻
+    uint32_t enqueue_tick; ///< 上报请求投递的时刻 (由 `SampleTrace_Take` 填写)
+    uint32_t send_tick;    ///< AT+HMPUB 发送的时刻 (由上报流程填写)
+} SampleTrace_t;
+
+/**
+ * @brief 一个设备的累计时延统计
+ */
+typedef struct {
+    uint16_t lora_id;                           ///< 设备的LoRa ID
+    uint16_t last_trace_id;                     ///< 最近收到的采样序号
+    uint32_t samples;                           ///< 收到的样本数
+    uint32_t completed;                         ///< 得到云端确认的样本数
+    uint32_t superseded;                        ///< 上报前被新样本覆盖的样本数
+    LatencyHist_t stage[SAMPLE_STAGE_COUNT];    ///< 各阶段的时延直方图
+} SampleTrace_DeviceStats_t;
+
+// --- Public Function Prototypes ---
+
+/**
+ * @brief 初始化追踪模块 (创建互斥锁)，由 `App_Main_Init` 调用一次
+ */
+void SampleTrace_Init(void);
+
+/**
+ * @brief 登记一个已写入 DeviceManager 的样本 (LoRa任务调用)
+ * @details 写入时刻取调用时刻。该设备尚未取走的旧样本被覆盖，计入 superseded。
+ * @param lora_id 设备的LoRa ID
+ * @param trace_id 节点的采样序号 (0 表示未追踪)
+ * @param node_ms 节点测得的 采集->射频 时长 (未追踪时忽略)
+ * @param acq_tick 换算到网关时钟的采集开始时刻 (未追踪时忽略)
+ * @param rx_tick 接收完成时刻
+ */
+void SampleTrace_OnSample(uint16_t lora_id, uint16_t trace_id, uint32_t node_ms,
+                          uint32_t acq_tick, uint32_t rx_tick);
+
+/**
+ * @brief 开始一轮网关上报 (上行任务调用)
+ * @param enqueue_tick 本轮上报请求的投递时刻
+ */
+void SampleTrace_BeginReport(uint32_t enqueue_tick);
+
+/**
+ * @brief 取出一个设备待上报样本的时间戳副本 (上报流程把设备写入消息时调用)
+ * @details 副本的 enqueue_tick 取本轮请求的投递时刻与样本写入时刻中较晚的一个。
+ *          取出后样本仍处于待上报状态，直到 `SampleTrace_Complete` 确认。
+ * @param lora_id 设备的LoRa ID
+ * @param out 输出
+ * @return bool 该设备没有待上报样本时返回 false
+ */
+bool SampleTrace_Take(uint16_t lora_id, SampleTrace_t *out);
+
+/**
+ * @brief 样本已得到云端确认 (发布结果回调中调用)
+ * @details 以调用时刻为 ack，按阶段记入直方图；若该设备的待上报样本仍是这一个，则将其清除。
+ * @param trace `SampleTrace_Take` 取出、并已填写 send_tick 的副本
+ */
+void SampleTrace_Complete(const SampleTrace_t *trace);
+
+/**
+ * @brief 当前已追踪的设备数
+ */
+uint8_t SampleTrace_GetDeviceCount(void);
+
+/**
+ * @brief 读取一个设备的统计快照
+ * @param index 设备下标 (0 ~ `SampleTrace_GetDeviceCount()`-1)
+ * @param out 输出
+ * @return bool 下标无效时返回 false
+ */
+bool SampleTrace_GetDevice(uint8_t index, SampleTrace_DeviceStats_t *out);
+
+/**
+ * @brief 阶段的简短名称 (用于打印和云端属性名)
+ */
+const char *SampleTrace_StageName(SampleTrace_Stage_t stage);
+
+/**
+ * @brief 通过调试串口打印各设备、各阶段的时延统计
+ */
+void SampleTrace_Dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SAMPLE_TRACE_H */
@@ -51,6 +51,8 @@
 #if defined(__ICCARM__) || defined(__ARMCC_VERSION) || defined(__GNUC__)
 #include <stdint.h>
 extern uint32_t SystemCoreClock;
+void configureTimerForRunTimeStats(void);
+unsigned long getRunTimeCounterValue(void);
 #endif
 #ifndef CMSIS_device_header
 #define CMSIS_device_header "stm32u5xx.h"
@@ -75,6 +77,8 @@ extern uint32_t SystemCoreClock;
 #define configSTACK_ALLOCATION_FROM_SEPARATE_HEAP 0
 #define configMAX_TASK_NAME_LEN                  ( 16 )
 #define configUSE_TRACE_FACILITY                 1
+#define configGENERATE_RUN_TIME_STATS            1
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS  1
 #define configUSE_16_BIT_TICKS                   0
 #define configUSE_MUTEXES                        1
 #define configQUEUE_REGISTRY_SIZE                8
@@ -163,6 +167,20 @@ header file. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+
+/* 运行时间统计：TIM2 以 1MHz 计数作为时间基准 (见 app_freertos.c) */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS   configureTimerForRunTimeStats
+#define portGET_RUN_TIME_COUNTER_VALUE           getRunTimeCounterValue
+
+/* 上下文切换计数：每个任务的线程局部存储指针 configTLS_INDEX_SWITCH_COUNT 保留给切入次数的计数器
+   (指针值即计数，任务创建时TCB清零)，由 SystemMonitor 通过 pvTaskGetThreadLocalStoragePointer() 读取。
+   新增线程局部存储的用途时须使用其他下标并增大 configNUM_THREAD_LOCAL_STORAGE_POINTERS。 */
+#define configTLS_INDEX_SWITCH_COUNT             0
+#define traceTASK_SWITCHED_IN() \
+    do { \
+        void **ppvSwitchCount = &pxCurrentTCB->pvThreadLocalStoragePointers[configTLS_INDEX_SWITCH_COUNT]; \
+        *ppvSwitchCount = (void *)((uintptr_t)*ppvSwitchCount + 1U); \
+    } while (0)
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
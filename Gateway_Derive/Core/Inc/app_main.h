@@ -36,7 +36,7 @@ extern "C" {
  * @brief  执行应用层的一次性初始化。
  * @details
  *         此函数应在RTOS启动后、主任务循环开始前被调用。
- *         它主要负责设置cJSON库的内存管理钩子，确保其在FreeRTOS环境下正确工作。
+ *         它初始化华为云应用层、设备管理器、任务监控器等模块。
  */
 void App_Main_Init(void);
 
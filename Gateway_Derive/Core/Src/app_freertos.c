@@ -46,7 +46,7 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN Variables */
-
+extern TIM_HandleTypeDef htim2; // 运行时间统计的计数器 (见 configureTimerForRunTimeStats)
 /* USER CODE END Variables */
 /* Definitions for defaultTask */
 osThreadId_t defaultTaskHandle;
@@ -93,10 +93,7 @@ void MX_FREERTOS_Init(void) {
   /* add threads, ... */
 	LoRa_APP_Init();
   
-  if (s_lora_app_task_handle != NULL)
-  {
-      SystemMonitor_Init(defaultTaskHandle, s_lora_app_task_handle);
-  }
+  SystemMonitor_Init();
   /* USER CODE END RTOS_THREADS */
 
   /* USER CODE BEGIN RTOS_EVENTS */
@@ -127,5 +124,26 @@ void StartDefaultTask(void *argument)
 /* Private application code --------------------------------------------------*/
 /* USER CODE BEGIN Application */
 
+/**
+  * @brief  配置运行时间统计的时钟 (由 vTaskStartScheduler 调用)
+  * @note   TIM2 是32位定时器，由 MX_TIM2_Init 以预分频0初始化但没有启动。这里把它改为1MHz计数后启动：
+  *         分辨率1us，远小于1ms的系统节拍，短任务的占用率也能测准；计数约71分钟回绕一次，
+  *         SystemMonitor 按监控周期求差值，回绕不影响结果。TIM2 时钟为 PCLK1 (APB1不分频)。
+  */
+void configureTimerForRunTimeStats(void)
+{
+  __HAL_TIM_SET_PRESCALER(&htim2, (HAL_RCC_GetPCLK1Freq() / 1000000U) - 1U);
+  htim2.Instance->EGR = TIM_EGR_UG; // 立即装载新的预分频值并清零计数
+  HAL_TIM_Base_Start(&htim2);
+}
+
+/**
+  * @brief  读取运行时间计数 (微秒)
+  */
+unsigned long getRunTimeCounterValue(void)
+{
+  return __HAL_TIM_GET_COUNTER(&htim2);
+}
+
 /* USER CODE END Application */
 
@@ -2,11 +2,21 @@
  * @file      app_main.c
  * @author    Your Name
  * @brief     物联网网关应用核心逻辑与状态机
- * @version   3.0
- * @date      2025-06-22
+ * @version   3.2
+ * @date      2025-07-17
  *
  * @copyright Copyright (c) 2025
  *
+ * @par V3.2 (2025-07-17)
+ *      1. [PERF] 快速重连：重连时若模组仍能响应AT，则保留AT处理器，跳过 `AT_DeInit` 和3秒等待，
+ *         由连接脚本复用仍然有效的PDP上下文，只重建MQTT会话。连续失败时才退回完整的重建流程。
+ *      2. [FEATURE] 云连接改由表驱动的AT脚本执行，记录每一步的耗时，并打印从掉线到重新上线的总时间。
+ *
+ * @par V3.1 (2025-07-15)
+ *      1. [REFACTOR] 数据上报移至独立的云端上行任务 (`cloud_uplink`)。运行状态下的监督循环
+ *         只投递上报请求并按绝对时刻严格周期运行，不再被最长15秒的AT命令阻塞，
+ *         看门狗预算与上报耗时彻底解耦。
+ *
  * @par V3.0 (2025-06-22)
  *      1. [BUGFIX] 修复了看门狗(IWDG)在初始化阶段超时导致系统反复重启的致命问题。
  *         通过在 `WAIT_FOR_MODULE` 和 `INITIALIZING` 状态的关键路径中添加手动喂狗
@@ -43,6 +53,9 @@
 #include <string.h>
 #include "stdio.h"
 #include "task_monitor.h"
+#include "cloud_uplink.h"
+#include "sample_trace.h"
+#include "hot_path_bench.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /**
@@ -54,9 +67,15 @@ typedef enum {
     SYS_STATE_WAIT_FOR_MODULE,      ///< 1: 等待模组就绪。此为鲁棒性设计的核心，结合主动轮询(`AT+CPIN?`)与被动监听(`+SIM READY`)，确保模组可用。
     SYS_STATE_INITIALIZING,         ///< 2: 模组已就绪。此状态执行一系列配置，完成网络注册和云平台连接。
     SYS_STATE_RUNNING,              ///< 3: 已成功连接，系统正常运行。此状态下，主要负责周期性地上报数据和监控各任务状态。
-    SYS_STATE_RECONNECTING,         ///< 4: 检测到连接中断。此状态负责清理资源，然后切换回 `SYS_STATE_START` 以尝试重新建立连接。
+    SYS_STATE_RECONNECTING,         ///< 4: 检测到连接中断。模组仍能响应时直接回到 `SYS_STATE_INITIALIZING` (快速重连)，否则清理资源并切换回 `SYS_STATE_START`。
 } SystemState_t;
 
+/* Private define ------------------------------------------------------------*/
+#define APP_SUPERVISOR_PERIOD_MS  2000  ///< 运行状态下监督循环的周期，必须小于看门狗超时 (约4.2s)
+#define UPLINK_DRAIN_TIMEOUT_MS   (CLOUD_UPLINK_INFLIGHT_DEADLINE_MS) ///< 重连前等待进行中上报结束的最长时间
+#define FAST_RECONNECT_MAX_TRIES  2     ///< 连续快速重连失败达到此次数后，退回完整的AT处理器重建流程
+#define TELEMETRY_PERIOD_MS       600000 ///< 网关自身遥测 (AT命令时延统计、任务/堆统计、样本时延统计) 的云端上报周期 (10分钟)
+
 /* Private variables ---------------------------------------------------------*/
 // 外部硬件句柄，由 main.c 初始化并提供
 extern UART_HandleTypeDef huart3;
@@ -68,9 +87,6 @@ extern IWDG_HandleTypeDef hiwdg;
 AT_Handler_t g_at_handle; // 全局句柄，以 'g_' 为前缀
 static volatile SystemState_t g_system_state = SYS_STATE_START; ///< 全局系统状态变量
 
-// --- Private Function Prototypes ---
-static void Cloud_UploadDataTask(void);
-
 // --- URC (主动上报信息) 处理 ---
 
 /**
@@ -123,14 +139,23 @@ static const uint8_t URC_TABLE_SIZE = sizeof(urc_table) / sizeof(urc_table[0]);
  */
 void App_Main_Init(void)
 {
-    // 1. 初始化cJSON钩子
+    // 1. 初始化华为云应用层 (临时内存池、命令表)
     HuaweiIoT_Init();
     
-    // 2. 初始化设备管理器
+    // 2. 初始化设备管理器，以及跟踪其中样本端到端时延的追踪模块
     DeviceManager_Init();
+    SampleTrace_Init();
 
     // 3. 初始化任务监控器
     TaskMonitor_Init();
+
+    // 4. 创建云端上行任务 (初始为暂停状态，连接云平台后再启用)
+    CloudUplink_Init(&g_at_handle);
+
+#if MICRO_BENCH_ENABLE
+    // 5. 热点函数微基准测试 (AT处理器启动之前运行，结果从调试串口输出)
+    HotPathBench_Run();
+#endif
 }
 
 /**
@@ -141,6 +166,11 @@ void App_Main_Init(void)
  */
 void App_Main_Task(void)
 {
+    uint32_t supervisor_tick = 0;      // 监督循环的下一次唤醒时刻 (绝对节拍)
+    uint32_t offline_since_tick = osKernelGetTickCount(); // 本次离线 (或上电) 的起始节拍，0 表示在线
+    uint8_t fast_reconnect_tries = 0;  // 连续快速重连的次数
+    uint32_t telemetry_tick = osKernelGetTickCount(); // 上一次投递网关遥测上报的节拍
+
     // --- 主状态机循环 ---
     for (;;)
     {
@@ -155,7 +185,10 @@ void App_Main_Task(void)
                 while(1) { osDelay(10000); }
             }
             // 步骤2: 注册URC回调
-            AT_RegisterURCCallbacks(&g_at_handle, urc_table, URC_TABLE_SIZE);
+            if (!AT_RegisterURCCallbacks(&g_at_handle, urc_table, URC_TABLE_SIZE)) {
+                printf("[FATAL] URC table registration failed. System Halted.\r\n");
+                while(1) { osDelay(10000); }
+            }
             g_system_state = SYS_STATE_WAIT_FOR_MODULE; // 初始化完成，进入等待模组就绪状态
             break;
 
@@ -231,7 +264,15 @@ void App_Main_Task(void)
             // 步骤4: 通知设备管理器，云平台已在线
             DeviceManager_SetCloudOnlineStatus(true);
 
+            // 步骤5: 启用上行任务
+            CloudUplink_Resume();
+
             // 所有初始化步骤成功，进入正常运行状态
+            supervisor_tick = osKernelGetTickCount();
+            printf("[APP] Online after %lu ms%s.\r\n", (unsigned long)(supervisor_tick - offline_since_tick),
+                   fast_reconnect_tries > 0 ? " (fast reconnect)" : "");
+            offline_since_tick = 0;
+            fast_reconnect_tries = 0;
             g_system_state = SYS_STATE_RUNNING;
             printf("\r\n--- [STATE] System Running ---\r\n");
             break;
@@ -239,20 +280,34 @@ void App_Main_Task(void)
         case SYS_STATE_RUNNING:
             // 进入正常运行状态后，喂狗的责任完全移交给 TaskMonitor 模块。
             // TaskMonitor 会检查所有被监控任务的"签到"状态，只有在所有任务都存活时才喂狗。
-            // 步骤1: 作为监督者，检查所有关键任务是否都已签到。
+            // 步骤1: 主任务自己签到，表明自己在本轮循环中是存活的。
+            // 先于检查进行：刚从初始化/重连流程进入本状态时，距上次签到可能已远超截止时间。
+            TaskMonitor_CheckIn(TASK_ID_APP_MAIN);
+
+            // 步骤2: 作为监督者，检查所有关键任务是否都在各自的截止时间内签到。
             // 如果是，此函数会喂狗。如果否，则不喂狗，系统将最终被复位。
             TaskMonitor_FeedDogIfAllOk();
 
-            // 步骤2: 主任务自己签到，表明自己在本轮循环中是存活的。
-            TaskMonitor_CheckIn(TASK_ID_APP_MAIN);
-            
-            // 步骤3: 调用批量上报函数
-            HuaweiIoT_PublishGatewayReport(&g_at_handle);
-            
-            // 步骤4: 短暂休眠，定义监督周期
-            // [TIMING] 此延时必须小于 (看门狗超时 - 上报函数最大耗时)
-            // 4.2s - 1.5s = 2.7s. 为保证裕量，取 2s.
-            osDelay(2000); 
+            // 步骤3: 上报进行中时，上行任务阻塞在AT命令上无法签到，由监督者在截止时间内代其签到。
+            CloudUplink_Supervise();
+
+            // 步骤4: 投递上报请求 (非阻塞)。实际的AT通信在上行任务中进行，
+            // 无论模组响应多慢，本循环都不会被阻塞。
+            CloudUplink_RequestReport();
+            if (osKernelGetTickCount() - telemetry_tick >= TELEMETRY_PERIOD_MS) {
+                telemetry_tick = osKernelGetTickCount();
+                CloudUplink_RequestModemStats();
+                CloudUplink_RequestSystemStats();
+                CloudUplink_RequestSampleLatency();
+            }
+
+            // 步骤5: 按绝对时刻休眠，保证监督周期严格固定，不随本循环的执行时间漂移。
+            // [TIMING] 周期只需小于看门狗超时 (约4.2s)，取 2s。
+            supervisor_tick += APP_SUPERVISOR_PERIOD_MS;
+            if ((int32_t)(supervisor_tick - osKernelGetTickCount()) <= 0) {
+                supervisor_tick = osKernelGetTickCount() + APP_SUPERVISOR_PERIOD_MS; // 落后过多时重新对齐
+            }
+            osDelayUntil(supervisor_tick);
             break;
 
         case SYS_STATE_RECONNECTING:
@@ -261,6 +316,30 @@ void App_Main_Task(void)
             // 步骤1: 通知设备管理器，云平台已离线
             DeviceManager_SetCloudOnlineStatus(false);
 
+            // 步骤2: 暂停上行任务，并等待正在进行的上报结束 (AT命令会在各自的超时内返回)，
+            // 之后才能安全地释放AT处理器。等待期间由本任务负责喂狗。
+            CloudUplink_Pause();
+            for (uint32_t waited = 0; CloudUplink_IsBusy() && waited < UPLINK_DRAIN_TIMEOUT_MS; waited += 100) {
+                HAL_IWDG_Refresh(&hiwdg);
+                osDelay(100);
+            }
+
+            if (offline_since_tick == 0) {
+                offline_since_tick = osKernelGetTickCount();
+            }
+
+            // 步骤3: [快速路径] 模组仍能响应AT时，保留AT处理器 (无需重建任务和缓冲区，也无需等待)，
+            // 直接重新执行初始化序列。连接脚本会检测并复用模组中仍然有效的PDP上下文。
+            HAL_IWDG_Refresh(&hiwdg);
+            if (fast_reconnect_tries < FAST_RECONNECT_MAX_TRIES &&
+                AT_SendBasicCommand(&g_at_handle, "AT", 1000) == AT_OK) {
+                fast_reconnect_tries++;
+                printf("  > Module responsive. Fast reconnect (attempt %u)...\r\n", fast_reconnect_tries);
+                g_system_state = SYS_STATE_INITIALIZING;
+                break;
+            }
+            fast_reconnect_tries = 0;
+
             // 核心步骤: 彻底清理旧的会话资源（如AT任务、缓冲区），为全新启动做准备。
             AT_DeInit(&g_at_handle); 
             osDelay(3000);          // 等待模组稳定或网络环境恢复
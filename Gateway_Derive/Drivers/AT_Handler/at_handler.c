@@ -1,4 +1,5 @@
 #include "at_handler.h"
+#include "at_stats.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -7,13 +8,54 @@
 
 /* Private Defines -----------------------------------------------------------*/
 #define AT_DMA_RX_BUFFER_SIZE 512    // 为获得最佳性能，此大小应能容纳最常见的AT响应
-#define AT_RING_BUFFER_SIZE   2048   // 环形缓冲区，应足够大以应对突发数据
+#define AT_RING_BUFFER_SIZE   2048   // 环形缓冲区，应足够大以应对突发数据 (必须为2的幂)
 #define AT_RX_TASK_STACK_SIZE 2048   // AT接收解析任务的堆栈大小
 #define AT_RX_TASK_PRIORITY   (osPriorityHigh) // AT接收解析任务的优先级
 
+// AT接收任务的线程标志
+#define AT_RX_FLAG_DATA       0x0001U // 环形缓冲区中有新数据 (由UART空闲中断设置)
+#define AT_RX_FLAG_ASYNC      0x0002U // 新增了在途异步命令，需重新计算超时等待时间
+
+#define URC_NODE_NONE         0xFFU   // 前缀树中表示"无"的下标
+
+/* Private Variables ---------------------------------------------------------*/
+
+// 数据模式命令的GPDMA链表 (命令头 + 负载区段)。链表寄存器只保存节点地址的低16位，
+// 所有节点必须位于同一个64KB区域内：按256字节对齐且总大小不足256字节即可保证。
+// 节点在命令锁和发送信号量的保护下使用，本模块只服务一个模组。
+static DMA_NodeTypeDef s_tx_nodes[AT_TX_MAX_SEGMENTS + 1] __ALIGNED(256);
+static DMA_QListTypeDef s_tx_queue;
+
 /* Private Function Prototypes -----------------------------------------------*/
 static void at_rx_task(void *argument);
 static void process_line(AT_Handler_t *handle, const char *line);
+static uint8_t urc_find_child(const AT_Handler_t *handle, uint8_t node, char ch);
+static bool urc_compile(AT_Handler_t *handle, const AT_URC_t *table, uint8_t table_size);
+static const AT_URC_t *urc_lookup(const AT_Handler_t *handle, const char *line);
+static AT_AsyncSlot_t *async_push(AT_Handler_t *handle, const char *result_prefix, uint32_t result_timeout_ms,
+                                  at_async_callback_t callback, void *ctx, bool windowed);
+static bool async_take(AT_Handler_t *handle, uint8_t index, AT_AsyncSlot_t *out);
+static bool async_take_by_tag(AT_Handler_t *handle, uint16_t tag, AT_AsyncSlot_t *out);
+static void async_finish(AT_Handler_t *handle, const AT_AsyncSlot_t *slot, AT_Status_t status, uint16_t rx_bytes);
+static bool async_match_result(AT_Handler_t *handle, const char *line);
+static void async_expire(AT_Handler_t *handle);
+static uint32_t async_wait_time(AT_Handler_t *handle);
+static AT_Status_t send_raw(AT_Handler_t *handle, const char *cmd, const char *result_prefix,
+                            uint32_t result_timeout_ms, at_async_callback_t callback, void *ctx);
+static void tx_dma_use_normal(AT_Handler_t *handle);
+static HAL_StatusTypeDef tx_dma_start_list(AT_Handler_t *handle, const AT_TxSegment_t *segs, uint8_t count);
+static AT_Status_t send_segments(AT_Handler_t *handle, const AT_TxSegment_t *segs, uint8_t count);
+static AT_Status_t send_frame(AT_Handler_t *handle, uint16_t cmd_len, const AT_TxSegment_t *data,
+                              uint8_t data_count, bool wait_prompt, bool *answered);
+static bool prompt_check(AT_Handler_t *handle, const char *text);
+static uint16_t frame_bytes(uint16_t cmd_len, const AT_TxSegment_t *data, uint8_t data_count);
+static AT_Status_t execute_sync(AT_Handler_t *handle, uint16_t cmd_len, const AT_TxSegment_t *data,
+                                uint8_t data_count, bool wait_prompt, uint32_t timeout_ms,
+                                char *response_buf, uint16_t buf_len);
+static AT_Status_t execute_async(AT_Handler_t *handle, uint16_t cmd_len, const AT_TxSegment_t *data,
+                                 uint8_t data_count, bool wait_prompt, const char *result_prefix,
+                                 uint32_t result_timeout_ms, at_async_callback_t callback, void *ctx,
+                                 uint16_t *tag);
 
 /* Public Functions ----------------------------------------------------------*/
 
@@ -44,15 +86,20 @@ osStatus_t AT_Init(AT_Handler_t *handle, UART_HandleTypeDef *huart_at, DMA_Handl
         return osErrorNoMemory;
     }
     handle->dma_rx_buffer_size = AT_DMA_RX_BUFFER_SIZE;
-    handle->ring_buffer_size = AT_RING_BUFFER_SIZE;
+    SpscRing_Init(&handle->rx_ring, handle->ring_buffer, AT_RING_BUFFER_SIZE);
     handle->tx_buffer_size = AT_TX_BUFFER_SIZE;
 
     // 2. 创建RTOS对象
     handle->cmd_mutex = osMutexNew(NULL);
     handle->response_sem = osSemaphoreNew(1, 0, NULL); // 命令响应信号量, 初始为0
     handle->tx_cplt_sem = osSemaphoreNew(1, 1, NULL);  // 发送完成信号量, 初始为1 (可用)
+    handle->async_mutex = osMutexNew(NULL);
+    handle->async_window_sem = osSemaphoreNew(AT_ASYNC_WINDOW_SIZE, AT_ASYNC_WINDOW_SIZE, NULL); // 异步窗口名额
+    handle->async_next_tag = 1;
+    AT_Stats_Init(); // 统计数据不随句柄重建而清零
 
-    if (!handle->cmd_mutex || !handle->response_sem || !handle->tx_cplt_sem)
+    if (!handle->cmd_mutex || !handle->response_sem || !handle->tx_cplt_sem ||
+        !handle->async_mutex || !handle->async_window_sem)
     {
         // 创建失败
         vPortFree(handle->dma_rx_buffer_a);
@@ -62,6 +109,8 @@ osStatus_t AT_Init(AT_Handler_t *handle, UART_HandleTypeDef *huart_at, DMA_Handl
         if (handle->cmd_mutex) osMutexDelete(handle->cmd_mutex);
         if (handle->response_sem) osSemaphoreDelete(handle->response_sem);
         if (handle->tx_cplt_sem) osSemaphoreDelete(handle->tx_cplt_sem);
+        if (handle->async_mutex) osMutexDelete(handle->async_mutex);
+        if (handle->async_window_sem) osSemaphoreDelete(handle->async_window_sem);
         return osErrorResource;
     }
 
@@ -81,6 +130,8 @@ osStatus_t AT_Init(AT_Handler_t *handle, UART_HandleTypeDef *huart_at, DMA_Handl
         if (handle->cmd_mutex) osMutexDelete(handle->cmd_mutex);
         if (handle->response_sem) osSemaphoreDelete(handle->response_sem);
         if (handle->tx_cplt_sem) osSemaphoreDelete(handle->tx_cplt_sem);
+        osMutexDelete(handle->async_mutex);
+        osSemaphoreDelete(handle->async_window_sem);
         return osErrorResource;
     }
     
@@ -107,6 +158,7 @@ void AT_DeInit(AT_Handler_t *handle)
     // 停止硬件
     HAL_UART_DMAStop(handle->huart);
     __HAL_UART_DISABLE_IT(handle->huart, UART_IT_IDLE);
+    tx_dma_use_normal(handle); // 发送通道恢复为CubeMX配置的普通模式，以便重新初始化
 
     // 删除RTOS对象
     if (handle->rx_task_handle)
@@ -129,6 +181,17 @@ void AT_DeInit(AT_Handler_t *handle)
         osSemaphoreDelete(handle->tx_cplt_sem);
         handle->tx_cplt_sem = NULL;
     }
+    // 在途的异步命令直接丢弃，不再回调 (调用者应在反初始化前通过 AT_WaitAsyncIdle 等待其完成)
+    if (handle->async_mutex)
+    {
+        osMutexDelete(handle->async_mutex);
+        handle->async_mutex = NULL;
+    }
+    if (handle->async_window_sem)
+    {
+        osSemaphoreDelete(handle->async_window_sem);
+        handle->async_window_sem = NULL;
+    }
 
     // 释放内存
     if (handle->dma_rx_buffer_a)
@@ -157,21 +220,70 @@ void AT_DeInit(AT_Handler_t *handle)
 }
 
 /**
- * @brief 发送 AT 命令并等待响应
+ * @brief 获取发送缓冲区的独占使用权 (实现)
  */
-AT_Status_t AT_SendCommand(AT_Handler_t *handle, const char *cmd, uint32_t timeout_ms,
-                           char *response_buf, uint16_t buf_len)
+char* AT_BeginCommand(AT_Handler_t *handle, uint32_t timeout_ms, uint16_t *capacity)
 {
     if (osMutexAcquire(handle->cmd_mutex, timeout_ms) != osOK)
     {
-        return AT_TIMEOUT;
+        return NULL;
     }
 
-    // 确保上一次DMA发送已完成
+    // 确保上一次DMA发送已完成，之后 tx_buffer 才能被安全地改写
     if (osSemaphoreAcquire(handle->tx_cplt_sem, timeout_ms) != osOK) {
         osMutexRelease(handle->cmd_mutex);
-        return AT_TIMEOUT;
+        return NULL;
+    }
+
+    if (capacity)
+    {
+        // 预留2字节给 AT_ExecuteCommand 追加的 "\r\n"
+        *capacity = handle->tx_buffer_size - 2;
+    }
+    return (char*)handle->tx_buffer;
+}
+
+/**
+ * @brief 放弃一次已开始的命令构建 (实现)
+ */
+void AT_AbortCommand(AT_Handler_t *handle)
+{
+    osSemaphoreRelease(handle->tx_cplt_sem); // 没有启动DMA，直接归还TX信号量
+    osMutexRelease(handle->cmd_mutex);
+}
+
+/**
+ * @brief 发送已写入发送缓冲区的命令并等待响应 (实现)
+ */
+AT_Status_t AT_ExecuteCommand(AT_Handler_t *handle, uint16_t cmd_len, uint32_t timeout_ms,
+                              char *response_buf, uint16_t buf_len)
+{
+    return execute_sync(handle, cmd_len, NULL, 0, false, timeout_ms, response_buf, buf_len);
+}
+
+/**
+ * @brief 以数据模式发送命令并等待响应 (实现)
+ */
+AT_Status_t AT_ExecuteDataCommand(AT_Handler_t *handle, uint16_t cmd_len, const AT_TxSegment_t *data,
+                                  uint8_t data_count, bool wait_prompt, uint32_t timeout_ms,
+                                  char *response_buf, uint16_t buf_len)
+{
+    return execute_sync(handle, cmd_len, data, data_count, wait_prompt, timeout_ms, response_buf, buf_len);
+}
+
+/**
+ * @brief [内部] 同步命令的公共实现：发送命令头 (及负载)，等待最终响应，释放命令锁
+ */
+static AT_Status_t execute_sync(AT_Handler_t *handle, uint16_t cmd_len, const AT_TxSegment_t *data,
+                                uint8_t data_count, bool wait_prompt, uint32_t timeout_ms,
+                                char *response_buf, uint16_t buf_len)
+{
+    if (cmd_len + 2 > handle->tx_buffer_size || data_count > AT_TX_MAX_SEGMENTS) {
+        AT_AbortCommand(handle);
+        return AT_BUFFER_FULL; // Command too long for buffer
     }
+    handle->tx_buffer[cmd_len++] = '\r';
+    handle->tx_buffer[cmd_len++] = '\n';
 
     // 清理上一次的响应状态
     handle->p_response_buf = response_buf;
@@ -185,30 +297,229 @@ AT_Status_t AT_SendCommand(AT_Handler_t *handle, const char *cmd, uint32_t timeo
     // 清空响应信号量，以防有残留
     osSemaphoreAcquire(handle->response_sem, 0);
 
-    // 格式化命令到发送缓冲区
-    int cmd_len = snprintf((char*)handle->tx_buffer, handle->tx_buffer_size, "%s\r\n", cmd);
-    if (cmd_len < 0 || cmd_len >= handle->tx_buffer_size) {
-        osSemaphoreRelease(handle->tx_cplt_sem); // 释放TX信号量，因为我们没有启动DMA
-        osMutexRelease(handle->cmd_mutex);
-        return AT_BUFFER_FULL; // Command too long for buffer
-    }
+    uint8_t stats_cmd = AT_Stats_Begin((const char *)handle->tx_buffer, cmd_len);
+    uint16_t tx_bytes = frame_bytes(cmd_len, data, data_count);
+    handle->stats_rx = 0;
+    uint32_t start = osKernelGetTickCount();
 
     // 使用DMA发送
-    if (HAL_UART_Transmit_DMA(handle->huart, handle->tx_buffer, cmd_len) != HAL_OK)
+    bool answered;
+    AT_Status_t status = send_frame(handle, cmd_len, data, data_count, wait_prompt, &answered);
+    if (status != AT_OK)
     {
-        osSemaphoreRelease(handle->tx_cplt_sem); // 释放TX信号量
+        AT_Stats_End(stats_cmd, start, status, tx_bytes, handle->stats_rx, false);
         osMutexRelease(handle->cmd_mutex);
-        return AT_UART_ERROR;
+        return status;
     }
 
-    // 等待响应信号量 (由process_line释放)
-    if (osSemaphoreAcquire(handle->response_sem, timeout_ms) != osOK)
+    // 等待响应信号量 (由process_line释放)；等待提示符时已收到最终响应则无需再等
+    if (!answered && osSemaphoreAcquire(handle->response_sem, timeout_ms) != osOK)
     {
         handle->last_status = AT_TIMEOUT;
     }
     
+    status = handle->last_status;
+    AT_Stats_End(stats_cmd, start, status, tx_bytes, handle->stats_rx, false);
+    osMutexRelease(handle->cmd_mutex);
+    return status;
+}
+
+/**
+ * @brief 发送 AT 命令并等待响应
+ */
+AT_Status_t AT_SendCommand(AT_Handler_t *handle, const char *cmd, uint32_t timeout_ms,
+                           char *response_buf, uint16_t buf_len)
+{
+    uint16_t capacity;
+    char *tx = AT_BeginCommand(handle, timeout_ms, &capacity);
+    if (tx == NULL)
+    {
+        return AT_TIMEOUT;
+    }
+
+    // 复制命令到发送缓冲区 ("\r\n" 由 AT_ExecuteCommand 追加)
+    size_t cmd_len = strlen(cmd);
+    if (cmd_len > capacity) {
+        AT_AbortCommand(handle);
+        return AT_BUFFER_FULL; // Command too long for buffer
+    }
+    memcpy(tx, cmd, cmd_len);
+
+    return AT_ExecuteCommand(handle, (uint16_t)cmd_len, timeout_ms, response_buf, buf_len);
+}
+
+/**
+ * @brief 开始一条异步命令 (实现)
+ */
+char* AT_BeginAsyncCommand(AT_Handler_t *handle, uint32_t timeout_ms, uint16_t *capacity)
+{
+    // 先占窗口名额再拿命令锁，窗口满时等待不会阻塞其他命令的发送
+    if (osSemaphoreAcquire(handle->async_window_sem, timeout_ms) != osOK)
+    {
+        return NULL;
+    }
+
+    char *tx = AT_BeginCommand(handle, timeout_ms, capacity);
+    if (tx == NULL)
+    {
+        osSemaphoreRelease(handle->async_window_sem);
+    }
+    return tx;
+}
+
+/**
+ * @brief 放弃一条异步命令 (实现)
+ */
+void AT_AbortAsyncCommand(AT_Handler_t *handle)
+{
+    AT_AbortCommand(handle);
+    osSemaphoreRelease(handle->async_window_sem);
+}
+
+/**
+ * @brief 发送异步命令，发送完毕后返回 (实现)
+ */
+AT_Status_t AT_ExecuteAsyncCommand(AT_Handler_t *handle, uint16_t cmd_len, const char *result_prefix,
+                                   uint32_t result_timeout_ms, at_async_callback_t callback, void *ctx,
+                                   uint16_t *tag)
+{
+    return execute_async(handle, cmd_len, NULL, 0, false, result_prefix, result_timeout_ms, callback, ctx, tag);
+}
+
+/**
+ * @brief 以数据模式发送异步命令，负载发送完毕后返回 (实现)
+ */
+AT_Status_t AT_ExecuteAsyncDataCommand(AT_Handler_t *handle, uint16_t cmd_len, const AT_TxSegment_t *data,
+                                       uint8_t data_count, bool wait_prompt, const char *result_prefix,
+                                       uint32_t result_timeout_ms, at_async_callback_t callback, void *ctx,
+                                       uint16_t *tag)
+{
+    return execute_async(handle, cmd_len, data, data_count, wait_prompt, result_prefix, result_timeout_ms,
+                         callback, ctx, tag);
+}
+
+/**
+ * @brief [内部] 异步命令的公共实现：登记在途记录，发送命令头 (及负载)，等待DMA发送完毕后释放命令锁
+ * @details 不等待模组回 "OK" (L610 对 AT+HMPUB 只回结果URC)，在途记录只跟踪最终结果。
+ *          等到DMA发送完毕才返回，调用者的负载缓冲区在返回后即可复用。
+ */
+static AT_Status_t execute_async(AT_Handler_t *handle, uint16_t cmd_len, const AT_TxSegment_t *data,
+                                 uint8_t data_count, bool wait_prompt, const char *result_prefix,
+                                 uint32_t result_timeout_ms, at_async_callback_t callback, void *ctx,
+                                 uint16_t *tag)
+{
+    if (cmd_len + 2 > handle->tx_buffer_size || data_count > AT_TX_MAX_SEGMENTS) {
+        AT_AbortAsyncCommand(handle);
+        return AT_BUFFER_FULL; // Command too long for buffer
+    }
+    handle->tx_buffer[cmd_len++] = '\r';
+    handle->tx_buffer[cmd_len++] = '\n';
+
+    uint8_t stats_cmd = AT_Stats_Begin((const char *)handle->tx_buffer, cmd_len);
+
+    // 先登记再发送，保证在途记录的顺序与模组收到命令的顺序一致
+    osMutexAcquire(handle->async_mutex, osWaitForever);
+    AT_AsyncSlot_t *slot = async_push(handle, result_prefix, result_timeout_ms, callback, ctx, true);
+    if (slot)
+    {
+        slot->stats_cmd = stats_cmd;
+        slot->tx_bytes = frame_bytes(cmd_len, data, data_count);
+    }
+    uint16_t my_tag = slot ? slot->tag : 0;
+    handle->async_accepting_tag = my_tag;
+    osMutexRelease(handle->async_mutex);
+
+    if (slot == NULL)
+    {
+        AT_AbortAsyncCommand(handle); // 窗口名额保证了有空闲记录，正常情况下不会发生
+        return AT_BUFFER_FULL;
+    }
+
+    handle->p_response_buf = NULL;
+    handle->response_buf_size = 0;
+    handle->response_len = 0;
+    handle->stats_rx = 0;
+    osSemaphoreAcquire(handle->response_sem, 0);
+
+    bool answered;
+    AT_Status_t status = send_frame(handle, cmd_len, data, data_count, wait_prompt, &answered);
+    if (status == AT_OK && answered)
+    {
+        // 等待提示符时模组直接给出了响应：结果行已完成本命令 (AT_OK)，不带前缀的 "ERROR" 则为拒绝
+        status = handle->last_status;
+    }
+    else if (status == AT_OK)
+    {
+        // 等待最后一段DMA发送完毕，随即归还发送信号量
+        if (osSemaphoreAcquire(handle->tx_cplt_sem, AT_DATA_PROMPT_TIMEOUT_MS) != osOK)
+        {
+            status = AT_TIMEOUT;
+        }
+        else
+        {
+            osSemaphoreRelease(handle->tx_cplt_sem);
+        }
+    }
+
+    // 未发送成功：撤销在途记录。若记录已不在 (结果行或超时已先行完成它)，回调已被调用，视为已发送
+    AT_AsyncSlot_t rejected;
+    osMutexAcquire(handle->async_mutex, osWaitForever);
+    handle->async_accepting_tag = 0;
+    bool revoke = (status != AT_OK) && async_take_by_tag(handle, my_tag, &rejected);
+    osMutexRelease(handle->async_mutex);
+
     osMutexRelease(handle->cmd_mutex);
-    return handle->last_status;
+
+    if (revoke)
+    {
+        AT_Stats_End(rejected.stats_cmd, rejected.start_tick, status, rejected.tx_bytes, handle->stats_rx, true);
+        osSemaphoreRelease(handle->async_window_sem);
+        return status;
+    }
+
+    if (tag)
+    {
+        *tag = my_tag;
+    }
+    return AT_OK;
+}
+
+/**
+ * @brief 等待异步窗口清空 (实现)
+ * @details 依次拿走窗口的全部名额，拿齐即说明没有占用窗口的在途命令，随后全部归还。
+ */
+AT_Status_t AT_WaitAsyncIdle(AT_Handler_t *handle, uint32_t timeout_ms)
+{
+    uint32_t start = osKernelGetTickCount();
+    uint8_t held = 0;
+    AT_Status_t status = AT_OK;
+
+    while (held < AT_ASYNC_WINDOW_SIZE)
+    {
+        uint32_t elapsed = osKernelGetTickCount() - start;
+        if (elapsed >= timeout_ms ||
+            osSemaphoreAcquire(handle->async_window_sem, timeout_ms - elapsed) != osOK)
+        {
+            status = AT_TIMEOUT;
+            break;
+        }
+        held++;
+    }
+
+    while (held > 0)
+    {
+        osSemaphoreRelease(handle->async_window_sem);
+        held--;
+    }
+    return status;
+}
+
+/**
+ * @brief 查询在途异步命令数 (实现)
+ */
+uint8_t AT_GetAsyncInFlight(AT_Handler_t *handle)
+{
+    return handle->async_count;
 }
 
 /**
@@ -224,6 +535,332 @@ AT_Status_t AT_SendBasicCommand(AT_Handler_t *handle, const char *cmd, uint32_t
  * @brief 发送一个原始的AT命令，不等待任何响应 (实现)
  */
 AT_Status_t AT_SendRaw(AT_Handler_t* handle, const char* cmd)
+{
+    return send_raw(handle, cmd, NULL, 0, NULL, NULL);
+}
+
+/**
+ * @brief 发送原始命令并登记其结果URC (实现)
+ */
+AT_Status_t AT_SendRawAsync(AT_Handler_t *handle, const char *cmd, const char *result_prefix,
+                            uint32_t result_timeout_ms, at_async_callback_t callback, void *ctx)
+{
+    return send_raw(handle, cmd, result_prefix, result_timeout_ms, callback, ctx);
+}
+
+/**
+ * @brief 注册 URC 回调函数表
+ */
+bool AT_RegisterURCCallbacks(AT_Handler_t *handle, const AT_URC_t *table, uint8_t table_size)
+{
+    // 先撤下旧表，编译完成后再发布，接收任务不会看到编译了一半的前缀树
+    handle->urc_table = NULL;
+    handle->urc_table_size = 0;
+
+    if (table == NULL || !urc_compile(handle, table, table_size))
+    {
+        printf("[AT] URC table rejected (empty prefix or more than %d trie nodes).\r\n", AT_URC_MAX_NODES);
+        return false;
+    }
+
+    handle->urc_table_size = table_size;
+    handle->urc_table = table;
+    return true;
+}
+
+/* Private Functions ---------------------------------------------------------*/
+
+/**
+ * @brief [内部] 若发送DMA通道处于链表模式，将其恢复为普通模式
+ * @note  只能在持有发送信号量 (通道空闲) 时调用。普通命令占绝大多数，因此只在数据模式命令之后
+ *        的下一次普通发送时才切换回来，连续的数据模式命令之间不来回切换。
+ */
+static void tx_dma_use_normal(AT_Handler_t *handle)
+{
+    if (!handle->tx_list_mode)
+    {
+        return;
+    }
+
+    DMA_HandleTypeDef *hdma = handle->hdma_tx;
+    HAL_DMAEx_List_UnLinkQ(hdma);
+    HAL_DMA_DeInit(hdma);
+    HAL_DMA_Init(hdma); // hdma->Init 仍是CubeMX生成的普通模式配置
+    __HAL_LINKDMA(handle->huart, hdmatx, *hdma); // DeInit 会清除 Parent
+    handle->tx_list_mode = false;
+}
+
+/**
+ * @brief [内部] 把各区段构建成GPDMA链表 (每个区段一个节点)，并启动UART发送
+ * @details
+ *        节点沿用普通模式的请求/方向/位宽配置，只在最后一个节点完成时产生传输完成事件，
+ *        因此整条链表发送完毕后才进入 `AT_UartTxCpltCallback`，与普通发送的完成语义一致。
+ *        `HAL_UART_Transmit_DMA` 会用传入的地址和长度改写头节点，这里传入的正是第一个区段。
+ */
+static HAL_StatusTypeDef tx_dma_start_list(AT_Handler_t *handle, const AT_TxSegment_t *segs, uint8_t count)
+{
+    DMA_HandleTypeDef *hdma = handle->hdma_tx;
+
+    if (handle->tx_list_mode)
+    {
+        HAL_DMAEx_List_UnLinkQ(hdma);
+    }
+    if (HAL_DMAEx_List_ResetQ(&s_tx_queue) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+
+    DMA_NodeConfTypeDef node_conf = {0};
+    node_conf.NodeType = DMA_GPDMA_LINEAR_NODE;
+    node_conf.Init = hdma->Init;
+    node_conf.Init.TransferEventMode = DMA_TCEM_LAST_LL_ITEM_TRANSFER;
+    node_conf.DataHandlingConfig.DataExchange = DMA_EXCHANGE_NONE;
+    node_conf.DataHandlingConfig.DataAlignment = DMA_DATA_RIGHTALIGN_ZEROPADDED;
+    node_conf.TriggerConfig.TriggerPolarity = DMA_TRIG_POLARITY_MASKED;
+    node_conf.DstAddress = (uint32_t)&handle->huart->Instance->TDR;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        node_conf.SrcAddress = (uint32_t)segs[i].data;
+        node_conf.DataSize = segs[i].len;
+        if (HAL_DMAEx_List_BuildNode(&node_conf, &s_tx_nodes[i]) != HAL_OK ||
+            HAL_DMAEx_List_InsertNode_Tail(&s_tx_queue, &s_tx_nodes[i]) != HAL_OK)
+        {
+            return HAL_ERROR;
+        }
+    }
+
+    if (!handle->tx_list_mode)
+    {
+        handle->tx_list_mode = true; // 即使下面失败，下一次普通发送也会重新初始化通道
+        HAL_DMA_DeInit(hdma);
+        hdma->InitLinkedList.Priority = hdma->Init.Priority;
+        hdma->InitLinkedList.LinkStepMode = DMA_LSM_FULL_EXECUTION;
+        hdma->InitLinkedList.LinkAllocatedPort = DMA_LINK_ALLOCATED_PORT0;
+        hdma->InitLinkedList.TransferEventMode = DMA_TCEM_LAST_LL_ITEM_TRANSFER;
+        hdma->InitLinkedList.LinkedListMode = DMA_LINKEDLIST_NORMAL;
+        if (HAL_DMAEx_List_Init(hdma) != HAL_OK)
+        {
+            return HAL_ERROR;
+        }
+        __HAL_LINKDMA(handle->huart, hdmatx, *hdma);
+    }
+
+    if (HAL_DMAEx_List_LinkQ(hdma, &s_tx_queue) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+    return HAL_UART_Transmit_DMA(handle->huart, (const uint8_t *)segs[0].data, segs[0].len);
+}
+
+/**
+ * @brief [内部] 以DMA发送若干区段 (调用前必须已持有发送信号量)
+ * @details 只有一个区段时走普通DMA，否则走链表传输。启动失败时归还发送信号量。
+ * @return AT_Status_t AT_OK: 已启动，发送信号量将由发送完成中断归还; AT_UART_ERROR: 启动失败
+ */
+static AT_Status_t send_segments(AT_Handler_t *handle, const AT_TxSegment_t *segs, uint8_t count)
+{
+    HAL_StatusTypeDef hal_status;
+    if (count == 1)
+    {
+        tx_dma_use_normal(handle);
+        hal_status = HAL_UART_Transmit_DMA(handle->huart, (const uint8_t *)segs[0].data, segs[0].len);
+    }
+    else
+    {
+        hal_status = tx_dma_start_list(handle, segs, count);
+    }
+
+    if (hal_status != HAL_OK)
+    {
+        osSemaphoreRelease(handle->tx_cplt_sem); // 没有启动DMA，直接归还TX信号量
+        return AT_UART_ERROR;
+    }
+    return AT_OK;
+}
+
+/**
+ * @brief [内部] 发送发送缓冲区中的命令头 (已追加 "\r\n") 及其后的负载区段
+ * @param answered 输出：等待提示符期间已收到最终响应 (response_sem 已被消耗，负载没有发送)
+ * @return AT_Status_t AT_OK: 已全部交给DMA (或 answered 为 true); 其他: 发送失败
+ */
+static AT_Status_t send_frame(AT_Handler_t *handle, uint16_t cmd_len, const AT_TxSegment_t *data,
+                              uint8_t data_count, bool wait_prompt, bool *answered)
+{
+    AT_TxSegment_t segs[AT_TX_MAX_SEGMENTS + 1];
+    uint8_t count = 0;
+
+    *answered = false;
+    segs[count].data = handle->tx_buffer;
+    segs[count++].len = cmd_len;
+    for (uint8_t i = 0; i < data_count; i++)
+    {
+        if (data[i].len > 0)
+        {
+            segs[count++] = data[i];
+        }
+    }
+
+    if (count == 1 || !wait_prompt)
+    {
+        return send_segments(handle, segs, count);
+    }
+
+    // 先发命令头，等待模组的 '>' 提示符
+    handle->prompt_received = false;
+    handle->prompt_pending = true;
+    AT_Status_t status = send_segments(handle, segs, 1);
+    if (status == AT_OK && osSemaphoreAcquire(handle->response_sem, AT_DATA_PROMPT_TIMEOUT_MS) != osOK)
+    {
+        status = AT_TIMEOUT;
+    }
+    handle->prompt_pending = false;
+    if (status != AT_OK)
+    {
+        return status;
+    }
+    if (!handle->prompt_received)
+    {
+        *answered = true; // 模组直接给出了最终响应 (例如 "ERROR")
+        return AT_OK;
+    }
+
+    // 提示符到达时命令头早已发完，取回发送信号量后发送负载
+    if (osSemaphoreAcquire(handle->tx_cplt_sem, AT_DATA_PROMPT_TIMEOUT_MS) != osOK)
+    {
+        return AT_UART_ERROR;
+    }
+    return send_segments(handle, &segs[1], count - 1);
+}
+
+/**
+ * @brief [内部] 在等待数据模式提示符时，检查收到的文本是否为 '>' 提示符
+ * @note  提示符后面没有换行，因此除了完整的行，接收任务还会用尚未结束的半行来调用本函数。
+ * @return bool true: 是提示符，已唤醒发送者
+ */
+static bool prompt_check(AT_Handler_t *handle, const char *text)
+{
+    if (!handle->prompt_pending || text[0] != '>')
+    {
+        return false;
+    }
+    handle->prompt_pending = false;
+    handle->prompt_received = true;
+    osSemaphoreRelease(handle->response_sem);
+    return true;
+}
+
+/**
+ * @brief [内部] 一帧的总发送字节数：命令头 (已含 "\r\n") 加上各负载区段
+ */
+static uint16_t frame_bytes(uint16_t cmd_len, const AT_TxSegment_t *data, uint8_t data_count)
+{
+    uint32_t total = cmd_len;
+    for (uint8_t i = 0; i < data_count; i++)
+    {
+        total += data[i].len;
+    }
+    return (total > UINT16_MAX) ? UINT16_MAX : (uint16_t)total;
+}
+
+/**
+ * @brief [内部] 在前缀树中查找 node 的字符为 ch 的子节点
+ * @return uint8_t 子节点下标；不存在时返回 URC_NODE_NONE
+ */
+static uint8_t urc_find_child(const AT_Handler_t *handle, uint8_t node, char ch)
+{
+    uint8_t child = handle->urc_nodes[node].child;
+    while (child != URC_NODE_NONE && handle->urc_nodes[child].ch != ch)
+    {
+        child = handle->urc_nodes[child].sibling;
+    }
+    return child;
+}
+
+/**
+ * @brief [内部] 把URC表编译成前缀树和首字节位图
+ * @return bool false: 节点不够用或存在空前缀
+ */
+static bool urc_compile(AT_Handler_t *handle, const AT_URC_t *table, uint8_t table_size)
+{
+    memset(handle->urc_first_char, 0, sizeof(handle->urc_first_char));
+    handle->urc_nodes[0] = (AT_URC_Node_t){.ch = '\0', .child = URC_NODE_NONE, .sibling = URC_NODE_NONE, .urc = URC_NODE_NONE};
+    handle->urc_node_count = 1;
+
+    for (uint8_t i = 0; i < table_size; i++)
+    {
+        const char *p = table[i].urc_prefix;
+        if (p == NULL || *p == '\0')
+        {
+            return false;
+        }
+
+        uint8_t first = (uint8_t)*p;
+        handle->urc_first_char[first >> 5] |= 1UL << (first & 31U);
+
+        uint8_t node = 0;
+        for (; *p; p++)
+        {
+            uint8_t child = urc_find_child(handle, node, *p);
+            if (child == URC_NODE_NONE)
+            {
+                if (handle->urc_node_count >= AT_URC_MAX_NODES)
+                {
+                    return false;
+                }
+                child = handle->urc_node_count++;
+                handle->urc_nodes[child] = (AT_URC_Node_t){
+                    .ch = *p, .child = URC_NODE_NONE, .sibling = handle->urc_nodes[node].child, .urc = URC_NODE_NONE};
+                handle->urc_nodes[node].child = child;
+            }
+            node = child;
+        }
+
+        if (handle->urc_nodes[node].urc == URC_NODE_NONE)
+        {
+            handle->urc_nodes[node].urc = i; // 相同前缀以先出现者为准
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief [内部] 判断该行是否为已注册的URC
+ * @details 先查首字节位图 (普通响应通常在这里就被排除)，再沿前缀树走一遍，记录经过的最长完整前缀。
+ * @return const AT_URC_t* 匹配的表项；不是URC时返回 NULL
+ */
+static const AT_URC_t *urc_lookup(const AT_Handler_t *handle, const char *line)
+{
+    const AT_URC_t *table = handle->urc_table;
+    uint8_t first = (uint8_t)line[0];
+    if (table == NULL || (handle->urc_first_char[first >> 5] & (1UL << (first & 31U))) == 0)
+    {
+        return NULL;
+    }
+
+    uint8_t node = 0;
+    uint8_t best = URC_NODE_NONE;
+    for (const char *p = line; *p; p++)
+    {
+        node = urc_find_child(handle, node, *p);
+        if (node == URC_NODE_NONE)
+        {
+            break;
+        }
+        if (handle->urc_nodes[node].urc != URC_NODE_NONE)
+        {
+            best = handle->urc_nodes[node].urc;
+        }
+    }
+    return (best != URC_NODE_NONE) ? &table[best] : NULL;
+}
+
+/**
+ * @brief [内部] "发后即忘"地发送原始命令
+ * @param result_prefix 非NULL时，在发送前为命令登记一条不占用窗口的在途记录
+ */
+static AT_Status_t send_raw(AT_Handler_t *handle, const char *cmd, const char *result_prefix,
+                            uint32_t result_timeout_ms, at_async_callback_t callback, void *ctx)
 {
     if (osMutexAcquire(handle->cmd_mutex, 1000) != osOK)
     {
@@ -245,9 +882,45 @@ AT_Status_t AT_SendRaw(AT_Handler_t* handle, const char* cmd)
     }
     memcpy(handle->tx_buffer, cmd, cmd_len);
 
+    // 在命令锁内登记，保证在途记录的顺序与发送顺序一致
+    uint16_t tag = 0;
+    if (result_prefix)
+    {
+        uint8_t stats_cmd = AT_Stats_Begin(cmd, (uint16_t)cmd_len);
+
+        osMutexAcquire(handle->async_mutex, osWaitForever);
+        AT_AsyncSlot_t *slot = async_push(handle, result_prefix, result_timeout_ms, callback, ctx, false);
+        if (slot)
+        {
+            slot->stats_cmd = stats_cmd;
+            slot->tx_bytes = (uint16_t)cmd_len;
+        }
+        tag = slot ? slot->tag : 0;
+        osMutexRelease(handle->async_mutex);
+
+        if (tag == 0)
+        {
+            osSemaphoreRelease(handle->tx_cplt_sem);
+            osMutexRelease(handle->cmd_mutex);
+            return AT_BUFFER_FULL;
+        }
+    }
+
     // 使用DMA发送
+    tx_dma_use_normal(handle);
     if (HAL_UART_Transmit_DMA(handle->huart, handle->tx_buffer, cmd_len) != HAL_OK)
     {
+        if (tag != 0)
+        {
+            AT_AsyncSlot_t unsent;
+            osMutexAcquire(handle->async_mutex, osWaitForever);
+            bool taken = async_take_by_tag(handle, tag, &unsent);
+            osMutexRelease(handle->async_mutex);
+            if (taken)
+            {
+                AT_Stats_End(unsent.stats_cmd, unsent.start_tick, AT_UART_ERROR, 0, 0, true);
+            }
+        }
         osSemaphoreRelease(handle->tx_cplt_sem);
         osMutexRelease(handle->cmd_mutex);
         return AT_UART_ERROR;
@@ -270,54 +943,264 @@ AT_Status_t AT_SendRaw(AT_Handler_t* handle, const char* cmd)
 }
 
 /**
- * @brief 注册 URC 回调函数表
+ * @brief [内部] 追加一条在途记录 (调用者须持有 async_mutex)
+ * @param windowed true: 占用异步窗口 (名额已由调用者取得); false: 使用窗口之外的预留记录
+ * @return AT_AsyncSlot_t* 新记录；没有空闲记录时返回 NULL
  */
-void AT_RegisterURCCallbacks(AT_Handler_t *handle, const AT_URC_t *table, uint8_t table_size)
+static AT_AsyncSlot_t *async_push(AT_Handler_t *handle, const char *result_prefix, uint32_t result_timeout_ms,
+                                  at_async_callback_t callback, void *ctx, bool windowed)
 {
-    handle->urc_table = table;
-    handle->urc_table_size = table_size;
+    if (handle->async_count >= AT_ASYNC_MAX_SLOTS)
+    {
+        return NULL;
+    }
+    if (!windowed)
+    {
+        // 窗口外的记录最多占用预留部分，不能挤占窗口名额对应的记录
+        uint8_t unwindowed = 0;
+        for (uint8_t i = 0; i < handle->async_count; i++)
+        {
+            if (!handle->async_slots[i].windowed)
+            {
+                unwindowed++;
+            }
+        }
+        if (unwindowed >= AT_ASYNC_MAX_SLOTS - AT_ASYNC_WINDOW_SIZE)
+        {
+            return NULL;
+        }
+    }
+
+    AT_AsyncSlot_t *slot = &handle->async_slots[handle->async_count];
+    slot->result_prefix = result_prefix;
+    slot->callback = callback;
+    slot->ctx = ctx;
+    slot->start_tick = osKernelGetTickCount();
+    slot->deadline = slot->start_tick + result_timeout_ms;
+    slot->windowed = windowed;
+    slot->stats_cmd = AT_STATS_NONE; // 由调用者填写
+    slot->tx_bytes = 0;
+    slot->tag = handle->async_next_tag++;
+    if (handle->async_next_tag == 0)
+    {
+        handle->async_next_tag = 1; // 0 保留为"无"
+    }
+
+    handle->async_count++;
+
+    // 接收任务可能正无限期阻塞，唤醒它按新记录的截止时刻重新计算等待时间
+    if (handle->rx_task_handle)
+    {
+        osThreadFlagsSet(handle->rx_task_handle, AT_RX_FLAG_ASYNC);
+    }
+    return slot;
 }
 
-/* Private Functions ---------------------------------------------------------*/
+/**
+ * @brief [内部] 取出第 index 条在途记录，其后的记录依次前移 (调用者须持有 async_mutex)
+ */
+static bool async_take(AT_Handler_t *handle, uint8_t index, AT_AsyncSlot_t *out)
+{
+    if (index >= handle->async_count)
+    {
+        return false;
+    }
+
+    *out = handle->async_slots[index];
+    for (uint8_t i = index + 1; i < handle->async_count; i++)
+    {
+        handle->async_slots[i - 1] = handle->async_slots[i];
+    }
+    handle->async_count--;
+    return true;
+}
+
+/**
+ * @brief [内部] 按标签取出在途记录 (调用者须持有 async_mutex)
+ */
+static bool async_take_by_tag(AT_Handler_t *handle, uint16_t tag, AT_AsyncSlot_t *out)
+{
+    for (uint8_t i = 0; i < handle->async_count; i++)
+    {
+        if (handle->async_slots[i].tag == tag)
+        {
+            return async_take(handle, i, out);
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief [内部] 完成一条已取出的在途记录：记录时延统计，调用回调并归还窗口名额
+ * @note  先调用回调再归还名额，`AT_WaitAsyncIdle` 返回时所有回调都已执行完毕。
+ * @param rx_bytes 结果行的字节数 (超时为0)
+ */
+static void async_finish(AT_Handler_t *handle, const AT_AsyncSlot_t *slot, AT_Status_t status, uint16_t rx_bytes)
+{
+    AT_Stats_End(slot->stats_cmd, slot->start_tick, status, slot->tx_bytes, rx_bytes, true);
+
+    if (slot->callback)
+    {
+        slot->callback(slot->tag, status, slot->ctx);
+    }
+    if (slot->windowed)
+    {
+        osSemaphoreRelease(handle->async_window_sem);
+    }
+}
+
+/**
+ * @brief [内部] 若该行是某条在途命令的结果URC，则完成最早的那条
+ * @details
+ *        结果行格式为 "<前缀> OK" 或 "<前缀> ERR:<错误码>"，例如 "+HMPUB OK"。
+ *        如果被完成的命令仍在发送 (模组没有给出 '>' 提示符而是直接回了结果)，同时唤醒等待提示符的发送者。
+ * @return bool true: 该行已被认领
+ */
+static bool async_match_result(AT_Handler_t *handle, const char *line)
+{
+    AT_AsyncSlot_t slot;
+    bool found = false;
+    bool was_accepting = false;
+    size_t prefix_len = 0;
+
+    osMutexAcquire(handle->async_mutex, osWaitForever);
+    for (uint8_t i = 0; i < handle->async_count; i++)
+    {
+        prefix_len = strlen(handle->async_slots[i].result_prefix);
+        if (strncmp(line, handle->async_slots[i].result_prefix, prefix_len) == 0)
+        {
+            found = async_take(handle, i, &slot);
+            was_accepting = (slot.tag == handle->async_accepting_tag);
+            break;
+        }
+    }
+    osMutexRelease(handle->async_mutex);
+
+    if (!found)
+    {
+        return false;
+    }
+
+    const char *result = line + prefix_len;
+    while (*result == ' ' || *result == ':')
+    {
+        result++;
+    }
+    async_finish(handle, &slot, (strncmp(result, "OK", 2) == 0) ? AT_OK : AT_ERROR, (uint16_t)(strlen(line) + 2));
+
+    if (was_accepting && handle->prompt_pending)
+    {
+        handle->prompt_pending = false;
+        handle->last_status = AT_OK;
+        osSemaphoreRelease(handle->response_sem);
+    }
+    return true;
+}
+
+/**
+ * @brief [内部] 计算接收任务最多可以阻塞多久：到最早一条在途命令的截止时刻为止
+ * @return uint32_t 等待时间 (节拍)；没有在途命令时返回 osWaitForever
+ */
+static uint32_t async_wait_time(AT_Handler_t *handle)
+{
+    if (handle->async_count == 0)
+    {
+        return osWaitForever;
+    }
+
+    uint32_t now = osKernelGetTickCount();
+    int32_t earliest = INT32_MAX;
+
+    osMutexAcquire(handle->async_mutex, osWaitForever);
+    for (uint8_t i = 0; i < handle->async_count; i++)
+    {
+        int32_t remaining = (int32_t)(handle->async_slots[i].deadline - now);
+        if (remaining < earliest)
+        {
+            earliest = remaining;
+        }
+    }
+    osMutexRelease(handle->async_mutex);
+
+    if (earliest == INT32_MAX)
+    {
+        return osWaitForever; // 等待期间记录已被全部完成
+    }
+    return (earliest > 0) ? (uint32_t)earliest : 0;
+}
+
+/**
+ * @brief [内部] 以 AT_TIMEOUT 完成所有已超过截止时刻的在途命令
+ * @note  结果URC不带编号，超时之后才到达的结果会被配给下一条同前缀的在途命令。
+ *        超时时间应明显长于模组自身的发布超时，使这种情况只在链路异常时出现。
+ */
+static void async_expire(AT_Handler_t *handle)
+{
+    uint32_t now = osKernelGetTickCount();
+
+    for (;;)
+    {
+        AT_AsyncSlot_t slot;
+        bool expired = false;
+
+        osMutexAcquire(handle->async_mutex, osWaitForever);
+        for (uint8_t i = 0; i < handle->async_count; i++)
+        {
+            if ((int32_t)(now - handle->async_slots[i].deadline) >= 0)
+            {
+                expired = async_take(handle, i, &slot);
+                break;
+            }
+        }
+        osMutexRelease(handle->async_mutex);
+
+        if (!expired)
+        {
+            return;
+        }
+        async_finish(handle, &slot, AT_TIMEOUT, 0);
+    }
+}
 
 /**
  * @brief [内部] AT 接收和解析任务
+ * @details
+ *        事件驱动：任务阻塞在线程标志上，由 `AT_UartIdleCallback` 在写入环形缓冲区后唤醒，
+ *        数据到达后立即解析，没有轮询延迟；空闲时不占用CPU。
+ *        有在途异步命令时，阻塞时间限制为距最早截止时刻的时间，以便及时判定超时。
  */
 static void at_rx_task(void *argument)
 {
     AT_Handler_t *handle = (AT_Handler_t *)argument;
     char line_buffer[AT_RESPONSE_LINE_BUFFER_SIZE];
-    uint16_t line_pos = 0;
+    SpscRing_LineReader_t reader = {
+        .buf = line_buffer,
+        .size = sizeof(line_buffer),
+    };
 
     while (1)
     {
-        if (handle->ring_buffer_head == handle->ring_buffer_tail)
+        // 等待新数据 (或新的在途命令)；标志在任务忙于解析时置位也不会丢失，下一轮立即返回
+        osThreadFlagsWait(AT_RX_FLAG_DATA | AT_RX_FLAG_ASYNC, osFlagsWaitAny, async_wait_time(handle));
+
+        if (handle->async_count > 0)
         {
-            // 缓冲区为空，等待
-            osDelay(10);
-            continue;
+            async_expire(handle);
         }
 
-        while (handle->ring_buffer_head != handle->ring_buffer_tail)
+        // 按行取出并解析 (行结束符 '\r'/'\n' 按字扫描，行内容整段拷贝)
+        while (SpscRing_ReadLine(&handle->rx_ring, &reader))
         {
-            char c = handle->ring_buffer[handle->ring_buffer_tail];
-            handle->ring_buffer_tail = (handle->ring_buffer_tail + 1) % handle->ring_buffer_size;
+            process_line(handle, line_buffer);
+        }
 
-            if (c == '\n' || c == '\r')
+        // 数据模式的 '>' 提示符不带换行，停留在未结束的半行中
+        if (handle->prompt_pending && reader.len > 0)
+        {
+            line_buffer[reader.len] = '\0';
+            if (prompt_check(handle, line_buffer))
             {
-                if (line_pos > 0)
-                {
-                    line_buffer[line_pos] = '\0';
-                    process_line(handle, line_buffer);
-                    line_pos = 0;
-                }
-            }
-            else
-            {
-                if (line_pos < sizeof(line_buffer) - 1)
-                {
-                    line_buffer[line_pos++] = c;
-                }
+                reader.len = 0;
             }
         }
     }
@@ -350,18 +1233,15 @@ void AT_UartIdleCallback(AT_Handler_t *handle, UART_HandleTypeDef *huart, uint16
     // 步骤2: 处理刚刚在 `completed_buffer` 中接收到的数据
     if (size > 0)
     {
-        // 将数据从DMA缓冲区拷贝到环形缓冲区，后续由 `at_rx_task` 进行解析
-        uint16_t head = handle->ring_buffer_head;
-        uint16_t len_to_copy = (head + size > handle->ring_buffer_size) ? (handle->ring_buffer_size - head) : size;
-        
-        memcpy(&handle->ring_buffer[head], completed_buffer, len_to_copy);
+        // 将数据从DMA缓冲区整段拷贝到环形缓冲区，后续由 `at_rx_task` 进行解析
+        // (缓冲区满时丢弃放不下的部分，计入 rx_ring.dropped，不会覆盖尚未解析的数据)
+        SpscRing_Write(&handle->rx_ring, completed_buffer, size);
 
-        if (len_to_copy < size)
+        // 唤醒接收任务进行解析
+        if (handle->rx_task_handle)
         {
-            memcpy(&handle->ring_buffer[0], &completed_buffer[len_to_copy], size - len_to_copy);
+            osThreadFlagsSet(handle->rx_task_handle, AT_RX_FLAG_DATA);
         }
-        
-        handle->ring_buffer_head = (handle->ring_buffer_head + size) % handle->ring_buffer_size;
     }
 }
 
@@ -379,7 +1259,9 @@ void AT_UartTxCpltCallback(AT_Handler_t *handle, UART_HandleTypeDef *huart)
 /**
  * @brief  [核心] 解析收到的单行响应或URC
  * @details 此函数是AT任务的核心处理逻辑，它按照以下顺序对传入的行进行解析：
- *          1. **URC优先**: 检查该行是否匹配URC注册表中的任何前缀。如果是，则调用对应的回调函数并立即返回。
+ *          0. **异步结果**: 如果有在途的异步命令，且该行以其结果前缀开头 (如 "+HMPUB OK")，则按发送顺序
+ *             完成最早的那条命令并返回。
+ *          1. **URC优先**: 沿注册时编译好的前缀树检查该行是否以某个URC前缀开头。如果是，则调用对应的回调函数并立即返回。
  *             这可以确保URC事件（如模组重启）得到最优先处理，并且不会被错误地判断为其他响应。
  *          2. **最终响应**: 如果不是URC，则检查是否为命令的最终响应。此处的逻辑经过增强，可以兼容：
  *             - 标准响应: "OK", "ERROR"
@@ -401,26 +1283,33 @@ static void process_line(AT_Handler_t *handle, const char *line)
         return; // 是空行，直接返回
     }
 
+    // 数据模式提示符 (模组在 '>' 之后补发了换行的情况)
+    if (prompt_check(handle, line))
+    {
+        return;
+    }
+
+    // 步骤0：在途异步命令的结果URC (必须先于最终响应判断，否则 "+HMPUB OK" 会被当成当前同步命令的 OK)
+    if (handle->async_count > 0 && async_match_result(handle, line))
+    {
+        return;
+    }
+
     // 步骤1：优先检查是否为已注册的URC
-    if (handle->urc_table)
+    const AT_URC_t *urc_entry = urc_lookup(handle, line);
+    if (urc_entry)
     {
-        const AT_URC_t *urc_entry = handle->urc_table;
-        for (uint8_t i = 0; i < handle->urc_table_size; i++, urc_entry++)
+        if (urc_entry->callback)
         {
-            if (strstr(line, urc_entry->urc_prefix))
-            {
-                if (urc_entry->callback)
-                {
-                    urc_entry->callback(line);
-                }
-                return; // URC 已处理，此行任务结束
-            }
+            urc_entry->callback(line);
         }
+        return; // URC 已处理，此行任务结束
     }
 
     // 步骤2：如果不是URC，再检查是否为最终响应
     // 兼容 "OK" 和 "+CMD OK" 这两种成功响应格式
     size_t len = strlen(line);
+    handle->stats_rx += (uint16_t)(len + 2); // 最终响应和中间响应都归属于当前命令 (含 "\r\n")
     if ((strcmp(line, "OK") == 0) || (len > 3 && line[0] == '+' && strcmp(line + len - 3, " OK") == 0))
     {
         handle->last_status = AT_OK;
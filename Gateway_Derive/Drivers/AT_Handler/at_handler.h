@@ -2,8 +2,8 @@
  * @file at_handler.h
  * @author Your Name
  * @brief 高性能、双缓冲、线程安全的AT命令处理器
- * @version 3.0
- * @date 2025-06-09
+ * @version 3.5
+ * @date 2025-07-21
  *
  * @copyright Copyright (c) 2025
  *
@@ -11,6 +11,35 @@
  *      - 升级为软件双缓冲DMA接收机制，实现无缝数据接收，极大提升高波特率下的稳定性。
  *      - 全面适配STM32U5系列HAL库，使用 `HAL_UARTEx_ReceiveToIdle_DMA` API。
  *      - 优化了解析逻辑，兼容多种AT响应格式，增强了驱动的通用性和健壮性。
+ *
+ * @par V3.1 (2025-07-16)
+ *      - 新增异步命令窗口：`AT+HMPUB` 等命令在命令帧 (及负载) 发送完毕后即释放命令锁，最多
+ *        `AT_ASYNC_WINDOW_SIZE` 条同时在途，其结果URC (例如 "+HMPUB OK") 按发送顺序
+ *        与在途命令配对后，通过回调通知调用者。上报吞吐量不再受制于每条发布的往返时延。
+ *        (L610 对 AT+HMPUB 不回 "OK"，只回结果URC，因此不能等模组"接受"后再释放命令锁。)
+ *
+ * @par V3.2 (2025-07-18)
+ *      - 接收任务改为事件驱动：UART空闲中断写入环形缓冲区后通过线程标志唤醒任务，
+ *        取代原先每10ms一次的轮询。响应和URC不再有最多10ms的额外延迟，空闲时CPU可以进入低功耗。
+ *      - 环形缓冲区改用无锁SPSC实现 (`spsc_ring`)：容量为2的幂、带内存序保证、整段拷贝，
+ *        接收任务按字扫描行结束符并整段复制，不再逐字节取模搬运。缓冲区满时丢弃新数据而不是覆盖未读数据。
+ *
+ * @par V3.3 (2025-07-19)
+ *      - URC分发改为前缀树：`AT_RegisterURCCallbacks` 把URC表编译成一棵字符前缀树，
+ *        每一行只需从头走一遍即可判定是哪条URC，耗时与URC表大小无关。
+ *        另有一张按首字节索引的位图，"OK"、"ERROR" 这类普通响应在第一个字节就被排除。
+ *      - URC匹配语义由"行内任意位置包含" (`strstr`) 改为"行首前缀匹配"；多个前缀都匹配时取最长的一个。
+ *
+ * @par V3.4 (2025-07-20)
+ *      - 新增"数据模式"命令 (`AT_ExecuteDataCommand` / `AT_ExecuteAsyncDataCommand`)：命令头在发送缓冲区中，
+ *        负载由调用者以若干区段 (`AT_TxSegment_t`) 给出，DMA直接从各自的缓冲区读取，不经过拷贝，
+ *        长度也不受 `AT_TX_BUFFER_SIZE` 限制。
+ *      - 模组需要 '>' 提示符时，先发命令头，收到提示符后再发负载；否则命令头和负载作为一次
+ *        GPDMA链表 (scatter-gather) 传输连续发出。
+ *
+ * @par V3.5 (2025-07-21)
+ *      - 新增按命令分类的时延统计和事务追踪 (`at_stats`)：同步命令、异步命令 (到结果URC为止) 和
+ *        登记了结果的原始命令在完成时记录耗时、结果和收发字节数，用于校准各命令的超时时间。
  * 
  * @par 模块功能:
  *      - 基于FreeRTOS，提供完全线程安全的AT命令处理框架。
@@ -29,6 +58,8 @@ extern "C" {
 
 #include "stm32u5xx_hal.h"
 #include "cmsis_os2.h"
+#include <stdbool.h>
+#include "spsc_ring.h"
 
 // --- Public Configuration ---
 
@@ -37,6 +68,19 @@ extern "C" {
 #define AT_RESPONSE_LINE_BUFFER_SIZE    512
 #define AT_TX_BUFFER_SIZE               1024
 
+// 数据模式命令的负载区段数上限 (每个区段一个GPDMA链表节点)
+#define AT_TX_MAX_SEGMENTS              3
+// 数据模式命令等待 '>' 提示符的超时时间 (毫秒)
+#define AT_DATA_PROMPT_TIMEOUT_MS       3000
+
+// 异步命令窗口：同时等待结果URC的命令数上限
+#define AT_ASYNC_WINDOW_SIZE            4
+// 在途记录总数，比窗口多出的部分留给不经过窗口的 `AT_SendRawAsync` (在AT接收任务中调用)
+#define AT_ASYNC_MAX_SLOTS              (AT_ASYNC_WINDOW_SIZE + 2)
+
+// URC前缀树的节点数上限 (约等于所有URC前缀的字符总数，共享的前缀只占一份)
+#define AT_URC_MAX_NODES                96
+
 // --- Public Enums and Structs ---
 
 /**
@@ -50,6 +94,50 @@ typedef enum {
     AT_UART_ERROR   // UART 发送或接收配置错误
 } AT_Status_t;
 
+/**
+ * @brief 异步命令完成回调函数指针类型
+ * @note  在AT接收任务的上下文中调用，不能在其中发送需要等待响应的AT命令。
+ * @param tag    提交命令时分配的标签
+ * @param status 结果: AT_OK (结果URC为成功), AT_ERROR (结果URC为失败), AT_TIMEOUT (超时未收到结果)
+ * @param ctx    提交命令时传入的用户上下文
+ */
+typedef void (*at_async_callback_t)(uint16_t tag, AT_Status_t status, void* ctx);
+
+/**
+ * @brief 一条在途异步命令的记录
+ */
+typedef struct {
+    const char*         result_prefix; ///< 结果URC的前缀，例如 "+HMPUB"
+    at_async_callback_t callback;      ///< 完成回调 (可为NULL)
+    void*               ctx;           ///< 用户上下文
+    uint32_t            deadline;      ///< 等待结果的截止时刻 (系统节拍)
+    uint32_t            start_tick;    ///< 发送时刻 (系统节拍，用于时延统计)
+    uint16_t            tag;           ///< 标签 (非0，单调递增)
+    uint16_t            tx_bytes;      ///< 发送字节数 (用于时延统计)
+    uint8_t             stats_cmd;     ///< 统计下标 (见 at_stats.h)
+    bool                windowed;      ///< 是否占用了异步窗口 (完成时归还)
+} AT_AsyncSlot_t;
+
+/**
+ * @brief 数据模式命令的一个负载区段
+ * @note  在命令返回前，区段所指的缓冲区必须保持有效且不被修改 (DMA直接从中读取)。
+ */
+typedef struct {
+    const void* data;  ///< 区段起始地址
+    uint16_t    len;   ///< 区段长度 (为0的区段会被跳过)
+} AT_TxSegment_t;
+
+/**
+ * @brief URC前缀树节点 (由 `AT_RegisterURCCallbacks` 生成，下标0为根节点)
+ * @note  所有下标均为节点数组/URC表中的下标，0xFF 表示"无"。
+ */
+typedef struct {
+    char    ch;       ///< 本节点对应的字符
+    uint8_t child;    ///< 第一个子节点
+    uint8_t sibling;  ///< 下一个兄弟节点
+    uint8_t urc;      ///< 到本节点为止恰好是哪条URC的完整前缀
+} AT_URC_Node_t;
+
 /**
  * @brief AT模块的主句柄结构体
  * @note  此结构体由 AT_Init 函数进行全自动初始化，用户无需直接操作其成员。
@@ -67,6 +155,9 @@ typedef struct {
     // --- DMA 发送机制 ---
     uint8_t*            tx_buffer;         // DMA 发送缓冲区
     uint16_t            tx_buffer_size;    // DMA 发送缓冲区大小
+    bool                tx_list_mode;      // 发送DMA通道当前处于链表模式 (下一次普通发送前切回)
+    volatile bool       prompt_pending;    // 正在等待数据模式的 '>' 提示符
+    volatile bool       prompt_received;   // 已收到提示符 (区分提示符和提前到达的最终响应)
 
     // --- 双缓冲DMA接收机制 ---
     uint8_t*            dma_rx_buffer_a;   // DMA 接收缓冲区 A
@@ -75,20 +166,30 @@ typedef struct {
     uint16_t            dma_rx_buffer_size;  // 单个DMA接收缓冲区大小
     
     // --- 内部环形缓冲区，用于解耦 ---
-    uint8_t*            ring_buffer;       // 环形缓冲区指针
-    uint16_t            ring_buffer_size;    // 环形缓冲区大小
-    volatile uint16_t   ring_buffer_head;  // 环形缓冲区头指针（写入）
-    volatile uint16_t   ring_buffer_tail;  // 环形缓冲区尾指针（读取）
+    uint8_t*            ring_buffer;       // 环形缓冲区存储区
+    SpscRing_t          rx_ring;           // 无锁环形缓冲区 (生产者: UART空闲中断; 消费者: 接收任务)
     
     // 响应处理
     char*               p_response_buf;    // 指向用户提供的用于存储响应的缓冲区
     uint16_t            response_buf_size; // 用户缓冲区的总大小
     uint16_t            response_len;      // 当前已存入用户缓冲区的响应长度
     AT_Status_t         last_status;       // 上一个命令的执行状态
+    uint16_t            stats_rx;          // 当前命令已收到的响应字节数 (用于时延统计)
 
     // URC (Unsolicited Result Code) 处理
     const void*         urc_table;         // 指向 URC 回调函数表的指针
     uint8_t             urc_table_size;    // URC 表的大小
+    AT_URC_Node_t       urc_nodes[AT_URC_MAX_NODES]; // 由URC表编译出的前缀树
+    uint8_t             urc_node_count;    // 已使用的节点数
+    uint32_t            urc_first_char[8]; // 256位位图：哪些字节可以作为URC的首字符
+
+    // 异步命令窗口
+    osMutexId_t         async_mutex;       // 保护在途记录
+    osSemaphoreId_t     async_window_sem;  // 窗口剩余名额 (初始为 AT_ASYNC_WINDOW_SIZE)
+    AT_AsyncSlot_t      async_slots[AT_ASYNC_MAX_SLOTS]; // 在途记录，按发送顺序排列
+    volatile uint8_t    async_count;       // 在途记录数
+    uint16_t            async_next_tag;    // 下一个分配的标签
+    uint16_t            async_accepting_tag; // 正在发送 (可能在等待 '>' 提示符) 的异步命令标签 (0: 无)
 
 } AT_Handler_t;
 
@@ -147,6 +248,125 @@ void AT_DeInit(AT_Handler_t* handle);
 AT_Status_t AT_SendCommand(AT_Handler_t* handle, const char* cmd, uint32_t timeout_ms, 
                            char* response_buf, uint16_t buf_len);
 
+/**
+ * @brief 开始一条"原地构建"的AT命令：获取命令锁并返回发送缓冲区指针。
+ * @details
+ *        用于较长的命令 (例如携带JSON负载的 AT+HMPUB)。调用者可以直接把命令写入
+ *        返回的DMA发送缓冲区，省去中间缓冲区和额外的拷贝。成功返回后，调用者
+ *        **必须** 以 `AT_ExecuteCommand` 或 `AT_AbortCommand` 之一结束本次命令，
+ *        否则命令锁不会被释放。
+ * @param handle AT句柄
+ * @param timeout_ms 等待命令锁及上一次DMA发送完成的超时时间 (毫秒)
+ * @param capacity (输出, 可为NULL) 可写入的最大命令长度 (已扣除 "\r\n")
+ * @retval char* 发送缓冲区指针；超时返回 NULL
+ */
+char* AT_BeginCommand(AT_Handler_t* handle, uint32_t timeout_ms, uint16_t* capacity);
+
+/**
+ * @brief 发送已通过 `AT_BeginCommand` 写入发送缓冲区的命令，并阻塞等待最终响应。
+ * @details 会自动追加 "\r\n"。无论结果如何，返回前都会释放命令锁。
+ * @param handle AT句柄
+ * @param cmd_len 已写入缓冲区的命令长度 (不含 "\r\n")
+ * @param timeout_ms 等待响应的超时时间 (毫秒)
+ * @param response_buf (可选, 可为NULL) 用于存储中间响应内容的缓冲区
+ * @param buf_len response_buf 的大小
+ * @retval AT_Status_t 命令执行的状态
+ */
+AT_Status_t AT_ExecuteCommand(AT_Handler_t* handle, uint16_t cmd_len, uint32_t timeout_ms,
+                              char* response_buf, uint16_t buf_len);
+
+/**
+ * @brief 放弃一条通过 `AT_BeginCommand` 开始的命令 (例如负载构建失败)，并释放命令锁。
+ * @param handle AT句柄
+ */
+void AT_AbortCommand(AT_Handler_t* handle);
+
+/**
+ * @brief 开始一条"原地构建"的异步命令：先占用一个异步窗口名额，再获取命令锁。
+ * @details
+ *        与 `AT_BeginCommand` 相同，但窗口已满时会先等待最早的在途命令完成。
+ *        成功返回后，调用者 **必须** 以 `AT_ExecuteAsyncCommand` 或 `AT_AbortAsyncCommand` 结束。
+ * @param handle AT句柄
+ * @param timeout_ms 等待窗口名额和命令锁的超时时间 (毫秒，两者分别计时)
+ * @param capacity (输出, 可为NULL) 可写入的最大命令长度 (已扣除 "\r\n")
+ * @retval char* 发送缓冲区指针；超时返回 NULL
+ */
+char* AT_BeginAsyncCommand(AT_Handler_t* handle, uint32_t timeout_ms, uint16_t* capacity);
+
+/**
+ * @brief 发送已写入发送缓冲区的异步命令，发送完毕后即返回，结果通过回调通知。
+ * @details
+ *        命令帧经DMA发送完毕后，释放命令锁并返回 AT_OK，此时其他命令 (包括下一条发布)
+ *        可以立即发送。不等待模组回 "OK"：L610 对 AT+HMPUB 只回结果URC。
+ *        在途记录只跟踪最终结果：以 `result_prefix` 开头的第一条未被认领的行即为本命令的结果。
+ *        由于模组的结果URC不携带任何编号，结果按发送顺序与在途命令配对。
+ * @note  模组若以不带前缀的 "ERROR" 拒绝命令 (例如语法错误)，该行不会与本命令配对，
+ *        本命令在 `result_timeout_ms` 后以 AT_TIMEOUT 完成。
+ * @param handle AT句柄
+ * @param cmd_len 已写入缓冲区的命令长度 (不含 "\r\n")
+ * @param result_prefix 结果URC的前缀，必须指向静态字符串
+ * @param result_timeout_ms 从发送起等待结果的超时时间 (毫秒)
+ * @param callback 完成回调 (可为NULL)
+ * @param ctx 传给回调的用户上下文
+ * @param tag (输出, 可为NULL) 本命令的标签
+ * @retval AT_Status_t AT_OK: 已发送，回调 **保证** 被调用且仅调用一次；
+ *         其他: 未发送，回调不会被调用
+ */
+AT_Status_t AT_ExecuteAsyncCommand(AT_Handler_t* handle, uint16_t cmd_len, const char* result_prefix,
+                                   uint32_t result_timeout_ms, at_async_callback_t callback, void* ctx,
+                                   uint16_t* tag);
+
+/**
+ * @brief 以数据模式发送命令：命令头取自发送缓冲区，负载直接从调用者的缓冲区发出，并等待最终响应。
+ * @details
+ *        与 `AT_ExecuteCommand` 相同 (以 `AT_BeginCommand` 开始，自动追加 "\r\n"，返回前释放命令锁)，
+ *        但命令头之后还要发送 `data` 中的负载区段：
+ *        - `wait_prompt` 为 true: 先发命令头，等到模组回 '>' 后再发负载。若模组没有给出提示符
+ *          而是直接回了最终响应 (例如 "ERROR")，负载不会发送。
+ *        - `wait_prompt` 为 false: 命令头和负载作为一次GPDMA链表传输连续发出。
+ * @param handle AT句柄
+ * @param cmd_len 已写入缓冲区的命令头长度 (不含 "\r\n")
+ * @param data 负载区段数组
+ * @param data_count 区段数 (不超过 AT_TX_MAX_SEGMENTS)
+ * @param wait_prompt 是否等待 '>' 提示符
+ * @param timeout_ms 等待最终响应的超时时间 (毫秒)
+ * @param response_buf (可选, 可为NULL) 用于存储中间响应内容的缓冲区
+ * @param buf_len response_buf 的大小
+ * @retval AT_Status_t 命令执行的状态
+ */
+AT_Status_t AT_ExecuteDataCommand(AT_Handler_t* handle, uint16_t cmd_len, const AT_TxSegment_t* data,
+                                  uint8_t data_count, bool wait_prompt, uint32_t timeout_ms,
+                                  char* response_buf, uint16_t buf_len);
+
+/**
+ * @brief `AT_ExecuteDataCommand` 的异步版本 (以 `AT_BeginAsyncCommand` 开始)。
+ * @details 负载发送完毕后即返回，结果的配对与回调规则同 `AT_ExecuteAsyncCommand`。
+ *          `wait_prompt` 为 true 时，若模组没有给出 '>' 而是直接回了结果行，该结果即为本命令的结果。
+ */
+AT_Status_t AT_ExecuteAsyncDataCommand(AT_Handler_t* handle, uint16_t cmd_len, const AT_TxSegment_t* data,
+                                       uint8_t data_count, bool wait_prompt, const char* result_prefix,
+                                       uint32_t result_timeout_ms, at_async_callback_t callback, void* ctx,
+                                       uint16_t* tag);
+
+/**
+ * @brief 放弃一条通过 `AT_BeginAsyncCommand` 开始的命令，释放命令锁并归还窗口名额。
+ * @param handle AT句柄
+ */
+void AT_AbortAsyncCommand(AT_Handler_t* handle);
+
+/**
+ * @brief 等待所有占用窗口的异步命令完成 (回调均已返回)。
+ * @param handle AT句柄
+ * @param timeout_ms 超时时间 (毫秒)
+ * @retval AT_Status_t AT_OK: 窗口已清空; AT_TIMEOUT: 超时
+ */
+AT_Status_t AT_WaitAsyncIdle(AT_Handler_t* handle, uint32_t timeout_ms);
+
+/**
+ * @brief 查询当前在途的异步命令数
+ */
+uint8_t AT_GetAsyncInFlight(AT_Handler_t* handle);
+
 /**
  * @brief 发送一个简单的AT命令，它只关心最终的 "OK" 或 "ERROR"。
  * @details
@@ -170,6 +390,22 @@ AT_Status_t AT_SendBasicCommand(AT_Handler_t* handle, const char* cmd, uint32_t
  */
 AT_Status_t AT_SendRaw(AT_Handler_t* handle, const char* cmd);
 
+/**
+ * @brief "发后即忘"地发送一条原始命令，同时登记其结果URC。
+ * @details
+ *        与 `AT_SendRaw` 相同，但会为命令登记一条在途记录 (不占用异步窗口)，使它的结果URC
+ *        不会被误认为其他在途命令的结果。可在AT接收任务中调用 (例如回复云端命令)。
+ * @param handle AT句柄
+ * @param cmd 要发送的完整AT命令字符串 (需要自行包含 \\r\\n)
+ * @param result_prefix 结果URC的前缀，必须指向静态字符串
+ * @param result_timeout_ms 等待结果的超时时间 (毫秒)
+ * @param callback 完成回调 (可为NULL)
+ * @param ctx 传给回调的用户上下文
+ * @retval AT_Status_t AT_OK: 已发送并登记; AT_BUFFER_FULL: 没有空闲记录，命令 **未发送**
+ */
+AT_Status_t AT_SendRawAsync(AT_Handler_t* handle, const char* cmd, const char* result_prefix,
+                            uint32_t result_timeout_ms, at_async_callback_t callback, void* ctx);
+
 /**
  * @brief 串口接收事件回调函数 (由应用层在 `HAL_UARTEx_RxEventCallback` 中调用)
  * @note  这是驱动整个模块数据接收的核心，必须被正确调用。
@@ -189,11 +425,16 @@ void AT_UartTxCpltCallback(AT_Handler_t *handle, UART_HandleTypeDef *huart);
 
 /**
  * @brief 注册一个URC回调函数表。
+ * @details
+ *        表会被编译成前缀树保存在句柄中，表本身必须在整个生命周期内有效 (通常为 static const)。
+ *        前缀从行首开始匹配，不能为空；多个前缀都匹配时调用最长的那个，相同前缀以先出现者为准。
+ * @note  应在模组开始上报URC之前 (即 AT_Init 之后立即) 调用。
  * @param handle AT句柄
  * @param table 指向 AT_URC_t 结构体数组的指针
  * @param table_size 数组中的元素数量
+ * @return bool false: 前缀总长度超出 `AT_URC_MAX_NODES`，或存在空前缀 (此时不注册任何URC)
  */
-void AT_RegisterURCCallbacks(AT_Handler_t* handle, const AT_URC_t* table, uint8_t table_size);
+bool AT_RegisterURCCallbacks(AT_Handler_t* handle, const AT_URC_t* table, uint8_t table_size);
 
 /*
  * This function is removed as it's incompatible with the task-based processing logic.
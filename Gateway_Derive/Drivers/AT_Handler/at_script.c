@@ -0,0 +1,90 @@
+#include "at_script.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Public Functions ----------------------------------------------------------*/
+
+/**
+ * @brief 执行一段AT命令脚本 (实现)
+ */
+bool AT_Script_Run(AT_Handler_t *handle, const AT_ScriptStep_t *steps, uint8_t step_count, AT_ScriptResult_t *result)
+{
+    AT_ScriptResult_t local_result;
+    if (result == NULL)
+    {
+        result = &local_result;
+    }
+    memset(result, 0, sizeof(AT_ScriptResult_t));
+
+    char response[AT_SCRIPT_RESPONSE_SIZE];
+    uint32_t script_start = osKernelGetTickCount();
+    int16_t index = 0;
+
+    while (index >= 0 && index < step_count)
+    {
+        if (result->trace_count >= AT_SCRIPT_MAX_TRACE)
+        {
+            printf("[Script] Step limit reached, aborting.\r\n");
+            index = AT_SCRIPT_ABORT;
+            break;
+        }
+
+        const AT_ScriptStep_t *step = &steps[index];
+        AT_ScriptTrace_t *trace = &result->trace[result->trace_count++];
+        uint8_t max_attempts = (step->attempts > 0) ? step->attempts : 1;
+        uint32_t step_start = osKernelGetTickCount();
+
+        trace->step = (uint8_t)index;
+        printf("[Script] %s: %s\r\n", step->name, step->cmd);
+
+        while (trace->attempts < max_attempts)
+        {
+            if (trace->attempts > 0 && step->retry_delay_ms > 0)
+            {
+                osDelay(step->retry_delay_ms);
+            }
+            trace->attempts++;
+
+            trace->status = AT_SendCommand(handle, step->cmd, step->timeout_ms, response, sizeof(response));
+            if (trace->status == AT_OK && (step->match == NULL || step->match(response)))
+            {
+                trace->success = true;
+                break;
+            }
+        }
+
+        trace->elapsed_ms = osKernelGetTickCount() - step_start;
+
+        int8_t target = trace->success ? step->on_success : step->on_failure;
+        if (target == AT_SCRIPT_NEXT)
+        {
+            index++;
+        }
+        else
+        {
+            index = target; // 下标或 DONE/ABORT
+        }
+    }
+
+    // 跳出表尾视为正常结束
+    result->success = (index != AT_SCRIPT_ABORT);
+    result->total_ms = osKernelGetTickCount() - script_start;
+    return result->success;
+}
+
+/**
+ * @brief 打印脚本执行结果 (实现)
+ */
+void AT_Script_PrintResult(const AT_ScriptStep_t *steps, const AT_ScriptResult_t *result)
+{
+    printf("[Script] %s in %lu ms:\r\n", result->success ? "Completed" : "FAILED", (unsigned long)result->total_ms);
+    for (uint8_t i = 0; i < result->trace_count; i++)
+    {
+        const AT_ScriptTrace_t *trace = &result->trace[i];
+        printf("  %-16s x%u  %-4s %6lu ms\r\n",
+               steps[trace->step].name,
+               trace->attempts,
+               trace->success ? "OK" : "FAIL",
+               (unsigned long)trace->elapsed_ms);
+    }
+}
@@ -0,0 +1,111 @@
+/**
+ * @file at_script.h
+ * @author Your Name
+ * @brief 表驱动的AT命令脚本引擎 - 头文件
+ * @version 1.0
+ * @date 2025-07-17
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @par 模块功能:
+ *      - 把一段AT命令序列 (例如连接云平台的拨号、建链流程) 描述为一张静态步骤表，
+ *        由引擎逐步执行，而不是在业务代码中手写一连串的 if/for/osDelay。
+ *      - 每一步可以单独配置超时、尝试次数、重试间隔，以及对响应内容的判定函数。
+ *      - 每一步根据成功/失败跳转到表中任意一步，或直接结束脚本 (提前退出)，
+ *        从而在同一张表里表达"快速路径"和"完整路径"。
+ *      - 记录每一步的执行次数和耗时，便于分析连接时间都花在了哪里。
+ */
+
+#ifndef __AT_SCRIPT_H
+#define __AT_SCRIPT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "at_handler.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// --- Public Configuration ---
+
+#define AT_SCRIPT_RESPONSE_SIZE  128 // 单步响应缓冲区大小 (供判定函数检查)
+#define AT_SCRIPT_MAX_TRACE      16  // 单次执行最多记录/执行的步数，防止跳转成环
+
+// --- 跳转目标 (非负值为步骤表中的下标) ---
+#define AT_SCRIPT_NEXT   (-1) // 继续执行下一步
+#define AT_SCRIPT_DONE   (-2) // 脚本成功结束
+#define AT_SCRIPT_ABORT  (-3) // 脚本失败结束
+
+// --- Public Types ---
+
+/**
+ * @brief 响应判定函数
+ * @param response 本步命令收到的中间响应 (不含最终的 OK)
+ * @return bool true: 满足本步的期望条件
+ */
+typedef bool (*at_script_match_t)(const char* response);
+
+/**
+ * @brief 脚本中的一步
+ */
+typedef struct {
+    const char*       name;           ///< 步骤名称 (用于日志和耗时统计)
+    const char*       cmd;            ///< 要发送的AT命令 (无需包含 \\r\\n)
+    uint32_t          timeout_ms;     ///< 单次尝试的响应超时
+    uint8_t           attempts;       ///< 最多尝试次数 (0 按 1 处理)
+    uint32_t          retry_delay_ms; ///< 两次尝试之间的间隔
+    at_script_match_t match;          ///< 响应判定函数；NULL 表示收到 OK 即成功
+    int8_t            on_success;     ///< 成功后的跳转目标
+    int8_t            on_failure;     ///< 所有尝试都失败后的跳转目标
+} AT_ScriptStep_t;
+
+/**
+ * @brief 一步的执行记录
+ */
+typedef struct {
+    uint8_t     step;       ///< 步骤下标
+    uint8_t     attempts;   ///< 实际尝试次数
+    AT_Status_t status;     ///< 最后一次尝试的AT状态
+    bool        success;    ///< 本步是否成功
+    uint32_t    elapsed_ms; ///< 本步总耗时 (含重试间隔)
+} AT_ScriptTrace_t;
+
+/**
+ * @brief 一次脚本执行的结果
+ */
+typedef struct {
+    bool             success;                    ///< 脚本是否以 AT_SCRIPT_DONE 结束
+    uint32_t         total_ms;                   ///< 总耗时
+    uint8_t          trace_count;                ///< 已执行的步数
+    AT_ScriptTrace_t trace[AT_SCRIPT_MAX_TRACE]; ///< 按执行顺序排列的每步记录
+} AT_ScriptResult_t;
+
+// --- Public Function Prototypes ---
+
+/**
+ * @brief 执行一段AT命令脚本
+ * @details
+ *        从第0步开始执行，每步根据结果跳转。脚本在以下情况结束：
+ *        跳转到 AT_SCRIPT_DONE (成功)、AT_SCRIPT_ABORT (失败)、跳出表尾 (视为成功)，
+ *        或执行步数达到 AT_SCRIPT_MAX_TRACE (视为失败)。
+ * @param handle AT句柄
+ * @param steps 步骤表
+ * @param step_count 步骤数
+ * @param result (输出, 可为NULL) 执行结果与每步耗时
+ * @retval bool 脚本是否成功
+ */
+bool AT_Script_Run(AT_Handler_t* handle, const AT_ScriptStep_t* steps, uint8_t step_count, AT_ScriptResult_t* result);
+
+/**
+ * @brief 打印脚本执行结果 (每步的尝试次数、状态和耗时)
+ * @param steps 执行时使用的步骤表 (用于获取步骤名称)
+ * @param result 执行结果
+ */
+void AT_Script_PrintResult(const AT_ScriptStep_t* steps, const AT_ScriptResult_t* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AT_SCRIPT_H */
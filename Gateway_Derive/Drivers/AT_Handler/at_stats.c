@@ -0,0 +1,264 @@
+#include "at_stats.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Private Variables ---------------------------------------------------------*/
+
+// 统计数据在同步命令的调用者任务和AT接收任务 (异步结果) 中更新，由互斥锁保护。
+// 数据不属于某个AT句柄，模组恢复流程重建句柄时不会被清零。
+static osMutexId_t s_stats_mutex = NULL;
+static AT_CmdStats_t s_cmds[AT_STATS_MAX_COMMANDS];
+static uint8_t s_cmd_count = 0;
+static uint32_t s_untracked = 0;                 // 因统计项已满而未统计的事务数
+static AT_Transaction_t s_trace[AT_TRACE_DEPTH];
+static uint32_t s_trace_total = 0;               // 累计写入的事务数，下一条写入 s_trace[s_trace_total % AT_TRACE_DEPTH]
+
+/* Private Function Prototypes -----------------------------------------------*/
+static uint16_t key_length(const char *cmd, uint16_t len);
+static const char *status_name(uint8_t status);
+
+/* Public Functions ----------------------------------------------------------*/
+
+/**
+ * @brief 初始化统计模块 (实现)
+ */
+void AT_Stats_Init(void)
+{
+    if (s_stats_mutex == NULL)
+    {
+        s_stats_mutex = osMutexNew(NULL);
+    }
+}
+
+/**
+ * @brief 清除统计数据 (实现)
+ */
+void AT_Stats_Reset(void)
+{
+    osMutexAcquire(s_stats_mutex, osWaitForever);
+    memset(s_cmds, 0, sizeof(s_cmds));
+    memset(s_trace, 0, sizeof(s_trace));
+    s_cmd_count = 0;
+    s_untracked = 0;
+    s_trace_total = 0;
+    osMutexRelease(s_stats_mutex);
+}
+
+/**
+ * @brief 登记一条即将发送的命令 (实现)
+ */
+uint8_t AT_Stats_Begin(const char *cmd, uint16_t len)
+{
+    uint16_t key_len = key_length(cmd, len);
+    uint8_t index = AT_STATS_NONE;
+
+    osMutexAcquire(s_stats_mutex, osWaitForever);
+    for (uint8_t i = 0; i < s_cmd_count; i++)
+    {
+        if (strncmp(s_cmds[i].key, cmd, key_len) == 0 && s_cmds[i].key[key_len] == '\0')
+        {
+            index = i;
+            break;
+        }
+    }
+    if (index == AT_STATS_NONE && s_cmd_count < AT_STATS_MAX_COMMANDS)
+    {
+        index = s_cmd_count++;
+        memcpy(s_cmds[index].key, cmd, key_len);
+        s_cmds[index].key[key_len] = '\0';
+    }
+
+    if (index == AT_STATS_NONE)
+    {
+        s_untracked++;
+    }
+    else if (s_cmds[index].last_failed)
+    {
+        s_cmds[index].retries++;
+    }
+    osMutexRelease(s_stats_mutex);
+    return index;
+}
+
+/**
+ * @brief 记录一条事务的结果 (实现)
+ */
+void AT_Stats_End(uint8_t cmd, uint32_t start_tick, AT_Status_t status,
+                  uint16_t tx_bytes, uint16_t rx_bytes, bool async)
+{
+    if (cmd >= AT_STATS_MAX_COMMANDS)
+    {
+        return;
+    }
+    uint32_t elapsed = osKernelGetTickCount() - start_tick;
+
+    osMutexAcquire(s_stats_mutex, osWaitForever);
+    AT_CmdStats_t *stats = &s_cmds[cmd];
+    stats->count++;
+    stats->tx_bytes += tx_bytes;
+    stats->rx_bytes += rx_bytes;
+    stats->last_failed = (status != AT_OK);
+
+    if (status == AT_TIMEOUT)
+    {
+        stats->timeouts++;
+    }
+    else
+    {
+        if (status != AT_OK)
+        {
+            stats->errors++;
+        }
+        LatencyHist_Add(&stats->latency, elapsed);
+    }
+
+    AT_Transaction_t *t = &s_trace[s_trace_total % AT_TRACE_DEPTH];
+    t->start_tick = start_tick;
+    t->elapsed_ms = elapsed;
+    t->tx_bytes = tx_bytes;
+    t->rx_bytes = rx_bytes;
+    t->cmd = cmd;
+    t->status = (uint8_t)status;
+    t->async = async;
+    s_trace_total++;
+    osMutexRelease(s_stats_mutex);
+}
+
+/**
+ * @brief 查询统计的命令种类数 (实现)
+ */
+uint8_t AT_Stats_GetCommandCount(void)
+{
+    return s_cmd_count;
+}
+
+/**
+ * @brief 读取一类命令的统计快照 (实现)
+ */
+bool AT_Stats_GetCommand(uint8_t index, AT_CmdStats_t *out)
+{
+    bool found = false;
+
+    osMutexAcquire(s_stats_mutex, osWaitForever);
+    if (index < s_cmd_count)
+    {
+        *out = s_cmds[index];
+        found = true;
+    }
+    osMutexRelease(s_stats_mutex);
+    return found;
+}
+
+/**
+ * @brief 读取事务追踪环 (实现)
+ */
+uint8_t AT_Stats_GetTrace(AT_Transaction_t *out, uint8_t max)
+{
+    osMutexAcquire(s_stats_mutex, osWaitForever);
+    uint32_t available = (s_trace_total < AT_TRACE_DEPTH) ? s_trace_total : AT_TRACE_DEPTH;
+    uint8_t count = (available < max) ? (uint8_t)available : max;
+    uint32_t first = s_trace_total - count; // 只取最新的 count 条
+    for (uint8_t i = 0; i < count; i++)
+    {
+        out[i] = s_trace[(first + i) % AT_TRACE_DEPTH];
+    }
+    osMutexRelease(s_stats_mutex);
+    return count;
+}
+
+/**
+ * @brief 通过调试串口打印统计数据 (实现)
+ * @details 逐项取快照后再打印，打印期间不持有锁，不会拖慢AT接收任务。
+ */
+void AT_Stats_Dump(void)
+{
+    AT_CmdStats_t stats;
+    uint8_t cmd_count = AT_Stats_GetCommandCount();
+
+    printf("[AT-Stats] %-14s %6s %4s %4s %4s %7s %7s %6s %6s %6s %6s\r\n",
+           "command", "n", "err", "tmo", "rty", "tx", "rx", "avg", "p50", "p95", "max");
+    for (uint8_t i = 0; i < cmd_count; i++)
+    {
+        if (!AT_Stats_GetCommand(i, &stats))
+        {
+            break;
+        }
+        printf("[AT-Stats] %-14s %6lu %4lu %4lu %4lu %7lu %7lu %6lu %6lu %6lu %6lu\r\n",
+               stats.key,
+               (unsigned long)stats.count, (unsigned long)stats.errors,
+               (unsigned long)stats.timeouts, (unsigned long)stats.retries,
+               (unsigned long)stats.tx_bytes, (unsigned long)stats.rx_bytes,
+               (unsigned long)LatencyHist_Mean(&stats.latency),
+               (unsigned long)LatencyHist_Percentile(&stats.latency, 50),
+               (unsigned long)LatencyHist_Percentile(&stats.latency, 95),
+               (unsigned long)stats.latency.max_ms);
+
+        // 只打印非空的桶: "下界:计数"
+        printf("[AT-Stats]   hist");
+        LatencyHist_PrintBuckets(&stats.latency);
+        printf("\r\n");
+    }
+    if (s_untracked > 0)
+    {
+        printf("[AT-Stats] %lu transaction(s) untracked (more than %d commands).\r\n",
+               (unsigned long)s_untracked, AT_STATS_MAX_COMMANDS);
+    }
+
+    // 追踪环逐条取出打印 (监控任务的栈很小，不整体拷贝)
+    uint32_t total = s_trace_total;
+    uint32_t first = (total > AT_TRACE_DEPTH) ? total - AT_TRACE_DEPTH : 0;
+    printf("[AT-Trace] last %lu transaction(s):\r\n", (unsigned long)(total - first));
+    for (uint32_t seq = first; seq < total; seq++)
+    {
+        AT_Transaction_t entry;
+        osMutexAcquire(s_stats_mutex, osWaitForever);
+        bool valid = (s_trace_total - seq <= AT_TRACE_DEPTH); // 打印期间可能已被新事务覆盖
+        entry = s_trace[seq % AT_TRACE_DEPTH];
+        osMutexRelease(s_stats_mutex);
+        if (!valid)
+        {
+            continue;
+        }
+
+        const AT_Transaction_t *t = &entry;
+        printf("[AT-Trace] %10lu %-14s %c %6lu ms  tx %4u rx %4u  %s\r\n",
+               (unsigned long)t->start_tick,
+               (t->cmd < cmd_count) ? s_cmds[t->cmd].key : "?",
+               t->async ? 'A' : 'S',
+               (unsigned long)t->elapsed_ms,
+               t->tx_bytes, t->rx_bytes,
+               status_name(t->status));
+    }
+}
+
+/* Private Functions ---------------------------------------------------------*/
+
+/**
+ * @brief [内部] 命令前缀的长度：到第一个 '='、'?' 或行结束符为止，最长 AT_STATS_KEY_SIZE-1
+ */
+static uint16_t key_length(const char *cmd, uint16_t len)
+{
+    uint16_t n = 0;
+    while (n < len && n < AT_STATS_KEY_SIZE - 1 &&
+           cmd[n] != '=' && cmd[n] != '?' && cmd[n] != '\r' && cmd[n] != '\n' && cmd[n] != '\0')
+    {
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief [内部] 事务结果的简短名称
+ */
+static const char *status_name(uint8_t status)
+{
+    switch (status)
+    {
+    case AT_OK:          return "OK";
+    case AT_ERROR:       return "ERROR";
+    case AT_TIMEOUT:     return "TIMEOUT";
+    case AT_BUFFER_FULL: return "BUFFER_FULL";
+    case AT_UART_ERROR:  return "UART_ERROR";
+    default:             return "?";
+    }
+}
@@ -0,0 +1,146 @@
+/**
+ * @file at_stats.h
+ * @author Your Name
+ * @brief AT命令时延统计与模组事务追踪 - 头文件
+ * @version 1.1
+ * @date 2025-07-24
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @par V1.1 (2025-07-24)
+ *      1. [REFACTOR] 时延直方图抽成公共模块 latency_hist，与端到端采样追踪 (sample_trace) 共用。
+ *
+ * @par 模块功能:
+ *      - 按命令前缀 (例如 "AT+HMPUB"，取 '=' 或 '?' 之前的部分) 分类统计每条AT事务：
+ *        完成次数、错误/超时次数、失败后的重发次数、收发字节数，以及一张对数分桶的时延直方图。
+ *      - 用一个固定深度的环形记录保存最近 `AT_TRACE_DEPTH` 条事务 (起始时刻、耗时、字节数、结果)，
+ *        模组出现异常时可以看到异常前后的命令序列。
+ *      - 统计数据是模块内的静态存储，不随 `AT_DeInit`/`AT_Init` (模组恢复流程) 清零，
+ *        可以长期积累，用来校准各命令的超时时间 (目前为 5000/8000/15000 ms)。
+ *
+ * @par 记录口径:
+ *      - 时延从命令交给DMA发送开始计时 (不含等待命令锁的时间)：同步命令到最终响应为止，
+ *        异步命令到结果URC (例如 "+HMPUB OK") 为止。
+ *      - 超时的事务只计入超时次数，不计入直方图，避免把超时时间本身当成模组时延。
+ *      - RX字节只统计归属于该命令的响应行 (含 "\r\n")，URC不计入。
+ *      - 不登记结果的 `AT_SendRaw` 没有可测的时延，不计入统计。
+ *
+ * @par 直方图分桶:
+ *      见 latency_hist.h：每个2倍区间再对半分成两个桶，在 5~15 秒的超时附近仍有约 1.5 倍的分辨率。
+ */
+
+#ifndef __AT_STATS_H
+#define __AT_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "at_handler.h"
+#include "latency_hist.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// --- Public Configuration ---
+
+#define AT_STATS_MAX_COMMANDS  12   // 统计的命令种类上限 (超出的命令计入 untracked)
+#define AT_STATS_KEY_SIZE      16   // 命令前缀的最大长度 (含结尾 '\0')
+#define AT_TRACE_DEPTH         16   // 事务追踪环的深度
+
+#define AT_STATS_NONE          0xFFU // 表示"不统计"的命令下标
+
+// --- Public Types ---
+
+/**
+ * @brief 一类AT命令的累计统计
+ */
+typedef struct {
+    char     key[AT_STATS_KEY_SIZE];  ///< 命令前缀，例如 "AT+HMPUB"
+    uint32_t count;                   ///< 已完成的事务数 (含失败)
+    uint32_t errors;                  ///< 结果为 ERROR (或其他非超时失败) 的次数
+    uint32_t timeouts;                ///< 超时次数
+    uint32_t retries;                 ///< 上一次同类命令失败后再次发送的次数
+    uint32_t tx_bytes;                ///< 累计发送字节数 (命令头 + 负载 + "\r\n")
+    uint32_t rx_bytes;                ///< 累计接收字节数
+    LatencyHist_t latency;            ///< 未超时事务的时延直方图 (含样本数、总耗时和最长耗时)
+    bool     last_failed;             ///< 最近一次事务是否失败 (用于判定重发)
+} AT_CmdStats_t;
+
+/**
+ * @brief 事务追踪环中的一条记录
+ */
+typedef struct {
+    uint32_t start_tick;  ///< 发送时刻 (系统节拍)
+    uint32_t elapsed_ms;  ///< 耗时
+    uint16_t tx_bytes;    ///< 发送字节数
+    uint16_t rx_bytes;    ///< 接收字节数
+    uint8_t  cmd;         ///< 命令下标 (`AT_Stats_GetCommand` 的参数)
+    uint8_t  status;      ///< 结果 (AT_Status_t)
+    bool     async;       ///< 是否经异步窗口或 `AT_SendRawAsync` 发送
+} AT_Transaction_t;
+
+// --- Public Function Prototypes ---
+
+/**
+ * @brief 初始化统计模块 (创建保护统计数据的互斥锁)
+ * @note  由 `AT_Init` 调用，可重复调用；已积累的统计数据不会被清除。
+ */
+void AT_Stats_Init(void);
+
+/**
+ * @brief 清除所有统计数据和事务记录
+ */
+void AT_Stats_Reset(void);
+
+/**
+ * @brief [AT层内部] 登记一条即将发送的命令
+ * @details 按命令前缀查找 (或新建) 统计项；若该类命令上一次失败，计一次重发。
+ * @param cmd 命令文本 (可以不以 '\0' 结尾)
+ * @param len 命令长度
+ * @return uint8_t 命令下标，传给 `AT_Stats_End`；统计项已满时返回 AT_STATS_NONE
+ */
+uint8_t AT_Stats_Begin(const char* cmd, uint16_t len);
+
+/**
+ * @brief [AT层内部] 记录一条事务的结果，并写入事务追踪环
+ * @param cmd `AT_Stats_Begin` 返回的命令下标 (AT_STATS_NONE 时忽略)
+ * @param start_tick 发送时刻 (系统节拍)
+ * @param status 事务结果
+ * @param tx_bytes 发送字节数
+ * @param rx_bytes 接收字节数
+ * @param async 是否为异步事务
+ */
+void AT_Stats_End(uint8_t cmd, uint32_t start_tick, AT_Status_t status,
+                  uint16_t tx_bytes, uint16_t rx_bytes, bool async);
+
+/**
+ * @brief 当前已统计的命令种类数
+ */
+uint8_t AT_Stats_GetCommandCount(void);
+
+/**
+ * @brief 读取一类命令的统计快照
+ * @param index 命令下标 (0 ~ `AT_Stats_GetCommandCount()`-1)
+ * @param out 输出
+ * @return bool 下标无效时返回 false
+ */
+bool AT_Stats_GetCommand(uint8_t index, AT_CmdStats_t* out);
+
+/**
+ * @brief 读取事务追踪环，按时间从旧到新排列
+ * @param out 输出数组
+ * @param max 输出数组的容量
+ * @return uint8_t 实际写入的记录数
+ */
+uint8_t AT_Stats_GetTrace(AT_Transaction_t* out, uint8_t max);
+
+/**
+ * @brief 通过调试串口打印统计表、非空的直方图桶和最近的事务记录
+ */
+void AT_Stats_Dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AT_STATS_H */
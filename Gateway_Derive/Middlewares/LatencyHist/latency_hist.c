@@ -0,0 +1,119 @@
+/**
+ * @file      latency_hist.c
+ * @author    Your Name
+ * @brief     对数分桶的时延直方图
+ */
+
+#include "latency_hist.h"
+#include <stdio.h>
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t bucket_of(uint32_t ms);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief 记录一个样本 (实现)
+ */
+void LatencyHist_Add(LatencyHist_t *hist, uint32_t ms)
+{
+    uint16_t *slot = &hist->bucket[bucket_of(ms)];
+    if (*slot < UINT16_MAX)
+    {
+        (*slot)++;
+    }
+    hist->count++;
+    hist->total_ms += ms;
+    if (ms > hist->max_ms)
+    {
+        hist->max_ms = ms;
+    }
+}
+
+/**
+ * @brief 由直方图估算分位数 (实现)
+ */
+uint32_t LatencyHist_Percentile(const LatencyHist_t *hist, uint8_t pct)
+{
+    // 桶计数可能已饱和，以各桶之和 (而不是 count) 为总数
+    uint32_t samples = 0;
+    for (uint8_t i = 0; i < LATENCY_HIST_BUCKETS; i++)
+    {
+        samples += hist->bucket[i];
+    }
+    if (samples == 0)
+    {
+        return 0;
+    }
+
+    // 第一个累计计数达到 ceil(samples * pct / 100) 的桶
+    uint32_t target = (samples * pct + 99) / 100;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < LATENCY_HIST_BUCKETS - 1; i++)
+    {
+        seen += hist->bucket[i];
+        if (seen >= target)
+        {
+            uint32_t upper = LatencyHist_BucketLower(i + 1) - 1;
+            return (upper < hist->max_ms) ? upper : hist->max_ms;
+        }
+    }
+    return hist->max_ms; // 落在不设上限的最后一个桶
+}
+
+/**
+ * @brief 平均耗时 (实现)
+ */
+uint32_t LatencyHist_Mean(const LatencyHist_t *hist)
+{
+    return (hist->count > 0) ? hist->total_ms / hist->count : 0;
+}
+
+/**
+ * @brief 直方图桶的下界 (实现)
+ */
+uint32_t LatencyHist_BucketLower(uint8_t bucket)
+{
+    if (bucket < 2)
+    {
+        return bucket;
+    }
+    uint8_t msb = bucket / 2;
+    return (1UL << msb) | ((uint32_t)(bucket & 1U) << (msb - 1));
+}
+
+/**
+ * @brief 打印非空的桶 (实现)
+ */
+void LatencyHist_PrintBuckets(const LatencyHist_t *hist)
+{
+    for (uint8_t b = 0; b < LATENCY_HIST_BUCKETS; b++)
+    {
+        if (hist->bucket[b] > 0)
+        {
+            printf(" %lu:%u", (unsigned long)LatencyHist_BucketLower(b), hist->bucket[b]);
+        }
+    }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief [内部] 计算耗时所在的直方图桶
+ * @details 0 和 1 ms 各占一个桶；此后最高有效位为 b 的耗时按次高位分入 2b 或 2b+1 号桶。
+ */
+static uint8_t bucket_of(uint32_t ms)
+{
+    if (ms < 2)
+    {
+        return (uint8_t)ms;
+    }
+
+    uint8_t msb = 0;
+    while ((ms >> (msb + 1)) != 0)
+    {
+        msb++;
+    }
+    uint32_t bucket = 2U * msb + ((ms >> (msb - 1)) & 1U);
+    return (bucket < LATENCY_HIST_BUCKETS) ? (uint8_t)bucket : (LATENCY_HIST_BUCKETS - 1);
+}
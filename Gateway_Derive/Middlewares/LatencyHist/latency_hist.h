@@ -0,0 +1,72 @@
+/**
+ * @file      latency_hist.h
+ * @author    Your Name
+ * @brief     对数分桶的时延直方图 - 头文件
+ * @version   1.0
+ * @date      2025-07-24
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @par 模块功能:
+ *      AT命令时延统计和端到端采样追踪都需要"记下每一个耗时，事后估算分位数"，
+ *      本模块把原先 at_stats.c 内部的直方图抽出来复用：
+ *      - 固定28个桶、每桶16位计数，一张直方图只占约70字节，可以为每个设备、每个阶段各放一张。
+ *      - 同时记录样本数、总耗时 (求平均值) 和最长耗时。
+ *
+ * @par 直方图分桶:
+ *      每个2倍区间再对半分成两个桶：0, 1, 2, 3, 4-5, 6-7, 8-11, 12-15, 16-23 ... ms，
+ *      最后一个桶 (>= 12288 ms) 不设上限。相对误差不超过约 1.5 倍。
+ *
+ * @par 线程模型:
+ *      本模块不加锁，由持有直方图的模块负责保护 (例如在其互斥锁内调用 `LatencyHist_Add`)。
+ */
+
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+
+#define LATENCY_HIST_BUCKETS  28  ///< 直方图桶数 (见文件头的分桶说明)
+
+/**
+ * @brief 一张时延直方图
+ */
+typedef struct {
+    uint32_t count;                          ///< 样本数
+    uint32_t total_ms;                       ///< 总耗时 (用于求平均值)
+    uint32_t max_ms;                         ///< 最长耗时
+    uint16_t bucket[LATENCY_HIST_BUCKETS];   ///< 各桶的计数 (计数到 0xFFFF 为止)
+} LatencyHist_t;
+
+/**
+ * @brief 记录一个样本
+ * @param hist 直方图
+ * @param ms 耗时 (毫秒)
+ */
+void LatencyHist_Add(LatencyHist_t *hist, uint32_t ms);
+
+/**
+ * @brief 由直方图估算分位数
+ * @details 返回累计计数达到 pct% 的那个桶的上界 (不超过 max_ms)，即"不超过该值的样本占 pct%"的保守估计。
+ * @param hist 直方图
+ * @param pct 百分位 (1 ~ 100)
+ * @return uint32_t 耗时 (毫秒)；没有样本时返回 0
+ */
+uint32_t LatencyHist_Percentile(const LatencyHist_t *hist, uint8_t pct);
+
+/**
+ * @brief 平均耗时 (毫秒)；没有样本时返回 0
+ */
+uint32_t LatencyHist_Mean(const LatencyHist_t *hist);
+
+/**
+ * @brief 直方图桶的下界 (毫秒)
+ */
+uint32_t LatencyHist_BucketLower(uint8_t bucket);
+
+/**
+ * @brief 通过调试串口打印非空的桶，格式为 " 下界:计数"，不换行
+ */
+void LatencyHist_PrintBuckets(const LatencyHist_t *hist);
+
+#endif // LATENCY_HIST_H
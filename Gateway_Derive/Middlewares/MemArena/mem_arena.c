@@ -0,0 +1,83 @@
+/**
+ * @file      mem_arena.c
+ * @author    Your Name
+ * @brief     线性(bump-pointer)内存池
+ *
+ * @par 内部实现机制:
+ *      分配时把 `used` 向上对齐到 `MEM_ARENA_ALIGN` 后再向后移动，不记录每块的大小，
+ *      因此没有任何额外的头部开销。`high_water` 在每次分配后更新，并在 Begin/End 之间保留，
+ *      反映的是内存池自启动以来的最大需求。
+ */
+
+#include "mem_arena.h"
+#include <stdio.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define MEM_ARENA_ALIGN 8U
+
+/* Private variables ---------------------------------------------------------*/
+static MemArena_t* s_arena_list = NULL; // 已注册的内存池链表 (只在初始化阶段修改)
+
+/* Public functions ----------------------------------------------------------*/
+
+void MemArena_Init(MemArena_t* arena, const char* name, void* buf, size_t size)
+{
+    // 起始地址向上对齐，保证后续所有分配都满足对齐要求
+    uintptr_t start = ((uintptr_t)buf + (MEM_ARENA_ALIGN - 1)) & ~(uintptr_t)(MEM_ARENA_ALIGN - 1);
+    size_t lost = (size_t)(start - (uintptr_t)buf);
+
+    arena->name = name;
+    arena->base = (uint8_t*)start;
+    arena->capacity = (size > lost) ? (size - lost) : 0;
+    arena->used = 0;
+    arena->high_water = 0;
+    arena->fail_count = 0;
+
+    arena->next = s_arena_list;
+    s_arena_list = arena;
+}
+
+void MemArena_Begin(MemArena_t* arena)
+{
+    arena->used = 0;
+}
+
+void MemArena_End(MemArena_t* arena)
+{
+    arena->used = 0;
+}
+
+void* MemArena_Alloc(MemArena_t* arena, size_t size)
+{
+    size_t offset = (arena->used + (MEM_ARENA_ALIGN - 1)) & ~(size_t)(MEM_ARENA_ALIGN - 1);
+    if (size == 0 || offset > arena->capacity || size > arena->capacity - offset) {
+        arena->fail_count++;
+        return NULL;
+    }
+
+    arena->used = offset + size;
+    if (arena->used > arena->high_water) {
+        arena->high_water = arena->used;
+    }
+    return arena->base + offset;
+}
+
+size_t MemArena_Mark(const MemArena_t* arena)
+{
+    return arena->used;
+}
+
+void MemArena_Release(MemArena_t* arena, size_t mark)
+{
+    if (mark <= arena->used) {
+        arena->used = mark;
+    }
+}
+
+void MemArena_PrintStats(void)
+{
+    for (const MemArena_t* a = s_arena_list; a != NULL; a = a->next) {
+        printf("[ARENA] %s: High Water: %u / %u B, Failed Allocs: %lu\r\n",
+               a->name, (unsigned int)a->high_water, (unsigned int)a->capacity, (unsigned long)a->fail_count);
+    }
+}
@@ -0,0 +1,86 @@
+/**
+ * @file      mem_arena.h
+ * @author    Your Name
+ * @brief     线性(bump-pointer)内存池 - 头文件
+ * @version   1.0
+ * @date      2025-07-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @par 设计思想:
+ *      网关的上报和命令处理会产生大量"用完即弃"的临时内存 (设备快照、JSON token数组、AT命令缓冲区等)。
+ *      如果这些内存都走 `pvPortMalloc`/`vPortFree`，在长时间运行后会使共享的 FreeRTOS 堆碎片化。
+ *
+ *      本模块为每个处理场景提供一块独立的静态内存池：
+ *      - **分配**: 只需把指针向后移动 (按8字节对齐)，时间恒定。
+ *      - **释放**: 单独释放是空操作；一次上报或一条命令处理完毕后，调用 `MemArena_End()`
+ *        整体归零即可。
+ *      - **统计**: 记录历史最高使用量 (高水位线) 和分配失败次数，用于调整内存池大小。
+ *
+ * @par 线程模型:
+ *      一个内存池在同一时刻只能被一个任务使用 (上报内存池属于上报流程，命令内存池属于URC处理)，
+ *      模块本身不加锁。
+ */
+
+#ifndef MEM_ARENA_H
+#define MEM_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief 内存池句柄
+ * @note  所有成员由 MemArena_* 函数维护，调用者只读即可。
+ */
+typedef struct MemArena {
+    const char*       name;        ///< 名称 (用于统计打印)
+    uint8_t*          base;        ///< 内存池起始地址
+    size_t            capacity;    ///< 内存池大小
+    size_t            used;        ///< 当前已使用的字节数
+    size_t            high_water;  ///< 历史最高使用量
+    uint32_t          fail_count;  ///< 因空间不足而分配失败的次数
+    struct MemArena*  next;        ///< 已注册内存池链表
+} MemArena_t;
+
+/**
+ * @brief 初始化内存池并注册到全局链表 (用于统计打印)
+ * @param arena 内存池句柄
+ * @param name  名称
+ * @param buf   内存池使用的静态缓冲区
+ * @param size  缓冲区大小
+ */
+void MemArena_Init(MemArena_t* arena, const char* name, void* buf, size_t size);
+
+/**
+ * @brief 开始一次处理 (一次上报或一条命令)：清空内存池
+ */
+void MemArena_Begin(MemArena_t* arena);
+
+/**
+ * @brief 结束一次处理：整体释放本次处理中的所有分配
+ */
+void MemArena_End(MemArena_t* arena);
+
+/**
+ * @brief 从内存池中分配内存 (8字节对齐)
+ * @return void* 分配到的内存，空间不足时返回 NULL
+ */
+void* MemArena_Alloc(MemArena_t* arena, size_t size);
+
+/**
+ * @brief 记录当前的分配位置，之后可用 MemArena_Release 回退到此处 (用于嵌套的临时缓冲区)
+ */
+size_t MemArena_Mark(const MemArena_t* arena);
+
+/**
+ * @brief 回退到 MemArena_Mark 记录的位置，释放其后的所有分配
+ */
+void MemArena_Release(MemArena_t* arena, size_t mark);
+
+/**
+ * @brief 打印所有已注册内存池的使用统计
+ */
+void MemArena_PrintStats(void);
+
+#endif // MEM_ARENA_H
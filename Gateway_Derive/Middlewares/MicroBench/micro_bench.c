@@ -0,0 +1,162 @@
+/**
+ * @file      micro_bench.c
+ * @author    Your Name
+ * @brief     热点函数的微基准测试框架
+ */
+
+#include "micro_bench.h"
+#include <stdio.h>
+
+#ifdef MICRO_BENCH_HOST
+#include <time.h>
+#define MICRO_BENCH_UNIT  "ns"
+#else
+#include "main.h" // DWT / CoreDebug (core_cm33.h) 和 SystemCoreClock
+#define MICRO_BENCH_UNIT  "cycles"
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t empty_op(void *ctx);
+static uint32_t run_batch(MicroBench_Fn_t fn, void *ctx, uint32_t iterations, uint32_t *bytes);
+static void sort_u32(uint32_t *values, uint8_t count);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief 初始化计数器 (实现)
+ */
+void MicroBench_Init(void)
+{
+#ifndef MICRO_BENCH_HOST
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // 使能 DWT/ITM 跟踪模块
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/**
+ * @brief 读取计数器的当前值 (实现)
+ */
+uint32_t MicroBench_Now(void)
+{
+#ifdef MICRO_BENCH_HOST
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec);
+#else
+    return DWT->CYCCNT;
+#endif
+}
+
+/**
+ * @brief 打印一组用例的头行 (实现)
+ */
+void MicroBench_Begin(const char *suite)
+{
+#ifdef MICRO_BENCH_HOST
+    uint32_t hz = 1000000000U;
+#else
+    uint32_t hz = SystemCoreClock;
+#endif
+    printf("#microbench,%d,%s,%s,%lu\r\n", MICRO_BENCH_FORMAT_VERSION, suite, MICRO_BENCH_UNIT, (unsigned long)hz);
+}
+
+/**
+ * @brief 运行一个用例并打印结果行 (实现)
+ */
+void MicroBench_Run(const char *suite, const MicroBench_Case_t *bench)
+{
+    uint32_t per_op_x10[MICRO_BENCH_BATCHES];
+    uint32_t bytes = 0;
+
+    (void)bench->fn(bench->ctx); // 预热: 填充指令/数据缓存，完成用例内部的首次初始化
+
+    for (uint8_t b = 0; b < MICRO_BENCH_BATCHES; b++)
+    {
+        // 空循环的开销与被测批次紧挨着测，二者受到的干扰相近
+        uint32_t overhead = run_batch(empty_op, NULL, bench->iterations, NULL);
+        uint32_t total = run_batch(bench->fn, bench->ctx, bench->iterations, &bytes);
+        uint32_t net = (total > overhead) ? (total - overhead) : 0;
+        per_op_x10[b] = (uint32_t)(((uint64_t)net * 10U + bench->iterations / 2U) / bench->iterations);
+    }
+    sort_u32(per_op_x10, MICRO_BENCH_BATCHES);
+
+    uint32_t min_x10 = per_op_x10[0];
+    uint32_t median_x10 = per_op_x10[MICRO_BENCH_BATCHES / 2];
+    printf("microbench,%s,%s,%lu,%lu.%lu,%lu.%lu,%lu\r\n", suite, bench->name,
+           (unsigned long)bench->iterations,
+           (unsigned long)(min_x10 / 10U), (unsigned long)(min_x10 % 10U),
+           (unsigned long)(median_x10 / 10U), (unsigned long)(median_x10 % 10U),
+           (unsigned long)(bytes / bench->iterations));
+}
+
+/**
+ * @brief 打印一组用例的尾行 (实现)
+ */
+void MicroBench_End(const char *suite, size_t case_count)
+{
+    printf("#microbench-end,%s,%lu\r\n", suite, (unsigned long)case_count);
+}
+
+/**
+ * @brief 依次运行一组用例 (实现)
+ */
+void MicroBench_RunAll(const char *suite, const MicroBench_Case_t *cases, size_t count)
+{
+    MicroBench_Begin(suite);
+    for (size_t i = 0; i < count; i++)
+    {
+        MicroBench_Run(suite, &cases[i]);
+    }
+    MicroBench_End(suite, count);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief 空操作，用于测量循环和间接调用本身的开销
+ */
+static uint32_t empty_op(void *ctx)
+{
+    (void)ctx;
+    return 0;
+}
+
+/**
+ * @brief 执行一批调用，返回总计数
+ * @param bytes 非NULL时，本批的字节数写入 (覆盖) 其中
+ */
+static uint32_t run_batch(MicroBench_Fn_t fn, void *ctx, uint32_t iterations, uint32_t *bytes)
+{
+    uint32_t sum = 0;
+    uint32_t start = MicroBench_Now();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        sum += fn(ctx);
+    }
+    uint32_t elapsed = MicroBench_Now() - start;
+
+    if (bytes != NULL)
+    {
+        *bytes = sum;
+    }
+    return elapsed;
+}
+
+/**
+ * @brief 插入排序 (元素个数只有 MICRO_BENCH_BATCHES 个)
+ */
+static void sort_u32(uint32_t *values, uint8_t count)
+{
+    for (uint8_t i = 1; i < count; i++)
+    {
+        uint32_t v = values[i];
+        uint8_t j = i;
+        while (j > 0 && values[j - 1] > v)
+        {
+            values[j] = values[j - 1];
+            j--;
+        }
+        values[j] = v;
+    }
+}
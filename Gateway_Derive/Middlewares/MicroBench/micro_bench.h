@@ -0,0 +1,103 @@
+/**
+ * @file      micro_bench.h
+ * @author    Your Name
+ * @brief     热点函数的微基准测试框架 - 头文件
+ * @version   1.0
+ * @date      2025-07-27
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @par 模块功能:
+ *      对一个函数重复调用若干次，测出每次调用的平均耗时 (cycles/op) 和处理的字节数 (bytes/op)，
+ *      以固定格式从调试串口 (主机上为标准输出) 打印，便于在不同固件版本之间比较。
+ *      - 目标板: 使用 Cortex-M33 的 DWT 周期计数器，单位为CPU周期。
+ *      - 主机:   定义 `MICRO_BENCH_HOST` 时使用 CLOCK_MONOTONIC，单位为纳秒。
+ *      同一份测试用例在两端编译运行 (见 Tools/HostBench)。
+ *
+ * @par 测量方法:
+ *      每个用例先调用一次预热，再执行 `MICRO_BENCH_BATCHES` 批、每批 `iterations` 次调用；
+ *      每批的计数减去空循环的开销后除以调用次数。输出所有批次中的最小值和中位数：
+ *      最小值最接近函数本身的耗时，中位数反映中断和任务切换的干扰程度。
+ *      计数器是32位的，单批耗时必须小于一个回绕周期 (160MHz 下约26秒，主机上约4秒)。
+ *
+ * @par 输出格式 (版本1，字段以逗号分隔，字段的顺序和含义不会改变):
+ *      @code
+ *      #microbench,1,<suite>,<unit>,<hz>
+ *      microbench,<suite>,<case>,<iterations>,<min_x10>,<median_x10>,<bytes_per_op>
+ *      #microbench-end,<suite>,<case_count>
+ *      @endcode
+ *      - unit: `cycles` (目标板) 或 `ns` (主机)；hz 为计数频率 (主机上为 1000000000)。
+ *      - min_x10 / median_x10: 每次调用的耗时乘以10 (保留一位小数，避免使用浮点 printf)。
+ *      - bytes_per_op: 每次调用处理的字节数 (由用例函数返回)。
+ *      以 `#` 开头的是头尾行，其余的行与固件的其他日志混在一起时可以用 `grep ^microbench` 取出。
+ */
+
+#ifndef MICRO_BENCH_H
+#define MICRO_BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 是否在固件启动时运行基准测试 (见 app_main.c)
+ *        测试期间AT处理器尚未启动，结果打印完后系统照常运行。
+ */
+#ifndef MICRO_BENCH_ENABLE
+#define MICRO_BENCH_ENABLE    0
+#endif
+
+#define MICRO_BENCH_FORMAT_VERSION  1   ///< 输出格式的版本号
+#define MICRO_BENCH_BATCHES         5   ///< 每个用例执行的批数
+
+/**
+ * @brief 被测函数：执行一次操作
+ * @param ctx 用例的上下文 (MicroBench_Case_t::ctx)
+ * @return uint32_t 本次操作处理的字节数
+ */
+typedef uint32_t (*MicroBench_Fn_t)(void *ctx);
+
+/**
+ * @brief 一个基准测试用例
+ */
+typedef struct {
+    const char     *name;        ///< 用例名 (不含逗号和空格，作为跨版本比较的键，不要随意改名)
+    MicroBench_Fn_t fn;          ///< 被测函数
+    void           *ctx;         ///< 传给被测函数的上下文
+    uint32_t        iterations;  ///< 每批调用次数
+} MicroBench_Case_t;
+
+/**
+ * @brief 初始化计数器 (目标板上使能 DWT 周期计数)
+ */
+void MicroBench_Init(void);
+
+/**
+ * @brief 读取计数器的当前值 (周期或纳秒，32位回绕)
+ */
+uint32_t MicroBench_Now(void);
+
+/**
+ * @brief 打印一组用例的头行
+ * @param suite 用例组名 (不含逗号和空格)
+ */
+void MicroBench_Begin(const char *suite);
+
+/**
+ * @brief 运行一个用例并打印结果行
+ * @param suite 用例组名
+ * @param bench 用例
+ */
+void MicroBench_Run(const char *suite, const MicroBench_Case_t *bench);
+
+/**
+ * @brief 打印一组用例的尾行
+ * @param case_count 本组运行的用例数
+ */
+void MicroBench_End(const char *suite, size_t case_count);
+
+/**
+ * @brief 依次运行一组用例 (Begin + Run x N + End)
+ */
+void MicroBench_RunAll(const char *suite, const MicroBench_Case_t *cases, size_t count);
+
+#endif // MICRO_BENCH_H
@@ -0,0 +1,116 @@
+/**
+ * @file      spsc_ring.h
+ * @author    Your Name
+ * @brief     单生产者/单消费者(SPSC)无锁环形缓冲区 - 头文件
+ * @version   1.0
+ * @date      2025-07-18
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @par 设计思想:
+ *      串口类驱动 (AT模组、GPS、Modbus) 的接收路径都是同一个模式：中断/DMA回调写入，
+ *      一个任务读出并按行或按帧解析。本模块把这个环形缓冲区抽成可复用的组件：
+ *      - **容量为2的幂**: 下标用 `& mask` 回绕，不用除法取模。
+ *      - **自由增长的读写计数**: `head`/`tail` 只增不减 (溢出自然回绕)，
+ *        `head - tail` 即为已用字节数，不需要浪费一个字节来区分空和满。
+ *      - **无锁**: 只有生产者写 `head`、只有消费者写 `tail`。发布新数据用 release 写，
+ *        读取对方的计数用 acquire 读，保证对方看到计数时数据已经就位。
+ *      - **批量拷贝**: 读写都按连续区段最多两次 `memcpy` 完成；消费者还可以直接
+ *        "窥视"连续区段并原地解析 (`SpscRing_PeekSpan` / `SpscRing_Consume`)，省去拷贝。
+ *      - **按行读取**: `SpscRing_ReadLine` 以字(4字节)为单位扫描行结束符，
+ *        整段拷贝到行缓冲区，替代逐字节的取出-判断-追加循环。
+ *
+ * @par 线程模型:
+ *      同一时刻只允许一个生产者 (例如UART接收回调) 和一个消费者 (例如解析任务)。
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief 环形缓冲区句柄
+ */
+typedef struct {
+    uint8_t*          buf;   ///< 存储区
+    uint32_t          mask;  ///< 容量 - 1 (容量为2的幂)
+    volatile uint32_t head;  ///< 累计写入字节数 (只由生产者修改)
+    volatile uint32_t tail;  ///< 累计读出字节数 (只由消费者修改)
+    volatile uint32_t dropped; ///< 因空间不足而丢弃的字节数 (只由生产者修改)
+} SpscRing_t;
+
+/**
+ * @brief 按行读取的状态 (由消费者持有，跨多次调用累积同一行)
+ */
+typedef struct {
+    char*    buf;       ///< 行缓冲区
+    uint32_t size;      ///< 行缓冲区大小 (含结尾 '\0')
+    uint32_t len;       ///< 当前已累积的长度
+    bool     complete;  ///< 上一次调用返回的是一个完整的行
+} SpscRing_LineReader_t;
+
+/**
+ * @brief 初始化环形缓冲区
+ * @param size 存储区大小，必须是2的幂
+ * @return bool size 不是2的幂时返回 false
+ */
+bool SpscRing_Init(SpscRing_t* ring, uint8_t* buf, uint32_t size);
+
+/**
+ * @brief 清空缓冲区 (只能在生产者和消费者都停止时调用)
+ */
+void SpscRing_Reset(SpscRing_t* ring);
+
+/**
+ * @brief [生产者] 写入数据，空间不足时只写入能放下的部分，其余计入 `dropped`
+ * @return uint32_t 实际写入的字节数
+ */
+uint32_t SpscRing_Write(SpscRing_t* ring, const uint8_t* data, uint32_t len);
+
+/**
+ * @brief [消费者] 读出最多 len 字节
+ * @return uint32_t 实际读出的字节数
+ */
+uint32_t SpscRing_Read(SpscRing_t* ring, uint8_t* out, uint32_t len);
+
+/**
+ * @brief [消费者] 获取从读位置开始的连续可读区段 (不拷贝)
+ * @param span 输出：区段起始地址
+ * @return uint32_t 区段长度；缓冲区为空时返回0
+ */
+uint32_t SpscRing_PeekSpan(SpscRing_t* ring, const uint8_t** span);
+
+/**
+ * @brief [消费者] 丢弃已处理的 n 个字节
+ */
+void SpscRing_Consume(SpscRing_t* ring, uint32_t n);
+
+/**
+ * @brief 当前已用字节数
+ */
+uint32_t SpscRing_Used(const SpscRing_t* ring);
+
+/**
+ * @brief 当前空闲字节数
+ */
+uint32_t SpscRing_Free(const SpscRing_t* ring);
+
+/**
+ * @brief [消费者] 提取下一个完整的非空行 (以 '\r' 或 '\n' 结尾)
+ * @details
+ *        行内容累积在 reader->buf 中，缓冲区读空时返回 false，下次调用继续累积。
+ *        返回 true 时，行已以 '\0' 结尾 (不含行结束符)，长度为 reader->len，
+ *        在下一次调用前有效。超出行缓冲区的部分被截断。
+ * @return bool true: 得到一个完整的行
+ */
+bool SpscRing_ReadLine(SpscRing_t* ring, SpscRing_LineReader_t* reader);
+
+/**
+ * @brief 在 p[0..len) 中查找第一个 '\r' 或 '\n'
+ * @return uint32_t 其下标；没有找到时返回 len
+ */
+uint32_t SpscRing_ScanEol(const uint8_t* p, uint32_t len);
+
+#endif // SPSC_RING_H
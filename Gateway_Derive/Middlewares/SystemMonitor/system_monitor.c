@@ -2,49 +2,99 @@
  * @file      system_monitor.c
  * @author    Your Name
  * @brief     系统资源监控任务 - 源文件
- * @version   1.0
- * @date      2025-06-22
- * 
+ * @version   1.1
+ * @date      2025-07-22
+ *
  * @copyright Copyright (c) 2025
  */
 #include "system_monitor.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "mem_arena.h"
+#include "at_stats.h"
+#include "task_monitor.h"
+#include "sample_trace.h"
 #include <stdio.h>
+#include <string.h>
 
 /* Private defines -----------------------------------------------------------*/
-#define MONITOR_TASK_STACK_SIZE    (configMINIMAL_STACK_SIZE * 2) // 1024 bytes
+#define MONITOR_TASK_STACK_SIZE    (configMINIMAL_STACK_SIZE * 3) // 1536 bytes (AT统计打印需要约300字节)
 #define MONITOR_TASK_PRIORITY      (osPriorityLow)
 #define MONITOR_PERIOD_MS          (5000) // 每5秒打印一次
+#define MONITOR_AT_STATS_EVERY     (12)   // 每12个周期 (1分钟) 打印一次AT命令时延、看门狗签到和样本时延统计
+
+/* Private types -------------------------------------------------------------*/
+
+/**
+ * @brief 上一周期末某个任务的累计值，用于求本周期的增量
+ */
+typedef struct {
+    UBaseType_t number;    // 任务编号 (xTaskNumber)，任务每次创建都不同，重建的任务不会沿用旧的累计值
+    uint32_t    runtime;   // 累计运行时间 (微秒，32位回绕)
+    uint32_t    switches;  // 累计切入次数 (线程局部存储指针 configTLS_INDEX_SWITCH_COUNT)
+} TaskHistory_t;
 
 /* Private variables ---------------------------------------------------------*/
-static osThreadId_t s_default_task_handle = NULL;
-static osThreadId_t s_lora_task_handle = NULL;
+static TaskStatus_t s_task_status[SYSMON_MAX_TASKS];  // uxTaskGetSystemState 的输出，只在监控任务中使用
+static TaskHistory_t s_history[SYSMON_MAX_TASKS];
+static uint8_t s_history_count = 0;
+static uint32_t s_last_total_runtime = 0;
+
+// 快照由监控任务写入，由云端上行任务读取
+static osMutexId_t s_snapshot_mutex = NULL;
+static SystemMonitor_Snapshot_t s_snapshot;
+static bool s_snapshot_valid = false;
 
 /* Private function prototypes -----------------------------------------------*/
 static void SystemMonitor_Task(void *argument);
+static bool collect_snapshot(void);
+static const TaskHistory_t *find_history(UBaseType_t number);
+static void print_snapshot(const SystemMonitor_Snapshot_t *snap);
 
 /* Public functions ----------------------------------------------------------*/
 
 /**
  * @brief 初始化并创建系统资源监控任务。
  */
-osStatus_t SystemMonitor_Init(osThreadId_t defaultTaskHandle, osThreadId_t loraTaskHandle)
+osStatus_t SystemMonitor_Init(void)
 {
-    s_default_task_handle = defaultTaskHandle;
-    s_lora_task_handle = loraTaskHandle;
+    s_snapshot_mutex = osMutexNew(NULL);
+    if (s_snapshot_mutex == NULL)
+    {
+        return osError;
+    }
 
     const osThreadAttr_t task_attributes = {
         .name = "SysMonitorTask",
         .stack_size = MONITOR_TASK_STACK_SIZE,
         .priority = (osPriority_t) MONITOR_TASK_PRIORITY,
     };
-    
+
     osThreadId_t task_handle = osThreadNew(SystemMonitor_Task, NULL, &task_attributes);
-    
+
     return (task_handle == NULL) ? osError : osOK;
 }
 
+/**
+ * @brief 读取最近一个监控周期的统计快照。
+ */
+bool SystemMonitor_GetSnapshot(SystemMonitor_Snapshot_t *out)
+{
+    if (s_snapshot_mutex == NULL)
+    {
+        return false;
+    }
+
+    osMutexAcquire(s_snapshot_mutex, osWaitForever);
+    bool valid = s_snapshot_valid;
+    if (valid)
+    {
+        *out = s_snapshot;
+    }
+    osMutexRelease(s_snapshot_mutex);
+    return valid;
+}
+
 /* Private functions ---------------------------------------------------------*/
 
 /**
@@ -56,26 +106,154 @@ static void SystemMonitor_Task(void *argument)
 
     printf("\r\n[Monitor] System Monitor Task Started.\r\n");
 
+    uint32_t cycle = 0;
     for(;;)
     {
         // 等待指定周期
         osDelay(MONITOR_PERIOD_MS);
 
-        // 1. 获取并打印堆内存信息
-        size_t free_heap_now = xPortGetFreeHeapSize();
-        size_t min_free_heap_ever = xPortGetMinimumEverFreeHeapSize();
-
         printf("\r\n--- System Status ---\r\n");
-        printf("[HEAP] Current Free: %u B, Minimum Ever: %u B\r\n", free_heap_now, min_free_heap_ever);
 
-        // 2. 获取并打印任务堆栈高水位线
-        // 高水位线(High Water Mark)指的是任务自启动以来，堆栈指针距离堆栈顶部的最小剩余字节数。
-        // 这个值越小，说明堆栈使用得越满，发生溢出的风险越高。
-        UBaseType_t main_stack_hwm = uxTaskGetStackHighWaterMark(s_default_task_handle);
-        UBaseType_t lora_stack_hwm = uxTaskGetStackHighWaterMark(s_lora_task_handle);
+        // 1. 采集全部任务和堆的统计，并打印
+        //    快照只由本任务写入，打印时直接读取，不需要加锁。
+        if (collect_snapshot())
+        {
+            print_snapshot(&s_snapshot);
+        }
+        else
+        {
+            printf("[Monitor] More than %d tasks, task statistics skipped.\r\n", SYSMON_MAX_TASKS);
+        }
+        MemArena_PrintStats();
 
-        printf("[STACK] AppMainTask HWM: %lu words (%lu B)\r\n", main_stack_hwm, main_stack_hwm * sizeof(StackType_t));
-        printf("[STACK] LoRaAppTask HWM: %lu words (%lu B)\r\n", lora_stack_hwm, lora_stack_hwm * sizeof(StackType_t));
+        // 2. 周期性打印AT命令时延统计、最近的模组事务、各任务的签到间隔统计和各节点的样本时延统计
+        if (++cycle % MONITOR_AT_STATS_EVERY == 0)
+        {
+            AT_Stats_Dump();
+            TaskMonitor_Dump();
+            SampleTrace_Dump();
+        }
         printf("---------------------\r\n");
     }
-} 
\ No newline at end of file
+}
+
+/**
+ * @brief [内部] 采集本周期的任务和堆统计，写入 s_snapshot
+ * @return bool 任务数超过 SYSMON_MAX_TASKS 时返回 false (堆统计仍会更新)
+ */
+static bool collect_snapshot(void)
+{
+    configRUN_TIME_COUNTER_TYPE total_runtime = 0;
+    uint32_t switches[SYSMON_MAX_TASKS];
+    HeapStats_t heap;
+
+    // 挂起调度器期间不会有任务被删除，枚举得到的句柄在读取切入次数时一定有效。
+    // 切入次数由 traceTASK_SWITCHED_IN() 累加在保留的线程局部存储槽位中 (见 FreeRTOSConfig.h)，
+    // 其他模块不得使用该槽位。
+    // (uxTaskGetSystemState 会顺带计算各任务的堆栈高水位线，耗时与空闲栈的大小成正比)
+    vTaskSuspendAll();
+    UBaseType_t count = uxTaskGetSystemState(s_task_status, SYSMON_MAX_TASKS, &total_runtime);
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        switches[i] = (uint32_t)(uintptr_t)pvTaskGetThreadLocalStoragePointer(s_task_status[i].xHandle,
+                                                                             configTLS_INDEX_SWITCH_COUNT);
+    }
+    (void)xTaskResumeAll();
+
+    vPortGetHeapStats(&heap);
+
+    osMutexAcquire(s_snapshot_mutex, osWaitForever);
+    SystemMonitor_Snapshot_t *snap = &s_snapshot;
+    snap->timestamp = osKernelGetTickCount();
+    snap->heap_free = heap.xAvailableHeapSpaceInBytes;
+    snap->heap_min_ever = heap.xMinimumEverFreeBytesRemaining;
+    snap->heap_largest_block = heap.xSizeOfLargestFreeBlockInBytes;
+    snap->heap_free_blocks = heap.xNumberOfFreeBlocks;
+    snap->heap_allocs = heap.xNumberOfSuccessfulAllocations;
+    snap->heap_frees = heap.xNumberOfSuccessfulFrees;
+    snap->heap_frag_permille = (heap.xAvailableHeapSpaceInBytes > 0)
+        ? (uint16_t)(1000U - (uint32_t)((uint64_t)heap.xSizeOfLargestFreeBlockInBytes * 1000U / heap.xAvailableHeapSpaceInBytes))
+        : 0;
+
+    if (count > 0)
+    {
+        // 运行时间和切入次数都是32位累计值，无符号减法自然处理回绕 (监控周期远小于回绕周期)
+        uint32_t period = (uint32_t)total_runtime - s_last_total_runtime;
+        snap->period_us = period;
+        snap->task_count = (uint8_t)count;
+
+        for (UBaseType_t i = 0; i < count; i++)
+        {
+            const TaskStatus_t *status = &s_task_status[i];
+            const TaskHistory_t *prev = find_history(status->xTaskNumber);
+            SystemMonitor_TaskStats_t *task = &snap->tasks[i];
+
+            uint32_t runtime = (uint32_t)status->ulRunTimeCounter - (prev ? prev->runtime : 0);
+            uint32_t permille = (period > 0) ? (uint32_t)((uint64_t)runtime * 1000U / period) : 0;
+            uint32_t hwm_bytes = (uint32_t)status->usStackHighWaterMark * sizeof(StackType_t);
+
+            strncpy(task->name, status->pcTaskName, SYSMON_TASK_NAME_SIZE - 1);
+            task->name[SYSMON_TASK_NAME_SIZE - 1] = '\0';
+            task->switches = switches[i] - (prev ? prev->switches : 0);
+            task->cpu_permille = (uint16_t)((permille > 1000U) ? 1000U : permille);
+            task->stack_hwm_bytes = (uint16_t)((hwm_bytes > UINT16_MAX) ? UINT16_MAX : hwm_bytes);
+            task->priority = (uint8_t)status->uxCurrentPriority;
+        }
+
+        // 用本周期的累计值替换历史 (已删除的任务随之淘汰)
+        for (UBaseType_t i = 0; i < count; i++)
+        {
+            s_history[i].number = s_task_status[i].xTaskNumber;
+            s_history[i].runtime = (uint32_t)s_task_status[i].ulRunTimeCounter;
+            s_history[i].switches = switches[i];
+        }
+        s_history_count = (uint8_t)count;
+        s_last_total_runtime = (uint32_t)total_runtime;
+        s_snapshot_valid = true;
+    }
+    osMutexRelease(s_snapshot_mutex);
+
+    return (count > 0);
+}
+
+/**
+ * @brief [内部] 按任务编号查找上一周期的累计值
+ * @return 新出现的任务返回 NULL (增量从任务创建时算起)
+ */
+static const TaskHistory_t *find_history(UBaseType_t number)
+{
+    for (uint8_t i = 0; i < s_history_count; i++)
+    {
+        if (s_history[i].number == number)
+        {
+            return &s_history[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief [内部] 打印一个统计快照
+ */
+static void print_snapshot(const SystemMonitor_Snapshot_t *snap)
+{
+    printf("[HEAP] Current Free: %lu B, Minimum Ever: %lu B\r\n",
+           (unsigned long)snap->heap_free, (unsigned long)snap->heap_min_ever);
+    printf("[HEAP] Largest Block: %lu B in %lu free block(s), Fragmentation: %u.%u%%, Allocs/Frees: %lu/%lu\r\n",
+           (unsigned long)snap->heap_largest_block, (unsigned long)snap->heap_free_blocks,
+           snap->heap_frag_permille / 10, snap->heap_frag_permille % 10,
+           (unsigned long)snap->heap_allocs, (unsigned long)snap->heap_frees);
+
+    // 高水位线(High Water Mark)指的是任务自启动以来，堆栈指针距离堆栈顶部的最小剩余字节数。
+    // 这个值越小，说明堆栈使用得越满，发生溢出的风险越高。
+    printf("[TASK] %-16s %4s %6s %8s %8s  (period %lu ms)\r\n",
+           "name", "prio", "cpu", "switches", "stack", (unsigned long)(snap->period_us / 1000U));
+    for (uint8_t i = 0; i < snap->task_count; i++)
+    {
+        const SystemMonitor_TaskStats_t *task = &snap->tasks[i];
+        printf("[TASK] %-16s %4u %4u.%u%% %8lu %6u B\r\n",
+               task->name, task->priority,
+               task->cpu_permille / 10, task->cpu_permille % 10,
+               (unsigned long)task->switches, task->stack_hwm_bytes);
+    }
+}
@@ -2,27 +2,82 @@
  * @file      system_monitor.h
  * @author    Your Name
  * @brief     系统资源监控任务 - 头文件
- * @version   1.0
- * @date      2025-06-22
- * 
+ * @version   1.1
+ * @date      2025-07-22
+ *
  * @copyright Copyright (c) 2025
  *
  * @par 模块功能:
  *      提供一个低优先级的后台任务，用于周期性地打印系统关键资源的使用情况，
  *      包括FreeRTOS堆内存和各个关键任务的堆栈高水位线。这对于调试内存问题、
  *      优化资源分配和确保系统长期稳定性至关重要。
+ *
+ * @par 任务统计:
+ *      - 每个监控周期枚举系统中的全部任务 (包括 IDLE 和 Tmr Svc)，不再只看固定的两个任务句柄，
+ *        AT接收任务等在模组恢复时被重建的任务也能被统计到。
+ *      - CPU占用率基于FreeRTOS运行时间统计，时钟为1MHz的TIM2 (见 app_freertos.c)，
+ *        按本周期内各任务运行时间的增量计算；IDLE 任务的占用率即为空闲率。
+ *      - 上下文切换次数由 FreeRTOSConfig.h 中的 traceTASK_SWITCHED_IN() 累加在每个任务保留的
+ *        线程局部存储指针 (configTLS_INDEX_SWITCH_COUNT) 上，同样按周期求增量。
+ *      - 堆统计来自 vPortGetHeapStats()，碎片率 = 1 - 最大空闲块 / 总空闲字节。
+ *
+ * @par V1.1 (2025-07-22)
+ *      - 新增全任务的CPU占用率、上下文切换次数和堆碎片统计，并提供快照接口供云端遥测使用。
+ *      - `SystemMonitor_Init` 不再需要传入任务句柄。
  */
 #ifndef SYSTEM_MONITOR_H
 #define SYSTEM_MONITOR_H
 
 #include "cmsis_os2.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// --- Public Configuration ---
+
+#define SYSMON_MAX_TASKS        16  // 可统计的任务数上限 (任务数超过上限时该周期不更新任务统计)
+#define SYSMON_TASK_NAME_SIZE   16  // 任务名的最大长度 (含结尾 '\0'，与 configMAX_TASK_NAME_LEN 一致)
+
+// --- Public Types ---
+
+/**
+ * @brief 单个任务在最近一个监控周期内的统计
+ */
+typedef struct {
+    char     name[SYSMON_TASK_NAME_SIZE]; ///< 任务名
+    uint32_t switches;                    ///< 本周期内被切入的次数
+    uint16_t cpu_permille;                ///< 本周期内的CPU占用率 (千分比)
+    uint16_t stack_hwm_bytes;             ///< 堆栈高水位线 (自任务创建以来的最小剩余字节数)
+    uint8_t  priority;                    ///< 当前优先级 (FreeRTOS优先级数值)
+} SystemMonitor_TaskStats_t;
+
+/**
+ * @brief 一个监控周期的系统统计快照
+ */
+typedef struct {
+    uint32_t timestamp;                   ///< 采样时刻 (系统节拍)
+    uint32_t period_us;                   ///< 本周期的长度 (运行时间时钟，微秒)
+    uint32_t heap_free;                   ///< 当前空闲堆字节数
+    uint32_t heap_min_ever;               ///< 启动以来的最小空闲堆字节数
+    uint32_t heap_largest_block;          ///< 最大的空闲块 (一次能分配到的上限)
+    uint32_t heap_free_blocks;            ///< 空闲块个数
+    uint32_t heap_allocs;                 ///< 累计成功分配次数
+    uint32_t heap_frees;                  ///< 累计释放次数
+    uint16_t heap_frag_permille;          ///< 堆碎片率 (千分比)
+    uint8_t  task_count;                  ///< tasks[] 中的有效项数
+    SystemMonitor_TaskStats_t tasks[SYSMON_MAX_TASKS];
+} SystemMonitor_Snapshot_t;
 
 /**
  * @brief 初始化并创建系统资源监控任务。
- * @param defaultTaskHandle App_Main_Task 的任务句柄。
- * @param loraTaskHandle LoRa_APP_Task 的任务句柄。
  * @return osOK 表示成功, 其他值表示失败。
  */
-osStatus_t SystemMonitor_Init(osThreadId_t defaultTaskHandle, osThreadId_t loraTaskHandle);
+osStatus_t SystemMonitor_Init(void);
+
+/**
+ * @brief 读取最近一个监控周期的统计快照。
+ * @param out 输出
+ * @return bool 监控任务尚未完成第一个周期时返回 false。
+ */
+bool SystemMonitor_GetSnapshot(SystemMonitor_Snapshot_t *out);
 
-#endif // SYSTEM_MONITOR_H 
\ No newline at end of file
+#endif // SYSTEM_MONITOR_H
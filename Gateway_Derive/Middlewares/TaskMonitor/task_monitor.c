@@ -2,58 +2,110 @@
  * @file      task_monitor.c
  * @author    Your Name
  * @brief     多任务看门狗监控系统
- * 
+ *
  * @par 内部实现机制:
- *      本模块使用一个极为高效的位掩码(bitmask)机制来追踪所有任务的签到状态。
- *      - `s_check_in_mask`: 这是一个32位的无符号整数，被用作"签到板"。它的每一个比特位
- *        都唯一对应 `TaskID_t` 枚举中的一个任务。当一个任务调用 `TaskMonitor_CheckIn()` 时，
- *        它对应的比特位就会被置为1。
- *      - `s_all_tasks_ok_mask`: 这是一个在初始化时根据 `TaskID_t` 枚举的任务总数自动
- *        计算出的"完成状态掩码"。如果系统中有N个任务被监控，那么这个掩码的值就是N个1
- *        （例如，3个任务时，值为 `0b111`）。
- * 
- *      `TaskMonitor_FeedDogIfAllOk()` 的核心逻辑就是一句简单的整数比较：
- *      `if (s_check_in_mask == s_all_tasks_ok_mask)`。
- *      这个操作极其快速，确保了监控逻辑本身不会成为系统的性能瓶颈。
- * 
- *      为了确保在读-改-写 `s_check_in_mask` 时的原子性，防止在多任务环境下被中断打断
- *      导致状态不一致，所有的写操作都使用了开关全局中断 (`__disable_irq`/`__enable_irq`)
- *      进行临界区保护。
+ *      本模块为每个被监控任务维护一个签到槽 (`TaskSlot_t`)，以 `TaskID_t` 为下标。
+ *      - `last_checkin`: 最近一次签到的系统节拍 (0 表示尚未签到)。签到时用原子交换写入新值，
+ *        同时取回旧值，二者之差即为本次签到间隔，计入直方图和最长间隔。
+ *      - `s_deadline_ms[]`: 每个任务的截止时间。
+ *
+ *      `TaskMonitor_FeedDogIfAllOk()` 逐个读取 `last_checkin`，计算距今的时长并与截止时间比较。
+ *      任务数很少，这个循环的开销可以忽略。
+ *
+ *      所有共享字段都只用 `__atomic` 内建函数访问 (Cortex-M33 上为 LDREX/STREX)，
+ *      不再开关全局中断，签到不会增加中断延迟。统计字段各自独立原子更新，
+ *      读取快照时各字段之间可能相差一次签到，这对统计用途没有影响。
+ *
+ *      拒绝喂狗时，超时最严重的任务的状态通过 `vTaskGetInfo()` 取得，写入 TAMP 备份寄存器。
+ *      备份寄存器在系统复位 (包括看门狗复位) 后保持不变，只有备份域复位或入侵检测才会清除。
  */
 
 #include "task_monitor.h"
 #include "stm32u5xx_hal.h"
 #include "main.h" // For HAL_IWDG_Refresh
 #include "cmsis_os2.h"
+#include "FreeRTOS.h"
+#include "task.h"
 #include <string.h>
 #include <stdio.h>
 
 // IWDG 句柄在 main.c 中定义，此处进行外部声明
 extern IWDG_HandleTypeDef hiwdg;
 
-// 使用一个静态的32位无符号整型作为"签到板" (bitmask)
-// 每个比特位代表一个任务的签到状态 (1: 已签到, 0: 未签到)
-// volatile 关键字确保编译器不会对此变量的读写操作进行过度优化，保证每次访问都从内存中读取。
-static volatile uint32_t s_check_in_mask = 0;
+/* Private defines -----------------------------------------------------------*/
 
-// 此掩码用于校验。当 s_check_in_mask 的值与它相等时，表明所有被监控的任务均已签到。
-static uint32_t s_all_tasks_ok_mask = 0;
+#define RESET_RECORD_MAGIC   0x544D4F4EUL // "TMON"
+#define RESET_RECORD_WORDS   (sizeof(TaskMonitor_ResetRecord_t) / sizeof(uint32_t))
+
+#define LOAD(p)              __atomic_load_n((p), __ATOMIC_RELAXED)
+#define ADD(p, v)            __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+
+/* Private types -------------------------------------------------------------*/
+
+typedef struct {
+    uint32_t last_checkin;                  // 最近一次签到的节拍，0 表示尚未签到
+    osThreadId_t thread;                    // 首次签到的任务 (用于在复位记录中读取任务状态)
+    uint32_t checkins;
+    uint32_t late;
+    uint32_t worst_interval_ms;
+    uint32_t hist[TASK_MONITOR_BUCKETS];
+} TaskSlot_t;
+
+/* Private variables ---------------------------------------------------------*/
+
+// 各任务的截止时间，必须大于任务自身的签到周期
+static const uint32_t s_deadline_ms[TASK_MONITOR_COUNT] = {
+    [TASK_ID_APP_MAIN]     = 3000, // 监督周期 2000ms
+    [TASK_ID_LORA_APP]     = 3000, // 事件等待超时 1800ms + 收发处理
+    [TASK_ID_CLOUD_UPLINK] = 3000, // 空闲时 1000ms 自签；上报进行中时由监督者每 2000ms 代签
+};
+
+static TaskSlot_t s_slots[TASK_MONITOR_COUNT];
+static uint32_t s_init_tick = 0;       // 初始化时刻，尚未签到的任务从此刻开始计时
+static uint8_t s_refusals = 0;         // 连续拒绝喂狗的次数 (只在监督者任务中访问)
+
+static TaskMonitor_ResetRecord_t s_reset_record; // 上次看门狗复位前的记录 (启动时从备份寄存器取出)
+static bool s_reset_record_valid = false;
+
+/* Private function prototypes -----------------------------------------------*/
+
+static uint8_t bucket_of(uint32_t ms);
+static void record_offender(TaskID_t task_id, uint32_t now, uint32_t age);
+static void backup_write(const TaskMonitor_ResetRecord_t *record);
+static void backup_read(TaskMonitor_ResetRecord_t *record);
+
+/* Public functions ----------------------------------------------------------*/
 
 /**
  * @brief 初始化任务监控系统。
  */
 void TaskMonitor_Init(void)
 {
-    // 根据在 .h 文件中 TaskID_t 枚举的任务总数，自动计算出"全员签到"状态对应的掩码值。
-    // 例如，如果 TASK_MONITOR_COUNT 是 3, 此掩码将是 0b111 (即7)。
-    // 这种设计使得在增删被监控任务时，此处代码无需任何修改。
-    for (int i = 0; i < TASK_MONITOR_COUNT; i++) {
-        s_all_tasks_ok_mask |= (1 << i);
+    memset(s_slots, 0, sizeof(s_slots));
+    s_init_tick = osKernelGetTickCount();
+    s_refusals = 0;
+
+    // 备份寄存器位于备份域，需要打开 RTC APB 时钟并解除备份域写保护
+    __HAL_RCC_RTCAPB_CLK_ENABLE();
+    HAL_PWR_EnableBkUpAccess();
+
+    // 只在看门狗复位后采信备份寄存器中的记录，其他复位原因下的记录属于已恢复的超时
+    TaskMonitor_ResetRecord_t record;
+    backup_read(&record);
+    if (record.magic == RESET_RECORD_MAGIC && __HAL_RCC_GET_FLAG(RCC_FLAG_IWDGRST)) {
+        record.name[TASK_MONITOR_NAME_SIZE - 1] = '\0';
+        s_reset_record = record;
+        s_reset_record_valid = true;
+        printf("[TaskMonitor] Last reset by IWDG: task %u (%s) overdue %lu ms (deadline %lu ms, worst %lu ms) "
+               "at uptime %lu ms, state %u, prio %u, stack HWM %lu B, %u refusal(s).\r\n",
+               record.task_id, record.name, (unsigned long)record.overdue_ms, (unsigned long)record.deadline_ms,
+               (unsigned long)record.worst_interval_ms, (unsigned long)record.uptime_ms,
+               record.rtos_state, record.priority, (unsigned long)record.stack_hwm_bytes, record.refusals);
     }
-    printf("[Debug][TaskMonitor] Initialized. Required check-in mask: 0x%08X\r\n", s_all_tasks_ok_mask);
+    memset(&record, 0, sizeof(record));
+    backup_write(&record);
 
-    // 初始状态下，清空签到板，没有任何任务签到。
-    s_check_in_mask = 0;
+    printf("[Debug][TaskMonitor] Initialized. %d task(s) monitored.\r\n", TASK_MONITOR_COUNT);
 }
 
 /**
@@ -61,49 +113,214 @@ void TaskMonitor_Init(void)
  */
 void TaskMonitor_CheckIn(TaskID_t task_id)
 {
-    // 基本的边界检查，防止无效的task_id访问数组越界（虽然此处是位操作，但仍是好习惯）
-    if (task_id < TASK_MONITOR_COUNT) {
-        // [CRITICAL SECTION]
-        // 通过"或"运算，将对应任务的比特位置为1。这是一个"读-改-写"操作。
-        // 为防止在执行此操作时被中断打断，导致数据不一致（例如，另一个任务也同时签到），
-        // 此处使用开关中断来保护这个关键的临界区，确保操作的原子性。
-        __disable_irq();
-        s_check_in_mask |= (1 << task_id);
-        __enable_irq();
+    // 基本的边界检查，防止无效的task_id访问数组越界
+    if (task_id >= TASK_MONITOR_COUNT) {
+        return;
+    }
+
+    TaskSlot_t *slot = &s_slots[task_id];
+    uint32_t now = osKernelGetTickCount();
+    if (now == 0) {
+        now = 1; // 0 保留为"尚未签到"
+    }
+
+    // 原子交换：写入本次签到时刻，同时取回上次的签到时刻。多个任务为同一ID签到时，各自得到一个不重叠的间隔。
+    uint32_t prev = __atomic_exchange_n(&slot->last_checkin, now, __ATOMIC_RELAXED);
+    if (prev == 0) {
+        osThreadId_t expected = NULL;
+        __atomic_compare_exchange_n(&slot->thread, &expected, osThreadGetId(), false,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        prev = s_init_tick;
+    }
+
+    uint32_t interval = now - prev;
+    ADD(&slot->checkins, 1U);
+    ADD(&slot->hist[bucket_of(interval)], 1U);
+
+    uint32_t worst = LOAD(&slot->worst_interval_ms);
+    while (interval > worst &&
+           !__atomic_compare_exchange_n(&slot->worst_interval_ms, &worst, interval, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        // CAS 失败时 worst 已被更新为当前值，重新比较
     }
 }
 
 /**
- * @brief 检查所有任务是否都已签到，如果全部签到则喂狗。
+ * @brief 检查所有任务是否都在截止时间内签到，如果是则喂狗。
  */
 void TaskMonitor_FeedDogIfAllOk(void)
 {
-    // [DEBUG] 打印当前签到状态和目标状态，用于调试
-    printf("[Debug][TaskMonitor] Checking... Current mask: 0x%08X, Required mask: 0x%08X\r\n", 
-           s_check_in_mask, s_all_tasks_ok_mask);
+    uint32_t now = osKernelGetTickCount();
+    int worst_task = -1;
+    uint32_t worst_overdue = 0;
 
-    // 核心逻辑: 检查"签到板"上的状态是否和"全员签到"状态完全一致。
-    if (s_check_in_mask == s_all_tasks_ok_mask) {
+    // 核心逻辑: 找出距上次签到的时长超过截止时间最多的任务
+    for (int i = 0; i < TASK_MONITOR_COUNT; i++) {
+        uint32_t last = LOAD(&s_slots[i].last_checkin);
+        uint32_t age = now - ((last != 0) ? last : s_init_tick);
+        if (age <= s_deadline_ms[i]) {
+            continue;
+        }
+
+        ADD(&s_slots[i].late, 1U);
+        printf("[Debug][TaskMonitor] Task %d overdue: %lu ms since last check-in (deadline %lu ms).\r\n",
+               i, (unsigned long)age, (unsigned long)s_deadline_ms[i]);
+        if (worst_task < 0 || age - s_deadline_ms[i] > worst_overdue) {
+            worst_overdue = age - s_deadline_ms[i];
+            worst_task = i;
+        }
+    }
+
+    if (worst_task < 0) {
         // 所有关键任务都健康，喂狗！
-        printf("[Debug][TaskMonitor] All tasks OK. Feeding the dog.\r\n");
         HAL_IWDG_Refresh(&hiwdg);
-        
-        // [CRITICAL SECTION]
-        // 喂狗后，必须清空签到板，为下一个监督周期做准备。
-        // 此处同样是关键临界区，需要用开关中断保护。
-        __disable_irq();
-        s_check_in_mask = 0;
-        __enable_irq();
-    }
-    else {
-        // [DEBUG] 如果检查失败，明确打印出来
-        printf("[Debug][TaskMonitor] Check failed! Not feeding dog.\r\n");
-    }
-    // else: 如果有任务没来签到，s_check_in_mask 的值就不会等于 s_all_tasks_ok_mask。
-    // 在这种情况下，我们什么都不做。物理看门狗IWDG将因为得不到刷新而超时，
+        if (s_refusals > 0) {
+            printf("[Debug][TaskMonitor] All tasks recovered after %u refusal(s). Feeding the dog.\r\n", s_refusals);
+            s_refusals = 0;
+
+            // 超时已恢复，清除备份寄存器中的记录，避免被之后其他原因的复位误认
+            TaskMonitor_ResetRecord_t empty = {0};
+            backup_write(&empty);
+        }
+        return;
+    }
+
+    // 有任务超时：不喂狗。物理看门狗IWDG将因为得不到刷新而超时，
     // 最终安全地复位整个系统，从而实现从任务卡死的故障中自动恢复。
+    // 复位前先把超时任务的状态保存下来，每次拒绝都刷新，复位时保留的是最后一次的状态。
+    if (s_refusals < UINT8_MAX) {
+        s_refusals++;
+    }
+    record_offender((TaskID_t)worst_task, now, worst_overdue + s_deadline_ms[worst_task]);
+    printf("[Debug][TaskMonitor] Check failed! Not feeding dog.\r\n");
+}
+
+/**
+ * @brief 读取一个任务的签到统计快照。
+ */
+bool TaskMonitor_GetStats(TaskID_t task_id, TaskMonitor_Stats_t *out)
+{
+    if (task_id >= TASK_MONITOR_COUNT || out == NULL) {
+        return false;
+    }
+
+    const TaskSlot_t *slot = &s_slots[task_id];
+    out->deadline_ms = s_deadline_ms[task_id];
+    out->checkins = LOAD(&slot->checkins);
+    out->late = LOAD(&slot->late);
+    out->worst_interval_ms = LOAD(&slot->worst_interval_ms);
+    for (int b = 0; b < TASK_MONITOR_BUCKETS; b++) {
+        out->hist[b] = LOAD(&slot->hist[b]);
+    }
+    return true;
 }
 
-// 注意：您之前添加的 Register 函数和相关数组逻辑与本文件核心的位掩码机制不符，
-// 且在 app_main.c 中并未调用 Register, 因此我将它们移除以保持文件逻辑一致性。
-// 如果需要基于超时的监控，则需要对本文件进行更完整的重构。 
\ No newline at end of file
+/**
+ * @brief 读取上次看门狗复位前保存的任务状态记录。
+ */
+bool TaskMonitor_GetResetRecord(TaskMonitor_ResetRecord_t *out)
+{
+    if (!s_reset_record_valid || out == NULL) {
+        return false;
+    }
+    *out = s_reset_record;
+    return true;
+}
+
+/**
+ * @brief 通过调试串口打印各任务的签到统计。
+ */
+void TaskMonitor_Dump(void)
+{
+    TaskMonitor_Stats_t stats;
+
+    printf("[TaskMon] %-4s %8s %8s %6s %8s\r\n", "task", "deadline", "checkins", "late", "worst");
+    for (int i = 0; i < TASK_MONITOR_COUNT; i++) {
+        TaskMonitor_GetStats((TaskID_t)i, &stats);
+        printf("[TaskMon] %-4d %8lu %8lu %6lu %8lu\r\n", i,
+               (unsigned long)stats.deadline_ms, (unsigned long)stats.checkins,
+               (unsigned long)stats.late, (unsigned long)stats.worst_interval_ms);
+
+        // 只打印非空的桶: "下界:计数"
+        printf("[TaskMon]   hist");
+        for (int b = 0; b < TASK_MONITOR_BUCKETS; b++) {
+            if (stats.hist[b] > 0) {
+                printf(" %lu:%lu", (b == 0) ? 0UL : (1UL << (b - 1)), (unsigned long)stats.hist[b]);
+            }
+        }
+        printf("\r\n");
+    }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief [内部] 计算签到间隔所在的直方图桶：0 ms 为 0 号桶，[2^(b-1), 2^b) ms 为 b 号桶
+ */
+static uint8_t bucket_of(uint32_t ms)
+{
+    uint8_t bucket = 0;
+    while (ms != 0 && bucket < TASK_MONITOR_BUCKETS - 1) {
+        ms >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/**
+ * @brief [内部] 读取超时任务的状态并写入备份寄存器
+ */
+static void record_offender(TaskID_t task_id, uint32_t now, uint32_t age)
+{
+    TaskMonitor_ResetRecord_t record = {0};
+    record.magic = RESET_RECORD_MAGIC;
+    record.task_id = (uint8_t)task_id;
+    record.refusals = s_refusals;
+    record.uptime_ms = now;
+    record.overdue_ms = age;
+    record.deadline_ms = s_deadline_ms[task_id];
+    record.worst_interval_ms = LOAD(&s_slots[task_id].worst_interval_ms);
+    record.rtos_state = (uint8_t)eInvalid;
+
+    // 被监控的任务都不会被删除，首次签到时记下的句柄一直有效
+    TaskHandle_t thread = (TaskHandle_t)LOAD(&s_slots[task_id].thread);
+    if (thread != NULL) {
+        TaskStatus_t status;
+        vTaskGetInfo(thread, &status, pdTRUE, eInvalid);
+        record.rtos_state = (uint8_t)status.eCurrentState;
+        record.priority = (uint8_t)status.uxCurrentPriority;
+        record.stack_hwm_bytes = (uint32_t)status.usStackHighWaterMark * sizeof(StackType_t);
+        record.runtime_us = (uint32_t)status.ulRunTimeCounter;
+        strncpy(record.name, status.pcTaskName, TASK_MONITOR_NAME_SIZE - 1);
+    }
+
+    backup_write(&record);
+}
+
+/**
+ * @brief [内部] 把复位记录写入备份寄存器 BKP0R 起的连续寄存器
+ */
+static void backup_write(const TaskMonitor_ResetRecord_t *record)
+{
+    uint32_t words[RESET_RECORD_WORDS];
+    volatile uint32_t *bkp = &TAMP->BKP0R;
+
+    memcpy(words, record, sizeof(words));
+    for (uint32_t i = 0; i < RESET_RECORD_WORDS; i++) {
+        bkp[i] = words[i];
+    }
+}
+
+/**
+ * @brief [内部] 从备份寄存器读出复位记录
+ */
+static void backup_read(TaskMonitor_ResetRecord_t *record)
+{
+    uint32_t words[RESET_RECORD_WORDS];
+    volatile uint32_t *bkp = &TAMP->BKP0R;
+
+    for (uint32_t i = 0; i < RESET_RECORD_WORDS; i++) {
+        words[i] = bkp[i];
+    }
+    memcpy(record, words, sizeof(words));
+}
@@ -2,18 +2,26 @@
  * @file      task_monitor.h
  * @author    Your Name
  * @brief     多任务看门狗监控系统 - 头文件
- * @version   1.1
- * @date      2025-06-22
- * 
+ * @version   2.0
+ * @date      2025-07-23
+ *
  * @copyright Copyright (c) 2025
  *
  * @par V1.1 (2025-06-22)
  *      1. [DOC] 添加了详细的 Doxygen 注释，阐明模块设计思想和使用方法。
- * 
+ *
+ * @par V2.0 (2025-07-23)
+ *      1. [FEAT] 签到板由"每个监督周期清零的位掩码"改为"每个任务的截止时间"：监督者检查各任务
+ *         距上次签到的时长是否超过该任务的截止时间，因而能区分"偶尔迟到"和"每次都慢"。
+ *      2. [PERF] 签到改为无锁的原子操作，不再开关全局中断。
+ *      3. [FEAT] 记录每个任务的签到间隔直方图、最长间隔和超时次数 (`TaskMonitor_GetStats`/`TaskMonitor_Dump`)。
+ *      4. [FEAT] 拒绝喂狗时，把超时任务的状态写入掉电前保持的备份寄存器；
+ *         看门狗复位后，下次启动时由 `TaskMonitor_Init()` 打印出来 (`TaskMonitor_GetResetRecord`)。
+ *
  * @par 设计思想:
  *      在一个多任务的嵌入式系统中，只由一个主任务来喂狗是不安全的。因为主任务本身运行正常，
  *      并不能保证其他关键的业务任务（如LoRa接收任务）没有陷入死锁或卡死。
- * 
+ *
  *      本模块实现了一个专业的"多任务签到"看门狗机制，解决了上述问题。其核心思想是：
  *      - **权责分离**:
  *          - **被监督者 (Workers)**: 所有被认为对系统至关重要的任务（如 app_main, lora_app）
@@ -22,12 +30,19 @@
  *          - **监督者 (Supervisor)**: 一个最高优先级的任务（通常是 app_main）作为监督者。
  *            它有**权力**周期性地调用 `TaskMonitor_FeedDogIfAllOk()` 来检查所有"工人"是否
  *            都已按时报到。
- *      - **喂狗条件**: 监督者**只有在确认所有工人都在本轮检查周期内报过平安后**，才会去喂狗。
- *        假如有任何一个工人任务没有按时签到，监督者便会拒绝喂狗。这将导致看门狗(IWDG)最终
+ *      - **喂狗条件**: 监督者**只有在确认每个工人距上次报平安都未超过各自的截止时间后**，才会去喂狗。
+ *        假如有任何一个工人任务超时未签到，监督者便会拒绝喂狗。这将导致看门狗(IWDG)最终
  *        超时，并安全地将整个系统复位，从而实现从任务死锁中恢复。
- * 
+ *        若该任务在看门狗超时前恢复签到，下一个监督周期会重新喂狗，这次超时只记入统计。
+ *
+ * @par 截止时间的选取:
+ *      截止时间应大于任务自身的签到周期 (留出正常的抖动余量)。监督周期为2s、看门狗超时约4.1s，
+ *      一个卡死的任务在截止时间之后最多再过一个监督周期被发现，随后约4.1s后复位。
+ *      复位前的状态记录写在 TAMP 备份寄存器 BKP0R ~ BKP11R 中，系统复位 (含看门狗复位) 后保持不变。
+ *
  * @par 如何使用:
- *      1. **定义任务**: 在 `TaskID_t` 枚举中，添加所有你需要监控的关键任务的ID。
+ *      1. **定义任务**: 在 `TaskID_t` 枚举中，添加所有你需要监控的关键任务的ID，
+ *         并在 task_monitor.c 的截止时间表中为它指定截止时间。
  *      2. **实现签到**: 在每个被监控任务的主循环中，确保 `TaskMonitor_CheckIn(TASK_ID_XXX)`
  *         被周期性地调用。
  *      3. **实现监督**: 在你的主任务（或任何可靠的监督任务）的主循环中，周期性地调用
@@ -37,6 +52,9 @@
 #ifndef TASK_MONITOR_H
 #define TASK_MONITOR_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 /**
  * @brief 定义所有被监控的关键任务的ID。
  * @note  这是一个可扩展的设计。当未来向系统中添加新的关键后台任务时，
@@ -46,20 +64,57 @@
 typedef enum {
     TASK_ID_APP_MAIN,   ///< 应用主任务
     TASK_ID_LORA_APP,   ///< LoRa 应用任务
+    TASK_ID_CLOUD_UPLINK, ///< 云端上行任务 (上报进行中时由监督者通过 CloudUplink_Supervise 代签)
     // 未来可在此处添加其他关键任务
     TASK_MONITOR_COUNT  ///< 特殊成员：自动计算被监控任务的总数，必须保留在最后。
 } TaskID_t;
 
+#define TASK_MONITOR_BUCKETS  16  ///< 签到间隔直方图的桶数：[0,1), [1,2), [2,4) ... [16384,+∞) ms
+#define TASK_MONITOR_NAME_SIZE 16 ///< 复位记录中任务名的最大长度 (含结尾 '\0')
+
+/**
+ * @brief 单个被监控任务的签到统计
+ */
+typedef struct {
+    uint32_t deadline_ms;                   ///< 截止时间
+    uint32_t checkins;                      ///< 累计签到次数
+    uint32_t late;                          ///< 监督者发现其超过截止时间的次数
+    uint32_t worst_interval_ms;             ///< 最长的签到间隔
+    uint32_t hist[TASK_MONITOR_BUCKETS];    ///< 签到间隔直方图
+} TaskMonitor_Stats_t;
+
+/**
+ * @brief 拒绝喂狗时写入备份寄存器的任务状态记录
+ */
+typedef struct {
+    uint32_t magic;                         ///< 有效标记
+    uint8_t  task_id;                       ///< 超时的任务 (TaskID_t)
+    uint8_t  rtos_state;                    ///< 当时的FreeRTOS任务状态 (eTaskState)
+    uint8_t  priority;                      ///< 当时的优先级
+    uint8_t  refusals;                      ///< 连续拒绝喂狗的次数
+    uint32_t uptime_ms;                     ///< 记录时刻 (系统节拍)
+    uint32_t overdue_ms;                    ///< 距该任务上次签到的时长
+    uint32_t deadline_ms;                   ///< 该任务的截止时间
+    uint32_t worst_interval_ms;             ///< 该任务此前的最长签到间隔
+    uint32_t stack_hwm_bytes;               ///< 堆栈高水位线
+    uint32_t runtime_us;                    ///< 累计运行时间 (运行时间统计时钟)
+    char     name[TASK_MONITOR_NAME_SIZE];  ///< 任务名
+} TaskMonitor_ResetRecord_t;
+
 /**
  * @brief 初始化任务监控系统。
  * @details 在系统启动时由 `App_Main_Init()` 调用一次，以清零内部的签到状态记录。
+ *          若上次复位由看门狗引起且备份寄存器中有状态记录，会将其打印并保存，
+ *          可通过 `TaskMonitor_GetResetRecord()` 读取。
  */
 void TaskMonitor_Init(void);
 
 /**
  * @brief 关键任务使用此函数进行"签到"或"报平安"。
  * @details 每个被监控的关键任务都需要在其主循环中周期性地调用此函数，
- *          以向监督者表明自己当前正存活且未卡死。
+ *          以向监督者表明自己当前正存活且未卡死。同时记录与上次签到的间隔。
+ *          签到为无锁操作，允许多个任务为同一个ID签到 (例如 `CloudUplink_Supervise` 代签)。
+ * @note  只能在任务上下文中调用。
  * @param task_id 调用此函数的任务的ID (来自 `TaskID_t` 枚举)。
  */
 void TaskMonitor_CheckIn(TaskID_t task_id);
@@ -68,10 +123,31 @@ void TaskMonitor_CheckIn(TaskID_t task_id);
  * @brief 监督者任务使用此函数检查所有任务的签到状态，并在满足条件时喂狗。
  * @details 此函数应由一个可靠的"监督者"任务（如`App_Main_Task`）周期性调用。
  *          其内部逻辑如下：
- *          - 检查内部的签到记录表，判断是否所有任务都已在本轮监控周期内调用过 `TaskMonitor_CheckIn()`。
- *          - **如果是**：说明系统健康。则调用 `HAL_IWDG_Refresh()` 喂狗，并清除所有签到记录，为下一个监控周期做准备。
- *          - **如果否**：说明有任务异常。则**不**执行任何操作，这将最终导致IWDG超时并安全地复位系统。
+ *          - 检查每个任务距上次签到的时长是否超过了它的截止时间。
+ *          - **如果都未超过**：说明系统健康。则调用 `HAL_IWDG_Refresh()` 喂狗。
+ *          - **如果有任务超过**：说明有任务异常。则**不**喂狗，并把超时最严重的任务的状态写入备份寄存器，
+ *            这将最终导致IWDG超时并安全地复位系统。
  */
 void TaskMonitor_FeedDogIfAllOk(void);
 
-#endif // TASK_MONITOR_H 
\ No newline at end of file
+/**
+ * @brief 读取一个任务的签到统计快照
+ * @param task_id 任务ID
+ * @param out 输出
+ * @return bool 任务ID无效时返回 false
+ */
+bool TaskMonitor_GetStats(TaskID_t task_id, TaskMonitor_Stats_t *out);
+
+/**
+ * @brief 读取上次看门狗复位前保存的任务状态记录
+ * @param out 输出
+ * @return bool 上次复位不是由任务超时引起的看门狗复位时返回 false
+ */
+bool TaskMonitor_GetResetRecord(TaskMonitor_ResetRecord_t *out);
+
+/**
+ * @brief 通过调试串口打印各任务的签到统计 (截止时间、超时次数、最长间隔和非空的直方图桶)
+ */
+void TaskMonitor_Dump(void);
+
+#endif // TASK_MONITOR_H
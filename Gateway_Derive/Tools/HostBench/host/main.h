@@ -0,0 +1,12 @@
+/**
+ * @file      main.h
+ * @author    Your Name
+ * @brief     主机端构建用: 替代节点固件的 Core/Inc/main.h
+ */
+
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#include "stm32g4xx_hal.h"
+
+#endif // __MAIN_H
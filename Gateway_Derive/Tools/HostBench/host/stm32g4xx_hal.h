@@ -0,0 +1,51 @@
+/**
+ * @file      stm32g4xx_hal.h
+ * @author    Your Name
+ * @brief     主机端构建用的节点固件 HAL 子集 (控制节点 OLED 驱动和传感器节点2 GPS 驱动)
+ * @note      只保留被测驱动访问到的类型和函数，名称与真实HAL一致，驱动源文件无需修改。
+ *            函数的实现在 node_bench.c 中：I2C 写入只统计总线字节数，UART 接收直接返回成功。
+ */
+
+#ifndef STM32G4XX_HAL_H
+#define STM32G4XX_HAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    HAL_OK      = 0x00U,
+    HAL_ERROR   = 0x01U,
+    HAL_BUSY    = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+void HAL_Delay(uint32_t Delay);
+
+/* I2C -----------------------------------------------------------------------*/
+
+#define I2C_MEMADD_SIZE_8BIT 0x00000001U
+
+typedef struct {
+    uint32_t bus_bytes; ///< [主机端] 累计写到总线上的字节数 (器件地址 + 寄存器地址 + 数据)
+} I2C_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                    uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+
+/* UART ----------------------------------------------------------------------*/
+
+#define UART_CLEAR_OREF 0x0008U
+#define UART_CLEAR_NEF  0x0004U
+#define UART_CLEAR_FEF  0x0002U
+
+typedef struct {
+    void *Instance;
+} UART_HandleTypeDef;
+
+#define __HAL_UART_CLEAR_IT(__HANDLE__, __IT_CLEAR__) ((void)(__HANDLE__))
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_AbortReceive_IT(UART_HandleTypeDef *huart);
+
+#endif // STM32G4XX_HAL_H
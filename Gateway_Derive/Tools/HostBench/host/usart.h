@@ -0,0 +1,12 @@
+/**
+ * @file      usart.h
+ * @author    Your Name
+ * @brief     主机端构建用: 替代传感器节点2的 Core/Inc/usart.h (GPS 驱动只需要 UART 类型)
+ */
+
+#ifndef __USART_H__
+#define __USART_H__
+
+#include "main.h"
+
+#endif // __USART_H__
@@ -0,0 +1,229 @@
+/**
+ * @file      spsc_ring_bench.c
+ * @author    Your Name
+ * @brief     SPSC环形缓冲区主机端性能测试
+ *
+ * @par 测试项目:
+ *      1. 单线程批量写入/读出吞吐量 (不同块大小)
+ *      2. 双线程 (生产者/消费者) 吞吐量，并校验数据顺序，验证无锁实现的正确性
+ *      3. 按行读取吞吐量，与原 `at_rx_task` 的逐字节取模算法对比
+ *
+ * @par 用法:
+ *      make && ./spsc_ring_bench [总字节数MB]
+ */
+
+#include "spsc_ring.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RING_SIZE 2048 // 与 AT_RING_BUFFER_SIZE 一致
+
+static uint8_t s_ring_buf[RING_SIZE];
+static SpscRing_t s_ring;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void report(const char *name, uint64_t bytes, double seconds)
+{
+    printf("%-32s %10.1f MB/s\n", name, (double)bytes / seconds / 1e6);
+}
+
+/* 1. 单线程 -----------------------------------------------------------------*/
+
+static void bench_single_thread(uint64_t total, uint32_t chunk)
+{
+    uint8_t in[512], out[512];
+    memset(in, 0x5A, sizeof(in));
+    SpscRing_Init(&s_ring, s_ring_buf, RING_SIZE);
+
+    double t0 = now_sec();
+    for (uint64_t done = 0; done < total; done += chunk) {
+        SpscRing_Write(&s_ring, in, chunk);
+        SpscRing_Read(&s_ring, out, chunk);
+    }
+    double t1 = now_sec();
+
+    char name[48];
+    snprintf(name, sizeof(name), "single-thread chunk=%u", chunk);
+    report(name, total, t1 - t0);
+}
+
+/* 2. 双线程 -----------------------------------------------------------------*/
+
+typedef struct {
+    uint64_t total;
+    uint32_t chunk;
+    uint64_t errors;
+} spsc_args_t;
+
+static void *producer(void *arg)
+{
+    spsc_args_t *a = arg;
+    uint8_t buf[512];
+    uint8_t seq = 0;
+    uint64_t sent = 0;
+
+    while (sent < a->total) {
+        uint32_t n = a->chunk;
+        if (SpscRing_Free(&s_ring) < n) {
+            sched_yield(); // 等待消费者 (不丢数据，以便校验顺序)
+            continue;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            buf[i] = seq++;
+        }
+        SpscRing_Write(&s_ring, buf, n);
+        sent += n;
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    spsc_args_t *a = arg;
+    uint8_t buf[512];
+    uint8_t expect = 0;
+    uint64_t received = 0;
+
+    while (received < a->total) {
+        uint32_t n = SpscRing_Read(&s_ring, buf, sizeof(buf));
+        if (n == 0) {
+            sched_yield();
+            continue;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            if (buf[i] != expect++) {
+                a->errors++;
+            }
+        }
+        received += n;
+    }
+    return NULL;
+}
+
+static void bench_two_threads(uint64_t total, uint32_t chunk)
+{
+    spsc_args_t args = {.total = total, .chunk = chunk, .errors = 0};
+    pthread_t p, c;
+    SpscRing_Init(&s_ring, s_ring_buf, RING_SIZE);
+
+    double t0 = now_sec();
+    pthread_create(&c, NULL, consumer, &args);
+    pthread_create(&p, NULL, producer, &args);
+    pthread_join(p, NULL);
+    pthread_join(c, NULL);
+    double t1 = now_sec();
+
+    char name[48];
+    snprintf(name, sizeof(name), "two-thread chunk=%u", chunk);
+    report(name, total, t1 - t0);
+    if (args.errors != 0 || s_ring.dropped != 0) {
+        printf("  !! %llu sequence errors, %u dropped\n", (unsigned long long)args.errors, s_ring.dropped);
+    }
+}
+
+/* 3. 按行读取 ---------------------------------------------------------------*/
+
+static const char *s_sample_lines[] = {
+    "+HMPUB OK\r\n",
+    "OK\r\n",
+    "+MIPCALL: 1,1,\"10.132.57.211\"\r\n",
+    "+HMREC: \"$oc/devices/xxxxxxxx/sys/commands/request_id=6b3f\",114,"
+    "\"{\"paras\":{\"fanStatus\":true},\"service_id\":\"Control\",\"command_name\":\"setFanStatus\"}\"\r\n",
+};
+
+static uint32_t build_stream(uint8_t *stream, uint32_t size)
+{
+    uint32_t len = 0;
+    for (uint32_t i = 0;; i++) {
+        const char *line = s_sample_lines[i % (sizeof(s_sample_lines) / sizeof(s_sample_lines[0]))];
+        uint32_t n = (uint32_t)strlen(line);
+        if (len + n > size) {
+            return len;
+        }
+        memcpy(stream + len, line, n);
+        len += n;
+    }
+}
+
+/** 原 at_rx_task 的算法：逐字节取模搬运 */
+static uint32_t legacy_split(const uint8_t *ring, uint16_t ring_size, uint16_t *tail, uint16_t head,
+                             char *line, uint16_t *line_pos, uint16_t line_size)
+{
+    uint32_t lines = 0;
+    while (head != *tail) {
+        char c = ring[*tail];
+        *tail = (*tail + 1) % ring_size;
+        if (c == '\n' || c == '\r') {
+            if (*line_pos > 0) {
+                line[*line_pos] = '\0';
+                *line_pos = 0;
+                lines++;
+            }
+        } else if (*line_pos < line_size - 1) {
+            line[(*line_pos)++] = c;
+        }
+    }
+    return lines;
+}
+
+static void bench_lines(uint64_t total)
+{
+    static uint8_t stream[1024];
+    uint32_t stream_len = build_stream(stream, sizeof(stream));
+    char line[512];
+    uint64_t lines_new = 0, lines_old = 0;
+
+    // 新实现：整段写入 + 按行读取
+    SpscRing_Init(&s_ring, s_ring_buf, RING_SIZE);
+    SpscRing_LineReader_t reader = {.buf = line, .size = sizeof(line)};
+    double t0 = now_sec();
+    for (uint64_t done = 0; done < total; done += stream_len) {
+        SpscRing_Write(&s_ring, stream, stream_len);
+        while (SpscRing_ReadLine(&s_ring, &reader)) {
+            lines_new++;
+        }
+    }
+    double t1 = now_sec();
+    report("ReadLine (word scan)", total, t1 - t0);
+
+    // 旧实现：两次 memcpy 写入 + 逐字节取模读取
+    uint16_t head = 0, tail = 0, line_pos = 0;
+    t0 = now_sec();
+    for (uint64_t done = 0; done < total; done += stream_len) {
+        uint32_t first = (head + stream_len > RING_SIZE) ? (uint32_t)(RING_SIZE - head) : stream_len;
+        memcpy(&s_ring_buf[head], stream, first);
+        memcpy(&s_ring_buf[0], stream + first, stream_len - first);
+        head = (head + stream_len) % RING_SIZE;
+        lines_old += legacy_split(s_ring_buf, RING_SIZE, &tail, head, line, &line_pos, sizeof(line));
+    }
+    t1 = now_sec();
+    report("legacy byte loop", total, t1 - t0);
+
+    if (lines_new != lines_old) {
+        printf("  !! line count mismatch: %llu vs %llu\n", (unsigned long long)lines_new, (unsigned long long)lines_old);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t total = (argc > 1) ? strtoull(argv[1], NULL, 10) << 20 : 256ULL << 20;
+
+    printf("SPSC ring benchmark, ring=%u B, %llu MB per case\n", RING_SIZE, (unsigned long long)(total >> 20));
+    bench_single_thread(total, 16);
+    bench_single_thread(total, 64);
+    bench_single_thread(total, 512);
+    bench_two_threads(total / 4, 64);
+    bench_two_threads(total / 4, 512);
+    bench_lines(total / 4);
+    return 0;
+}
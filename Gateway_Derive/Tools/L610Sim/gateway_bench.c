@@ -0,0 +1,339 @@
+/**
+ * @file      gateway_bench.c
+ * @author    Your Name
+ * @brief     网关AT/云平台链路的主机端端到端测试，对接 l610_sim 模拟器
+ *
+ * @details
+ *      直接编译固件中的 at_handler.c / at_script.c / huawei_iot_app.c / device_manager.c 等源文件，
+ *      RTOS与UART由 host/ 目录下的 pthreads/伪终端 实现替代。测试流程与 app_main.c 的状态机一致:
+ *      1. 等待模组就绪 (`+SIM READY` 或轮询 `AT+CPIN?`)，`AT` / `ATE0`
+ *      2. 冷启动连接云平台 (完整路径: 拨号 + HMCON)，打印连接脚本每步耗时
+ *      3. 上报子设备在线状态，然后循环: 更新全部子设备数据 -> `HuaweiIoT_PublishGatewayReport`，
+ *         统计上报路径耗时 (最小/平均/P50/P95/最大)
+ *      4. 热重连 (快速路径: 复用PDP，只重建MQTT会话)
+ *      5. 通过 `AT+SIMCTL=REBOOT` 让模拟器重启模组，测量从重启到重新连上云平台的恢复时间
+ *      6. 上报AT命令时延、任务/堆和样本端到端时延统计 (传感器样本在第3步中按带追踪尾部的帧登记)
+ *      期间模拟器注入的 `+HMREC` 会走与固件相同的命令分发和响应流程。
+ *
+ * @par 用法:
+ *      ./l610_sim -g ../../Log/<日志文件> &
+ *      ./gateway_bench [-p /tmp/l610] [-n 上报次数]
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "at_handler.h"
+#include "at_script.h"
+#include "cmsis_os2.h"
+#include "device_manager.h"
+#include "huawei_iot_app.h"
+#include "at_stats.h"
+#include "sample_trace.h"
+#include "lora_app.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define MAX_ITERATIONS     1000
+#define MODULE_READY_MS    15000
+#define CONNECT_ATTEMPTS   5     // 注入错误时，冷启动连接与 app_main.c 一样重试
+
+/* Firmware Dependencies -----------------------------------------------------*/
+
+// 固件中由 main.c / lora_app.c 提供的对象，主机端只需满足链接
+RNG_HandleTypeDef hrng;
+static CRC_TypeDef s_crc;
+CRC_HandleTypeDef hcrc = {.Instance = &s_crc};
+osThreadId_t s_lora_app_task_handle;
+
+bool LoRa_APP_Send(const uint8_t *data, uint8_t len)
+{
+    (void)data;
+    printf("[HOST] LoRa downlink %u bytes (not sent)\r\n", len);
+    return true;
+}
+
+bool LoRa_APP_QueueDownlink(uint8_t node_addr, const uint8_t *payload, uint8_t len)
+{
+    (void)payload;
+    printf("[HOST] LoRa downlink for 0x%02X, %u bytes (not queued)\r\n", node_addr, len);
+    return true;
+}
+
+void Error_Handler(void)
+{
+    abort();
+}
+
+/* Private Variables ---------------------------------------------------------*/
+
+static AT_Handler_t g_at_handle;
+static USART_TypeDef s_usart3;
+static UART_HandleTypeDef huart3 = {.Instance = &s_usart3};
+static DMA_HandleTypeDef hdma_rx;
+static DMA_HandleTypeDef hdma_tx;
+
+static volatile bool s_module_ready = false;
+static volatile uint32_t s_commands_handled = 0;
+
+/* Private Functions (Callbacks) ---------------------------------------------*/
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    AT_UartIdleCallback(&g_at_handle, huart, Size);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    AT_UartTxCpltCallback(&g_at_handle, huart);
+}
+
+static void on_module_ready(const char *urc_line)
+{
+    (void)urc_line;
+    s_module_ready = true;
+}
+
+static void on_cloud_command(const char *urc_line)
+{
+    HuaweiIoT_ParseHMREC(&g_at_handle, urc_line);
+    s_commands_handled++;
+}
+
+static const AT_URC_t urc_table[] = {
+    {"+SIM READY", on_module_ready},
+    {"+HMREC:", on_cloud_command},
+};
+
+/* Private Functions (Helpers) -----------------------------------------------*/
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void report_stats(const char *name, uint32_t *samples, uint32_t n)
+{
+    if (n == 0) {
+        printf("%-28s (no samples)\n", name);
+        return;
+    }
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        sum += samples[i];
+    }
+    qsort(samples, n, sizeof(samples[0]), cmp_u32);
+    printf("%-28s n=%-4u min=%-5u avg=%-7.1f p50=%-5u p95=%-5u max=%u ms\n", name, n, samples[0],
+           (double)sum / n, samples[n / 2], samples[(n * 95) / 100 < n ? (n * 95) / 100 : n - 1], samples[n - 1]);
+}
+
+/** 与 app_main.c 的 SYS_STATE_WAIT_FOR_MODULE / SYS_STATE_INITIALIZING 一致 */
+static bool wait_module_ready(void)
+{
+    char resp[64];
+    uint32_t start = osKernelGetTickCount();
+    while (osKernelGetTickCount() - start < MODULE_READY_MS) {
+        if (s_module_ready) {
+            break;
+        }
+        if (AT_SendCommand(&g_at_handle, "AT+CPIN?", 500, resp, sizeof(resp)) == AT_OK &&
+            strstr(resp, "+CPIN: READY") != NULL) {
+            break;
+        }
+        osDelay(200);
+    }
+    return AT_SendBasicCommand(&g_at_handle, "AT", 2000) == AT_OK &&
+           AT_SendBasicCommand(&g_at_handle, "ATE0", 2000) == AT_OK;
+}
+
+static bool connect_cloud(const char *label, uint32_t *elapsed)
+{
+    AT_ScriptResult_t result;
+    uint32_t t0 = osKernelGetTickCount();
+    AT_Status_t status = HuaweiIoT_ConnectCloud(&g_at_handle);
+    *elapsed = osKernelGetTickCount() - t0;
+    HuaweiIoT_GetLastConnectResult(&result);
+
+    printf("%-28s %s in %u ms, steps:", label, status == AT_OK ? "OK" : "FAILED", *elapsed);
+    for (uint8_t i = 0; i < result.trace_count; i++) {
+        printf(" %u:%ums%s", result.trace[i].step, result.trace[i].elapsed_ms, result.trace[i].success ? "" : "!");
+    }
+    printf("\n");
+    return status == AT_OK;
+}
+
+/** 让全部子设备的数据发生变化 (打上"脏"标记)，数值随迭代次数变化以改变负载长度 */
+static void update_all_devices(uint32_t iter)
+{
+    InternalSensorProperties_t in = {
+        .greenhouseTemperature = 22.5 + (iter % 10) * 0.1,
+        .greenhouseHumidity = 61.0 + (iter % 7),
+        .soilMoisture = 33.3f, .soilTemperature = 19.8f, .soilEc = 512, .soilPh = 6.7f,
+        .soilNitrogen = 40, .soilPhosphorus = 22, .soilPotassium = 130, .soilSalinity = 210,
+        .soilTds = 320, .soilFertility = 88, .lightIntensity = 12000 + iter,
+        .vocConcentration = 15, .co2Concentration = 420 + (uint16_t)(iter % 50),
+        .common = {.batteryLevel = 87, .batteryVoltage = 3.95f},
+    };
+    ControlNodeProperties_t ctrl = {
+        .fanStatus = (iter & 1) != 0, .growLightStatus = true, .pumpStatus = false,
+        .fanSpeed = (uint8_t)(iter % 100), .pumpSpeed = 0,
+    };
+    ExternalSensorProperties_t ext = {
+        .outdoorTemperature = 18.2, .outdoorHumidity = 72.0, .outdoorLightIntensity = 30000 + iter,
+        .airPressure = 1012.6, .altitude = 45.3, .location = "30.5728 N, 104.0668 E",
+        .common = {.batteryLevel = 64, .batteryVoltage = 3.81f},
+    };
+    DeviceManager_UpdateInternalSensorData(DEVICE_TYPE_SENSOR_Internal, &in);
+    DeviceManager_UpdateControlNodeData(DEVICE_TYPE_CONTROL, &ctrl);
+    DeviceManager_UpdateExternalSensorData(DEVICE_TYPE_SENSOR_External, &ext);
+
+    // 与 lora_app.c 一样登记传感器样本：节点测得 采集->射频 约1.2s，空中时间约90ms
+    uint32_t now = osKernelGetTickCount();
+    uint16_t trace_id = (uint16_t)(iter + 1);
+    SampleTrace_OnSample(DEVICE_TYPE_SENSOR_Internal, trace_id, 1200, now - 1290, now - 2);
+    SampleTrace_OnSample(DEVICE_TYPE_SENSOR_External, trace_id, 800, now - 890, now - 2);
+}
+
+/** 以目标板上的任务表构造一份系统监控快照并上报 (任务名取最长的情形) */
+static AT_Status_t publish_sample_system_stats(void)
+{
+    static const char *const names[] = {"defaultTask", "LoRa_APP_Task", "AT_RX_Task", "CloudUplinkTask",
+                                        "SysMonitorTask", "IDLE", "Tmr Svc"};
+    SystemMonitor_Snapshot_t snap = {
+        .period_us = 5000000, .heap_free = 61234, .heap_min_ever = 52800, .heap_largest_block = 58000,
+        .heap_free_blocks = 4, .heap_allocs = 1234, .heap_frees = 1190, .heap_frag_permille = 53,
+    };
+    for (uint8_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        SystemMonitor_TaskStats_t *t = &snap.tasks[snap.task_count++];
+        snprintf(t->name, sizeof(t->name), "%s", names[i]);
+        t->cpu_permille = (strcmp(names[i], "IDLE") == 0) ? 962 : 6 * i;
+        t->switches = 2500 + 10 * i;
+        t->stack_hwm_bytes = 31000 - 1000 * i;
+        t->priority = 24 + i;
+    }
+    return HuaweiIoT_PublishSystemStats(&g_at_handle, &snap);
+}
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(int argc, char **argv)
+{
+    const char *port = "/tmp/l610";
+    uint32_t iterations = 20;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:n:h")) != -1) {
+        switch (opt) {
+        case 'p': port = optarg; break;
+        case 'n': iterations = (uint32_t)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-p pty] [-n report iterations]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (iterations > MAX_ITERATIONS) {
+        iterations = MAX_ITERATIONS;
+    }
+
+    if (HAL_UART_HostOpen(&huart3, port) != HAL_OK) {
+        fprintf(stderr, "start l610_sim first (it creates %s)\n", port);
+        return 1;
+    }
+    __HAL_LINKDMA(&huart3, hdmarx, hdma_rx);
+    __HAL_LINKDMA(&huart3, hdmatx, hdma_tx);
+    HAL_DMA_Init(&hdma_tx);
+
+    if (AT_Init(&g_at_handle, &huart3, &hdma_rx, &hdma_tx) != osOK ||
+        !AT_RegisterURCCallbacks(&g_at_handle, urc_table, sizeof(urc_table) / sizeof(urc_table[0]))) {
+        fprintf(stderr, "AT handler init failed\n");
+        return 1;
+    }
+    HuaweiIoT_Init();
+    DeviceManager_Init();
+    SampleTrace_Init();
+
+    // 1. 模组就绪
+    uint32_t t0 = osKernelGetTickCount();
+    if (!wait_module_ready()) {
+        fprintf(stderr, "module not ready\n");
+        return 1;
+    }
+    printf("%-28s %u ms\n", "module ready", osKernelGetTickCount() - t0);
+
+    // 2. 冷启动连接
+    uint32_t cold_ms = 0, warm_ms, recover_ms;
+    bool connected = false;
+    for (uint8_t i = 0; i < CONNECT_ATTEMPTS && !connected; i++) {
+        uint32_t elapsed;
+        connected = connect_cloud("connect (cold, full path)", &elapsed);
+        cold_ms += elapsed;
+    }
+    if (!connected) {
+        return 1;
+    }
+    DeviceManager_SetCloudOnlineStatus(true);
+    HuaweiIoT_PublishAllSubDevicesOnline(&g_at_handle);
+
+    // 3. 上报路径
+    static uint32_t report_ms[MAX_ITERATIONS];
+    uint32_t report_ok = 0, report_fail = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        update_all_devices(i);
+        uint32_t start = osKernelGetTickCount();
+        SampleTrace_BeginReport(start);
+        AT_Status_t status = HuaweiIoT_PublishGatewayReport(&g_at_handle);
+        uint32_t elapsed = osKernelGetTickCount() - start;
+        if (status == AT_OK) {
+            report_ms[report_ok++] = elapsed;
+        } else {
+            report_fail++;
+        }
+    }
+
+    // 4. 热重连 (快速路径)
+    connect_cloud("reconnect (warm, fast path)", &warm_ms);
+
+    // 5. 模组重启后的恢复时间
+    s_module_ready = false;
+    t0 = osKernelGetTickCount();
+    AT_SendBasicCommand(&g_at_handle, "AT+SIMCTL=REBOOT", 2000);
+    bool recovered = false;
+    while (osKernelGetTickCount() - t0 < MODULE_READY_MS && !s_module_ready) {
+        osDelay(10);
+    }
+    if (s_module_ready && wait_module_ready()) {
+        for (uint8_t i = 0; i < CONNECT_ATTEMPTS && !recovered; i++) {
+            recovered = connect_cloud("  connect after reboot", &recover_ms);
+        }
+    }
+    uint32_t total_recover = osKernelGetTickCount() - t0;
+
+    // 6. AT命令时延统计：作为网关属性上报一次，并打印统计表和最近的事务
+    AT_Status_t stats_status = recovered ? HuaweiIoT_PublishModemStats(&g_at_handle) : AT_ERROR;
+    printf("\n");
+    AT_Stats_Dump();
+
+    // 7. 任务/堆统计：主机端没有FreeRTOS内核，用一份与目标板任务表相同规模的快照检验负载长度
+    AT_Status_t system_status = recovered ? publish_sample_system_stats() : AT_ERROR;
+
+    // 8. 样本端到端时延统计
+    AT_Status_t latency_status = recovered ? HuaweiIoT_PublishSampleLatency(&g_at_handle) : AT_ERROR;
+    printf("\n");
+    SampleTrace_Dump();
+
+    printf("\n--- summary ---\n");
+    printf("%-28s %u ms\n", "connect cold", cold_ms);
+    printf("%-28s %u ms\n", "connect warm", warm_ms);
+    printf("%-28s %s %u ms (includes simulated boot)\n", "recover after reboot", recovered ? "OK" : "FAILED",
+           total_recover);
+    report_stats("gateway report", report_ms, report_ok);
+    printf("%-28s %u failed, %u cloud commands handled, %u RX bytes dropped\n", "errors", report_fail,
+           s_commands_handled, g_at_handle.rx_ring.dropped);
+    printf("%-28s %s\n", "modem stats report", stats_status == AT_OK ? "OK" : "FAILED");
+    printf("%-28s %s\n", "system stats report", system_status == AT_OK ? "OK" : "FAILED");
+    printf("%-28s %s\n", "sample latency report", latency_status == AT_OK ? "OK" : "FAILED");
+
+    AT_DeInit(&g_at_handle);
+    return (report_fail == 0 && recovered) ? 0 : 2;
+}
@@ -0,0 +1,15 @@
+/**
+ * @file      FreeRTOS.h
+ * @author    Your Name
+ * @brief     主机端构建用: 只提供固件中用到的堆接口，映射到C库 malloc/free
+ */
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stdlib.h>
+
+#define pvPortMalloc(size) malloc(size)
+#define vPortFree(ptr)     free(ptr)
+
+#endif // INC_FREERTOS_H
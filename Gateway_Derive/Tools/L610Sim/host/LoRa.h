@@ -0,0 +1,10 @@
+/**
+ * @file      LoRa.h
+ * @author    Your Name
+ * @brief     主机端构建用: LoRa 驱动不参与主机端构建，lora_app.h 只需要该头文件存在
+ */
+
+#ifndef LORA_H
+#define LORA_H
+
+#endif // LORA_H
@@ -0,0 +1,109 @@
+/**
+ * @file      cmsis_os2.h
+ * @author    Your Name
+ * @brief     主机端构建用的 CMSIS-RTOS2 接口子集 (基于 pthreads 实现，见 cmsis_os2_posix.c)
+ * @note      只声明网关固件中 AT处理器/华为云应用层/设备管理器 实际用到的部分，
+ *            常量取值与 CMSIS-RTOS2 V2.1 一致。系统节拍固定为 1ms (与 FreeRTOSConfig.h 一致)。
+ */
+
+#ifndef CMSIS_OS2_H_
+#define CMSIS_OS2_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    osOK                   =  0,
+    osError                = -1,
+    osErrorTimeout         = -2,
+    osErrorResource        = -3,
+    osErrorParameter       = -4,
+    osErrorNoMemory        = -5,
+    osErrorISR             = -6,
+} osStatus_t;
+
+typedef enum {
+    osPriorityNone         =  0,
+    osPriorityIdle         =  1,
+    osPriorityLow          =  8,
+    osPriorityBelowNormal  = 16,
+    osPriorityNormal       = 24,
+    osPriorityAboveNormal  = 32,
+    osPriorityHigh         = 40,
+    osPriorityRealtime     = 48,
+} osPriority_t;
+
+#define osWaitForever         0xFFFFFFFFU
+
+#define osFlagsWaitAny        0x00000000U
+#define osFlagsWaitAll        0x00000001U
+#define osFlagsNoClear        0x00000002U
+
+#define osFlagsError          0x80000000U
+#define osFlagsErrorTimeout   0xFFFFFFFEU
+#define osFlagsErrorParameter 0xFFFFFFFCU
+
+#define osMutexRecursive      0x00000001U
+#define osMutexPrioInherit    0x00000002U
+#define osMutexRobust         0x00000008U
+
+typedef void (*osThreadFunc_t)(void *argument);
+typedef void *osThreadId_t;
+typedef void *osMutexId_t;
+typedef void *osSemaphoreId_t;
+
+typedef struct {
+    const char  *name;
+    uint32_t     attr_bits;
+    void        *cb_mem;
+    uint32_t     cb_size;
+    void        *stack_mem;
+    uint32_t     stack_size;
+    osPriority_t priority;
+    uint32_t     tz_module;
+    uint32_t     reserved;
+} osThreadAttr_t;
+
+typedef struct {
+    const char *name;
+    uint32_t    attr_bits;
+    void       *cb_mem;
+    uint32_t    cb_size;
+} osMutexAttr_t;
+
+typedef struct {
+    const char *name;
+    uint32_t    attr_bits;
+    void       *cb_mem;
+    uint32_t    cb_size;
+} osSemaphoreAttr_t;
+
+uint32_t        osKernelGetTickCount(void);
+osStatus_t      osDelay(uint32_t ticks);
+
+osThreadId_t    osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr);
+osThreadId_t    osThreadGetId(void);
+osStatus_t      osThreadTerminate(osThreadId_t thread_id);
+uint32_t        osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags);
+uint32_t        osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout);
+
+osMutexId_t     osMutexNew(const osMutexAttr_t *attr);
+osStatus_t      osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout);
+osStatus_t      osMutexRelease(osMutexId_t mutex_id);
+osStatus_t      osMutexDelete(osMutexId_t mutex_id);
+
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t *attr);
+osStatus_t      osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout);
+osStatus_t      osSemaphoreRelease(osSemaphoreId_t semaphore_id);
+uint32_t        osSemaphoreGetCount(osSemaphoreId_t semaphore_id);
+osStatus_t      osSemaphoreDelete(osSemaphoreId_t semaphore_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CMSIS_OS2_H_
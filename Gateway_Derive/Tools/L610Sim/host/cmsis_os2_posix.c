@@ -0,0 +1,342 @@
+/**
+ * @file      cmsis_os2_posix.c
+ * @author    Your Name
+ * @brief     CMSIS-RTOS2 接口子集的 pthreads 实现 (仅供主机端构建)
+ * @note      线程优先级被忽略：主机上的调度顺序与目标板不同，因此只用于功能测试和
+ *            由模组时延主导的端到端时间测量，不适合测量任务切换开销。
+ */
+
+#define _GNU_SOURCE
+#include "cmsis_os2.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Private Types -------------------------------------------------------------*/
+
+typedef struct {
+    pthread_t       thread;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    uint32_t        flags;
+    osThreadFunc_t  func;
+    void           *argument;
+} os_thread_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    uint32_t        count;
+    uint32_t        max;
+} os_semaphore_t;
+
+/* Private Variables ---------------------------------------------------------*/
+
+static __thread os_thread_t *s_current;
+static struct timespec s_epoch;
+static pthread_once_t s_epoch_once = PTHREAD_ONCE_INIT;
+
+/* Private Functions ---------------------------------------------------------*/
+
+static void epoch_init(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &s_epoch);
+}
+
+/** 把以节拍 (1ms) 计的超时换算为绝对截止时刻 */
+static struct timespec deadline_after(uint32_t ticks)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += ticks / 1000U;
+    ts.tv_nsec += (long)(ticks % 1000U) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+static void cond_init_monotonic(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static os_thread_t *thread_alloc(void)
+{
+    os_thread_t *t = calloc(1, sizeof(*t));
+    if (t != NULL) {
+        pthread_mutex_init(&t->lock, NULL);
+        cond_init_monotonic(&t->cond);
+    }
+    return t;
+}
+
+static void *thread_entry(void *arg)
+{
+    os_thread_t *t = arg;
+    s_current = t;
+    t->func(t->argument);
+    return NULL;
+}
+
+/* Kernel --------------------------------------------------------------------*/
+
+uint32_t osKernelGetTickCount(void)
+{
+    struct timespec ts;
+    pthread_once(&s_epoch_once, epoch_init);
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((ts.tv_sec - s_epoch.tv_sec) * 1000 + (ts.tv_nsec - s_epoch.tv_nsec) / 1000000);
+}
+
+osStatus_t osDelay(uint32_t ticks)
+{
+    struct timespec ts = {.tv_sec = ticks / 1000U, .tv_nsec = (long)(ticks % 1000U) * 1000000L};
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+    return osOK;
+}
+
+/* Threads -------------------------------------------------------------------*/
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr)
+{
+    (void)attr;
+    os_thread_t *t = thread_alloc();
+    if (t == NULL) {
+        return NULL;
+    }
+    t->func = func;
+    t->argument = argument;
+    if (pthread_create(&t->thread, NULL, thread_entry, t) != 0) {
+        free(t);
+        return NULL;
+    }
+    pthread_detach(t->thread);
+    return t;
+}
+
+osThreadId_t osThreadGetId(void)
+{
+    if (s_current == NULL) {
+        s_current = thread_alloc(); // 主线程或外部创建的线程 (例如UART接收线程) 首次调用
+        s_current->thread = pthread_self();
+    }
+    return s_current;
+}
+
+osStatus_t osThreadTerminate(osThreadId_t thread_id)
+{
+    os_thread_t *t = thread_id;
+    if (t == NULL) {
+        return osErrorParameter;
+    }
+    pthread_cancel(t->thread);
+    return osOK;
+}
+
+uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags)
+{
+    os_thread_t *t = thread_id;
+    if (t == NULL || (flags & osFlagsError) != 0) {
+        return osFlagsErrorParameter;
+    }
+    pthread_mutex_lock(&t->lock);
+    t->flags |= flags;
+    uint32_t result = t->flags;
+    pthread_cond_broadcast(&t->cond);
+    pthread_mutex_unlock(&t->lock);
+    return result;
+}
+
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout)
+{
+    os_thread_t *t = osThreadGetId();
+    struct timespec deadline = deadline_after(timeout);
+    uint32_t result;
+
+    pthread_mutex_lock(&t->lock);
+    for (;;) {
+        uint32_t hit = t->flags & flags;
+        bool done = (options & osFlagsWaitAll) ? (hit == flags) : (hit != 0);
+        if (done) {
+            result = t->flags;
+            if ((options & osFlagsNoClear) == 0) {
+                t->flags &= ~flags;
+            }
+            break;
+        }
+        if (timeout == 0) {
+            result = osFlagsErrorTimeout;
+            break;
+        }
+        int rc = (timeout == osWaitForever) ? pthread_cond_wait(&t->cond, &t->lock)
+                                            : pthread_cond_timedwait(&t->cond, &t->lock, &deadline);
+        if (rc == ETIMEDOUT) {
+            result = osFlagsErrorTimeout;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&t->lock);
+    return result;
+}
+
+/* Mutexes -------------------------------------------------------------------*/
+
+osMutexId_t osMutexNew(const osMutexAttr_t *attr)
+{
+    (void)attr;
+    pthread_mutex_t *m = malloc(sizeof(*m));
+    pthread_mutexattr_t ma;
+    if (m == NULL) {
+        return NULL;
+    }
+    // 统一使用递归锁：对非递归用法同样正确
+    pthread_mutexattr_init(&ma);
+    pthread_mutexattr_settype(&ma, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(m, &ma);
+    pthread_mutexattr_destroy(&ma);
+    return m;
+}
+
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout)
+{
+    pthread_mutex_t *m = mutex_id;
+    if (m == NULL) {
+        return osErrorParameter;
+    }
+    if (timeout == osWaitForever) {
+        return pthread_mutex_lock(m) == 0 ? osOK : osError;
+    }
+    if (timeout == 0) {
+        return pthread_mutex_trylock(m) == 0 ? osOK : osErrorResource;
+    }
+
+    // pthread_mutex_timedlock 只接受 CLOCK_REALTIME，这里按1ms轮询
+    uint32_t start = osKernelGetTickCount();
+    while (pthread_mutex_trylock(m) != 0) {
+        if (osKernelGetTickCount() - start >= timeout) {
+            return osErrorTimeout;
+        }
+        osDelay(1);
+    }
+    return osOK;
+}
+
+osStatus_t osMutexRelease(osMutexId_t mutex_id)
+{
+    pthread_mutex_t *m = mutex_id;
+    if (m == NULL) {
+        return osErrorParameter;
+    }
+    return pthread_mutex_unlock(m) == 0 ? osOK : osErrorResource;
+}
+
+osStatus_t osMutexDelete(osMutexId_t mutex_id)
+{
+    pthread_mutex_t *m = mutex_id;
+    if (m == NULL) {
+        return osErrorParameter;
+    }
+    pthread_mutex_destroy(m);
+    free(m);
+    return osOK;
+}
+
+/* Semaphores ----------------------------------------------------------------*/
+
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t *attr)
+{
+    (void)attr;
+    if (max_count == 0 || initial_count > max_count) {
+        return NULL;
+    }
+    os_semaphore_t *s = calloc(1, sizeof(*s));
+    if (s == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&s->lock, NULL);
+    cond_init_monotonic(&s->cond);
+    s->count = initial_count;
+    s->max = max_count;
+    return s;
+}
+
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout)
+{
+    os_semaphore_t *s = semaphore_id;
+    if (s == NULL) {
+        return osErrorParameter;
+    }
+    struct timespec deadline = deadline_after(timeout);
+    osStatus_t status = osOK;
+
+    pthread_mutex_lock(&s->lock);
+    while (s->count == 0) {
+        if (timeout == 0) {
+            status = osErrorResource;
+            break;
+        }
+        int rc = (timeout == osWaitForever) ? pthread_cond_wait(&s->cond, &s->lock)
+                                            : pthread_cond_timedwait(&s->cond, &s->lock, &deadline);
+        if (rc == ETIMEDOUT && s->count == 0) {
+            status = osErrorTimeout;
+            break;
+        }
+    }
+    if (status == osOK) {
+        s->count--;
+    }
+    pthread_mutex_unlock(&s->lock);
+    return status;
+}
+
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id)
+{
+    os_semaphore_t *s = semaphore_id;
+    if (s == NULL) {
+        return osErrorParameter;
+    }
+    osStatus_t status = osOK;
+    pthread_mutex_lock(&s->lock);
+    if (s->count < s->max) {
+        s->count++;
+        pthread_cond_signal(&s->cond);
+    } else {
+        status = osErrorResource;
+    }
+    pthread_mutex_unlock(&s->lock);
+    return status;
+}
+
+uint32_t osSemaphoreGetCount(osSemaphoreId_t semaphore_id)
+{
+    os_semaphore_t *s = semaphore_id;
+    if (s == NULL) {
+        return 0;
+    }
+    pthread_mutex_lock(&s->lock);
+    uint32_t count = s->count;
+    pthread_mutex_unlock(&s->lock);
+    return count;
+}
+
+osStatus_t osSemaphoreDelete(osSemaphoreId_t semaphore_id)
+{
+    os_semaphore_t *s = semaphore_id;
+    if (s == NULL) {
+        return osErrorParameter;
+    }
+    pthread_mutex_destroy(&s->lock);
+    pthread_cond_destroy(&s->cond);
+    free(s);
+    return osOK;
+}
@@ -0,0 +1,14 @@
+/**
+ * @file      main.h
+ * @author    Your Name
+ * @brief     主机端构建用: 替代 Core/Inc/main.h (其中的GPIO引脚定义在主机上没有意义)
+ */
+
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#include "stm32u5xx_hal.h"
+
+void Error_Handler(void);
+
+#endif // __MAIN_H
@@ -0,0 +1,164 @@
+/**
+ * @file      stm32u5xx_hal.h
+ * @author    Your Name
+ * @brief     主机端构建用的 STM32U5 HAL 子集: UART + GPDMA，底层为伪终端 (见 stm32u5xx_hal_pty.c)
+ * @note      结构体只保留 at_handler.c 访问到的成员，名称与真实HAL一致，
+ *            因此固件源文件无需任何修改即可在主机上编译。
+ */
+
+#ifndef STM32U5XX_HAL_H
+#define STM32U5XX_HAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define __IO volatile
+#define __ALIGNED(x) __attribute__((aligned(x)))
+
+typedef enum {
+    HAL_OK      = 0x00U,
+    HAL_ERROR   = 0x01U,
+    HAL_BUSY    = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+/* DMA -----------------------------------------------------------------------*/
+
+#define DMA_GPDMA_LINEAR_NODE          0x00000001U
+#define DMA_TCEM_LAST_LL_ITEM_TRANSFER 0xC0000000U
+#define DMA_EXCHANGE_NONE              0x00000000U
+#define DMA_DATA_RIGHTALIGN_ZEROPADDED 0x00000000U
+#define DMA_TRIG_POLARITY_MASKED       0x00000000U
+#define DMA_LSM_FULL_EXECUTION         0x00000000U
+#define DMA_LINK_ALLOCATED_PORT0       0x00000000U
+#define DMA_LINKEDLIST_NORMAL          0x00000000U
+#define DMA_NORMAL                     0x00000000U
+#define DMA_LINKEDLIST                 0x00000080U
+
+typedef struct {
+    uint32_t TDR;
+    uint32_t ICR;
+} USART_TypeDef;
+
+typedef struct {
+    uint32_t Request, BlkHWRequest, Direction, SrcInc, DestInc, SrcDataWidth, DestDataWidth, Priority;
+    uint32_t SrcBurstLength, DestBurstLength, TransferAllocatedPort, TransferEventMode, Mode;
+} DMA_InitTypeDef;
+
+typedef struct {
+    uint32_t Priority, LinkStepMode, LinkAllocatedPort, TransferEventMode, LinkedListMode;
+} DMA_InitLinkedListTypeDef;
+
+typedef struct { uint32_t DataExchange, DataAlignment; } DMA_DataHandlingConfTypeDef;
+typedef struct { uint32_t TriggerMode, TriggerPolarity, TriggerSelection; } DMA_TriggerConfTypeDef;
+typedef struct { uint32_t RepeatBlockCount; } DMA_RepeatBlockConfTypeDef;
+
+typedef struct {
+    uint32_t                    NodeType;
+    DMA_InitTypeDef             Init;
+    DMA_DataHandlingConfTypeDef DataHandlingConfig;
+    DMA_TriggerConfTypeDef      TriggerConfig;
+    DMA_RepeatBlockConfTypeDef  RepeatBlockConfig;
+    uint32_t                    SrcAddress;
+    uint32_t                    DstAddress;
+    uint32_t                    DataSize;
+} DMA_NodeConfTypeDef;
+
+/** 节点: LinkRegisters[0] 为源地址，[1] 为长度 (主机端约定)，next 指向队列中的下一节点 */
+typedef struct DMA_NodeTypeDef {
+    uint32_t                LinkRegisters[8U];
+    uint32_t                NodeInfo;
+    struct DMA_NodeTypeDef *next;
+} DMA_NodeTypeDef;
+
+typedef struct {
+    DMA_NodeTypeDef *Head;
+    uint32_t         NodeNumber;
+    uint32_t         State;
+    uint32_t         ErrorCode;
+    uint32_t         Type;
+} DMA_QListTypeDef;
+
+typedef struct {
+    void                     *Instance;
+    DMA_InitTypeDef           Init;
+    DMA_InitLinkedListTypeDef InitLinkedList;
+    DMA_QListTypeDef         *LinkedListQueue;
+    uint32_t                  Mode;
+    void                     *Parent;
+} DMA_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMAEx_List_Init(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMAEx_List_BuildNode(DMA_NodeConfTypeDef const *conf, DMA_NodeTypeDef *node);
+HAL_StatusTypeDef HAL_DMAEx_List_InsertNode_Tail(DMA_QListTypeDef *queue, DMA_NodeTypeDef *node);
+HAL_StatusTypeDef HAL_DMAEx_List_ResetQ(DMA_QListTypeDef *queue);
+HAL_StatusTypeDef HAL_DMAEx_List_LinkQ(DMA_HandleTypeDef *hdma, DMA_QListTypeDef *queue);
+HAL_StatusTypeDef HAL_DMAEx_List_UnLinkQ(DMA_HandleTypeDef *hdma);
+
+#define __HAL_LINKDMA(__HANDLE__, __PPP_DMA_FIELD__, __DMA_HANDLE__) \
+    do {                                                             \
+        (__HANDLE__)->__PPP_DMA_FIELD__ = &(__DMA_HANDLE__);         \
+        (__DMA_HANDLE__).Parent = (__HANDLE__);                      \
+    } while (0)
+
+/* UART ----------------------------------------------------------------------*/
+
+#define UART_IT_IDLE     0x0004U
+#define UART_CLEAR_IDLEF 0x0010U
+
+typedef struct __UART_HandleTypeDef {
+    USART_TypeDef     *Instance;
+    DMA_HandleTypeDef *hdmarx;
+    DMA_HandleTypeDef *hdmatx;
+    int                fd; ///< [主机端] 伪终端文件描述符
+} UART_HandleTypeDef;
+
+#define __HAL_UART_CLEAR_IT(__HANDLE__, __IT_CLEAR__) ((void)(__HANDLE__))
+#define __HAL_UART_DISABLE_IT(__HANDLE__, __INTERRUPT__) ((void)(__HANDLE__))
+
+/**
+ * @brief [主机端] 打开伪终端并绑定到UART句柄
+ * @param path 伪终端从端路径 (例如 l610_sim 创建的 /tmp/l610)
+ */
+HAL_StatusTypeDef HAL_UART_HostOpen(UART_HandleTypeDef *huart, const char *path);
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_DMAStop(UART_HandleTypeDef *huart);
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+
+/* CRC -----------------------------------------------------------------------*/
+
+/** 只满足 lora_protocol.c 的编译，计算结果无意义 (主机端不会真正发出LoRa帧) */
+typedef struct {
+    __IO uint32_t DR;
+} CRC_TypeDef;
+
+typedef struct {
+    CRC_TypeDef *Instance;
+} CRC_HandleTypeDef;
+
+#define READ_REG(REG)                  ((REG))
+#define __HAL_CRC_DR_RESET(__HANDLE__) ((__HANDLE__)->Instance->DR = 0U)
+
+/* RNG -----------------------------------------------------------------------*/
+
+typedef struct {
+    void *Instance;
+} RNG_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_RNG_GenerateRandomNumber(RNG_HandleTypeDef *hrng, uint32_t *random32bit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STM32U5XX_HAL_H
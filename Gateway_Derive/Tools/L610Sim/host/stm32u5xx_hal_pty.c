@@ -0,0 +1,220 @@
+/**
+ * @file      stm32u5xx_hal_pty.c
+ * @author    Your Name
+ * @brief     UART/GPDMA HAL 子集的主机端实现: 收发走伪终端
+ *
+ * @details
+ *      - 发送: `HAL_UART_Transmit_DMA` 同步写入伪终端后调用 `HAL_UART_TxCpltCallback`；
+ *        链表模式下依次写出队列中的后续节点，与GPDMA链表 "最后一个节点完成才产生事件" 的语义一致。
+ *      - 接收: 后台线程阻塞读取伪终端，每次 read() 返回的数据视为一次 "空闲线路" 事件，
+ *        写入当前DMA缓冲区后调用 `HAL_UARTEx_RxEventCallback`。
+ *
+ * @note  链表节点中的地址是32位的 (与目标板一致)，因此主机端必须以非PIE方式链接，
+ *        保证静态数据和小块堆内存位于4GB以下 (见 Makefile 中的 -no-pie)。
+ */
+
+#define _GNU_SOURCE
+#include "stm32u5xx_hal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+/* Private Variables ---------------------------------------------------------*/
+
+static pthread_mutex_t s_rx_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t *s_rx_buf;
+static uint16_t s_rx_size;
+static bool s_rx_armed;
+static bool s_rx_thread_started;
+static pthread_t s_rx_thread;
+
+/* Private Functions ---------------------------------------------------------*/
+
+static void write_all(int fd, const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            perror("[HAL] pty write");
+            return;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+static void *rx_thread(void *arg)
+{
+    UART_HandleTypeDef *huart = arg;
+
+    for (;;) {
+        struct pollfd pfd = {.fd = huart->fd, .events = POLLIN};
+        if (poll(&pfd, 1, 100) <= 0) {
+            continue;
+        }
+
+        pthread_mutex_lock(&s_rx_lock);
+        uint8_t *buf = s_rx_buf;
+        uint16_t size = s_rx_size;
+        bool armed = s_rx_armed;
+        pthread_mutex_unlock(&s_rx_lock);
+        if (!armed) {
+            usleep(1000); // DMA未启动，数据留在伪终端中
+            continue;
+        }
+
+        ssize_t n = read(huart->fd, buf, size);
+        if (n > 0) {
+            pthread_mutex_lock(&s_rx_lock);
+            s_rx_armed = false; // 回调中会以另一个缓冲区重新启动接收
+            pthread_mutex_unlock(&s_rx_lock);
+            HAL_UARTEx_RxEventCallback(huart, (uint16_t)n);
+        } else if (n == 0 || (errno != EINTR && errno != EAGAIN)) {
+            usleep(10000); // 模拟器退出或重启中
+        }
+    }
+    return NULL;
+}
+
+/* UART ----------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_UART_HostOpen(UART_HandleTypeDef *huart, const char *path)
+{
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        return HAL_ERROR;
+    }
+    struct termios tio;
+    tcgetattr(fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+    tcflush(fd, TCIOFLUSH);
+    huart->fd = fd;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size)
+{
+    if (pData == NULL || Size == 0) {
+        return HAL_ERROR;
+    }
+    write_all(huart->fd, pData, Size);
+
+    // 链表模式: 头节点由本函数的参数改写，其余节点按队列顺序发出
+    DMA_HandleTypeDef *hdma = huart->hdmatx;
+    if (hdma != NULL && hdma->Mode == DMA_LINKEDLIST && hdma->LinkedListQueue != NULL) {
+        for (DMA_NodeTypeDef *node = hdma->LinkedListQueue->Head->next; node != NULL; node = node->next) {
+            write_all(huart->fd, (const uint8_t *)(uintptr_t)node->LinkRegisters[0], node->LinkRegisters[1]);
+        }
+    }
+
+    HAL_UART_TxCpltCallback(huart);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    pthread_mutex_lock(&s_rx_lock);
+    s_rx_buf = pData;
+    s_rx_size = Size;
+    s_rx_armed = true;
+    if (!s_rx_thread_started) {
+        s_rx_thread_started = (pthread_create(&s_rx_thread, NULL, rx_thread, huart) == 0);
+    }
+    pthread_mutex_unlock(&s_rx_lock);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_DMAStop(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+    pthread_mutex_lock(&s_rx_lock);
+    s_rx_armed = false;
+    pthread_mutex_unlock(&s_rx_lock);
+    return HAL_OK;
+}
+
+/* DMA -----------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    hdma->Mode = DMA_NORMAL;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma)
+{
+    hdma->LinkedListQueue = NULL;
+    hdma->Parent = NULL;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_Init(DMA_HandleTypeDef *hdma)
+{
+    hdma->Mode = DMA_LINKEDLIST;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_BuildNode(DMA_NodeConfTypeDef const *conf, DMA_NodeTypeDef *node)
+{
+    memset(node, 0, sizeof(*node));
+    node->LinkRegisters[0] = conf->SrcAddress;
+    node->LinkRegisters[1] = conf->DataSize;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_InsertNode_Tail(DMA_QListTypeDef *queue, DMA_NodeTypeDef *node)
+{
+    DMA_NodeTypeDef **tail = &queue->Head;
+    while (*tail != NULL) {
+        tail = &(*tail)->next;
+    }
+    *tail = node;
+    node->next = NULL;
+    queue->NodeNumber++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_ResetQ(DMA_QListTypeDef *queue)
+{
+    memset(queue, 0, sizeof(*queue));
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_LinkQ(DMA_HandleTypeDef *hdma, DMA_QListTypeDef *queue)
+{
+    if (hdma->Mode != DMA_LINKEDLIST || queue->Head == NULL) {
+        return HAL_ERROR;
+    }
+    hdma->LinkedListQueue = queue;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_UnLinkQ(DMA_HandleTypeDef *hdma)
+{
+    hdma->LinkedListQueue = NULL;
+    return HAL_OK;
+}
+
+/* RNG -----------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_RNG_GenerateRandomNumber(RNG_HandleTypeDef *hrng, uint32_t *random32bit)
+{
+    (void)hrng;
+    static uint32_t state = 0x12345678U;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    *random32bit = state;
+    return HAL_OK;
+}
@@ -0,0 +1,904 @@
+/**
+ * @file      l610_sim.c
+ * @author    Your Name
+ * @brief     Fibocom L610 模组主机端模拟器 (基于伪终端)
+ *
+ * @details
+ *      在 Linux/macOS 上创建一个伪终端 (pty)，在其从端上模拟 L610 的AT命令行为，
+ *      供网关的主机端构建 (见 host/ 与 gateway_bench.c) 或串口调试工具直接连接，
+ *      无需真实模组和SIM卡即可做端到端的AT/云平台测试与时延测试。
+ *
+ * @par 支持的命令:
+ *      `AT`, `ATE0`/`ATE1`, `AT+CPIN?`, `AT+MIPCALL?`, `AT+MIPCALL=0/1`, `AT+HMCON=...`, `AT+HMDIS`,
+ *      `AT+HMPUB=qos,"topic",len,"payload"` (内联负载) 以及 `AT+HMPUB=qos,"topic",len` (数据模式，
+ *      先回 '>' 提示符再接收 len 字节负载，需 `-d` 开启)。
+ *      另有模拟器专用的 `AT+SIMCTL=REBOOT`，供测试程序触发一次模组重启。
+ *
+ * @par 故障注入:
+ *      - 响应时延: 默认值取自 Log/ 目录下的串口调试日志 (HMCON约830ms, HMPUB约180ms)，
+ *        可用 `-g <日志>` 从日志重新推导，或在场景文件中用 `latency` 覆盖，`-x` 整体缩放。
+ *      - 错误: `-e <百分比>` 让 HMCON/HMPUB 按概率返回 "ERR:"；场景文件中的 `error` 可针对任意命令。
+ *      - 重启: `-r <毫秒>` 或场景文件中的 `reboot`，模组静默 `boot` 毫秒后重新上报 `+SIM READY`，
+ *        PDP与MQTT会话全部丢失。
+ *      - URC: 场景文件中的 `urc` 在每次MQTT连接建立后按时注入 (例如 `+HMREC`)；
+ *        `-g` 会把日志里的 `+HMREC` 作为URC加入场景。
+ *
+ * @par 场景文件格式 (每行一条，'#' 开头为注释):
+ *      boot    <ms>                       模组上电/重启到 +SIM READY 的时间
+ *      latency <命令前缀> <ms> [抖动ms]    例如 `latency AT+HMPUB 180 40`
+ *      error   <命令前缀> <百分比> [响应]   例如 `error AT+HMCON 20 +HMCON ERR:4`
+ *      urc     <ms> <文本>                MQTT连接建立后 ms 毫秒注入一条URC
+ *      reboot  <ms>                       模拟器启动后 ms 毫秒模组重启一次
+ *
+ * @par 交互控制:
+ *      在模拟器的标准输入中输入 `reboot`、`stats`，或直接输入一行以 '+' 开头的文本作为URC注入。
+ *
+ * @par 用法:
+ *      make && ./l610_sim -l /tmp/l610 -g ../../Log/<日志文件>
+ */
+
+#define _GNU_SOURCE
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define MAX_RULES       32
+#define MAX_URCS        16
+#define MAX_EVENTS      64
+#define LINE_SIZE       4096
+#define DATA_SIZE       8192
+#define SIM_IP          "10.122.14.103" // 与调试日志中的地址一致
+
+/* Private Types -------------------------------------------------------------*/
+
+/**
+ * @brief 命令规则: 时延与错误注入，按命令前缀匹配 (最长匹配优先)
+ */
+typedef struct {
+    char     prefix[32];
+    uint32_t latency_ms;
+    uint32_t jitter_ms;
+    uint32_t error_pct;
+    char     error_resp[64];
+} rule_t;
+
+/**
+ * @brief 定时事件的类型
+ */
+typedef enum {
+    EV_TEXT,       ///< 输出一行文本
+    EV_PDP_UP,     ///< PDP激活完成，输出 +MIPCALL: <ip>
+    EV_MQTT_UP,    ///< MQTT连接建立，输出 +HMCON OK 并安排URC
+    EV_MQTT_URC,   ///< MQTT会话内的URC (会话断开后作废)
+    EV_REBOOT,     ///< 模组重启
+    EV_BOOT_DONE,  ///< 启动完成，输出 +SIM READY
+} event_kind_t;
+
+typedef struct {
+    uint64_t     due_ms;
+    event_kind_t kind;
+    uint32_t     session; ///< 事件产生时的MQTT会话号，用于作废过期的URC
+    char        *text;
+} event_t;
+
+typedef struct {
+    uint32_t at_ms;
+    char    *text;
+} urc_t;
+
+/* Private Variables ---------------------------------------------------------*/
+
+static rule_t   s_rules[MAX_RULES];
+static int      s_rule_count;
+static urc_t    s_urcs[MAX_URCS];
+static int      s_urc_count;
+static event_t  s_events[MAX_EVENTS];
+static int      s_event_count;
+
+static int      s_master = -1;
+static uint32_t s_boot_ms = 500;
+static double   s_time_scale = 1.0;
+static uint32_t s_baud = 0;
+static uint32_t s_default_error_pct = 0;
+static bool     s_data_mode_enabled = false;
+static bool     s_verbose = false;
+static volatile sig_atomic_t s_quit = 0;
+
+// 模组状态
+static bool     s_ready = false;
+static bool     s_echo = true;
+static bool     s_pdp_up = false;
+static bool     s_mqtt_up = false;
+static uint32_t s_session = 0;
+
+// 数据模式接收状态
+static bool     s_data_active = false;
+static uint32_t s_data_expect = 0;
+static uint32_t s_data_got = 0;
+static char     s_data_topic[256];
+
+// 统计
+static struct {
+    uint32_t commands;
+    uint32_t publishes;
+    uint32_t publish_errors;
+    uint64_t publish_bytes;
+    uint32_t connects;
+    uint32_t reboots;
+    uint32_t urcs;
+} s_stats;
+
+/* Private Functions (Utilities) ---------------------------------------------*/
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static uint64_t s_start_ms;
+
+static void sim_log(const char *fmt, ...)
+{
+    va_list ap;
+    printf("[%8.3f] ", (double)(now_ms() - s_start_ms) / 1000.0);
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+    putchar('\n');
+    fflush(stdout);
+}
+
+static void write_all(const char *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(s_master, data, len);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            return;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+/** 输出一行响应，格式与模组一致: "\r\n<text>\r\n" */
+static void emit_line(const char *text)
+{
+    write_all("\r\n", 2);
+    write_all(text, strlen(text));
+    write_all("\r\n", 2);
+    if (s_verbose) {
+        sim_log("<- %s", text);
+    }
+}
+
+static bool starts_with_ci(const char *s, const char *prefix)
+{
+    while (*prefix) {
+        if (toupper((unsigned char)*s++) != toupper((unsigned char)*prefix++)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Private Functions (Rules and Events) --------------------------------------*/
+
+static const rule_t *rule_match(const char *cmd);
+
+/** 查找或新建前缀规则；新建的规则继承当前最长匹配规则的时延 */
+static rule_t *rule_get(const char *prefix)
+{
+    for (int i = 0; i < s_rule_count; i++) {
+        if (strcasecmp(s_rules[i].prefix, prefix) == 0) {
+            return &s_rules[i];
+        }
+    }
+    if (s_rule_count == MAX_RULES) {
+        return NULL;
+    }
+    const rule_t *parent = rule_match(prefix);
+    rule_t *r = &s_rules[s_rule_count];
+    memset(r, 0, sizeof(*r));
+    if (parent != NULL) {
+        r->latency_ms = parent->latency_ms;
+        r->jitter_ms = parent->jitter_ms;
+    }
+    snprintf(r->prefix, sizeof(r->prefix), "%s", prefix);
+    s_rule_count++;
+    return r;
+}
+
+static const rule_t *rule_match(const char *cmd)
+{
+    const rule_t *best = NULL;
+    size_t best_len = 0;
+    for (int i = 0; i < s_rule_count; i++) {
+        size_t n = strlen(s_rules[i].prefix);
+        if (n > best_len && starts_with_ci(cmd, s_rules[i].prefix)) {
+            best = &s_rules[i];
+            best_len = n;
+        }
+    }
+    return best;
+}
+
+/** 命令的响应时延: 规则时延 + 抖动，再加上命令本身在串口线上的传输时间 */
+static uint32_t response_delay(const rule_t *rule, size_t cmd_len)
+{
+    double ms = 0;
+    if (rule != NULL) {
+        ms = rule->latency_ms;
+        if (rule->jitter_ms > 0) {
+            ms += (double)(rand() % (int)(rule->jitter_ms + 1));
+        }
+    }
+    ms *= s_time_scale;
+    if (s_baud > 0) {
+        ms += (double)cmd_len * 10.0 * 1000.0 / s_baud;
+    }
+    return (uint32_t)ms;
+}
+
+static void event_add(uint32_t delay_ms, event_kind_t kind, const char *text)
+{
+    if (s_event_count == MAX_EVENTS) {
+        sim_log("!! event queue full, dropped: %s", text ? text : "(event)");
+        return;
+    }
+    event_t ev = {.due_ms = now_ms() + delay_ms, .kind = kind, .session = s_session,
+                  .text = text ? strdup(text) : NULL};
+
+    // 按到期时间插入 (同一时刻的事件保持提交顺序)
+    int i = s_event_count++;
+    while (i > 0 && s_events[i - 1].due_ms > ev.due_ms) {
+        s_events[i] = s_events[i - 1];
+        i--;
+    }
+    s_events[i] = ev;
+}
+
+static void events_clear(void)
+{
+    for (int i = 0; i < s_event_count; i++) {
+        free(s_events[i].text);
+    }
+    s_event_count = 0;
+}
+
+static void module_reboot(void)
+{
+    sim_log("== module reboot (boot %u ms)", s_boot_ms);
+    s_stats.reboots++;
+    events_clear();
+    s_ready = false;
+    s_echo = true;
+    s_pdp_up = false;
+    s_mqtt_up = false;
+    s_data_active = false;
+    s_session++;
+    event_add(s_boot_ms, EV_BOOT_DONE, NULL);
+}
+
+static void event_fire(event_t *ev)
+{
+    switch (ev->kind) {
+    case EV_TEXT:
+        emit_line(ev->text);
+        break;
+    case EV_PDP_UP:
+        s_pdp_up = true;
+        emit_line("+MIPCALL: " SIM_IP);
+        break;
+    case EV_MQTT_UP:
+        s_mqtt_up = true;
+        s_session++;
+        s_stats.connects++;
+        emit_line("+HMCON OK");
+        sim_log("== MQTT session %u up", s_session);
+        for (int i = 0; i < s_urc_count; i++) {
+            event_add((uint32_t)(s_urcs[i].at_ms * s_time_scale), EV_MQTT_URC, s_urcs[i].text);
+        }
+        break;
+    case EV_MQTT_URC:
+        if (s_mqtt_up && ev->session == s_session) {
+            s_stats.urcs++;
+            emit_line(ev->text);
+            sim_log("-> URC %.60s", ev->text);
+        }
+        break;
+    case EV_REBOOT:
+        module_reboot();
+        break;
+    case EV_BOOT_DONE:
+        s_ready = true;
+        emit_line("+SIM READY");
+        sim_log("== +SIM READY");
+        break;
+    }
+}
+
+/* Private Functions (Command Handling) --------------------------------------*/
+
+/** 计算转义后JSON字符串的逻辑长度 (`\"` 与 `\\` 各算一个字符) */
+static uint32_t unescaped_len(const char *s, size_t n)
+{
+    uint32_t len = 0;
+    for (size_t i = 0; i < n; i++, len++) {
+        if (s[i] == '\\' && i + 1 < n) {
+            i++;
+        }
+    }
+    return len;
+}
+
+static void publish_done(const char *topic, uint32_t len, const rule_t *rule, size_t wire_len)
+{
+    char resp[64];
+    uint32_t delay = response_delay(rule, wire_len);
+    uint32_t err_pct = (rule && rule->error_pct) ? rule->error_pct : s_default_error_pct;
+
+    if (!s_mqtt_up) {
+        snprintf(resp, sizeof(resp), "+HMPUB ERR:3");
+    } else if (err_pct > 0 && (uint32_t)(rand() % 100) < err_pct) {
+        snprintf(resp, sizeof(resp), "%s", (rule && rule->error_resp[0]) ? rule->error_resp : "+HMPUB ERR:1");
+    } else {
+        snprintf(resp, sizeof(resp), "+HMPUB OK");
+    }
+
+    if (strcmp(resp, "+HMPUB OK") == 0) {
+        s_stats.publishes++;
+        s_stats.publish_bytes += len;
+    } else {
+        s_stats.publish_errors++;
+    }
+    if (s_verbose) {
+        sim_log("   HMPUB #%u %u B -> %s (%s)", s_stats.publishes, len, topic, resp);
+    }
+    event_add(delay, EV_TEXT, resp);
+}
+
+/**
+ * @brief 处理 AT+HMPUB=<qos>,"<topic>",<len>[,"<payload>"]
+ */
+static void handle_hmpub(const char *line, const rule_t *rule)
+{
+    const char *p = line + strlen("AT+HMPUB=");
+    char topic[256];
+    char *end;
+
+    // qos
+    strtoul(p, &end, 10);
+    if (*end != ',' || end[1] != '"') {
+        event_add(response_delay(rule, strlen(line)), EV_TEXT, "ERROR");
+        return;
+    }
+    p = end + 2;
+    const char *q = strchr(p, '"');
+    if (q == NULL || (size_t)(q - p) >= sizeof(topic) || q[1] != ',') {
+        event_add(response_delay(rule, strlen(line)), EV_TEXT, "ERROR");
+        return;
+    }
+    memcpy(topic, p, (size_t)(q - p));
+    topic[q - p] = '\0';
+
+    uint32_t len = (uint32_t)strtoul(q + 2, &end, 10);
+
+    // 数据模式: 命令头后没有负载，回 '>' 后接收 len 字节
+    if (*end == '\0') {
+        if (!s_data_mode_enabled || len == 0 || len > DATA_SIZE) {
+            event_add(response_delay(rule, strlen(line)), EV_TEXT, "ERROR");
+            return;
+        }
+        s_data_active = true;
+        s_data_expect = len;
+        s_data_got = 0;
+        snprintf(s_data_topic, sizeof(s_data_topic), "%s", topic);
+        write_all("\r\n> ", 4);
+        return;
+    }
+
+    // 内联负载: 引号内为转义后的JSON，逻辑长度必须与 len 一致
+    if (end[0] != ',' || end[1] != '"' || line[strlen(line) - 1] != '"') {
+        event_add(response_delay(rule, strlen(line)), EV_TEXT, "ERROR");
+        return;
+    }
+    const char *payload = end + 2;
+    size_t payload_n = strlen(payload) - 1;
+    uint32_t logical = unescaped_len(payload, payload_n);
+    if (logical != len) {
+        sim_log("!! HMPUB length mismatch: declared %u, payload %u", len, logical);
+        s_stats.publish_errors++;
+        event_add(response_delay(rule, strlen(line)), EV_TEXT, "+HMPUB ERR:2");
+        return;
+    }
+    publish_done(topic, len, rule, strlen(line));
+}
+
+static void handle_data_byte(char c)
+{
+    (void)c;
+    if (++s_data_got == s_data_expect) {
+        s_data_active = false;
+        publish_done(s_data_topic, s_data_expect, rule_match("AT+HMPUB"), s_data_expect);
+    }
+}
+
+static void handle_command(const char *line)
+{
+    const rule_t *rule = rule_match(line);
+    uint32_t delay = response_delay(rule, strlen(line));
+    uint32_t err_pct = (rule && rule->error_pct) ? rule->error_pct : 0;
+
+    s_stats.commands++;
+    if (s_verbose) {
+        sim_log("-> %.120s", line);
+    }
+
+    if (strcasecmp(line, "AT+SIMCTL=REBOOT") == 0) {
+        emit_line("OK");
+        event_add(10, EV_REBOOT, NULL);
+        return;
+    }
+
+    // 针对具体命令的错误注入 (HMPUB 的错误注入在 publish_done 中处理)
+    if (err_pct > 0 && !starts_with_ci(line, "AT+HMPUB") && (uint32_t)(rand() % 100) < err_pct) {
+        event_add(delay, EV_TEXT, rule->error_resp[0] ? rule->error_resp : "ERROR");
+        return;
+    }
+
+    if (strcasecmp(line, "AT") == 0) {
+        event_add(delay, EV_TEXT, "OK");
+    } else if (strcasecmp(line, "ATE0") == 0 || strcasecmp(line, "ATE1") == 0) {
+        s_echo = (line[3] == '1');
+        event_add(delay, EV_TEXT, "OK");
+    } else if (strcasecmp(line, "AT+CPIN?") == 0) {
+        event_add(delay, EV_TEXT, "+CPIN: READY");
+        event_add(delay, EV_TEXT, "OK");
+    } else if (strcasecmp(line, "AT+MIPCALL?") == 0) {
+        event_add(delay, EV_TEXT, s_pdp_up ? "+MIPCALL: 1," SIM_IP : "+MIPCALL: 0");
+        event_add(delay, EV_TEXT, "OK");
+    } else if (strcasecmp(line, "AT+MIPCALL=1") == 0) {
+        if (s_pdp_up) {
+            event_add(delay, EV_TEXT, "ERROR");
+        } else {
+            event_add(delay, EV_TEXT, "OK");
+            event_add(delay + (uint32_t)(500 * s_time_scale), EV_PDP_UP, NULL);
+        }
+    } else if (strcasecmp(line, "AT+MIPCALL=0") == 0) {
+        s_pdp_up = false;
+        s_mqtt_up = false;
+        event_add(delay, EV_TEXT, "OK");
+    } else if (starts_with_ci(line, "AT+HMCON=")) {
+        if (!s_pdp_up) {
+            event_add(delay, EV_TEXT, "+HMCON ERR:1");
+        } else if (s_mqtt_up) {
+            event_add(delay, EV_TEXT, "+HMCON ERR:2"); // 已有会话，需先 AT+HMDIS
+        } else if (s_default_error_pct > 0 && (uint32_t)(rand() % 100) < s_default_error_pct) {
+            event_add(delay, EV_TEXT, "+HMCON ERR:4");
+        } else {
+            event_add(delay, EV_MQTT_UP, NULL);
+        }
+    } else if (strcasecmp(line, "AT+HMDIS") == 0) {
+        s_mqtt_up = false;
+        s_session++;
+        event_add(delay, EV_TEXT, "OK");
+    } else if (starts_with_ci(line, "AT+HMPUB=")) {
+        handle_hmpub(line, rule);
+    } else {
+        event_add(delay, EV_TEXT, "ERROR");
+    }
+}
+
+/* Private Functions (Configuration) -----------------------------------------*/
+
+/** 内置默认值，取自 Log/ 中的调试日志 (SEND 到最终响应的时间差) */
+static void rules_set_defaults(void)
+{
+    static const struct { const char *prefix; uint32_t ms; uint32_t jitter; } defaults[] = {
+        {"AT", 20, 0},
+        {"AT+MIPCALL", 60, 0},
+        {"AT+HMCON", 830, 0},
+        {"AT+HMDIS", 100, 0},
+        {"AT+HMPUB", 180, 0},
+    };
+    for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++) {
+        rule_t *r = rule_get(defaults[i].prefix);
+        r->latency_ms = defaults[i].ms;
+        r->jitter_ms = defaults[i].jitter;
+    }
+}
+
+static void urc_add(uint32_t at_ms, const char *text)
+{
+    if (s_urc_count < MAX_URCS) {
+        s_urcs[s_urc_count].at_ms = at_ms;
+        s_urcs[s_urc_count].text = strdup(text);
+        s_urc_count++;
+    }
+}
+
+static char *trim(char *s)
+{
+    while (isspace((unsigned char)*s)) {
+        s++;
+    }
+    char *e = s + strlen(s);
+    while (e > s && isspace((unsigned char)e[-1])) {
+        *--e = '\0';
+    }
+    return s;
+}
+
+static bool load_scenario(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return false;
+    }
+
+    char buf[LINE_SIZE];
+    int lineno = 0;
+    while (fgets(buf, sizeof(buf), f)) {
+        char *line = trim(buf);
+        char key[16], arg[64];
+        unsigned a = 0, b = 0;
+        int n = 0;
+        lineno++;
+        if (*line == '\0' || *line == '#') {
+            continue;
+        }
+        if (sscanf(line, "%15s", key) != 1) {
+            continue;
+        }
+
+        if (strcmp(key, "boot") == 0 && sscanf(line, "%*s %u", &a) == 1) {
+            s_boot_ms = a;
+        } else if (strcmp(key, "latency") == 0 && sscanf(line, "%*s %63s %u %u", arg, &a, &b) >= 2) {
+            rule_t *r = rule_get(arg);
+            if (r) {
+                r->latency_ms = a;
+                r->jitter_ms = b;
+            }
+        } else if (strcmp(key, "error") == 0 && sscanf(line, "%*s %63s %u %n", arg, &a, &n) >= 2) {
+            rule_t *r = rule_get(arg);
+            if (r) {
+                r->error_pct = a;
+                snprintf(r->error_resp, sizeof(r->error_resp), "%s", n > 0 ? trim(line + n) : "");
+            }
+        } else if (strcmp(key, "urc") == 0 && sscanf(line, "%*s %u %n", &a, &n) >= 1 && n > 0) {
+            urc_add(a, trim(line + n));
+        } else if (strcmp(key, "reboot") == 0 && sscanf(line, "%*s %u", &a) == 1) {
+            event_add(a, EV_REBOOT, NULL);
+        } else {
+            fprintf(stderr, "%s:%d: unrecognized line: %s\n", path, lineno, line);
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+/** 解析日志时间戳 "[2025-06-05 02:01:21.439]"，返回当日毫秒数 */
+static bool parse_log_time(const char *line, uint64_t *ms)
+{
+    unsigned h, m, s, frac;
+    if (sscanf(line, "[%*d-%*d-%*d %u:%u:%u.%u]", &h, &m, &s, &frac) != 4) {
+        return false;
+    }
+    *ms = ((uint64_t)h * 3600u + m * 60u + s) * 1000u + frac;
+    return true;
+}
+
+/** 日志中命令的规则键: 取到 '=' 或 '?' 之前 (例如 "AT+HMPUB") */
+static void command_key(const char *cmd, char *key, size_t size)
+{
+    size_t n = strcspn(cmd, "=?");
+    if (n >= size) {
+        n = size - 1;
+    }
+    memcpy(key, cmd, n);
+    key[n] = '\0';
+}
+
+/**
+ * @brief 从串口调试日志推导各命令的响应时延，并收集 +HMREC 作为URC
+ * @details 日志由 "[时间]# SEND ASCII>" / "[时间]# RECV ASCII>" 块组成。
+ *          对每个 SEND，取其后第一个包含最终响应 (OK / ERR) 的 RECV 块的时间作为完成时间。
+ */
+static bool seed_from_log(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return false;
+    }
+
+    struct { char key[32]; uint64_t sum; uint32_t n; } acc[MAX_RULES];
+    int acc_count = 0;
+    char buf[LINE_SIZE];
+    char pending_key[32] = "";
+    uint64_t block_ms = 0, send_ms = 0;
+    bool in_send = false, awaiting_cmd = false, have_pending = false;
+    uint32_t urc_at = 1000;
+
+    while (fgets(buf, sizeof(buf), f)) {
+        char *line = trim(buf);
+        uint64_t t;
+        if (parse_log_time(line, &t)) {
+            block_ms = t;
+            in_send = strstr(line, "SEND") != NULL;
+            awaiting_cmd = in_send;
+            continue;
+        }
+        if (*line == '\0' || *line == '#') {
+            continue;
+        }
+
+        if (in_send) {
+            if (awaiting_cmd) {
+                command_key(line, pending_key, sizeof(pending_key));
+                send_ms = block_ms;
+                have_pending = true;
+                awaiting_cmd = false;
+            }
+            continue;
+        }
+
+        // RECV 块
+        if (strncmp(line, "+HMREC:", 7) == 0) {
+            urc_add(urc_at, line);
+            urc_at += 1000;
+            continue;
+        }
+        size_t len = strlen(line);
+        bool final = strcmp(line, "OK") == 0 || strstr(line, "ERR") != NULL ||
+                     (len > 3 && line[0] == '+' && strcmp(line + len - 3, " OK") == 0);
+        if (final && have_pending) {
+            int i;
+            for (i = 0; i < acc_count && strcmp(acc[i].key, pending_key) != 0; i++) {
+            }
+            if (i == acc_count && acc_count < MAX_RULES) {
+                snprintf(acc[acc_count].key, sizeof(acc[0].key), "%s", pending_key);
+                acc[acc_count].sum = 0;
+                acc[acc_count].n = 0;
+                acc_count++;
+            }
+            if (i < acc_count) {
+                acc[i].sum += block_ms - send_ms;
+                acc[i].n++;
+            }
+            have_pending = false;
+        }
+    }
+    fclose(f);
+
+    for (int i = 0; i < acc_count; i++) {
+        rule_t *r = rule_get(acc[i].key);
+        if (r) {
+            r->latency_ms = (uint32_t)(acc[i].sum / acc[i].n);
+        }
+    }
+    return true;
+}
+
+static void dump_scenario(FILE *out)
+{
+    fprintf(out, "boot %u\n", s_boot_ms);
+    for (int i = 0; i < s_rule_count; i++) {
+        fprintf(out, "latency %s %u %u\n", s_rules[i].prefix, s_rules[i].latency_ms, s_rules[i].jitter_ms);
+        if (s_rules[i].error_pct > 0) {
+            fprintf(out, "error %s %u %s\n", s_rules[i].prefix, s_rules[i].error_pct, s_rules[i].error_resp);
+        }
+    }
+    for (int i = 0; i < s_urc_count; i++) {
+        fprintf(out, "urc %u %s\n", s_urcs[i].at_ms, s_urcs[i].text);
+    }
+}
+
+static void print_stats(void)
+{
+    sim_log("stats: %u commands, %u connects, %u publishes (%llu B), %u publish errors, %u URCs, %u reboots",
+            s_stats.commands, s_stats.connects, s_stats.publishes, (unsigned long long)s_stats.publish_bytes,
+            s_stats.publish_errors, s_stats.urcs, s_stats.reboots);
+}
+
+/* Private Functions (Main Loop) ---------------------------------------------*/
+
+static void handle_console(char *line)
+{
+    line = trim(line);
+    if (strcmp(line, "reboot") == 0) {
+        module_reboot();
+    } else if (strcmp(line, "stats") == 0) {
+        print_stats();
+    } else if (line[0] == '+') {
+        s_stats.urcs++;
+        emit_line(line);
+    } else if (*line != '\0') {
+        sim_log("console: reboot | stats | +<URC text>");
+    }
+}
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    s_quit = 1;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -l PATH   create a symlink to the pty slave (default /tmp/l610)\n"
+            "  -s FILE   load a scenario file\n"
+            "  -g FILE   seed latencies and +HMREC URCs from a serial debug log\n"
+            "  -e PCT    HMCON/HMPUB error probability in percent\n"
+            "  -r MS     reboot the module once after MS milliseconds\n"
+            "  -b BAUD   add UART wire time at BAUD to every response\n"
+            "  -x SCALE  scale all latencies (e.g. 0.1)\n"
+            "  -d        accept data-mode AT+HMPUB ('>' prompt)\n"
+            "  -p        print the effective scenario and exit\n"
+            "  -v        log every command and response\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *link_path = "/tmp/l610";
+    bool dump_only = false;
+    int opt;
+
+    s_start_ms = now_ms();
+    srand((unsigned)s_start_ms);
+    rules_set_defaults();
+
+    while ((opt = getopt(argc, argv, "l:s:g:e:r:b:x:dpvh")) != -1) {
+        switch (opt) {
+        case 'l': link_path = optarg; break;
+        case 's': if (!load_scenario(optarg)) return 1; break;
+        case 'g': if (!seed_from_log(optarg)) return 1; break;
+        case 'e': s_default_error_pct = (uint32_t)atoi(optarg); break;
+        case 'r': event_add((uint32_t)atoi(optarg), EV_REBOOT, NULL); break;
+        case 'b': s_baud = (uint32_t)atoi(optarg); break;
+        case 'x': s_time_scale = atof(optarg); break;
+        case 'd': s_data_mode_enabled = true; break;
+        case 'p': dump_only = true; break;
+        case 'v': s_verbose = true; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (dump_only) {
+        dump_scenario(stdout);
+        return 0;
+    }
+
+    // 创建伪终端，主端由模拟器持有，从端交给被测程序
+    s_master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (s_master < 0 || grantpt(s_master) != 0 || unlockpt(s_master) != 0) {
+        perror("posix_openpt");
+        return 1;
+    }
+    struct termios tio;
+    tcgetattr(s_master, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(s_master, TCSANOW, &tio);
+
+    const char *slave = ptsname(s_master);
+    int slave_keep = open(slave, O_RDWR | O_NOCTTY); // 保持从端打开，被测程序重连时主端不会收到 EIO
+    unlink(link_path);
+    if (symlink(slave, link_path) != 0) {
+        perror("symlink");
+    }
+    sim_log("L610 simulator on %s (-> %s), boot %u ms, scale %.2f", slave, link_path, s_boot_ms, s_time_scale);
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    event_add(s_boot_ms, EV_BOOT_DONE, NULL);
+
+    char line[LINE_SIZE];
+    size_t line_len = 0;
+    bool skip_lf = false; // 命令以 "\r\n" 结束时，'\n' 不能算作数据模式负载的第一个字节
+    char console[LINE_SIZE];
+    size_t console_len = 0;
+
+    while (!s_quit) {
+        // 处理到期事件
+        uint64_t now = now_ms();
+        while (s_event_count > 0 && s_events[0].due_ms <= now) {
+            event_t ev = s_events[0];
+            memmove(&s_events[0], &s_events[1], (size_t)(--s_event_count) * sizeof(event_t));
+            event_fire(&ev);
+            free(ev.text);
+        }
+
+        int timeout = -1;
+        if (s_event_count > 0) {
+            timeout = (int)(s_events[0].due_ms - now_ms());
+            timeout = timeout < 0 ? 0 : timeout;
+        }
+
+        struct pollfd fds[2] = {{.fd = s_master, .events = POLLIN}, {.fd = STDIN_FILENO, .events = POLLIN}};
+        if (poll(fds, 2, timeout) < 0) {
+            continue;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            ssize_t n = read(STDIN_FILENO, console + console_len, sizeof(console) - 1 - console_len);
+            if (n > 0) {
+                console_len += (size_t)n;
+                char *nl;
+                while ((nl = memchr(console, '\n', console_len)) != NULL) {
+                    *nl = '\0';
+                    handle_console(console);
+                    console_len -= (size_t)(nl + 1 - console);
+                    memmove(console, nl + 1, console_len);
+                }
+            } else if (n == 0) {
+                fds[1].fd = -1; // 标准输入已关闭 (例如后台运行)，不再轮询
+                close(STDIN_FILENO);
+            }
+        }
+
+        if (!(fds[0].revents & POLLIN)) {
+            continue;
+        }
+        char rx[512];
+        ssize_t n = read(s_master, rx, sizeof(rx));
+        for (ssize_t i = 0; i < n; i++) {
+            char c = rx[i];
+            if (!s_ready) {
+                continue; // 启动中，丢弃输入
+            }
+            if (skip_lf) {
+                skip_lf = false;
+                if (c == '\n') {
+                    if (s_echo) {
+                        write_all(&c, 1);
+                    }
+                    continue;
+                }
+            }
+            if (s_data_active) {
+                handle_data_byte(c);
+                continue;
+            }
+            if (s_echo) {
+                write_all(&c, 1);
+            }
+            if (c == '\r' || c == '\n') {
+                skip_lf = (c == '\r');
+                if (line_len > 0) {
+                    line[line_len] = '\0';
+                    handle_command(line);
+                    line_len = 0;
+                }
+            } else if (line_len < sizeof(line) - 1) {
+                line[line_len++] = c;
+            }
+        }
+    }
+
+    print_stats();
+    unlink(link_path);
+    close(slave_keep);
+    close(s_master);
+    return 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file      gateway_posix.c
+ * @author    Your Name
+ * @brief     在 Linux 上运行完整的网关固件 (FreeRTOS POSIX 移植 + 主机端HAL)
+ *
+ * @details
+ *      替代 Core/Src/main.c 和 app_freertos.c：创建与目标板相同的外设句柄和任务
+ *      (defaultTask -> App_Main_Init/App_Main_Task、LoRaAppTask、SysMonitorTask)，
+ *      应用层源文件和 FreeRTOS 内核 (含 CMSIS-RTOS2 封装层) 都直接使用工程中的文件，不做修改。
+ *      外设由 host/ 目录下的实现替代:
+ *      - USART3 (L610): 伪终端，对接 Tools/L610Sim 的 l610_sim 模拟器
+ *      - LoRa (SX1278): 本机 UDP，对接 node_sim 虚拟节点
+ *      - IWDG: 主机时钟计时，超时后模拟复位 (TAMP 备份寄存器经文件保留)
+ *      - CRC / RNG: 见 host/stm32u5xx_hal.h
+ *      另有一个最高优先级的 HostIrq 任务在模拟的中断上下文中调用 HAL 回调 (见 host/hal_posix.c)。
+ *
+ * @par 用途:
+ *      浸泡测试 (长时间运行观察堆、任务签到和AT时延统计)、valgrind 内存检查、perf 热点分析，
+ *      以及在没有硬件时调试任务间的交互。时间行为 (调度、节拍) 与目标板相近但不相同，
+ *      周期计数级别的测量仍应在目标板上进行。
+ *
+ * @par 用法:
+ *      ./gateway_posix [-p /tmp/l610] [-r 射频端口] [-n 节点端口] [-b 备份寄存器文件] [-t 运行秒数] [-W]
+ *      -t 到时后打印AT、看门狗签到和样本时延统计并退出；-W 让看门狗复位直接以退出码3结束进程。
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "main.h"
+#include "cmsis_os2.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "LoRa.h"
+#include "app_main.h"
+#include "at_handler.h"
+#include "at_stats.h"
+#include "lora_app.h"
+#include "sample_trace.h"
+#include "system_monitor.h"
+#include "task_monitor.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define DEFAULT_PTY         "/tmp/l610"
+#define DEFAULT_RADIO_PORT  17000
+#define DEFAULT_NODE_PORT   17001
+#define DEFAULT_BKP_FILE    "/tmp/gateway_posix.bkp"
+
+/* Peripheral Handles (与 Core/Src/main.c 同名) ------------------------------*/
+
+static USART_TypeDef s_usart3;
+static CRC_TypeDef s_crc;
+
+UART_HandleTypeDef huart3 = {.Instance = &s_usart3, .fd = -1};
+DMA_HandleTypeDef handle_GPDMA1_Channel0;
+DMA_HandleTypeDef handle_GPDMA1_Channel1;
+IWDG_HandleTypeDef hiwdg;
+CRC_HandleTypeDef hcrc = {.Instance = &s_crc};
+RNG_HandleTypeDef hrng;
+SPI_HandleTypeDef hspi2;
+
+extern AT_Handler_t g_at_handle;
+
+/* Private Variables ---------------------------------------------------------*/
+
+static uint32_t s_run_seconds = 0;
+static osThreadId_t defaultTaskHandle;
+static const osThreadAttr_t defaultTask_attributes = {
+    .name = "defaultTask",
+    .priority = (osPriority_t) osPriorityNormal,
+    .stack_size = 8192 * 4
+};
+
+/* HAL Callbacks (与 main.c / stm32u5xx_it.c 一致) ---------------------------*/
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    if (huart == &huart3) {
+        AT_UartIdleCallback(&g_at_handle, huart, Size);
+    }
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    AT_UartTxCpltCallback(&g_at_handle, huart);
+}
+
+void HAL_GPIO_EXTI_Rising_Callback(uint16_t GPIO_Pin)
+{
+    LoRa_DIO0_ISR(GPIO_Pin);
+}
+
+void Error_Handler(void)
+{
+    printf("[HOST] Error_Handler called\r\n");
+    abort();
+}
+
+void vAssertCalled(const char *file, int line)
+{
+    printf("[HOST] configASSERT failed at %s:%d\r\n", file, line);
+    abort();
+}
+
+/* Tasks ---------------------------------------------------------------------*/
+
+/** 与 app_freertos.c 的 StartDefaultTask 一致 */
+static void StartDefaultTask(void *argument)
+{
+    (void)argument;
+    App_Main_Init();
+    App_Main_Task();
+    for (;;) {
+        osDelay(1);
+    }
+}
+
+/** 运行 -t 指定的时长后打印统计并退出 (浸泡测试的结束点) */
+static void HostRunTask(void *argument)
+{
+    (void)argument;
+    osDelay(s_run_seconds * 1000U);
+
+    printf("\r\n[HOST] Run time of %lu s reached.\r\n", (unsigned long)s_run_seconds);
+    AT_Stats_Dump();
+    TaskMonitor_Dump();
+    SampleTrace_Dump();
+    _exit(0);
+}
+
+/** 与 app_freertos.c 的 MX_FREERTOS_Init 一致，另加 HostIrq 任务 */
+static void MX_FREERTOS_Init(void)
+{
+    defaultTaskHandle = osThreadNew(StartDefaultTask, NULL, &defaultTask_attributes);
+
+    LoRa_APP_Init();
+
+    SystemMonitor_Init();
+
+    HAL_Host_StartIrqTask();
+
+    if (s_run_seconds > 0) {
+        const osThreadAttr_t run_attributes = {
+            .name = "HostRun",
+            .priority = (osPriority_t) osPriorityRealtime,
+        };
+        osThreadNew(HostRunTask, NULL, &run_attributes);
+    }
+}
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    const char *pty = DEFAULT_PTY;
+    const char *bkp = DEFAULT_BKP_FILE;
+    uint16_t radio_port = DEFAULT_RADIO_PORT;
+    uint16_t node_port = DEFAULT_NODE_PORT;
+    bool exit_on_reset = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:r:n:b:t:Wh")) != -1) {
+        switch (opt) {
+        case 'p': pty = optarg; break;
+        case 'r': radio_port = (uint16_t)atoi(optarg); break;
+        case 'n': node_port = (uint16_t)atoi(optarg); break;
+        case 'b': bkp = optarg; break;
+        case 't': s_run_seconds = (uint32_t)atoi(optarg); break;
+        case 'W': exit_on_reset = true; break;
+        default:
+            fprintf(stderr, "usage: %s [-p pty] [-r radio_port] [-n node_port] [-b bkp_file] [-t seconds] [-W]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    // 对应 main() 中的 MX_xxx_Init
+    HAL_Host_Init(bkp, exit_on_reset ? NULL : argv);
+    if (HAL_UART_HostOpen(&huart3, pty) != HAL_OK) {
+        fprintf(stderr, "Start the modem simulator first: ../L610Sim/l610_sim -l %s\n", pty);
+        return 1;
+    }
+    if (!LoRa_HostOpen(radio_port, node_port)) {
+        return 1;
+    }
+    HAL_IWDG_Init(&hiwdg);
+
+    if (LoRa_HW_Init()) {
+        printf("LoRa Hardware Init OK.\r\n");
+    } else {
+        printf("[FATAL] LoRa Hardware Init Failed!\r\n");
+        Error_Handler();
+    }
+    printf("System Init Over\r\n");
+
+    osKernelInitialize();
+    MX_FREERTOS_Init();
+    osKernelStart();
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file      FreeRTOSConfig.h
+ * @author    Your Name
+ * @brief     主机端构建用: FreeRTOS POSIX 移植的内核配置
+ * @note      与 Core/Inc/FreeRTOSConfig.h 保持一致的部分: 优先级数、节拍频率、最小堆栈、
+ *            CMSIS-RTOS2 开关、INCLUDE_xxx、运行时间统计和上下文切换计数 (线程局部存储)。
+ *            Cortex-M 专有的部分 (中断优先级、SysTick、FPU/TrustZone) 在主机上没有意义，已删除。
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <stdint.h>
+
+extern uint32_t SystemCoreClock;
+void configureTimerForRunTimeStats(void);
+unsigned long getRunTimeCounterValue(void);
+void vAssertCalled(const char *file, int line);
+
+#ifndef CMSIS_device_header
+#define CMSIS_device_header "stm32u5xx.h"
+#endif
+
+#define configUSE_PREEMPTION                     1
+#define configSUPPORT_STATIC_ALLOCATION          1
+#define configSUPPORT_DYNAMIC_ALLOCATION         1
+#define configUSE_IDLE_HOOK                      0
+#define configUSE_TICK_HOOK                      0
+#define configCPU_CLOCK_HZ                       ( SystemCoreClock )
+#define configTICK_RATE_HZ                       ((TickType_t)1000)
+#define configMAX_PRIORITIES                     ( 56 )
+#define configMINIMAL_STACK_SIZE                 ((uint16_t)512)
+/* 64位主机上TCB、队列和链表项约为目标板的两倍，堆按两倍配置，堆统计只宜看趋势 (泄漏、碎片) */
+#define configTOTAL_HEAP_SIZE                    ((size_t)(131072 * 2))
+#define configMAX_TASK_NAME_LEN                  ( 16 )
+#define configUSE_TRACE_FACILITY                 1
+#define configGENERATE_RUN_TIME_STATS            1
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS  1
+#define configUSE_16_BIT_TICKS                   0
+#define configUSE_MUTEXES                        1
+#define configQUEUE_REGISTRY_SIZE                8
+#define configUSE_RECURSIVE_MUTEXES              1
+#define configUSE_COUNTING_SEMAPHORES            1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
+#define configUSE_TASK_NOTIFICATIONS             1
+#define configHEAP_CLEAR_MEMORY_ON_FREE          0
+#define configUSE_MINI_LIST_ITEM                 1
+#define configUSE_SB_COMPLETED_CALLBACK          0
+#define configMESSAGE_BUFFER_LENGTH_TYPE         size_t
+#define configRUN_TIME_COUNTER_TYPE              size_t
+
+/* 任务运行在 pthread 上，堆栈溢出检查没有意义 (见 Makefile 中关于堆栈的说明) */
+#define configCHECK_FOR_STACK_OVERFLOW           0
+
+/* Co-routine definitions. */
+#define configUSE_CO_ROUTINES                    0
+#define configMAX_CO_ROUTINE_PRIORITIES          ( 2 )
+
+/* Software timer definitions. */
+#define configUSE_TIMERS                         1
+#define configTIMER_TASK_PRIORITY                ( 2 )
+#define configTIMER_QUEUE_LENGTH                 10
+#define configTIMER_TASK_STACK_DEPTH             512
+
+/* CMSIS-RTOS V2 flags */
+#define configUSE_OS2_THREAD_SUSPEND_RESUME  1
+#define configUSE_OS2_THREAD_ENUMERATE       1
+#define configUSE_OS2_EVENTFLAGS_FROM_ISR    1
+#define configUSE_OS2_THREAD_FLAGS           1
+#define configUSE_OS2_TIMER                  1
+#define configUSE_OS2_MUTEX                  1
+
+#define INCLUDE_vTaskPrioritySet             1
+#define INCLUDE_uxTaskPriorityGet            1
+#define INCLUDE_vTaskDelete                  1
+#define INCLUDE_vTaskCleanUpResources        0
+#define INCLUDE_vTaskSuspend                 1
+#define INCLUDE_xTaskDelayUntil              1
+#define INCLUDE_vTaskDelay                   1
+#define INCLUDE_xTaskGetSchedulerState       1
+#define INCLUDE_xTimerPendFunctionCall       1
+#define INCLUDE_xQueueGetMutexHolder         1
+#define INCLUDE_xSemaphoreGetMutexHolder     1
+#define INCLUDE_uxTaskGetStackHighWaterMark  1
+#define INCLUDE_xTaskGetCurrentTaskHandle    1
+#define INCLUDE_eTaskGetState                1
+
+/* 断言失败时打印位置并 abort()，便于在 gdb/valgrind 下定位 (目标板上是关中断死循环) */
+#define configASSERT( x ) if ((x) == 0) { vAssertCalled(__FILE__, __LINE__); }
+
+/* 运行时间统计：主机单调时钟，单位微秒 (与目标板 TIM2 的 1MHz 计数一致，见 hal_posix.c) */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS   configureTimerForRunTimeStats
+#define portGET_RUN_TIME_COUNTER_VALUE           getRunTimeCounterValue
+
+/* 上下文切换计数：与目标板相同，线程局部存储指针 configTLS_INDEX_SWITCH_COUNT 作为切入次数的计数器，
+   由 SystemMonitor 读取 */
+#define configTLS_INDEX_SWITCH_COUNT             0
+#define traceTASK_SWITCHED_IN() \
+    do { \
+        void **ppvSwitchCount = &pxCurrentTCB->pvThreadLocalStoragePointers[configTLS_INDEX_SWITCH_COUNT]; \
+        *ppvSwitchCount = (void *)((uintptr_t)*ppvSwitchCount + 1U); \
+    } while (0)
+
+#endif /* FREERTOS_CONFIG_H */
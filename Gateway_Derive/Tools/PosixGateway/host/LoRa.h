@@ -0,0 +1,108 @@
+/**
+ * @file      LoRa.h
+ * @author    Your Name
+ * @brief     主机端构建用: SX127x LoRa 驱动的虚拟射频实现 (UDP 数据报，见 lora_radio_udp.c)
+ * @note      接口与 Drivers/LoRa/LoRa.h 一致 (只保留 lora_app.c 用到的部分)。
+ *            一个UDP数据报就是一个完整的LoRa数据包；收到数据包后由 HostIrq 任务产生 DIO0 上升沿中断。
+ */
+
+#ifndef LORA_H
+#define LORA_H
+
+#include "main.h"
+
+// Operating modes:
+#define SLEEP_MODE          0
+#define STNBY_MODE          1
+#define TRANSMIT_MODE       3
+#define RXCONTIN_MODE       5
+#define RXSINGLE_MODE       6
+
+// Bandwidth:
+#define BW_7_8KHz           0
+#define BW_10_4KHz          1
+#define BW_15_6KHz          2
+#define BW_20_8KHz          3
+#define BW_31_25KHz         4
+#define BW_41_7KHz          5
+#define BW_62_5KHz          6
+#define BW_125KHz           7
+#define BW_250KHz           8
+#define BW_500KHz           9
+
+// Coding rate:
+#define CR_4_5              1
+#define CR_4_6              2
+#define CR_4_7              3
+#define CR_4_8              4
+
+// Spreading factor:
+#define SF_7                7
+#define SF_8                8
+#define SF_9                9
+#define SF_10               10
+#define SF_11               11
+#define SF_12               12
+
+// Power gain:
+#define POWER_11db          0xF6
+#define POWER_14db          0xF9
+#define POWER_17db          0xFC
+#define POWER_20db          0xFF
+
+// Registers (虚拟射频只响应 RegVersion):
+#define RegVersion          0x42
+
+// Status:
+#define LORA_OK             200
+#define LORA_NOT_FOUND      404
+#define LORA_LARGE_PAYLOAD  413
+#define LORA_UNAVAILABLE    503
+
+typedef struct LoRa_setting{
+
+    // Hardware setings:
+    GPIO_TypeDef*       CS_port;
+    uint16_t            CS_pin;
+    GPIO_TypeDef*       reset_port;
+    uint16_t            reset_pin;
+    GPIO_TypeDef*       DIO0_port;
+    uint16_t            DIO0_pin;
+    SPI_HandleTypeDef*  hSPIx;
+
+    // Module settings:
+    int                 current_mode;
+    int                 frequency;
+    uint8_t             spredingFactor;
+    uint8_t             bandWidth;
+    uint8_t             crcRate;
+    uint16_t            preamble;
+    uint8_t             power;
+    uint8_t             overCurrentProtection;
+
+} LoRa;
+
+LoRa newLoRa(void);
+void LoRa_reset(LoRa* _LoRa);
+uint8_t LoRa_read(LoRa* _LoRa, uint8_t address);
+uint8_t LoRa_transmit(LoRa* _LoRa, uint8_t* data, uint8_t length, uint16_t timeout);
+void LoRa_startReceiving(LoRa* _LoRa);
+uint8_t LoRa_receive(LoRa* _LoRa, uint8_t* data, uint8_t length);
+int LoRa_getRSSI(LoRa* _LoRa);
+uint16_t LoRa_init(LoRa* _LoRa);
+
+/**
+ * @brief [主机端] 打开虚拟射频 (须在 osKernelStart 之前调用)
+ * @param local_port 本机接收数据包的UDP端口
+ * @param peer_port  发送数据包的目的UDP端口 (虚拟节点 node_sim 监听的端口，发往 127.0.0.1)
+ * @return bool 套接字创建或绑定失败时返回 false
+ */
+bool LoRa_HostOpen(uint16_t local_port, uint16_t peer_port);
+
+/**
+ * @brief [主机端] 由 HostIrq 任务每个节拍调用：射频处于接收模式且FIFO为空时取出一个数据报，
+ *        并在模拟的中断上下文中调用 `HAL_GPIO_EXTI_Rising_Callback(DIO0_pin)`
+ */
+void LoRa_HostPoll(void);
+
+#endif // LORA_H
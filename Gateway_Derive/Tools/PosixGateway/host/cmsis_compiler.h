@@ -0,0 +1,42 @@
+/**
+ * @file      cmsis_compiler.h
+ * @author    Your Name
+ * @brief     主机端构建用: 替代 CMSIS 的编译器/内核寄存器访问接口，供 CMSIS-RTOS2 封装层 (cmsis_os2.c) 使用
+ * @note      `__get_IPSR()` 返回主机端模拟的中断号：由 HostIrq 任务在调用 HAL 回调期间置位 (见 hal_posix.c)，
+ *            因此回调中调用的 osXxx 接口与目标板一样走 FromISR 分支。
+ */
+
+#ifndef CMSIS_COMPILER_H
+#define CMSIS_COMPILER_H
+
+#include <stdint.h>
+
+#ifndef __STATIC_INLINE
+#define __STATIC_INLINE static inline
+#endif
+#ifndef __WEAK
+#define __WEAK __attribute__((weak))
+#endif
+#ifndef __NO_RETURN
+#define __NO_RETURN __attribute__((__noreturn__))
+#endif
+#ifndef __ALIGNED
+#define __ALIGNED(x) __attribute__((aligned(x)))
+#endif
+
+/** [主机端] 当前线程正在执行的模拟中断号，0 表示线程模式 */
+uint32_t HAL_Host_GetIPSR(void);
+
+__STATIC_INLINE uint32_t __get_IPSR(void)    { return HAL_Host_GetIPSR(); }
+__STATIC_INLINE uint32_t __get_PRIMASK(void) { return 0U; }
+__STATIC_INLINE uint32_t __get_BASEPRI(void) { return 0U; }
+__STATIC_INLINE void __disable_irq(void)     { }
+__STATIC_INLINE void __enable_irq(void)      { }
+
+typedef enum {
+    SVCall_IRQn = -5
+} IRQn_Type;
+
+#define NVIC_SetPriority(IRQn, priority) ((void)(IRQn), (void)(priority))
+
+#endif // CMSIS_COMPILER_H
@@ -0,0 +1,446 @@
+/**
+ * @file      hal_posix.c
+ * @author    Your Name
+ * @brief     STM32U5 HAL 子集的主机端实现 (FreeRTOS POSIX 移植)
+ *
+ * @details
+ *      - 中断: FreeRTOS 的接口不能在内核不认识的 pthread 中调用，因此不另起接收线程，
+ *        而是由最高优先级的 HostIrq 任务每个节拍非阻塞地轮询伪终端、虚拟射频和看门狗。
+ *        有事件时在临界区内置位模拟的 IPSR 并调用 HAL 回调：回调中的 osXxx 接口与目标板一样走
+ *        FromISR 分支，节拍信号也不会打断回调 (目标板上 SysTick 是最低优先级)。
+ *      - UART: 发送同步写入伪终端，完成中断在下一个节拍产生；接收的每次 read() 视为一次空闲线路事件。
+ *        链表模式的发送与GPDMA一致，头节点由参数改写，其余节点按队列顺序发出。
+ *      - IWDG: 超过 Reload 毫秒未刷新即模拟一次看门狗复位：TAMP 备份寄存器写入文件，
+ *        置位 RCC_FLAG_IWDGRST 后重新执行本程序 (或以退出码3结束，供浸泡测试脚本判断)。
+ *      - 调试串口: 目标板上 printf 经 fputc 重定向到 USART1；主机上重定向到标准输出。
+ *        直接调用 write()，不经过 stdio 的锁 (见 printf 的说明)。
+ *
+ * @note  链表节点中的地址是32位的 (与目标板一致)，因此主机端必须以非PIE方式链接，
+ *        保证静态数据和 FreeRTOS 堆位于4GB以下 (见 Makefile 中的 -no-pie)。
+ */
+
+#define _GNU_SOURCE
+#include "stm32u5xx_hal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "LoRa.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define HOST_IRQ_TASK_STACK   (configMINIMAL_STACK_SIZE * 2)
+#define IWDG_DEFAULT_RELOAD   4100U           // 与 MX_IWDG_Init 的配置一致 (约4.1s)
+#define IWDG_EXIT_CODE        3
+#define RESET_CAUSE_ENV       "HOST_RESET_CAUSE"
+#define PRINTF_BUFFER_SIZE    1024
+
+/* Private Variables ---------------------------------------------------------*/
+
+uint32_t SystemCoreClock = 160000000U;
+
+static SysTick_Type s_systick = {.LOAD = (160000000U / 1000U) - 1U};
+static TAMP_TypeDef s_tamp;
+static GPIO_TypeDef s_gpiob;
+static GPIO_TypeDef s_gpioc;
+
+SysTick_Type *const SysTick = &s_systick;
+TAMP_TypeDef *const TAMP = &s_tamp;
+GPIO_TypeDef *const GPIOB = &s_gpiob;
+GPIO_TypeDef *const GPIOC = &s_gpioc;
+
+static __thread uint32_t s_ipsr;          // 当前线程正在执行的模拟中断号
+
+static UART_HandleTypeDef *s_uart;       // 主机端只支持一个UART (USART3 <-> L610)
+static uint16_t s_rx_event_size;
+
+static IWDG_HandleTypeDef *s_iwdg;
+static uint32_t s_iwdg_last_refresh;
+static uint32_t s_reset_flags;
+static const char *s_bkp_path;
+static char **s_argv;                    // 为 NULL 时看门狗复位以退出码结束进程
+
+static struct timespec s_runtime_epoch;
+
+/* Private Functions ---------------------------------------------------------*/
+
+static uint32_t host_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000U + (uint64_t)ts.tv_nsec / 1000000U);
+}
+
+static void write_all(int fd, const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN) {
+                struct pollfd pfd = {.fd = fd, .events = POLLOUT};
+                (void)poll(&pfd, 1, 10);
+                continue;
+            }
+            perror("[HAL] write");
+            return;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+static void uart_tx_irq(void *arg)
+{
+    HAL_UART_TxCpltCallback((UART_HandleTypeDef *)arg);
+}
+
+static void uart_rx_irq(void *arg)
+{
+    HAL_UARTEx_RxEventCallback((UART_HandleTypeDef *)arg, s_rx_event_size);
+}
+
+static void uart_poll(UART_HandleTypeDef *huart)
+{
+    if (__atomic_exchange_n(&huart->tx_pending, false, __ATOMIC_ACQ_REL)) {
+        HAL_Host_RaiseIrq(HOST_IRQ_GPDMA1_CH1, uart_tx_irq, huart);
+    }
+
+    if (!__atomic_load_n(&huart->rx_armed, __ATOMIC_ACQUIRE)) {
+        return; // DMA未启动，数据留在伪终端中
+    }
+    ssize_t n = read(huart->fd, huart->rx_buf, huart->rx_size);
+    if (n > 0) {
+        huart->rx_armed = false; // 回调中会以另一个缓冲区重新启动接收
+        s_rx_event_size = (uint16_t)n;
+        HAL_Host_RaiseIrq(HOST_IRQ_USART3, uart_rx_irq, huart);
+    }
+}
+
+static void save_backup_registers(void)
+{
+    FILE *f = fopen(s_bkp_path, "wb");
+    if (f == NULL) {
+        perror(s_bkp_path);
+        return;
+    }
+    fwrite((const void *)&s_tamp, sizeof(s_tamp), 1, f);
+    fclose(f);
+}
+
+/**
+ * @brief 模拟一次看门狗复位：保存备份寄存器，重新执行本程序 (复位标志经环境变量传递)
+ */
+static void iwdg_reset(uint32_t starved_ms)
+{
+    printf("\r\n[IWDG] Not refreshed for %lu ms, system reset.\r\n", (unsigned long)starved_ms);
+    save_backup_registers();
+    if (s_argv == NULL) {
+        _exit(IWDG_EXIT_CODE);
+    }
+
+    // 节拍定时器和信号屏蔽字会被 execv 继承：先停掉定时器、忽略残留的节拍信号，新进程的内核会重新安装
+    struct itimerval stop = {0};
+    setitimer(ITIMER_REAL, &stop, NULL);
+    signal(SIGALRM, SIG_IGN);
+    sigset_t none;
+    sigemptyset(&none);
+    pthread_sigmask(SIG_SETMASK, &none, NULL);
+
+    setenv(RESET_CAUSE_ENV, "IWDG", 1);
+    execv("/proc/self/exe", s_argv);
+    perror("[IWDG] execv");
+    _exit(IWDG_EXIT_CODE);
+}
+
+static void iwdg_poll(void)
+{
+    if (s_iwdg == NULL) {
+        return;
+    }
+    uint32_t starved = host_now_ms() - __atomic_load_n(&s_iwdg_last_refresh, __ATOMIC_RELAXED);
+    if (starved > s_iwdg->Reload) {
+        iwdg_reset(starved);
+    }
+}
+
+/**
+ * @brief HostIrq 任务：每个节拍轮询一次所有模拟的中断源
+ */
+static void host_irq_task(void *argument)
+{
+    (void)argument;
+    for (;;) {
+        if (s_uart != NULL) {
+            uart_poll(s_uart);
+        }
+        LoRa_HostPoll();
+        iwdg_poll();
+        vTaskDelay(1);
+    }
+}
+
+/* 主机端 --------------------------------------------------------------------*/
+
+void HAL_Host_Init(const char *bkp_path, char **argv)
+{
+    s_bkp_path = bkp_path;
+    s_argv = argv;
+
+    FILE *f = fopen(bkp_path, "rb");
+    if (f != NULL) {
+        if (fread((void *)&s_tamp, sizeof(s_tamp), 1, f) != 1) {
+            memset((void *)&s_tamp, 0, sizeof(s_tamp));
+        }
+        fclose(f);
+    }
+
+    const char *cause = getenv(RESET_CAUSE_ENV);
+    if (cause != NULL && strcmp(cause, "IWDG") == 0) {
+        s_reset_flags |= RCC_FLAG_IWDGRST;
+    }
+    unsetenv(RESET_CAUSE_ENV);
+}
+
+uint32_t HAL_Host_GetResetFlag(uint32_t flag)
+{
+    return (s_reset_flags & flag) ? 1U : 0U;
+}
+
+uint32_t HAL_Host_GetIPSR(void)
+{
+    return s_ipsr;
+}
+
+void HAL_Host_StartIrqTask(void)
+{
+    xTaskCreate(host_irq_task, "HostIrq", HOST_IRQ_TASK_STACK, NULL, configMAX_PRIORITIES - 1, NULL);
+}
+
+void HAL_Host_RaiseIrq(uint32_t irq, void (*handler)(void *arg), void *arg)
+{
+    taskENTER_CRITICAL();
+    s_ipsr = irq;
+    handler(arg);
+    s_ipsr = 0;
+    taskEXIT_CRITICAL();
+}
+
+/* UART ----------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_UART_HostOpen(UART_HandleTypeDef *huart, const char *path)
+{
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        perror(path);
+        return HAL_ERROR;
+    }
+    struct termios tio;
+    tcgetattr(fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+    tcflush(fd, TCIOFLUSH);
+    huart->fd = fd;
+    s_uart = huart;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size)
+{
+    if (pData == NULL || Size == 0) {
+        return HAL_ERROR;
+    }
+    write_all(huart->fd, pData, Size);
+
+    // 链表模式: 头节点由本函数的参数改写，其余节点按队列顺序发出
+    DMA_HandleTypeDef *hdma = huart->hdmatx;
+    if (hdma != NULL && hdma->Mode == DMA_LINKEDLIST && hdma->LinkedListQueue != NULL) {
+        for (DMA_NodeTypeDef *node = hdma->LinkedListQueue->Head->next; node != NULL; node = node->next) {
+            write_all(huart->fd, (const uint8_t *)(uintptr_t)node->LinkRegisters[0], node->LinkRegisters[1]);
+        }
+    }
+
+    __atomic_store_n(&huart->tx_pending, true, __ATOMIC_RELEASE);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    huart->rx_buf = pData;
+    huart->rx_size = Size;
+    __atomic_store_n(&huart->rx_armed, true, __ATOMIC_RELEASE);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_DMAStop(UART_HandleTypeDef *huart)
+{
+    __atomic_store_n(&huart->rx_armed, false, __ATOMIC_RELEASE);
+    return HAL_OK;
+}
+
+/* DMA -----------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    hdma->Mode = DMA_NORMAL;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma)
+{
+    hdma->LinkedListQueue = NULL;
+    hdma->Parent = NULL;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_Init(DMA_HandleTypeDef *hdma)
+{
+    hdma->Mode = DMA_LINKEDLIST;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_BuildNode(DMA_NodeConfTypeDef const *conf, DMA_NodeTypeDef *node)
+{
+    memset(node, 0, sizeof(*node));
+    node->LinkRegisters[0] = conf->SrcAddress;
+    node->LinkRegisters[1] = conf->DataSize;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_InsertNode_Tail(DMA_QListTypeDef *queue, DMA_NodeTypeDef *node)
+{
+    DMA_NodeTypeDef **tail = &queue->Head;
+    while (*tail != NULL) {
+        tail = &(*tail)->next;
+    }
+    *tail = node;
+    node->next = NULL;
+    queue->NodeNumber++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_ResetQ(DMA_QListTypeDef *queue)
+{
+    memset(queue, 0, sizeof(*queue));
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_LinkQ(DMA_HandleTypeDef *hdma, DMA_QListTypeDef *queue)
+{
+    if (hdma->Mode != DMA_LINKEDLIST || queue->Head == NULL) {
+        return HAL_ERROR;
+    }
+    hdma->LinkedListQueue = queue;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_UnLinkQ(DMA_HandleTypeDef *hdma)
+{
+    hdma->LinkedListQueue = NULL;
+    return HAL_OK;
+}
+
+/* RNG -----------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_RNG_GenerateRandomNumber(RNG_HandleTypeDef *hrng, uint32_t *random32bit)
+{
+    (void)hrng;
+    static uint32_t state = 0x12345678U;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    *random32bit = state;
+    return HAL_OK;
+}
+
+/* IWDG / PWR ----------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_IWDG_Init(IWDG_HandleTypeDef *hiwdg)
+{
+    if (hiwdg->Reload == 0) {
+        hiwdg->Reload = IWDG_DEFAULT_RELOAD;
+    }
+    __atomic_store_n(&s_iwdg_last_refresh, host_now_ms(), __ATOMIC_RELAXED);
+    s_iwdg = hiwdg;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_IWDG_Refresh(IWDG_HandleTypeDef *hiwdg)
+{
+    (void)hiwdg;
+    __atomic_store_n(&s_iwdg_last_refresh, host_now_ms(), __ATOMIC_RELAXED);
+    return HAL_OK;
+}
+
+void HAL_PWR_EnableBkUpAccess(void)
+{
+}
+
+/* 运行时间统计 --------------------------------------------------------------*/
+
+void configureTimerForRunTimeStats(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &s_runtime_epoch);
+}
+
+unsigned long getRunTimeCounterValue(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long)((ts.tv_sec - s_runtime_epoch.tv_sec) * 1000000L +
+                           (ts.tv_nsec - s_runtime_epoch.tv_nsec) / 1000L);
+}
+
+/* 调试串口 ------------------------------------------------------------------*/
+
+/*
+ * POSIX 移植在节拍信号中切换任务：被切走的任务若正持有 stdio 的锁，更高优先级的任务再调用
+ * printf 就会在锁上永远等待 (持锁的低优先级任务得不到调度)。固件的日志因此不经过 stdio，
+ * 格式化到栈上的缓冲区后直接 write()。Makefile 以 -fno-builtin-printf 等编译固件，
+ * 防止编译器把 printf 改写为 puts/putchar。
+ */
+
+int vprintf(const char *format, va_list args)
+{
+    char buf[PRINTF_BUFFER_SIZE];
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    if (len > 0) {
+        write_all(STDOUT_FILENO, (const uint8_t *)buf, ((size_t)len < sizeof(buf)) ? (size_t)len : sizeof(buf) - 1);
+    }
+    return len;
+}
+
+int printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int len = vprintf(format, args);
+    va_end(args);
+    return len;
+}
+
+int puts(const char *s)
+{
+    write_all(STDOUT_FILENO, (const uint8_t *)s, strlen(s));
+    write_all(STDOUT_FILENO, (const uint8_t *)"\n", 1);
+    return 1;
+}
+
+int putchar(int c)
+{
+    uint8_t ch = (uint8_t)c;
+    write_all(STDOUT_FILENO, &ch, 1);
+    return c;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file      lora_radio_udp.c
+ * @author    Your Name
+ * @brief     LoRa 驱动的主机端实现: 虚拟射频，数据包走本机 UDP
+ *
+ * @details
+ *      - 发送: `LoRa_transmit` 把数据包作为一个数据报发往 127.0.0.1:peer_port，立即返回成功
+ *        (不模拟空中时间；lora_app.c 自行按射频参数估算空中时间)。
+ *      - 接收: 与 SX127x 一样只有一个包的 FIFO。射频处于接收模式且 FIFO 为空时，
+ *        HostIrq 任务取出一个数据报放入 FIFO 并产生 DIO0 中断，`LoRa_receive` 读出后 FIFO 清空。
+ *        FIFO 未读出期间到达的数据报留在套接字的接收队列中 (真实芯片会覆盖旧包)。
+ *
+ * @note  FIFO 只在 HostIrq 任务和 LoRa 任务之间共享，POSIX 移植同一时刻只运行一个任务，
+ *        `s_fifo_len` 用原子操作发布即可保证另一方看到完整的数据。
+ */
+
+#define _GNU_SOURCE
+#include "LoRa.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define RADIO_MAX_PACKET  255
+#define RADIO_VERSION     0x12  // SX1278 的 RegVersion
+#define RADIO_RSSI        (-40) // 虚拟射频没有信道模型，RSSI 固定
+
+/* Private Variables ---------------------------------------------------------*/
+static int s_sock = -1;
+static struct sockaddr_in s_peer;
+static volatile int s_mode = SLEEP_MODE;
+static uint16_t s_dio0_pin;
+static uint8_t s_fifo[RADIO_MAX_PACKET];
+static uint8_t s_fifo_len; // 非0表示 FIFO 中有一个未读出的包
+
+/* Private Functions ---------------------------------------------------------*/
+
+static void dio0_irq(void *arg)
+{
+    HAL_GPIO_EXTI_Rising_Callback((uint16_t)(uintptr_t)arg);
+}
+
+/* Public Functions ----------------------------------------------------------*/
+
+bool LoRa_HostOpen(uint16_t local_port, uint16_t peer_port)
+{
+    s_sock = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (s_sock < 0) {
+        perror("[Radio] socket");
+        return false;
+    }
+
+    struct sockaddr_in local = {
+        .sin_family = AF_INET,
+        .sin_port = htons(local_port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (bind(s_sock, (struct sockaddr *)&local, sizeof(local)) != 0) {
+        perror("[Radio] bind");
+        close(s_sock);
+        s_sock = -1;
+        return false;
+    }
+    fcntl(s_sock, F_SETFL, fcntl(s_sock, F_GETFL) | O_NONBLOCK);
+
+    s_peer.sin_family = AF_INET;
+    s_peer.sin_port = htons(peer_port);
+    s_peer.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    printf("[Radio] Virtual radio on udp/%u, peer udp/%u\r\n", local_port, peer_port);
+    return true;
+}
+
+void LoRa_HostPoll(void)
+{
+    if (s_sock < 0 || s_mode != RXCONTIN_MODE || __atomic_load_n(&s_fifo_len, __ATOMIC_ACQUIRE) != 0) {
+        return;
+    }
+
+    ssize_t n = recv(s_sock, s_fifo, sizeof(s_fifo), 0);
+    if (n <= 0) {
+        return; // EAGAIN: 没有数据包
+    }
+    __atomic_store_n(&s_fifo_len, (uint8_t)n, __ATOMIC_RELEASE);
+    HAL_Host_RaiseIrq(HOST_IRQ_EXTI12, dio0_irq, (void *)(uintptr_t)s_dio0_pin);
+}
+
+LoRa newLoRa(void)
+{
+    LoRa new_LoRa;
+    memset(&new_LoRa, 0, sizeof(new_LoRa));
+    new_LoRa.frequency             = 433;
+    new_LoRa.spredingFactor        = SF_7;
+    new_LoRa.bandWidth             = BW_125KHz;
+    new_LoRa.crcRate               = CR_4_5;
+    new_LoRa.power                 = POWER_20db;
+    new_LoRa.overCurrentProtection = 100;
+    new_LoRa.preamble              = 8;
+    return new_LoRa;
+}
+
+void LoRa_reset(LoRa* _LoRa)
+{
+    (void)_LoRa;
+    s_mode = SLEEP_MODE;
+    __atomic_store_n(&s_fifo_len, 0, __ATOMIC_RELEASE);
+}
+
+uint16_t LoRa_init(LoRa* _LoRa)
+{
+    if (s_sock < 0) {
+        return LORA_NOT_FOUND;
+    }
+    s_dio0_pin = _LoRa->DIO0_pin;
+    _LoRa->current_mode = STNBY_MODE;
+    s_mode = STNBY_MODE;
+    return LORA_OK;
+}
+
+uint8_t LoRa_read(LoRa* _LoRa, uint8_t address)
+{
+    (void)_LoRa;
+    return (address == RegVersion) ? RADIO_VERSION : 0;
+}
+
+uint8_t LoRa_transmit(LoRa* _LoRa, uint8_t* data, uint8_t length, uint16_t timeout)
+{
+    (void)timeout;
+    _LoRa->current_mode = TRANSMIT_MODE;
+    s_mode = TRANSMIT_MODE;
+
+    ssize_t n;
+    do {
+        n = sendto(s_sock, data, length, 0, (struct sockaddr *)&s_peer, sizeof(s_peer));
+    } while (n < 0 && errno == EINTR);
+
+    _LoRa->current_mode = STNBY_MODE;
+    s_mode = STNBY_MODE;
+    return (n == length) ? 1 : 0;
+}
+
+void LoRa_startReceiving(LoRa* _LoRa)
+{
+    _LoRa->current_mode = RXCONTIN_MODE;
+    s_mode = RXCONTIN_MODE;
+}
+
+uint8_t LoRa_receive(LoRa* _LoRa, uint8_t* data, uint8_t length)
+{
+    (void)_LoRa;
+    uint8_t len = __atomic_load_n(&s_fifo_len, __ATOMIC_ACQUIRE);
+    if (len == 0) {
+        return 0;
+    }
+    if (len > length) {
+        len = length;
+    }
+    memcpy(data, s_fifo, len);
+    __atomic_store_n(&s_fifo_len, 0, __ATOMIC_RELEASE);
+    return len;
+}
+
+int LoRa_getRSSI(LoRa* _LoRa)
+{
+    (void)_LoRa;
+    return RADIO_RSSI;
+}
@@ -0,0 +1,21 @@
+/**
+ * @file      main.h
+ * @author    Your Name
+ * @brief     主机端构建用: 替代 Core/Inc/main.h，只保留 lora_app.c 用到的 LoRa 引脚定义
+ */
+
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#include "stm32u5xx_hal.h"
+
+#define LORA_RESET_Pin GPIO_PIN_10
+#define LORA_RESET_GPIO_Port GPIOB
+#define LORA_DIO0_Pin GPIO_PIN_12
+#define LORA_DIO0_GPIO_Port GPIOB
+#define LORA_NSS_Pin GPIO_PIN_6
+#define LORA_NSS_GPIO_Port GPIOC
+
+void Error_Handler(void);
+
+#endif // __MAIN_H
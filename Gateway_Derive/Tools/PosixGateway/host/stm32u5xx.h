@@ -0,0 +1,35 @@
+/**
+ * @file      stm32u5xx.h
+ * @author    Your Name
+ * @brief     主机端构建用: 替代 CMSIS 设备头文件，只提供固件和 CMSIS-RTOS2 封装层访问到的外设寄存器
+ * @note      `SysTick` 与 `TAMP` 是真实的对象而不是宏：cmsis_os2.c 在 `defined(SysTick)` 时会定义
+ *            调用 `xPortSysTickHandler` 的 SysTick 中断函数，POSIX 移植没有这个函数。
+ */
+
+#ifndef STM32U5XX_H
+#define STM32U5XX_H
+
+#include <stdint.h>
+#include "cmsis_compiler.h"
+
+#define __IO volatile
+
+typedef struct {
+    __IO uint32_t CTRL;
+    __IO uint32_t LOAD;
+    __IO uint32_t VAL;
+    __IO uint32_t CALIB;
+} SysTick_Type;
+
+/** TAMP 备份寄存器: 模拟的复位 (看门狗超时) 前写入文件，重启后读回，与目标板的掉电前保持语义一致 */
+typedef struct {
+    __IO uint32_t BKP0R,  BKP1R,  BKP2R,  BKP3R,  BKP4R,  BKP5R,  BKP6R,  BKP7R;
+    __IO uint32_t BKP8R,  BKP9R,  BKP10R, BKP11R, BKP12R, BKP13R, BKP14R, BKP15R;
+    __IO uint32_t BKP16R, BKP17R, BKP18R, BKP19R, BKP20R, BKP21R, BKP22R, BKP23R;
+    __IO uint32_t BKP24R, BKP25R, BKP26R, BKP27R, BKP28R, BKP29R, BKP30R, BKP31R;
+} TAMP_TypeDef;
+
+extern SysTick_Type *const SysTick;
+extern TAMP_TypeDef *const TAMP;
+
+#endif // STM32U5XX_H
@@ -0,0 +1,244 @@
+/**
+ * @file      stm32u5xx_hal.h
+ * @author    Your Name
+ * @brief     主机端构建用的 STM32U5 HAL 子集 (FreeRTOS POSIX 移植版本，见 hal_posix.c)
+ * @note      结构体只保留固件访问到的成员，名称与真实HAL一致，固件源文件无需任何修改。
+ *            UART/GPDMA 部分与 Tools/L610Sim/host 的定义相同；区别在于回调不再由后台线程直接调用，
+ *            而是由最高优先级的 HostIrq 任务在模拟的中断上下文中调用 (FreeRTOS 的接口不能在
+ *            内核不认识的 pthread 中调用)。
+ */
+
+#ifndef STM32U5XX_HAL_H
+#define STM32U5XX_HAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "stm32u5xx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    HAL_OK      = 0x00U,
+    HAL_ERROR   = 0x01U,
+    HAL_BUSY    = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+/* 模拟的中断号 (IPSR = 16 + IRQn，与 STM32U575 的向量表一致) */
+#define HOST_IRQ_EXTI12          (16U + 23U)  ///< LoRa DIO0
+#define HOST_IRQ_GPDMA1_CH1      (16U + 30U)  ///< USART3 TX DMA 完成
+#define HOST_IRQ_USART3          (16U + 63U)  ///< USART3 空闲线路
+
+/* DMA -----------------------------------------------------------------------*/
+
+#define DMA_GPDMA_LINEAR_NODE          0x00000001U
+#define DMA_TCEM_LAST_LL_ITEM_TRANSFER 0xC0000000U
+#define DMA_EXCHANGE_NONE              0x00000000U
+#define DMA_DATA_RIGHTALIGN_ZEROPADDED 0x00000000U
+#define DMA_TRIG_POLARITY_MASKED       0x00000000U
+#define DMA_LSM_FULL_EXECUTION         0x00000000U
+#define DMA_LINK_ALLOCATED_PORT0       0x00000000U
+#define DMA_LINKEDLIST_NORMAL          0x00000000U
+#define DMA_NORMAL                     0x00000000U
+#define DMA_LINKEDLIST                 0x00000080U
+
+typedef struct {
+    uint32_t TDR;
+    uint32_t ICR;
+} USART_TypeDef;
+
+typedef struct {
+    uint32_t Request, BlkHWRequest, Direction, SrcInc, DestInc, SrcDataWidth, DestDataWidth, Priority;
+    uint32_t SrcBurstLength, DestBurstLength, TransferAllocatedPort, TransferEventMode, Mode;
+} DMA_InitTypeDef;
+
+typedef struct {
+    uint32_t Priority, LinkStepMode, LinkAllocatedPort, TransferEventMode, LinkedListMode;
+} DMA_InitLinkedListTypeDef;
+
+typedef struct { uint32_t DataExchange, DataAlignment; } DMA_DataHandlingConfTypeDef;
+typedef struct { uint32_t TriggerMode, TriggerPolarity, TriggerSelection; } DMA_TriggerConfTypeDef;
+typedef struct { uint32_t RepeatBlockCount; } DMA_RepeatBlockConfTypeDef;
+
+typedef struct {
+    uint32_t                    NodeType;
+    DMA_InitTypeDef             Init;
+    DMA_DataHandlingConfTypeDef DataHandlingConfig;
+    DMA_TriggerConfTypeDef      TriggerConfig;
+    DMA_RepeatBlockConfTypeDef  RepeatBlockConfig;
+    uint32_t                    SrcAddress;
+    uint32_t                    DstAddress;
+    uint32_t                    DataSize;
+} DMA_NodeConfTypeDef;
+
+/** 节点: LinkRegisters[0] 为源地址，[1] 为长度 (主机端约定)，next 指向队列中的下一节点 */
+typedef struct DMA_NodeTypeDef {
+    uint32_t                LinkRegisters[8U];
+    uint32_t                NodeInfo;
+    struct DMA_NodeTypeDef *next;
+} DMA_NodeTypeDef;
+
+typedef struct {
+    DMA_NodeTypeDef *Head;
+    uint32_t         NodeNumber;
+    uint32_t         State;
+    uint32_t         ErrorCode;
+    uint32_t         Type;
+} DMA_QListTypeDef;
+
+typedef struct {
+    void                     *Instance;
+    DMA_InitTypeDef           Init;
+    DMA_InitLinkedListTypeDef InitLinkedList;
+    DMA_QListTypeDef         *LinkedListQueue;
+    uint32_t                  Mode;
+    void                     *Parent;
+} DMA_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMAEx_List_Init(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMAEx_List_BuildNode(DMA_NodeConfTypeDef const *conf, DMA_NodeTypeDef *node);
+HAL_StatusTypeDef HAL_DMAEx_List_InsertNode_Tail(DMA_QListTypeDef *queue, DMA_NodeTypeDef *node);
+HAL_StatusTypeDef HAL_DMAEx_List_ResetQ(DMA_QListTypeDef *queue);
+HAL_StatusTypeDef HAL_DMAEx_List_LinkQ(DMA_HandleTypeDef *hdma, DMA_QListTypeDef *queue);
+HAL_StatusTypeDef HAL_DMAEx_List_UnLinkQ(DMA_HandleTypeDef *hdma);
+
+#define __HAL_LINKDMA(__HANDLE__, __PPP_DMA_FIELD__, __DMA_HANDLE__) \
+    do {                                                             \
+        (__HANDLE__)->__PPP_DMA_FIELD__ = &(__DMA_HANDLE__);         \
+        (__DMA_HANDLE__).Parent = (__HANDLE__);                      \
+    } while (0)
+
+/* UART ----------------------------------------------------------------------*/
+
+#define UART_IT_IDLE     0x0004U
+#define UART_CLEAR_IDLEF 0x0010U
+
+typedef struct __UART_HandleTypeDef {
+    USART_TypeDef     *Instance;
+    DMA_HandleTypeDef *hdmarx;
+    DMA_HandleTypeDef *hdmatx;
+    int                fd;         ///< [主机端] 伪终端文件描述符
+    uint8_t           *rx_buf;     ///< [主机端] 当前接收DMA缓冲区
+    uint16_t           rx_size;    ///< [主机端] 当前接收DMA缓冲区长度
+    bool               rx_armed;   ///< [主机端] 接收DMA已启动
+    bool               tx_pending; ///< [主机端] 发送已写出，等待 HostIrq 产生完成中断
+} UART_HandleTypeDef;
+
+#define __HAL_UART_CLEAR_IT(__HANDLE__, __IT_CLEAR__) ((void)(__HANDLE__))
+#define __HAL_UART_DISABLE_IT(__HANDLE__, __INTERRUPT__) ((void)(__HANDLE__))
+
+/**
+ * @brief [主机端] 打开伪终端并绑定到UART句柄
+ * @param path 伪终端从端路径 (例如 l610_sim 创建的 /tmp/l610)
+ */
+HAL_StatusTypeDef HAL_UART_HostOpen(UART_HandleTypeDef *huart, const char *path);
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_DMAStop(UART_HandleTypeDef *huart);
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+
+/* GPIO / SPI ----------------------------------------------------------------*/
+
+typedef struct {
+    __IO uint32_t ODR;
+} GPIO_TypeDef;
+
+#define GPIO_PIN_6   ((uint16_t)0x0040)
+#define GPIO_PIN_10  ((uint16_t)0x0400)
+#define GPIO_PIN_12  ((uint16_t)0x1000)
+
+extern GPIO_TypeDef *const GPIOB;
+extern GPIO_TypeDef *const GPIOC;
+
+void HAL_GPIO_EXTI_Rising_Callback(uint16_t GPIO_Pin);
+
+/** LoRa 模块由 LoRa.h 的主机端实现直接收发 UDP 数据报，SPI 句柄只是占位 */
+typedef struct {
+    void *Instance;
+} SPI_HandleTypeDef;
+
+/* CRC -----------------------------------------------------------------------*/
+
+/**
+ * 只满足 lora_protocol.c 的编译：固件逐字节写入 DR，主机上无法拦截，结果只是最后写入的字节。
+ * 虚拟节点 (node_sim) 链接同一份 lora_protocol.c 生成数据帧，两端的校验值因此一致；
+ * 真实节点的数据帧在主机端不能通过校验。
+ */
+typedef struct {
+    __IO uint32_t DR;
+} CRC_TypeDef;
+
+typedef struct {
+    CRC_TypeDef *Instance;
+} CRC_HandleTypeDef;
+
+#define READ_REG(REG)                  ((REG))
+#define __HAL_CRC_DR_RESET(__HANDLE__) ((__HANDLE__)->Instance->DR = 0U)
+
+/* RNG -----------------------------------------------------------------------*/
+
+typedef struct {
+    void *Instance;
+} RNG_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_RNG_GenerateRandomNumber(RNG_HandleTypeDef *hrng, uint32_t *random32bit);
+
+/* IWDG / RCC / PWR ----------------------------------------------------------*/
+
+/**
+ * 看门狗以主机单调时钟计时：超过 Reload 毫秒未刷新即模拟一次看门狗复位
+ * (备份寄存器写入文件后重新执行本程序，见 hal_posix.c)
+ */
+typedef struct {
+    void    *Instance;
+    uint32_t Reload; ///< [主机端] 超时时间 (毫秒)
+} IWDG_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_IWDG_Init(IWDG_HandleTypeDef *hiwdg);
+HAL_StatusTypeDef HAL_IWDG_Refresh(IWDG_HandleTypeDef *hiwdg);
+
+#define RCC_FLAG_IWDGRST 0x1U
+
+#define __HAL_RCC_RTCAPB_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_GET_FLAG(__FLAG__)  HAL_Host_GetResetFlag(__FLAG__)
+
+void HAL_PWR_EnableBkUpAccess(void);
+
+/* 主机端 --------------------------------------------------------------------*/
+
+/**
+ * @brief [主机端] 恢复上一次模拟复位前的备份寄存器和复位标志
+ * @param bkp_path 备份寄存器文件路径
+ * @param argv 看门狗复位时重新执行本程序所用的参数；为 NULL 时看门狗复位以退出码3结束进程
+ */
+void HAL_Host_Init(const char *bkp_path, char **argv);
+
+/** @brief [主机端] 读取复位标志 (RCC_FLAG_xxx) */
+uint32_t HAL_Host_GetResetFlag(uint32_t flag);
+
+/**
+ * @brief [主机端] 创建 HostIrq 任务 (须在 osKernelStart 之前调用)
+ * @details 该任务以最高优先级每个节拍轮询一次伪终端、虚拟射频和看门狗，
+ *          有事件时置位模拟的 IPSR 并调用对应的 HAL 回调。
+ */
+void HAL_Host_StartIrqTask(void);
+
+/**
+ * @brief [主机端] 在模拟的中断上下文中调用一个中断处理函数 (只能由 HostIrq 任务调用)
+ * @param irq 模拟的中断号 (HOST_IRQ_xxx)
+ */
+void HAL_Host_RaiseIrq(uint32_t irq, void (*handler)(void *arg), void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STM32U5XX_HAL_H
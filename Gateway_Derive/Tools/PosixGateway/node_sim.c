@@ -0,0 +1,257 @@
+/**
+ * @file      node_sim.c
+ * @author    Your Name
+ * @brief     虚拟 LoRa 节点：通过本机 UDP 向 gateway_posix 的虚拟射频发送传感器和控制节点数据帧
+ *
+ * @details
+ *      按 iot_config.h 的设备表模拟三个节点:
+ *      - 0x11 大棚传感器节点: 每个周期发送一帧 MSG_TYPE_REPORT_SENSOR (带采样追踪尾部)
+ *      - 0x13 室外传感器节点: 同上
+ *      - 0x12 控制节点:       每4个周期发送一帧 MSG_TYPE_CMD_REPORT_CONFIG
+ *      网关下发的数据帧 (云端命令转发) 会被解析并打印。
+ *      数据帧由网关同一份 lora_protocol.c 生成，校验值与网关的主机端CRC实现一致 (见 host/stm32u5xx_hal.h)。
+ *
+ * @par 用法:
+ *      ./node_sim [-g 网关射频端口] [-l 本机端口] [-i 周期ms] [-c 周期数，0为不限]
+ */
+
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "main.h"
+#include "lora_protocol.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define DEFAULT_GATEWAY_PORT  17000
+#define DEFAULT_LOCAL_PORT    17001
+#define DEFAULT_INTERVAL_MS   5000
+#define CONTROL_REPORT_EVERY  4
+
+/* Firmware Dependencies -----------------------------------------------------*/
+
+static CRC_TypeDef s_crc;
+CRC_HandleTypeDef hcrc = {.Instance = &s_crc};
+
+/* Private Types -------------------------------------------------------------*/
+
+typedef struct {
+    uint8_t  addr;
+    uint8_t  seq;
+    uint16_t trace_id;
+} virtual_node_t;
+
+typedef struct {
+    sensor_internal_data_payload_t data;
+    lora_trace_trailer_t           trace;
+} __attribute__((packed)) internal_frame_body_t;
+
+typedef struct {
+    sensor_external_data_payload_t data;
+    lora_trace_trailer_t           trace;
+} __attribute__((packed)) external_frame_body_t;
+
+/* Private Variables ---------------------------------------------------------*/
+
+static int s_sock = -1;
+static struct sockaddr_in s_gateway;
+static uint32_t s_sent = 0;
+static uint32_t s_received = 0;
+static volatile sig_atomic_t s_stop = 0;
+
+static virtual_node_t s_internal = {.addr = DEVICE_TYPE_SENSOR_Internal};
+static virtual_node_t s_external = {.addr = DEVICE_TYPE_SENSOR_External};
+static virtual_node_t s_control = {.addr = DEVICE_TYPE_CONTROL};
+
+/* Private Functions ---------------------------------------------------------*/
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    s_stop = 1;
+}
+
+static uint32_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000U + (uint64_t)ts.tv_nsec / 1000000U);
+}
+
+static uint16_t next_trace_id(virtual_node_t *node)
+{
+    if (++node->trace_id == 0) {
+        node->trace_id = 1; // 0 表示未追踪，与节点固件一样跳过
+    }
+    return node->trace_id;
+}
+
+static void send_frame(virtual_node_t *node, uint8_t msg_type, const void *payload, size_t len)
+{
+    uint8_t frame[LORA_MAX_RAW_PACKET];
+    int frame_len = generate_lora_frame(LORA_HOST_ADDRESS, node->addr, msg_type, node->seq++,
+                                        payload, len, frame, sizeof(frame));
+    if (frame_len <= 0) {
+        fprintf(stderr, "[Node] 0x%02X frame build failed (%d)\n", node->addr, frame_len);
+        return;
+    }
+    if (sendto(s_sock, frame, (size_t)frame_len, 0, (struct sockaddr *)&s_gateway, sizeof(s_gateway)) == frame_len) {
+        s_sent++;
+    }
+}
+
+/** 采集耗时: 传感器预热与 Modbus 轮询，300~1500ms */
+static uint32_t random_acq_age_ms(void)
+{
+    return 300U + (uint32_t)(rand() % 1200);
+}
+
+static void send_internal_sensor(void)
+{
+    internal_frame_body_t body;
+    memset(&body, 0, sizeof(body));
+    body.data.greenhouse_temp_int = (int8_t)(22 + rand() % 6);
+    body.data.greenhouse_temp_dec = (uint8_t)(rand() % 100);
+    body.data.greenhouse_humid_int = (uint8_t)(55 + rand() % 20);
+    body.data.greenhouse_humid_dec = (uint8_t)(rand() % 100);
+    body.data.soil_moisture_int = (int8_t)(30 + rand() % 10);
+    body.data.soil_temp_int = (int8_t)(18 + rand() % 4);
+    body.data.soil_ec = (uint16_t)(400 + rand() % 200);
+    body.data.soil_ph_int = 6;
+    body.data.soil_ph_dec = (uint8_t)(rand() % 100);
+    body.data.soil_nitrogen = (uint16_t)(40 + rand() % 20);
+    body.data.soil_phosphorus = (uint16_t)(20 + rand() % 10);
+    body.data.soil_potassium = (uint16_t)(100 + rand() % 40);
+    body.data.light_intensity = (uint32_t)(8000 + rand() % 4000);
+    body.data.voc_concentration = (uint16_t)(rand() % 300);
+    body.data.co2_concentration = (uint16_t)(400 + rand() % 400);
+    body.data.battery_level = 87;
+    body.data.battery_voltage_x10 = 39;
+    body.trace.trace_id = next_trace_id(&s_internal);
+    body.trace.acq_age_ms = random_acq_age_ms();
+    send_frame(&s_internal, MSG_TYPE_REPORT_SENSOR, &body, sizeof(body));
+}
+
+static void send_external_sensor(void)
+{
+    external_frame_body_t body;
+    memset(&body, 0, sizeof(body));
+    body.data.temperature_int = (int8_t)(15 + rand() % 10);
+    body.data.temperature_dec = (uint8_t)(rand() % 100);
+    body.data.humidity_int = (uint8_t)(40 + rand() % 30);
+    body.data.air_pressure = (uint32_t)(100800 + rand() % 1000);
+    body.data.light_intensity = (uint32_t)(20000 + rand() % 30000);
+    body.data.altitude = 52;
+    body.data.latitude_e6 = 30657000;
+    body.data.longitude_e6 = 104066000;
+    body.data.battery_level = 92;
+    body.data.battery_voltage_x10 = 40;
+    body.trace.trace_id = next_trace_id(&s_external);
+    body.trace.acq_age_ms = random_acq_age_ms();
+    send_frame(&s_external, MSG_TYPE_REPORT_SENSOR, &body, sizeof(body));
+}
+
+static void send_control_report(void)
+{
+    control_data_payload_t body = {
+        .fanStatus = true,
+        .growLightStatus = false,
+        .pumpStatus = (rand() % 2) != 0,
+        .fanSpeed = 60,
+        .pumpSpeed = 40,
+    };
+    send_frame(&s_control, MSG_TYPE_CMD_REPORT_CONFIG, &body, sizeof(body));
+}
+
+static void handle_downlink(void)
+{
+    uint8_t raw[LORA_MAX_RAW_PACKET];
+    ssize_t n = recv(s_sock, raw, sizeof(raw), MSG_DONTWAIT);
+    if (n <= 0) {
+        return;
+    }
+    s_received++;
+
+    lora_parsed_message_t msg;
+    lora_frame_status_t status = parse_lora_frame(raw, (size_t)n, &msg);
+    if (status != LORA_FRAME_OK) {
+        printf("[Node] Downlink of %zd bytes rejected (status %d)\n", n, status);
+        return;
+    }
+    printf("[Node] Downlink to 0x%02X: type 0x%02X, seq %u, %u byte(s) payload\n",
+           msg.target_addr, msg.msg_type, msg.seq_num, msg.payload_len);
+}
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    uint16_t gateway_port = DEFAULT_GATEWAY_PORT;
+    uint16_t local_port = DEFAULT_LOCAL_PORT;
+    uint32_t interval_ms = DEFAULT_INTERVAL_MS;
+    uint32_t cycles = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "g:l:i:c:h")) != -1) {
+        switch (opt) {
+        case 'g': gateway_port = (uint16_t)atoi(optarg); break;
+        case 'l': local_port = (uint16_t)atoi(optarg); break;
+        case 'i': interval_ms = (uint32_t)atoi(optarg); break;
+        case 'c': cycles = (uint32_t)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-g gateway_port] [-l local_port] [-i interval_ms] [-c cycles]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    s_sock = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in local = {
+        .sin_family = AF_INET,
+        .sin_port = htons(local_port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (s_sock < 0 || bind(s_sock, (struct sockaddr *)&local, sizeof(local)) != 0) {
+        perror("[Node] socket");
+        return 1;
+    }
+    s_gateway.sin_family = AF_INET;
+    s_gateway.sin_port = htons(gateway_port);
+    s_gateway.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    srand((unsigned)time(NULL));
+    setvbuf(stdout, NULL, _IOLBF, 0); // 输出重定向到日志文件时也按行写出
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    printf("[Node] Virtual nodes 0x%02X/0x%02X/0x%02X -> udp/%u every %u ms\n",
+           s_internal.addr, s_control.addr, s_external.addr, gateway_port, interval_ms);
+
+    uint32_t next = now_ms();
+    for (uint32_t cycle = 0; !s_stop && (cycles == 0 || cycle < cycles); cycle++) {
+        send_internal_sensor();
+        send_external_sensor();
+        if (cycle % CONTROL_REPORT_EVERY == 0) {
+            send_control_report();
+        }
+
+        // 等待下一个周期，期间接收网关的下行帧
+        next += interval_ms;
+        for (int32_t wait; !s_stop && (wait = (int32_t)(next - now_ms())) > 0;) {
+            struct pollfd pfd = {.fd = s_sock, .events = POLLIN};
+            if (poll(&pfd, 1, wait) > 0) {
+                handle_downlink();
+            }
+        }
+    }
+
+    printf("[Node] Sent %u frame(s), received %u downlink frame(s)\n", s_sent, s_received);
+    return 0;
+}
@@ -0,0 +1,415 @@
+#include "acquisition.h"
+#include "main.h"
+#include "bh1750.h"
+#include "sht40.h"
+#include "sgp30.h"
+#include "sp3485.h"
+#include "battery.h"
+#include "config_manager.h"
+#include <stdio.h>
+
+#define SOIL_SLAVE_ADDR     0x01 // 土壤传感器的Modbus从机地址
+
+#define ACQ_STEP_DONE       0xFF // 任务已完成 (成功或失败)
+
+/**
+ * @brief  一个传感器的采集任务：按步骤推进的小状态机。
+ */
+typedef struct {
+    uint8_t  step;      // 当前步骤，ACQ_STEP_DONE 表示已完成
+    uint32_t due_tick;  // 执行当前步骤的时刻
+} AcqTask_t;
+
+// 执行一个已到期的步骤：推进 task->step 并设置下一步的 due_tick
+typedef void (*AcqStepFn_t)(AcqTask_t *task, uint32_t now);
+
+// --- 私有函数声明 ---
+static void sht40_step(AcqTask_t *task, uint32_t now);
+static void bh1750_step(AcqTask_t *task, uint32_t now);
+static void sgp30_step(AcqTask_t *task, uint32_t now);
+static void soil_step(AcqTask_t *task, uint32_t now);
+static void battery_step(AcqTask_t *task, uint32_t now);
+static void task_finish(AcqTask_t *task, uint8_t sensor_bit, bool ok, const char *name);
+static void sgp30_update_baseline(uint32_t now);
+
+// 任务编号，与 ACQ_SENSOR_xxx 的位序一致
+enum {
+    ACQ_TASK_SHT40,
+    ACQ_TASK_BH1750,
+    ACQ_TASK_SGP30,
+    ACQ_TASK_SOIL,
+    ACQ_TASK_BATTERY,
+    ACQ_TASK_COUNT
+};
+
+static const AcqStepFn_t s_step_fns[ACQ_TASK_COUNT] = {
+    [ACQ_TASK_SHT40]   = sht40_step,
+    [ACQ_TASK_BH1750]  = bh1750_step,
+    [ACQ_TASK_SGP30]   = sgp30_step,
+    [ACQ_TASK_SOIL]    = soil_step,
+    [ACQ_TASK_BATTERY] = battery_step,
+};
+
+static AcqTask_t s_tasks[ACQ_TASK_COUNT];
+static InternalSensorProperties_t *s_out;
+static uint32_t s_start_tick;
+static uint8_t  s_valid_mask;
+static uint8_t  s_scheduled_mask;
+static uint8_t  s_done_mask;
+
+// 各任务跨步骤保存的数据
+static uint32_t s_sgp30_init_tick;
+static uint8_t  s_soil_raw[SOIL_FULL_RAW_SIZE];
+
+// 跨采集周期保存的数据 (STOP2 期间SRAM保持)
+static uint16_t s_sgp30_cycle;          // SGP30 测量间隔计数
+static uint32_t s_baseline_saved_run_s; // Flash中的基线对应的算法累计运行时间
+
+/**
+ * @brief 开始一个采集周期
+ */
+void Acquisition_Start(InternalSensorProperties_t *out)
+{
+    s_out = out;
+    s_start_tick = HAL_GetTick();
+    s_valid_mask = 0;
+    s_done_mask = 0;
+    s_scheduled_mask = ACQ_SENSOR_ALL;
+
+    for (uint8_t i = 0; i < ACQ_TASK_COUNT; i++)
+    {
+        s_tasks[i].step = 0;
+        s_tasks[i].due_tick = s_start_tick + ACQ_I2C_POWERUP_MS;
+    }
+    s_tasks[ACQ_TASK_SOIL].due_tick = s_start_tick + ACQ_SOIL_POWERUP_MS;
+    s_tasks[ACQ_TASK_BATTERY].due_tick = s_start_tick + BATTERY_SETTLE_TIME_MS;
+
+    // 不测量SGP30的周期：CO2/TVOC 字段保持上一次的值，但不记为本周期读取的有效值
+    if (s_sgp30_cycle++ % ACQ_SGP30_EVERY_N_CYCLES != 0)
+    {
+        s_tasks[ACQ_TASK_SGP30].step = ACQ_STEP_DONE;
+        s_done_mask |= ACQ_SENSOR_SGP30;
+        s_scheduled_mask &= (uint8_t)~ACQ_SENSOR_SGP30;
+    }
+
+    // 电池测量电路和RS485驱动不需要等待传感器上电，立即启动
+    Battery_BeginMeasure();
+    SP3485_Init();
+
+    // 第一步的到期时间很短，这里直接执行一次，让各传感器尽早开始转换
+    (void)Acquisition_Poll();
+}
+
+/**
+ * @brief 执行已到期的采集步骤
+ */
+bool Acquisition_Poll(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    for (uint8_t i = 0; i < ACQ_TASK_COUNT; i++)
+    {
+        AcqTask_t *task = &s_tasks[i];
+        if (task->step == ACQ_STEP_DONE)
+        {
+            continue;
+        }
+        if (now - s_start_tick >= ACQ_TIMEOUT_MS)
+        {
+            printf("Acquisition timeout, sensor %u skipped\r\n", i);
+            task->step = ACQ_STEP_DONE;
+            s_done_mask |= (uint8_t)(1U << i);
+            continue;
+        }
+        if ((int32_t)(now - task->due_tick) >= 0)
+        {
+            s_step_fns[i](task, now);
+        }
+    }
+
+    return s_done_mask == ACQ_SENSOR_ALL;
+}
+
+/**
+ * @brief 等待本周期采集完成
+ */
+uint8_t Acquisition_Wait(void)
+{
+    while (!Acquisition_Poll())
+    {
+        // 下一个事件最早也在下一个SysTick之后，CPU在此期间睡眠。
+        // SysTick (1ms) 和 LPUART1 的发送完成/IDLE中断都会唤醒CPU。
+        HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+    }
+
+    printf("Acquisition done in %lu ms (valid 0x%02X)\r\n", (unsigned long)(HAL_GetTick() - s_start_tick), s_valid_mask);
+    return s_valid_mask;
+}
+
+/**
+ * @brief 冷启动后从Flash恢复SGP30基线
+ */
+void Acquisition_RestoreSgp30Baseline(void)
+{
+    if (g_Sgp30Baseline.magic_number == SGP30_BASELINE_MAGIC_NUMBER)
+    {
+        return; // 从STOP2唤醒：内存中的基线比Flash中的新
+    }
+
+    if (Config_LoadSgp30Baseline())
+    {
+        s_baseline_saved_run_s = g_Sgp30Baseline.run_seconds;
+        printf("SGP30 baseline restored (CO2eq 0x%04X, TVOC 0x%04X, %lu h)\r\n", g_Sgp30Baseline.co2eq_base,
+               g_Sgp30Baseline.tvoc_base, (unsigned long)(g_Sgp30Baseline.run_seconds / 3600U));
+    }
+    else
+    {
+        s_baseline_saved_run_s = 0;
+        printf("No SGP30 baseline in Flash, learning from scratch\r\n");
+    }
+}
+
+/**
+ * @brief 获取本采集周期计划读取的传感器
+ */
+uint8_t Acquisition_GetScheduledMask(void)
+{
+    return s_scheduled_mask;
+}
+
+/**
+ * @brief 获取本采集周期的开始时刻
+ */
+uint32_t Acquisition_GetStartTick(void)
+{
+    return s_start_tick;
+}
+
+// --- 私有函数实现 ---
+
+/**
+ * @brief 结束一个任务并记录结果
+ */
+static void task_finish(AcqTask_t *task, uint8_t sensor_bit, bool ok, const char *name)
+{
+    task->step = ACQ_STEP_DONE;
+    s_done_mask |= sensor_bit;
+    if (ok)
+    {
+        s_valid_mask |= sensor_bit;
+    }
+    else
+    {
+        printf("%s read err!\r\n", name);
+    }
+}
+
+/**
+ * @brief SHT40: 发出高精度测量命令 -> 8.3ms后读取
+ */
+static void sht40_step(AcqTask_t *task, uint32_t now)
+{
+    if (task->step == 0)
+    {
+        if (SHT40_StartMeasure() != SUCCESS)
+        {
+            task_finish(task, ACQ_SENSOR_SHT40, false, "SHT40");
+            return;
+        }
+        task->step = 1;
+        task->due_tick = now + SHT40_MEAS_TIME_MS;
+    }
+    else
+    {
+        bool ok = (SHT40_ReadResult(&s_out->greenhouseTemperature, &s_out->greenhouseHumidity) == SUCCESS);
+        task_finish(task, ACQ_SENSOR_SHT40, ok, "SHT40");
+    }
+}
+
+/**
+ * @brief BH1750: 上电并进入连续高分辨率模式 -> 180ms后读取
+ */
+static void bh1750_step(AcqTask_t *task, uint32_t now)
+{
+    if (task->step == 0)
+    {
+        if (!BH1750_StartMeasure())
+        {
+            task_finish(task, ACQ_SENSOR_BH1750, false, "BH1750");
+            return;
+        }
+        task->step = 1;
+        task->due_tick = now + BH1750_MEAS_TIME_MS;
+    }
+    else
+    {
+        uint16_t light;
+        bool ok = BH1750_ReadResult(&light);
+        if (ok)
+        {
+            s_out->lightIntensity = light;
+        }
+        task_finish(task, ACQ_SENSOR_BH1750, ok, "BH1750");
+    }
+}
+
+/**
+ * @brief SGP30: Init_air_quality (+ 恢复基线) -> 每秒一次 Measure_iaq，初始化阶段结束后的第一个值为结果
+ */
+static void sgp30_step(AcqTask_t *task, uint32_t now)
+{
+    switch (task->step)
+    {
+    case 0:
+        if (sgp30_iaq_init() < 0)
+        {
+            task_finish(task, ACQ_SENSOR_SGP30, false, "SGP30");
+            return;
+        }
+        s_sgp30_init_tick = now;
+        task->step = 1;
+        task->due_tick = now;
+        if (g_Sgp30Baseline.magic_number == SGP30_BASELINE_MAGIC_NUMBER &&
+            sgp30_set_baseline(g_Sgp30Baseline.co2eq_base, g_Sgp30Baseline.tvoc_base) == 0)
+        {
+            task->due_tick = now + SGP30_BASELINE_TIME_MS;
+        }
+        break;
+
+    case 1:
+        // 测量失败时按1秒间隔重试，直到初始化阶段结束
+        if (sgp30_measure_start() == 0)
+        {
+            task->step = 2;
+            task->due_tick = now + SGP30_MEASURE_TIME_MS;
+        }
+        else
+        {
+            task->due_tick = now + ACQ_SGP30_INTERVAL_MS;
+        }
+        break;
+
+    default:
+    {
+        uint16_t co2 = 0, tvoc = 0;
+        bool ok = (sgp30_measure_read(&co2, &tvoc) == 0);
+
+        // 初始化阶段内的读数固定为400ppm/0ppb，只为让算法按1秒节拍运行，不作为结果
+        if (now - s_sgp30_init_tick < SGP30_INIT_PHASE_MS)
+        {
+            task->step = 1;
+            task->due_tick = task->due_tick - SGP30_MEASURE_TIME_MS + ACQ_SGP30_INTERVAL_MS;
+            return;
+        }
+        if (ok)
+        {
+            s_out->co2Concentration = co2;
+            s_out->vocConcentration = tvoc;
+            sgp30_update_baseline(now);
+        }
+        task_finish(task, ACQ_SENSOR_SGP30, ok, "SGP30");
+        break;
+    }
+    }
+}
+
+/**
+ * @brief 读回SGP30的基线供下一周期恢复，按策略保存到Flash
+ */
+static void sgp30_update_baseline(uint32_t now)
+{
+    uint16_t co2eq_base, tvoc_base;
+    if (sgp30_get_baseline(&co2eq_base, &tvoc_base) != 0)
+    {
+        return;
+    }
+
+    g_Sgp30Baseline.magic_number = SGP30_BASELINE_MAGIC_NUMBER;
+    g_Sgp30Baseline.co2eq_base = co2eq_base;
+    g_Sgp30Baseline.tvoc_base = tvoc_base;
+    g_Sgp30Baseline.run_seconds += (now - s_sgp30_init_tick) / 1000U;
+
+    if (g_Sgp30Baseline.run_seconds >= ACQ_SGP30_BASELINE_MIN_RUN_S &&
+        g_Sgp30Baseline.run_seconds - s_baseline_saved_run_s >= ACQ_SGP30_BASELINE_SAVE_S)
+    {
+        if (Config_SaveSgp30Baseline())
+        {
+            s_baseline_saved_run_s = g_Sgp30Baseline.run_seconds;
+            printf("SGP30 baseline saved (%lu h)\r\n", (unsigned long)(g_Sgp30Baseline.run_seconds / 3600U));
+        }
+        else
+        {
+            printf("SGP30 baseline save err!\r\n");
+        }
+    }
+}
+
+/**
+ * @brief 土壤传感器: 两次Modbus问询 (0x0000起9个寄存器，然后肥力寄存器)，响应由LPUART1 DMA接收
+ */
+static void soil_step(AcqTask_t *task, uint32_t now)
+{
+    uint8_t status;
+
+    switch (task->step)
+    {
+    case 0:
+        (void)SP3485_Start_Read_Holding_Registers(SOIL_SLAVE_ADDR, SOIL_FULL_START, SOIL_FULL_REGS);
+        task->step = 1;
+        break;
+
+    case 1:
+        status = SP3485_Poll_Read_Holding_Registers(s_soil_raw);
+        if (status == SP3485_BUSY)
+        {
+            break;
+        }
+        if (status != 0)
+        {
+            task_finish(task, ACQ_SENSOR_SOIL, false, "Soil sensor");
+            return;
+        }
+        // 第二次问询前的帧间隔由 SP3485_Start_Read_Holding_Registers 保证
+        (void)SP3485_Start_Read_Holding_Registers(SOIL_SLAVE_ADDR, SOIL_FULL_FERTILITY_REG, 1);
+        task->step = 2;
+        break;
+
+    default:
+        status = SP3485_Poll_Read_Holding_Registers(&s_soil_raw[SOIL_FULL_REGS * 2]);
+        if (status == SP3485_BUSY)
+        {
+            break;
+        }
+        if (status == 0)
+        {
+            Soil_Sensor_Full_Data_t soil_data;
+            SP3485_Parse_Soil_Full_Data(s_soil_raw, &soil_data);
+            s_out->soilMoisture = soil_data.moisture;
+            s_out->soilTemperature = soil_data.temperature;
+            s_out->soilEc = soil_data.ec;
+            s_out->soilPh = soil_data.ph;
+            s_out->soilNitrogen = soil_data.nitrogen;
+            s_out->soilPhosphorus = soil_data.phosphorus;
+            s_out->soilPotassium = soil_data.potassium;
+            s_out->soilSalinity = soil_data.salinity;
+            s_out->soilTds = soil_data.tds;
+            s_out->soilFertility = soil_data.fertility;
+        }
+        task_finish(task, ACQ_SENSOR_SOIL, status == 0, "Soil sensor");
+        return;
+    }
+
+    // 响应由DMA接收，每次唤醒 (至少每个SysTick) 检查一次
+    task->due_tick = now + 1;
+}
+
+/**
+ * @brief 电池电压: 测量电路在 Acquisition_Start 中已打开，RC稳定后采样
+ */
+static void battery_step(AcqTask_t *task, uint32_t now)
+{
+    (void)now;
+    s_out->common.batteryVoltage = Battery_ReadVoltage();
+    s_out->common.batteryLevel = Battery_GetPercentage(s_out->common.batteryVoltage);
+    task_finish(task, ACQ_SENSOR_BATTERY, true, "Battery");
+}
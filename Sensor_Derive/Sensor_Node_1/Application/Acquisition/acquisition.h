@@ -0,0 +1,85 @@
+#ifndef __ACQUISITION_H
+#define __ACQUISITION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "device_properties.h"
+
+/*
+ * 事件驱动的并行采集：
+ *   SHT40 (I2C1)、BH1750 (I2C2)、SGP30 (I2C3)、土壤传感器 (LPUART1/RS485) 和电池电压 (ADC)
+ *   在 Acquisition_Start() 中同时发出第一步命令，之后由 Acquisition_Poll() 在各自的
+ *   转换时间到达时收取结果并发出下一步命令。每一步的总线传输只有几个字节，
+ *   转换期间总线和CPU都空闲，Acquisition_Wait() 在两个事件之间让CPU进入睡眠。
+ *   一个采集周期的耗时取决于最慢的一个传感器，而不是所有传感器耗时之和。
+ */
+
+// 各传感器在结果掩码中的位
+#define ACQ_SENSOR_SHT40    (1U << 0)
+#define ACQ_SENSOR_BH1750   (1U << 1)
+#define ACQ_SENSOR_SGP30    (1U << 2)
+#define ACQ_SENSOR_SOIL     (1U << 3)
+#define ACQ_SENSOR_BATTERY  (1U << 4)
+#define ACQ_SENSOR_ALL      0x1FU
+
+// 时序参数，单位：毫秒 (ms)
+#define ACQ_I2C_POWERUP_MS      5       // 传感器上电后到可以接受I2C命令的时间 (SHT40 1ms, SGP30 0.6ms)
+#define ACQ_SOIL_POWERUP_MS     500     // 土壤传感器上电后到可以应答Modbus问询的时间
+#define ACQ_SGP30_INTERVAL_MS   1000    // SGP30 的 Measure_iaq 必须以1秒为间隔调用
+#define ACQ_TIMEOUT_MS          25000   // 整个采集周期的上限，超时的传感器保留上一次的值
+
+/*
+ * SGP30 策略：
+ *   SGP30 每次上电后有15秒的初始化阶段 (SGP30_INIT_PHASE_MS)，是采集周期中最慢的一步，
+ *   因此每 ACQ_SGP30_EVERY_N_CYCLES 个周期才测量一次。其余周期的CO2/TVOC字段保持上一次的值，
+ *   结果掩码中的 ACQ_SENSOR_SGP30 位为0 (见 Acquisition_GetScheduledMask)。
+ *   每次测量在 iaq_init 之后恢复上一次的基线 (g_Sgp30Baseline)，结束时读回新的基线，
+ *   使补偿算法跨周期连续运行。基线在Flash中的副本用于冷启动后恢复：
+ *   没有可信基线时，算法累计运行 ACQ_SGP30_BASELINE_MIN_RUN_S 之后才开始保存，
+ *   之后每累计运行 ACQ_SGP30_BASELINE_SAVE_S 保存一次。休眠期间算法不运行，不计入运行时间。
+ *   数据手册的12小时指连续运行；节点每次测量只运行约15秒，因此门槛取1小时运行时间 (约240次测量)，
+ *   按默认的30秒最短采样间隔约20小时可以达到。
+ */
+#define ACQ_SGP30_EVERY_N_CYCLES        10                  // 每10个采集周期测量一次 (周期长度由 SamplingPolicy 决定)
+#define ACQ_SGP30_BASELINE_MIN_RUN_S    3600UL              // 首次保存前需要的算法累计运行时间
+#define ACQ_SGP30_BASELINE_SAVE_S       900UL               // 之后的保存间隔 (算法累计运行时间)
+
+/**
+ * @brief  传感器上电后调用：开始一个采集周期，发出各传感器的第一步命令。
+ * @note   调用前 DEV_PWR_CTRL 须已打开，I2C1/2/3、LPUART1、ADC 须已初始化 (ADC已校准)。
+ * @param  out: 采集结果写入的结构体。某个传感器读取失败时，对应字段保持原值。
+ */
+void Acquisition_Start(InternalSensorProperties_t *out);
+
+/**
+ * @brief  执行已到期的采集步骤，不阻塞。
+ * @note   可以在其他初始化步骤 (Flash、LoRa) 之间调用，使它们与传感器转换重叠。
+ * @retval true  - 本周期的所有传感器都已完成 (成功或失败)。
+ * @retval false - 还有传感器在转换中。
+ */
+bool Acquisition_Poll(void);
+
+/**
+ * @brief  等待本周期采集完成，两个事件之间CPU进入睡眠模式 (由SysTick或LPUART1/DMA中断唤醒)。
+ * @retval 本周期成功读取的传感器掩码 (ACQ_SENSOR_xxx)。
+ */
+uint8_t Acquisition_Wait(void);
+
+/**
+ * @brief  冷启动后从Flash恢复SGP30基线。
+ * @note   须在 W25QXX_Init 之后、Acquisition_Start 之前调用；内存中已有基线时 (从STOP2唤醒) 不读Flash。
+ */
+void Acquisition_RestoreSgp30Baseline(void);
+
+/**
+ * @brief  获取本采集周期计划读取的传感器掩码 (ACQ_SENSOR_xxx)。
+ * @note   不测量SGP30的周期中不含 ACQ_SENSOR_SGP30；结果掩码与之相等表示计划读取的传感器全部成功。
+ */
+uint8_t Acquisition_GetScheduledMask(void);
+
+/**
+ * @brief  获取本采集周期的开始时刻 (HAL_GetTick)，用于计算样本的时延。
+ */
+uint32_t Acquisition_GetStartTick(void);
+
+#endif // __ACQUISITION_H
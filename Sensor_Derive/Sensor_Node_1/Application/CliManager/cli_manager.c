@@ -1,6 +1,8 @@
 #include "cli_manager.h"
 #include "usart.h"
 #include "config_manager.h"
+#include "sampling_policy.h"
+#include "lora_protocol.h" // SAMPLING_LIMIT_MIN_S / SAMPLING_LIMIT_MAX_S
 #include "main.h" // For HAL_NVIC_SystemReset
 
 #include <string.h>
@@ -59,6 +61,22 @@ void CLI_Process(void)
         g_DeviceConfig.device_id = new_id;
         printf("OK: Set Device ID to 0x%X.\r\n", g_DeviceConfig.device_id);
     }
+    else if (strncmp(cmd_buffer, "AT+SAMPLE=", 10) == 0)
+    {
+        // 格式: AT+SAMPLE=<最短间隔>,<最长间隔>，单位秒
+        char *end;
+        uint32_t min_s = strtoul(cmd_buffer + 10, &end, 10);
+        uint32_t max_s = (*end == ',') ? strtoul(end + 1, NULL, 10) : 0;
+        if (min_s <= UINT16_MAX && max_s <= UINT16_MAX && SamplingPolicy_SetBounds((uint16_t)min_s, (uint16_t)max_s))
+        {
+            printf("OK: Set sampling interval to %u-%u s.\r\n", g_DeviceConfig.sample_min_s, g_DeviceConfig.sample_max_s);
+        }
+        else
+        {
+            printf("ERROR: Invalid sampling interval. Use AT+SAMPLE=<min>,<max> with %u <= min <= max <= %u.\r\n",
+                   SAMPLING_LIMIT_MIN_S, SAMPLING_LIMIT_MAX_S);
+        }
+    }
     else if (strncmp(cmd_buffer, "AT+SAVE", 7) == 0)
     {
         if (Config_Save())
@@ -78,7 +96,8 @@ void CLI_Process(void)
     }
     else if (strncmp(cmd_buffer, "AT+CONFIG?", 10) == 0)
     {
-        printf("Current Config -> ID: 0x%X, Freq: %d MHz\r\n", g_DeviceConfig.device_id, g_DeviceConfig.lora_frequency);
+        printf("Current Config -> ID: 0x%X, Freq: %d MHz, Sampling: %u-%u s\r\n", g_DeviceConfig.device_id, g_DeviceConfig.lora_frequency,
+               g_DeviceConfig.sample_min_s, g_DeviceConfig.sample_max_s);
     }
     else
     {
@@ -2,14 +2,19 @@
 #include "w25qxx.h"
 #include "crc.h"
 #include <string.h> // 用于 memcpy 和 memcmp
+#include <stddef.h> // 用于 offsetof
 
 // 全局配置实例在此文件中定义
 DeviceConfig_t g_DeviceConfig;
+Sgp30Baseline_t g_Sgp30Baseline;
+
+#define SGP30_BASELINE_RECORD_COUNT (W25Q32_SECTOR_SIZE / sizeof(Sgp30Baseline_t))
 
 // 外部的HAL CRC句柄，在 crc.c 中定义
 extern CRC_HandleTypeDef hcrc;
 
 // --- 私有函数 ---
+static uint16_t Config_CalculateBufferCRC(const uint8_t* data, size_t len);
 
 /**
  * @brief  为给定的配置结构体计算 CRC16-Modbus 校验和。
@@ -18,19 +23,86 @@ extern CRC_HandleTypeDef hcrc;
  */
 static uint16_t Config_CalculateCRC(DeviceConfig_t* config)
 {
-    // 需要进行校验和计算的数据是结构体的前10个字节。
-    // (magic_number, lora_frequency, device_id)
-    const size_t data_len = sizeof(uint32_t) * 2 + sizeof(uint16_t);
-    uint8_t *p_data = (uint8_t*)config;
+    // 需要进行校验和计算的数据是 crc16 之前的14个字节。
+    // (magic_number, lora_frequency, device_id, sample_min_s, sample_max_s)
+    return Config_CalculateBufferCRC((const uint8_t*)config, offsetof(DeviceConfig_t, crc16));
+}
+
+/**
+ * @brief  检查读出的数据是否是旧版本的12字节配置 (没有采样间隔字段)。
+ * @note   旧版本的CRC位于第10个字节 (即现在 sample_min_s 的位置)，只覆盖前10个字节，
+ *         其后是Flash的擦除状态 0xFF。
+ */
+static bool Config_IsLegacyLayout(const DeviceConfig_t* config)
+{
+    return config->sample_max_s == 0xFFFF && config->crc16 == 0xFFFF &&
+           config->sample_min_s == Config_CalculateBufferCRC((const uint8_t*)config, offsetof(DeviceConfig_t, sample_min_s));
+}
+
+/**
+ * @brief  为给定的SGP30基线记录计算 CRC16-Modbus 校验和 (crc16 字段之前的14个字节)。
+ */
+static uint16_t Config_CalculateBaselineCRC(const Sgp30Baseline_t* baseline)
+{
+    return Config_CalculateBufferCRC((const uint8_t*)baseline, offsetof(Sgp30Baseline_t, crc16));
+}
+
+/**
+ * @brief  检查一条SGP30基线记录是否有效。
+ */
+static bool Config_IsBaselineValid(const Sgp30Baseline_t* baseline)
+{
+    return baseline->magic_number == SGP30_BASELINE_MAGIC_NUMBER &&
+           baseline->crc16 == Config_CalculateBaselineCRC(baseline);
+}
+
+/**
+ * @brief  查找基线扇区中第一个空闲 (已擦除) 的记录槽，并返回其前面最后一条有效记录。
+ * @param  last_valid: [out] 最后一条有效记录，可为NULL。没有有效记录时 magic_number 为0。
+ * @retval 第一个空闲槽的序号；扇区已写满时返回 SGP30_BASELINE_RECORD_COUNT。
+ */
+static uint32_t Config_ScanBaselineSector(Sgp30Baseline_t* last_valid)
+{
+    Sgp30Baseline_t record;
+    uint32_t slot;
+
+    if (last_valid != NULL)
+    {
+        memset(last_valid, 0, sizeof(Sgp30Baseline_t));
+    }
+
+    for (slot = 0; slot < SGP30_BASELINE_RECORD_COUNT; slot++)
+    {
+        W25QXX_Read_Data((uint8_t*)&record, SGP30_BASELINE_STORAGE_ADDRESS + slot * sizeof(Sgp30Baseline_t), sizeof(record));
+        if (record.magic_number == 0xFFFFFFFF)
+        {
+            break; // 已擦除：记录按顺序追加，后面的槽都是空的
+        }
+        if (last_valid != NULL && Config_IsBaselineValid(&record))
+        {
+            memcpy(last_valid, &record, sizeof(Sgp30Baseline_t));
+        }
+    }
+    return slot;
+}
+
+/**
+ * @brief  计算一段数据的 CRC16-Modbus 校验和。
+ * @param  data: 数据指针。
+ * @param  len:  数据长度 (字节)。
+ * @retval 计算出的CRC16值。
+ */
+static uint16_t Config_CalculateBufferCRC(const uint8_t* data, size_t len)
+{
 
     // 将CRC计算单元的初值复位 (对于CRC16-Modbus，初值为0xFFFF)
     __HAL_CRC_DR_RESET(&hcrc);
 
     // 将数据逐字节喂给CRC外设进行计算
-    for (size_t i = 0; i < data_len; i++)
+    for (size_t i = 0; i < len; i++)
     {
         // 直接向数据寄存器(DR)写入8位数据
-        *(__IO uint8_t *)(&(hcrc.Instance->DR)) = p_data[i];
+        *(__IO uint8_t *)(&(hcrc.Instance->DR)) = data[i];
     }
     
     // 硬件会自动执行在CubeMX中配置的输出反转。
@@ -46,9 +118,17 @@ void Config_SetDefault(void)
     g_DeviceConfig.magic_number = CONFIG_MAGIC_NUMBER;
     g_DeviceConfig.lora_frequency = DEFAULT_LORA_FREQUENCY;
     g_DeviceConfig.device_id = DEFAULT_DEVICE_ID;
+    g_DeviceConfig.sample_min_s = DEFAULT_SAMPLE_MIN_S;
+    g_DeviceConfig.sample_max_s = DEFAULT_SAMPLE_MAX_S;
     g_DeviceConfig.crc16 = 0; // CRC值会在调用 Config_Save() 保存前自动计算
 }
 
+bool Config_IsValid(void)
+{
+    return g_DeviceConfig.magic_number == CONFIG_MAGIC_NUMBER &&
+           g_DeviceConfig.crc16 == Config_CalculateCRC(&g_DeviceConfig);
+}
+
 bool Config_Load(void)
 {
     DeviceConfig_t tempConfig;
@@ -64,7 +144,15 @@ bool Config_Load(void)
         return false;
     }
 
-    // 3. 校验CRC，确保数据完整性
+    // 3. 旧版本的配置：保留频率和设备ID，采样间隔取默认值 (下次 Config_Save 时以新格式写回)
+    if (Config_IsLegacyLayout(&tempConfig))
+    {
+        tempConfig.sample_min_s = DEFAULT_SAMPLE_MIN_S;
+        tempConfig.sample_max_s = DEFAULT_SAMPLE_MAX_S;
+        tempConfig.crc16 = Config_CalculateCRC(&tempConfig);
+    }
+
+    // 4. 校验CRC，确保数据完整性
     uint16_t calculated_crc = Config_CalculateCRC(&tempConfig);
     if (calculated_crc != tempConfig.crc16)
     {
@@ -73,7 +161,7 @@ bool Config_Load(void)
         return false;
     }
 
-    // 4. 配置有效，将其从临时缓冲复制到全局结构体中
+    // 5. 配置有效，将其从临时缓冲复制到全局结构体中
     memcpy(&g_DeviceConfig, &tempConfig, sizeof(DeviceConfig_t));
     return true;
 }
@@ -107,4 +195,43 @@ bool Config_Save(void)
     {
         return false; // 保存失败 (读回的数据与源数据不一致)
     }
-} 
\ No newline at end of file
+} 
+
+/**
+ * @brief  从基线扇区加载最后一条有效的SGP30基线记录。
+ * @note   基线记录依次追加在扇区中 (磨损均衡)，最后一条有效记录即最近一次保存的基线。
+ */
+bool Config_LoadSgp30Baseline(void)
+{
+    // 扫描基线扇区，取最后一条有效记录 (没有时 last_valid 已被清零)
+    (void)Config_ScanBaselineSector(&g_Sgp30Baseline);
+    return g_Sgp30Baseline.magic_number == SGP30_BASELINE_MAGIC_NUMBER;
+}
+
+/**
+ * @brief  把 g_Sgp30Baseline 追加写入基线扇区的第一个空闲槽，写满后擦除扇区从头开始。
+ * @note   每条记录只写一次，一个扇区可保存 SGP30_BASELINE_RECORD_COUNT 次才需要擦除。
+ */
+bool Config_SaveSgp30Baseline(void)
+{
+    // 1. 设置"魔数"并计算CRC
+    g_Sgp30Baseline.magic_number = SGP30_BASELINE_MAGIC_NUMBER;
+    g_Sgp30Baseline.reserved = 0;
+    g_Sgp30Baseline.crc16 = Config_CalculateBaselineCRC(&g_Sgp30Baseline);
+
+    // 2. 找到第一个空闲槽；扇区写满时擦除后从头开始
+    uint32_t slot = Config_ScanBaselineSector(NULL);
+    if (slot >= SGP30_BASELINE_RECORD_COUNT)
+    {
+        W25QXX_Erase_Sector(SGP30_BASELINE_STORAGE_ADDRESS / W25Q32_SECTOR_SIZE);
+        slot = 0;
+    }
+
+    // 3. 写入并读回校验
+    uint32_t addr = SGP30_BASELINE_STORAGE_ADDRESS + slot * sizeof(Sgp30Baseline_t);
+    W25QXX_Write_Data((uint8_t*)&g_Sgp30Baseline, addr, sizeof(Sgp30Baseline_t));
+
+    Sgp30Baseline_t verify;
+    W25QXX_Read_Data((uint8_t*)&verify, addr, sizeof(Sgp30Baseline_t));
+    return memcmp(&g_Sgp30Baseline, &verify, sizeof(Sgp30Baseline_t)) == 0;
+}
@@ -14,21 +14,50 @@
 // 默认配置值
 #define DEFAULT_LORA_FREQUENCY 433U          								 // 默认LoRa频率：433 MHz
 #define DEFAULT_DEVICE_ID      DEVICE_TYPE_SENSOR_Internal   // 默认设备ID
+#define DEFAULT_SAMPLE_MIN_S   30U                           // 默认最短采样间隔：30秒 (与原固定周期相同)
+#define DEFAULT_SAMPLE_MAX_S   600U                          // 默认最长采样间隔：10分钟
 
 /**
  * @brief  设备配置数据结构体。
- * @note   此结构体总大小为12字节。
+ * @note   此结构体总大小为16字节。旧版本的12字节配置 (没有采样间隔字段) 在加载时会被识别，
+ *         采样间隔取默认值。
  */
 typedef struct {
     uint32_t magic_number;    // 4字节：用于验证结构体有效性的“魔数”
     uint32_t lora_frequency;  // 4字节：LoRa频率，单位MHz (例如: 433)
     uint16_t device_id;       // 2字节：设备ID (范围 0-65535)
-    uint16_t crc16;           // 2字节：针对前10个字节计算的 CRC16-Modbus 校验和
+    uint16_t sample_min_s;    // 2字节：自适应采样的最短间隔 (秒)，见 sampling_policy.h
+    uint16_t sample_max_s;    // 2字节：自适应采样的最长间隔 (秒)
+    uint16_t crc16;           // 2字节：针对前14个字节计算的 CRC16-Modbus 校验和
 } DeviceConfig_t;
 
 // 全局变量，用于在整个应用程序中保存和访问当前的设备配置
 extern DeviceConfig_t g_DeviceConfig;
 
+// SGP30 基线存放在配置之后的独立扇区，频繁更新时不会擦除设备配置。
+// 扇区内按记录追加写入，写满后才擦除一次 (4096 / 16 = 256 条记录)，以减少擦写次数。
+#define SGP30_BASELINE_STORAGE_ADDRESS 0x001000
+#define SGP30_BASELINE_MAGIC_NUMBER    0x53475033 // "SGP3"
+
+// 扇区2起的其余空间是样本日志 (见 sample_log.h)。
+
+/**
+ * @brief  SGP30 空气质量算法的基线。
+ * @note   此结构体总大小为16字节，整除Flash页大小 (记录不会跨页)。
+ */
+typedef struct {
+    uint32_t magic_number;  // 4字节：SGP30_BASELINE_MAGIC_NUMBER，Flash擦除后为0xFFFFFFFF
+    uint16_t co2eq_base;    // 2字节：CO2eq 基线 (sgp30_get_baseline 的原始值)
+    uint16_t tvoc_base;     // 2字节：TVOC 基线
+    uint32_t run_seconds;   // 4字节：算法累计运行时间 (秒)，用于判断基线是否可信
+    uint16_t reserved;      // 2字节：保留，为0
+    uint16_t crc16;         // 2字节：针对前14个字节计算的 CRC16-Modbus 校验和
+} Sgp30Baseline_t;
+
+// SGP30 基线的内存副本。STOP2 期间SRAM保持，仅在冷启动后需要从Flash加载。
+// magic_number != SGP30_BASELINE_MAGIC_NUMBER 表示没有可用的基线。
+extern Sgp30Baseline_t g_Sgp30Baseline;
+
 /**
  * @brief  从W25Q32 Flash中加载配置到全局变量 g_DeviceConfig。
  * @retval true  - 如果成功加载了有效的配置。
@@ -50,4 +79,27 @@ bool Config_Save(void);
  */
 void Config_SetDefault(void);
 
+/**
+ * @brief  检查内存中的 g_DeviceConfig 是否是一份经过校验的配置 (魔数和CRC均正确)。
+ * @note   从STOP2唤醒时SRAM保持，校验通过即可沿用，不必重新从Flash加载。
+ *         Config_SetDefault() 填充的默认值尚未计算CRC，不算作有效配置。
+ * @retval true  - 配置有效。
+ * @retval false - 其他情况。
+ */
+bool Config_IsValid(void);
+
+/**
+ * @brief  从Flash加载最近一次保存的SGP30基线到 g_Sgp30Baseline。
+ * @retval true  - 加载成功。
+ * @retval false - Flash中没有有效的基线，g_Sgp30Baseline 被清零 (无基线)。
+ */
+bool Config_LoadSgp30Baseline(void);
+
+/**
+ * @brief  将 g_Sgp30Baseline 追加保存到Flash的基线扇区 (扇区写满时先擦除)。
+ * @retval true  - 保存并校验成功。
+ * @retval false - 其他情况。
+ */
+bool Config_SaveSgp30Baseline(void);
+
 #endif // __CONFIG_MANAGER_H 
\ No newline at end of file
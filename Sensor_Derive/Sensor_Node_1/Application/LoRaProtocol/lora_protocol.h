@@ -23,6 +23,7 @@
 // #define MSG_TYPE_CMD_GET_STATUS 0x11 // Host -> Slave: 获取状态命令
 #define MSG_TYPE_REPORT_SENSOR 0x20 // Slave -> Host: 上报传感器数据
 #define MSG_TYPE_REPORT_STATUS 0x21 // Slave -> Host: 上报设备状态/回复状态
+#define MSG_TYPE_REPORT_LOG 0x22    // Slave -> Host: 补发节点Flash中记录的历史样本
 #define MSG_TYPE_HEARTBEAT 0xA0     // Slave -> Host: 心跳包
 // 如果未来需要 ACK/NACK
 // #define MSG_TYPE_ACK_SUCCESS      0xAC
@@ -41,6 +42,21 @@
 #define CONTROLLER_DEVICE_TYPE_SPEED_PUMP 0x04   // 水泵工作速度
 #define CONTROLLER_DEVICE_TYPE_STATUS_LIGHT 0x05 // 补光灯状态
 
+// 传感器节点的配置项 (MSG_TYPE_CMD_SET_CONFIG 发往传感器节点时的载荷)
+// 载荷由若干个 [配置项(1) + 值(uint16 小端)] 依次拼接而成。
+// 传感器节点只在每次上报后的短暂接收窗口内收听，网关在收到该节点的上报后立即下发。
+#define SENSOR_CONFIG_SAMPLE_MIN_S 0x01 // 最短采样间隔 (秒)
+#define SENSOR_CONFIG_SAMPLE_MAX_S 0x02 // 最长采样间隔 (秒)
+#define SENSOR_CONFIG_REQUEST_REPORT 0x03 // 请节点在下一个周期发送完整数据 (值无意义，填0)
+#define SENSOR_CONFIG_BACKFILL_FROM_MIN 0x04 // 请节点补发历史样本：时间段的起点，距现在的分钟数
+#define SENSOR_CONFIG_BACKFILL_TO_MIN 0x05 // 时间段的终点，距现在的分钟数 (省略时为0，即到现在)
+#define SENSOR_CONFIG_ITEM_SIZE    3    // 每个配置项占用的字节数
+
+// SENSOR_CONFIG_SAMPLE_MIN_S / MAX_S 的取值范围，单位：秒 (节点RTC唤醒定时器以1Hz计数，16位计数器最长约18小时)
+// 网关在下发前、节点在应用前都按此范围校验。
+#define SAMPLING_LIMIT_MIN_S       10U
+#define SAMPLING_LIMIT_MAX_S       3600U
+
 // --- 解析后的消息结构体 (应用层使用) ---
 // 注意：此结构体不包含原始 CRC 校验字节
 typedef struct
@@ -94,6 +110,42 @@ typedef struct
 
 } __attribute__((packed)) sensor_data_payload_t;
 
+// --- 采样追踪尾部 ---
+// 追加在 MSG_TYPE_REPORT_SENSOR 的载荷之后，网关据此测量样本从采集到云端确认的端到端时延
+// (与网关 lora_protocol.h 中的定义一致；网关也接受不带尾部的帧)。
+typedef struct
+{
+    uint16_t trace_id;     // 采样序号 (每次采集加1，跳过0)
+    uint32_t acq_age_ms;   // 从开始采集到交给射频发送所经过的时长 (本机 HAL_GetTick 时钟)
+} __attribute__((packed)) lora_trace_trailer_t;
+
+// 带追踪尾部的传感器载荷，作为一个整体交给 generate_lora_frame
+typedef struct
+{
+    sensor_data_payload_t data;
+    lora_trace_trailer_t  trace;
+} __attribute__((packed)) sensor_traced_payload_t;
+
+// --- 传感器节点心跳的载荷 (MSG_TYPE_HEARTBEAT) ---
+// 按例外上报的节点在读数没有变化时不发送数据，只定期发送心跳，表示"读数与上一次完整上报相同"。
+// 完整上报 (MSG_TYPE_REPORT_SENSOR) 的帧头 seq_num 为其序号，心跳带上最近一次完整上报的序号，
+// 网关没有收到这次上报时 (丢包或网关重启) 下发 SENSOR_CONFIG_REQUEST_REPORT 请节点补发。
+typedef struct
+{
+    uint8_t report_seq;    // 最近一次完整上报的序号
+} __attribute__((packed)) sensor_heartbeat_payload_t;
+
+// --- 历史样本补发 (MSG_TYPE_REPORT_LOG) ---
+// 节点把每个样本记录在Flash中，收到 SENSOR_CONFIG_BACKFILL_xxx 后在之后的周期里补发该时间段的样本，
+// 每帧的载荷由若干条记录依次拼接而成。节点与网关没有共同的时钟，记录中只带样本的"年龄"，
+// 样本的采集时刻 = 接收时刻 - age_s。
+// 补发只由云端命令 (requestBackfill) 触发；网关目前只记录收到的样本，尚不上传到云端。
+typedef struct
+{
+    uint32_t age_s;                 // 样本采集至今的时长 (秒，节点时钟)
+    sensor_data_payload_t data;     // 样本数据，与 MSG_TYPE_REPORT_SENSOR 的载荷相同
+} __attribute__((packed)) sensor_log_record_t;
+
 // control_data_payload_t 与 device_properties.h 中的 ControlNodeProperties_t 结构几乎一致
 // 我们可以直接使用 ControlNodeProperties_t，并确保其打包
 typedef struct {
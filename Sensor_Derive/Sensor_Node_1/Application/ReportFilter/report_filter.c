@@ -0,0 +1,162 @@
+#include "report_filter.h"
+#include "lora_protocol.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @brief  参与比较的一个字段。
+ * @note   死区 = max(abs, rel * |上一次发送的值|)，变化量超过死区时需要发送。
+ */
+typedef struct {
+    uint16_t offset;    // 字段在 InternalSensorProperties_t 中的偏移
+    uint8_t  type;      // 字段类型 (FIELD_xxx)
+    float    abs;       // 绝对死区
+    float    rel;       // 相对死区 (比例)，0 表示不使用
+} ReportField_t;
+
+enum {
+    FIELD_DOUBLE,
+    FIELD_FLOAT,
+    FIELD_U8,
+    FIELD_U16,
+    FIELD_U32
+};
+
+#define FIELD(member, type, abs, rel) {offsetof(InternalSensorProperties_t, member), type, abs, rel}
+
+// 各字段的死区：大致为传感器的精度或一个有意义的变化量
+static const ReportField_t s_fields[] = {
+    FIELD(greenhouseTemperature, FIELD_DOUBLE, 0.3f,  0.0f),    // ℃
+    FIELD(greenhouseHumidity,    FIELD_DOUBLE, 2.0f,  0.0f),    // %RH
+    FIELD(soilMoisture,          FIELD_FLOAT,  0.5f,  0.0f),    // %
+    FIELD(soilTemperature,       FIELD_FLOAT,  0.3f,  0.0f),    // ℃
+    FIELD(soilEc,                FIELD_U16,    20.0f, 0.0f),    // μS/cm
+    FIELD(soilPh,                FIELD_FLOAT,  0.1f,  0.0f),
+    FIELD(soilNitrogen,          FIELD_U16,    5.0f,  0.0f),    // mg/kg
+    FIELD(soilPhosphorus,        FIELD_U16,    5.0f,  0.0f),
+    FIELD(soilPotassium,         FIELD_U16,    5.0f,  0.0f),
+    FIELD(soilSalinity,          FIELD_U16,    20.0f, 0.0f),
+    FIELD(soilTds,               FIELD_U16,    20.0f, 0.0f),
+    FIELD(soilFertility,         FIELD_U16,    20.0f, 0.0f),
+    FIELD(lightIntensity,        FIELD_U32,    20.0f, 0.15f),   // lux，夜间按绝对值，白天按15%
+    FIELD(vocConcentration,      FIELD_U16,    50.0f, 0.0f),    // ppb
+    FIELD(co2Concentration,      FIELD_U16,    50.0f, 0.0f),    // ppm
+    FIELD(common.batteryLevel,   FIELD_U8,     5.0f,  0.0f),    // %
+};
+
+#define FIELD_COUNT (sizeof(s_fields) / sizeof(s_fields[0]))
+
+// 跨采集周期保存的数据 (STOP2 期间SRAM保持)
+static InternalSensorProperties_t s_last_sent;  // 最近一次成功发送的完整数据
+static bool     s_has_last_sent;                // 冷启动后是否已经成功发送过完整数据
+static bool     s_report_requested;             // 网关请求补发完整数据
+static uint32_t s_silence_s;                    // 距离上一次成功发送的时长 (秒)
+static uint8_t  s_report_seq;                   // 最近一次完整上报的序号
+
+// --- 私有函数 ---
+
+static float field_value(const InternalSensorProperties_t *data, const ReportField_t *field)
+{
+    const uint8_t *p = (const uint8_t *)data + field->offset;
+    switch (field->type)
+    {
+    case FIELD_DOUBLE: return (float)*(const double *)p;
+    case FIELD_FLOAT:  return *(const float *)p;
+    case FIELD_U8:     return (float)*p;
+    case FIELD_U16:    return (float)*(const uint16_t *)p;
+    default:           return (float)*(const uint32_t *)p;
+    }
+}
+
+/**
+ * @brief  查找第一个变化超过死区的字段。
+ * @retval 字段在 s_fields 中的下标，没有时返回 -1。
+ */
+static int find_changed_field(const InternalSensorProperties_t *data)
+{
+    for (uint8_t i = 0; i < FIELD_COUNT; i++)
+    {
+        float last = field_value(&s_last_sent, &s_fields[i]);
+        float deadband = fmaxf(s_fields[i].abs, s_fields[i].rel * fabsf(last));
+        if (fabsf(field_value(data, &s_fields[i]) - last) >= deadband)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// --- 公有函数 ---
+
+/**
+ * @brief 决定本周期发送什么
+ */
+ReportDecision_t ReportFilter_Check(const InternalSensorProperties_t *data, uint16_t slept_s)
+{
+    s_silence_s += slept_s;
+
+    int changed = s_has_last_sent ? find_changed_field(data) : -1;
+    if (!s_has_last_sent || s_report_requested || changed >= 0)
+    {
+        if (changed >= 0)
+        {
+            printf("Report: field #%d changed\r\n", changed);
+        }
+        return REPORT_FULL;
+    }
+
+    if (s_silence_s >= REPORT_HEARTBEAT_S)
+    {
+        return REPORT_HEARTBEAT;
+    }
+
+    printf("Report: readings unchanged, silent for %lu s\r\n", (unsigned long)s_silence_s);
+    return REPORT_SKIP;
+}
+
+/**
+ * @brief 发送成功后调用
+ */
+void ReportFilter_OnSent(const InternalSensorProperties_t *data)
+{
+    if (data != NULL)
+    {
+        s_last_sent = *data;
+        s_has_last_sent = true;
+        s_report_requested = false;
+        s_report_seq++;
+    }
+    s_silence_s = 0;
+}
+
+/**
+ * @brief 获取最近一次完整上报的序号
+ */
+uint8_t ReportFilter_GetReportSeq(void)
+{
+    return s_report_seq;
+}
+
+/**
+ * @brief 获取本周期完整上报要使用的序号
+ */
+uint8_t ReportFilter_GetNextReportSeq(void)
+{
+    return (uint8_t)(s_report_seq + 1U);
+}
+
+/**
+ * @brief 处理与上报有关的下行配置项
+ */
+void ReportFilter_ApplyDownlink(const uint8_t *payload, uint8_t len)
+{
+    for (uint8_t pos = 0; pos + SENSOR_CONFIG_ITEM_SIZE <= len; pos += SENSOR_CONFIG_ITEM_SIZE)
+    {
+        if (payload[pos] == SENSOR_CONFIG_REQUEST_REPORT)
+        {
+            printf("Downlink: full report requested\r\n");
+            s_report_requested = true;
+        }
+    }
+}
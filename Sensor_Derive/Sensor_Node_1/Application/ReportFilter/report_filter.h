@@ -0,0 +1,58 @@
+#ifndef __REPORT_FILTER_H
+#define __REPORT_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "device_properties.h"
+
+/*
+ * 按例外上报 (report-by-exception)：
+ *   射频发送是节点耗电最多的操作。每个周期把新读数与最近一次成功发送的读数逐字段比较，
+ *   只有某个字段的变化超过其死区 (见 report_filter.c 中的字段表) 时才发送完整的传感器数据；
+ *   读数没有变化时不发送，距离上一次发送超过 REPORT_HEARTBEAT_S 时发送一个心跳
+ *   (MSG_TYPE_HEARTBEAT)，表示"读数与上一次完整上报相同"。
+ *   心跳中带有最近一次完整上报的序号 (完整上报的帧头 seq_num)，网关发现自己没有这次上报时
+ *   (丢包或网关重启)，通过下行 SENSOR_CONFIG_REQUEST_REPORT 请节点补发。
+ *   上一次发送的读数和计时保存在SRAM中 (STOP2 期间保持)，冷启动后的第一个周期总是完整上报。
+ */
+
+#define REPORT_HEARTBEAT_S  900U    // 最长静默时间：15分钟
+
+typedef enum {
+    REPORT_SKIP,        // 读数没有变化，本周期不发送
+    REPORT_FULL,        // 发送完整的传感器数据 (MSG_TYPE_REPORT_SENSOR)
+    REPORT_HEARTBEAT    // 发送心跳 (MSG_TYPE_HEARTBEAT)
+} ReportDecision_t;
+
+/**
+ * @brief  决定本周期发送什么。
+ * @param  data:    本周期的采集结果。
+ * @param  slept_s: 上一个周期结束后休眠的时长 (秒)，用于累计静默时间。
+ * @retval 本周期的发送方式。完整上报的帧头序号取 ReportFilter_GetNextReportSeq()。
+ */
+ReportDecision_t ReportFilter_Check(const InternalSensorProperties_t *data, uint16_t slept_s);
+
+/**
+ * @brief  本周期的数据或心跳发送成功后调用，重新开始计算静默时间。
+ * @note   完整上报的序号在这里才加1：发送失败时序号不变，网关不会把它当作丢失的上报。
+ * @param  data: 已发送的完整数据，作为之后比较的基准；发送的是心跳时传 NULL。
+ */
+void ReportFilter_OnSent(const InternalSensorProperties_t *data);
+
+/**
+ * @brief  获取最近一次完整上报的序号 (完整上报的帧头 seq_num，心跳的载荷)。
+ */
+uint8_t ReportFilter_GetReportSeq(void);
+
+/**
+ * @brief  获取本周期完整上报要使用的序号 (最近一次完整上报的序号加1)。
+ */
+uint8_t ReportFilter_GetNextReportSeq(void);
+
+/**
+ * @brief  处理网关下发的传感器配置中与上报有关的配置项 (SENSOR_CONFIG_REQUEST_REPORT)。
+ * @note   其他配置项由各自的模块处理，这里忽略。
+ */
+void ReportFilter_ApplyDownlink(const uint8_t *payload, uint8_t len);
+
+#endif // __REPORT_FILTER_H
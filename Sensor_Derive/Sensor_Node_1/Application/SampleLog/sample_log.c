@@ -0,0 +1,290 @@
+#include "sample_log.h"
+#include "rtc.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define RECORDS_PER_SECTOR  (W25Q32_SECTOR_SIZE / sizeof(SampleRecord_t))
+#define TOTAL_SLOTS         (SAMPLE_LOG_SECTOR_COUNT * RECORDS_PER_SECTOR)
+#define EMPTY_SEQ           0xFFFFFFFFU
+
+// 跨采集周期保存的数据 (STOP2 期间SRAM保持)
+static bool     s_ready;            // SampleLog_Init() 已执行
+static uint32_t s_head;             // 下一条记录写入的槽
+static uint32_t s_next_seq;         // 下一条记录的序号
+static uint32_t s_time_base;        // RTC为0时 (冷启动时) 的节点时间
+
+// 补发状态
+static bool     s_bf_active;        // 有尚未补发完的请求
+static uint32_t s_bf_slot;          // 下一个待检查的槽
+static uint32_t s_bf_next_slot;     // 上一次读取之后的槽，确认发出后成为 s_bf_slot
+static uint32_t s_bf_from_ts;       // 请求的时间段 (节点时间)
+static uint32_t s_bf_to_ts;
+
+// --- 私有函数 ---
+
+static uint32_t slot_address(uint32_t slot)
+{
+    return (SAMPLE_LOG_FIRST_SECTOR + slot / RECORDS_PER_SECTOR) * W25Q32_SECTOR_SIZE +
+           (slot % RECORDS_PER_SECTOR) * sizeof(SampleRecord_t);
+}
+
+static uint16_t record_crc(const SampleRecord_t *record)
+{
+    return crc16_modbus((const uint8_t *)record, offsetof(SampleRecord_t, crc16));
+}
+
+/**
+ * @brief  读取一个槽中的记录。
+ * @retval 记录是否有效 (非空且CRC正确)。
+ */
+static bool read_record(uint32_t slot, SampleRecord_t *record)
+{
+    W25QXX_Read_Data((uint8_t *)record, slot_address(slot), sizeof(SampleRecord_t));
+    return record->seq != EMPTY_SEQ && record->crc16 == record_crc(record);
+}
+
+/**
+ * @brief  RTC计时的秒数 (MX_RTC_Init 在冷启动时把RTC设为 2000-01-01 00:00:00)。
+ */
+static uint32_t rtc_seconds(void)
+{
+    static const uint16_t days_before_month[12] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+    RTC_TimeTypeDef time;
+    RTC_DateTypeDef date;
+
+    // 必须先读时间再读日期，读日期后影子寄存器才会解锁
+    HAL_RTC_GetTime(&hrtc, &time, RTC_FORMAT_BIN);
+    HAL_RTC_GetDate(&hrtc, &date, RTC_FORMAT_BIN);
+
+    // 2000-2099 年间每4年一个闰年
+    uint32_t days = date.Year * 365U + (date.Year + 3U) / 4U + days_before_month[date.Month - 1U] + date.Date - 1U;
+    if (date.Year % 4U == 0 && date.Month > 2U)
+    {
+        days++;
+    }
+    return ((days * 24U + time.Hours) * 60U + time.Minutes) * 60U + time.Seconds;
+}
+
+/**
+ * @brief  定位时间段的起点，开始补发。
+ * @note   从最旧的扇区到最后写入的扇区，各扇区第一条记录的时间戳递增 (尚未写过的扇区为空，排在最前)。
+ *         二分查找第一条记录不晚于 from_ts 的最后一个扇区，补发从该扇区开始，
+ *         早于 from_ts 的记录在读取时跳过。
+ */
+static void start_backfill(uint32_t from_ts, uint32_t to_ts)
+{
+    SampleRecord_t record;
+    uint32_t last_sector = ((s_head + TOTAL_SLOTS - 1U) % TOTAL_SLOTS) / RECORDS_PER_SECTOR;
+    uint32_t oldest_sector = (last_sector + 1U) % SAMPLE_LOG_SECTOR_COUNT;
+    uint32_t lo = 0;
+    uint32_t hi = SAMPLE_LOG_SECTOR_COUNT - 1U;
+
+    while (lo < hi)
+    {
+        uint32_t mid = (lo + hi + 1U) / 2U;
+        uint32_t sector = (oldest_sector + mid) % SAMPLE_LOG_SECTOR_COUNT;
+        if (!read_record(sector * RECORDS_PER_SECTOR, &record) || record.timestamp <= from_ts)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid - 1U;
+        }
+    }
+
+    s_bf_slot = ((oldest_sector + lo) % SAMPLE_LOG_SECTOR_COUNT) * RECORDS_PER_SECTOR;
+    s_bf_from_ts = from_ts;
+    s_bf_to_ts = to_ts;
+    s_bf_active = true;
+}
+
+// --- 公有函数 ---
+
+/**
+ * @brief 扫描Flash，恢复日志状态
+ */
+void SampleLog_Init(void)
+{
+    SampleRecord_t record;
+    uint32_t newest_sector = 0;
+    uint32_t newest_seq = 0;
+
+    // 1. 第一条记录序号最大的扇区是最新的扇区
+    for (uint32_t sector = 0; sector < SAMPLE_LOG_SECTOR_COUNT; sector++)
+    {
+        if (read_record(sector * RECORDS_PER_SECTOR, &record) && record.seq > newest_seq)
+        {
+            newest_seq = record.seq;
+            newest_sector = sector;
+        }
+    }
+
+    s_head = 0;
+    s_next_seq = 1;
+    s_time_base = 0;
+
+    // 2. 在最新的扇区内找到第一个空槽，最后一条有效记录给出下一个序号和节点时间
+    if (newest_seq != 0)
+    {
+        uint32_t slot = newest_sector * RECORDS_PER_SECTOR;
+        uint32_t end = slot + RECORDS_PER_SECTOR;
+        for (; slot < end; slot++)
+        {
+            if (read_record(slot, &record))
+            {
+                s_next_seq = record.seq + 1U;
+                s_time_base = record.timestamp + 1U;
+            }
+            else if (record.seq == EMPTY_SEQ)
+            {
+                break; // 记录按顺序追加，后面的槽都是空的 (CRC错误的记录是掉电时写了一半的，跳过)
+            }
+        }
+        s_head = slot % TOTAL_SLOTS;
+    }
+
+    s_bf_active = false;
+    s_ready = true;
+    printf("Sample log: next record #%lu at slot %lu\r\n", (unsigned long)s_next_seq, (unsigned long)s_head);
+}
+
+/**
+ * @brief 获取当前的节点时间
+ */
+uint32_t SampleLog_Now(void)
+{
+    return s_time_base + rtc_seconds();
+}
+
+/**
+ * @brief 追加一条样本记录
+ */
+bool SampleLog_Append(const InternalSensorProperties_t *data, uint8_t valid_mask)
+{
+    SampleRecord_t record;
+    SampleRecord_t verify;
+
+    if (!s_ready)
+    {
+        return false;
+    }
+
+    // 1. 填充记录并计算CRC
+    memset(&record, 0, sizeof(record));
+    if (!lora_model_create_sensor_payload(data, &record.data))
+    {
+        return false;
+    }
+    record.seq = s_next_seq++;
+    record.timestamp = SampleLog_Now();
+    record.valid_mask = valid_mask;
+    record.crc16 = record_crc(&record);
+
+    // 2. 进入新扇区时先擦除它 (其中是最旧的记录)
+    if (s_head % RECORDS_PER_SECTOR == 0)
+    {
+        W25QXX_Erase_Sector(SAMPLE_LOG_FIRST_SECTOR + s_head / RECORDS_PER_SECTOR);
+        if (s_bf_active && s_bf_slot / RECORDS_PER_SECTOR == s_head / RECORDS_PER_SECTOR)
+        {
+            // 待补发的记录被覆盖，从下一个扇区 (现在最旧的记录) 继续
+            s_bf_slot = (s_head + RECORDS_PER_SECTOR) % TOTAL_SLOTS;
+        }
+    }
+
+    // 3. 写入并读回校验；失败时跳过该槽
+    uint32_t addr = slot_address(s_head);
+    W25QXX_Write_Data((uint8_t *)&record, addr, sizeof(record));
+    W25QXX_Read_Data((uint8_t *)&verify, addr, sizeof(verify));
+    s_head = (s_head + 1U) % TOTAL_SLOTS;
+    return memcmp(&record, &verify, sizeof(record)) == 0;
+}
+
+/**
+ * @brief 处理补发请求
+ */
+void SampleLog_ApplyDownlink(const uint8_t *payload, uint8_t len)
+{
+    bool requested = false;
+    uint32_t from_min = 0;
+    uint32_t to_min = 0;
+
+    for (uint8_t pos = 0; pos + SENSOR_CONFIG_ITEM_SIZE <= len; pos += SENSOR_CONFIG_ITEM_SIZE)
+    {
+        if (payload[pos] == SENSOR_CONFIG_BACKFILL_FROM_MIN)
+        {
+            from_min = lora_model_unpack_u16le(&payload[pos + 1]);
+            requested = true;
+        }
+        else if (payload[pos] == SENSOR_CONFIG_BACKFILL_TO_MIN)
+        {
+            to_min = lora_model_unpack_u16le(&payload[pos + 1]);
+        }
+    }
+
+    if (!requested || !s_ready || s_next_seq == 1U || from_min < to_min)
+    {
+        return;
+    }
+
+    uint32_t now = SampleLog_Now();
+    uint32_t from_ts = (now > from_min * 60U) ? now - from_min * 60U : 0;
+    uint32_t to_ts = (now > to_min * 60U) ? now - to_min * 60U : 0;
+    printf("Downlink: backfill of the last %lu-%lu min requested\r\n", (unsigned long)to_min, (unsigned long)from_min);
+    start_backfill(from_ts, to_ts);
+}
+
+/**
+ * @brief 读取下一批待补发的记录
+ */
+uint8_t SampleLog_ReadBackfill(sensor_log_record_t *out, uint8_t max)
+{
+    SampleRecord_t record;
+    uint32_t slot = s_bf_slot;
+    uint32_t now = SampleLog_Now();
+    uint8_t count = 0;
+
+    if (!s_bf_active)
+    {
+        return 0;
+    }
+
+    while (count < max && slot != s_head)
+    {
+        bool valid = read_record(slot, &record);
+        if (valid && record.timestamp > s_bf_to_ts)
+        {
+            slot = s_head; // 时间段已结束
+            break;
+        }
+
+        slot = (slot + 1U) % TOTAL_SLOTS;
+        if (valid && record.timestamp >= s_bf_from_ts)
+        {
+            out[count].age_s = now - record.timestamp;
+            out[count].data = record.data;
+            count++;
+        }
+    }
+
+    s_bf_next_slot = slot;
+    if (count == 0)
+    {
+        s_bf_active = false;
+    }
+    return count;
+}
+
+/**
+ * @brief 确认上一批记录已发出
+ */
+void SampleLog_CommitBackfill(void)
+{
+    s_bf_slot = s_bf_next_slot;
+    if (s_bf_slot == s_head)
+    {
+        s_bf_active = false;
+        printf("Backfill complete\r\n");
+    }
+}
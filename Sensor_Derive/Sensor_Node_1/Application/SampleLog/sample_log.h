@@ -0,0 +1,83 @@
+#ifndef __SAMPLE_LOG_H
+#define __SAMPLE_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "device_properties.h"
+#include "lora_protocol.h"
+#include "w25qxx.h"
+
+/*
+ * 样本日志：
+ *   每个采集周期的样本都追加写入W25Q32 (无论本周期是否发送)，网关在通信中断后可以请求补发
+ *   某个时间段的样本 (SENSOR_CONFIG_BACKFILL_xxx)，单次上报丢失不会丢失数据。
+ *   - 扇区0、1分别保存设备配置和SGP30基线 (见 config_manager.h)，其余扇区构成一个环形日志。
+ *     记录按顺序追加，写入一个新扇区前先擦除它 (其中是最旧的记录)，所有扇区轮流擦写，
+ *     擦写次数自然均衡。
+ *   - 每条记录带有序号和CRC。掉电时最多损坏正在写入的一条记录，冷启动时扫描各扇区的第一条记录
+ *     找到最新的扇区，再在扇区内找到第一个空槽作为写入位置。
+ *   - 扇区按时间顺序排列，每个扇区的第一条记录即是该扇区的索引：按时间查找时对扇区二分查找
+ *     (约10次读取)，不需要另外维护索引表。
+ *   - 时间戳为节点时间 (秒)：RTC在冷启动时从0开始计时，因此冷启动后从日志中最后一条记录的
+ *     时间戳继续计时 (断电期间的时长无法得知，时间戳保持单调递增)。
+ */
+
+#define SAMPLE_LOG_FIRST_SECTOR         2U      // 扇区0: 设备配置, 扇区1: SGP30基线
+#define SAMPLE_LOG_SECTOR_COUNT         (W25Q32_SECTOR_COUNT - SAMPLE_LOG_FIRST_SECTOR)
+#define SAMPLE_LOG_BACKFILL_PER_FRAME   4U      // 每个补发帧携带的记录数
+
+/**
+ * @brief  一条样本记录。
+ * @note   此结构体总大小为48字节 (每个扇区85条记录)。
+ */
+typedef struct {
+    uint32_t seq;                   // 4字节：记录序号，从1开始递增；Flash擦除后为0xFFFFFFFF
+    uint32_t timestamp;             // 4字节：节点时间 (秒)，见 SampleLog_Now()
+    uint8_t  valid_mask;            // 1字节：本周期成功读取的传感器 (ACQ_SENSOR_xxx)
+    sensor_data_payload_t data;     // 34字节：样本数据，与 MSG_TYPE_REPORT_SENSOR 的载荷相同
+    uint8_t  reserved[3];           // 3字节：保留，为0
+    uint16_t crc16;                 // 2字节：针对前46个字节计算的 CRC16-Modbus 校验和
+} __attribute__((packed)) SampleRecord_t;
+
+/**
+ * @brief  扫描Flash，恢复写入位置、下一个序号和节点时间。
+ * @note   仅在冷启动后、W25QXX_Init 成功时调用一次；从STOP2唤醒时状态保存在SRAM中。
+ *         没有调用时 (Flash不可用) 之后的追加和补发均不执行。
+ */
+void SampleLog_Init(void);
+
+/**
+ * @brief  获取当前的节点时间 (秒)。
+ */
+uint32_t SampleLog_Now(void);
+
+/**
+ * @brief  追加一条样本记录 (写入后读回校验)。
+ * @param  data:       本周期的采集结果。
+ * @param  valid_mask: 本周期成功读取的传感器掩码 (ACQ_SENSOR_xxx)。
+ * @retval true  - 写入成功。
+ * @retval false - 日志不可用或校验失败 (该槽被跳过)。
+ */
+bool SampleLog_Append(const InternalSensorProperties_t *data, uint8_t valid_mask);
+
+/**
+ * @brief  处理网关下发的传感器配置中的补发请求 (SENSOR_CONFIG_BACKFILL_xxx)。
+ * @note   其他配置项由各自的模块处理，这里忽略。新的请求取代尚未补发完的请求。
+ */
+void SampleLog_ApplyDownlink(const uint8_t *payload, uint8_t len);
+
+/**
+ * @brief  读取下一批待补发的记录 (不移动补发位置)。
+ * @param  out: 输出缓冲区，age_s 按当前节点时间计算。
+ * @param  max: 最多读取的记录数。
+ * @retval 读取的记录数，0 表示没有待补发的记录。
+ * @note   发送成功后调用 SampleLog_CommitBackfill()；发送失败时不调用，下次重新读取同一批记录。
+ */
+uint8_t SampleLog_ReadBackfill(sensor_log_record_t *out, uint8_t max);
+
+/**
+ * @brief  确认上一次 SampleLog_ReadBackfill() 读取的记录已发出，补发位置移到其后。
+ */
+void SampleLog_CommitBackfill(void);
+
+#endif // __SAMPLE_LOG_H
@@ -0,0 +1,222 @@
+#include "sampling_policy.h"
+#include "acquisition.h"
+#include "config_manager.h"
+#include "lora_protocol.h"
+#include "main.h"
+#include <math.h>
+#include <stdio.h>
+
+/**
+ * @brief  参与变化速率判断的一个读数通道。
+ */
+typedef struct {
+    uint8_t sensor;     // 通道所属的传感器 (ACQ_SENSOR_xxx)
+    float   rate;       // 触发最短间隔的变化速率 (每分钟)
+} SamplingChannel_t;
+
+enum {
+    CH_AIR_TEMP,
+    CH_AIR_HUMID,
+    CH_SOIL_MOISTURE,
+    CH_SOIL_TEMP,
+    CH_COUNT
+};
+
+static const SamplingChannel_t s_channels[CH_COUNT] = {
+    [CH_AIR_TEMP]      = {ACQ_SENSOR_SHT40, SAMPLING_RATE_AIR_TEMP},
+    [CH_AIR_HUMID]     = {ACQ_SENSOR_SHT40, SAMPLING_RATE_AIR_HUMID},
+    [CH_SOIL_MOISTURE] = {ACQ_SENSOR_SOIL,  SAMPLING_RATE_SOIL_MOISTURE},
+    [CH_SOIL_TEMP]     = {ACQ_SENSOR_SOIL,  SAMPLING_RATE_SOIL_TEMP},
+};
+
+// 跨采集周期保存的数据 (STOP2 期间SRAM保持)
+static float    s_prev_values[CH_COUNT];
+static uint8_t  s_prev_mask;        // s_prev_values 中有效的传感器 (上一周期读取成功的)
+static uint32_t s_prev_tick;        // 上一次更新时的 HAL_GetTick (STOP2 期间 SysTick 暂停)
+static uint16_t s_base_interval_s;  // 未考虑电池电量的间隔
+static uint16_t s_interval_s;       // 下一次休眠的时长，0 表示冷启动后尚未更新
+
+// --- 私有函数 ---
+
+static uint16_t clamp_interval(uint32_t interval_s)
+{
+    if (interval_s < g_DeviceConfig.sample_min_s)
+    {
+        return g_DeviceConfig.sample_min_s;
+    }
+    if (interval_s > g_DeviceConfig.sample_max_s)
+    {
+        return g_DeviceConfig.sample_max_s;
+    }
+    return (uint16_t)interval_s;
+}
+
+static void read_channels(const InternalSensorProperties_t *data, float values[CH_COUNT])
+{
+    values[CH_AIR_TEMP] = (float)data->greenhouseTemperature;
+    values[CH_AIR_HUMID] = (float)data->greenhouseHumidity;
+    values[CH_SOIL_MOISTURE] = data->soilMoisture;
+    values[CH_SOIL_TEMP] = data->soilTemperature;
+}
+
+/**
+ * @brief  计算各通道变化速率与其阈值之比的最大值 (百分比)。
+ * @param  elapsed_s: 两次读数之间的时长 (秒)。
+ */
+static uint32_t change_percent(const float values[CH_COUNT], uint8_t valid_mask, uint32_t elapsed_s)
+{
+    uint32_t max_percent = 0;
+    float minutes = (float)elapsed_s / 60.0f;
+
+    for (uint8_t i = 0; i < CH_COUNT; i++)
+    {
+        uint8_t sensor = s_channels[i].sensor;
+        if ((valid_mask & s_prev_mask & sensor) == 0)
+        {
+            continue;
+        }
+
+        uint32_t percent = (uint32_t)(fabsf(values[i] - s_prev_values[i]) / minutes / s_channels[i].rate * 100.0f);
+        if (percent > max_percent)
+        {
+            max_percent = percent;
+        }
+    }
+    return max_percent;
+}
+
+// --- 公有函数 ---
+
+/**
+ * @brief 根据本周期的采集结果更新采样间隔
+ */
+uint16_t SamplingPolicy_Update(const InternalSensorProperties_t *data, uint8_t valid_mask)
+{
+    float values[CH_COUNT];
+    uint32_t now = HAL_GetTick();
+    read_channels(data, values);
+
+    if (s_interval_s == 0)
+    {
+        // 冷启动后的第一个周期：没有可比较的读数，从最短间隔开始
+        s_base_interval_s = g_DeviceConfig.sample_min_s;
+    }
+    else
+    {
+        uint32_t elapsed_s = s_interval_s + (now - s_prev_tick) / 1000U;
+        uint32_t percent = change_percent(values, valid_mask, elapsed_s);
+
+        if (percent >= 100U)
+        {
+            s_base_interval_s = g_DeviceConfig.sample_min_s;
+        }
+        else if (percent >= SAMPLING_STABLE_PERCENT)
+        {
+            s_base_interval_s = clamp_interval(s_base_interval_s / 2U);
+        }
+        else
+        {
+            s_base_interval_s = clamp_interval((uint32_t)s_base_interval_s + s_base_interval_s / 2U);
+        }
+        printf("Sampling: change %lu%% of threshold, ", (unsigned long)percent);
+    }
+
+    // 电量低时整体拉长间隔 (电池读取失败时按上一次的电量处理)
+    uint32_t interval_s = s_base_interval_s;
+    if (data->common.batteryLevel < SAMPLING_BATTERY_CRITICAL_PCT)
+    {
+        interval_s *= 4U;
+    }
+    else if (data->common.batteryLevel < SAMPLING_BATTERY_LOW_PCT)
+    {
+        interval_s *= 2U;
+    }
+    s_interval_s = clamp_interval(interval_s);
+
+    for (uint8_t i = 0; i < CH_COUNT; i++)
+    {
+        if (valid_mask & s_channels[i].sensor)
+        {
+            s_prev_values[i] = values[i];
+        }
+    }
+    s_prev_mask = valid_mask;
+    s_prev_tick = now;
+
+    printf("next interval %u s (battery %u%%)\r\n", s_interval_s, data->common.batteryLevel);
+    return s_interval_s;
+}
+
+/**
+ * @brief 获取当前的采样间隔
+ */
+uint16_t SamplingPolicy_GetInterval(void)
+{
+    return (s_interval_s != 0) ? s_interval_s : g_DeviceConfig.sample_min_s;
+}
+
+/**
+ * @brief 修改最短/最长间隔
+ */
+bool SamplingPolicy_SetBounds(uint16_t min_s, uint16_t max_s)
+{
+    if (min_s < SAMPLING_LIMIT_MIN_S || max_s > SAMPLING_LIMIT_MAX_S || min_s > max_s)
+    {
+        return false;
+    }
+
+    g_DeviceConfig.sample_min_s = min_s;
+    g_DeviceConfig.sample_max_s = max_s;
+    s_base_interval_s = clamp_interval(s_base_interval_s);
+    s_interval_s = (s_interval_s != 0) ? clamp_interval(s_interval_s) : 0;
+    return true;
+}
+
+/**
+ * @brief 应用网关下发的传感器配置
+ */
+bool SamplingPolicy_ApplyDownlink(const uint8_t *payload, uint8_t len)
+{
+    uint16_t min_s = g_DeviceConfig.sample_min_s;
+    uint16_t max_s = g_DeviceConfig.sample_max_s;
+
+    if (len == 0 || len % SENSOR_CONFIG_ITEM_SIZE != 0)
+    {
+        return false;
+    }
+
+    for (uint8_t pos = 0; pos < len; pos += SENSOR_CONFIG_ITEM_SIZE)
+    {
+        uint16_t value = lora_model_unpack_u16le(&payload[pos + 1]);
+        switch (payload[pos])
+        {
+        case SENSOR_CONFIG_SAMPLE_MIN_S:
+            min_s = value;
+            break;
+        case SENSOR_CONFIG_SAMPLE_MAX_S:
+            max_s = value;
+            break;
+        case SENSOR_CONFIG_REQUEST_REPORT:
+            break;  // 由 ReportFilter 处理
+        case SENSOR_CONFIG_BACKFILL_FROM_MIN:
+        case SENSOR_CONFIG_BACKFILL_TO_MIN:
+            break;  // 由 SampleLog 处理
+        default:
+            printf("Downlink: unknown config item 0x%02X\r\n", payload[pos]);
+            return false;
+        }
+    }
+
+    if (min_s == g_DeviceConfig.sample_min_s && max_s == g_DeviceConfig.sample_max_s)
+    {
+        return false;
+    }
+    if (!SamplingPolicy_SetBounds(min_s, max_s))
+    {
+        printf("Downlink: invalid sampling interval %u-%u s\r\n", min_s, max_s);
+        return false;
+    }
+
+    printf("Downlink: sampling interval set to %u-%u s\r\n", min_s, max_s);
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef __SAMPLING_POLICY_H
+#define __SAMPLING_POLICY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "device_properties.h"
+
+/*
+ * 自适应采样间隔：
+ *   每个采集周期结束后，根据本次与上一次读数的变化速率和电池电量，计算下一次STOP2的休眠时长。
+ *   - 任一通道的变化速率达到 SAMPLING_RATE_xxx (例如灌溉时土壤含水率快速上升)：
+ *     立即回到最短间隔，保证事件的时间分辨率。
+ *   - 变化速率低于阈值的 SAMPLING_STABLE_PERCENT：间隔逐步拉长 (每次 ×1.5)，直到最长间隔。
+ *   - 介于两者之间：间隔减半，向最短间隔靠拢。
+ *   - 电池电量低于 SAMPLING_BATTERY_LOW_PCT / SAMPLING_BATTERY_CRITICAL_PCT 时，
+ *     上述结果再乘以2 / 4 (仍不超过最长间隔)。
+ *   最短/最长间隔保存在 g_DeviceConfig 中，可由CLI (AT+SAMPLE=) 或网关下行 (MSG_TYPE_CMD_SET_CONFIG) 修改，
+ *   可配置范围 SAMPLING_LIMIT_MIN_S ~ SAMPLING_LIMIT_MAX_S 定义在 lora_protocol.h 中，与网关共用。
+ */
+
+// 触发最短间隔的变化速率，单位：每分钟
+// 光照 (云层遮挡时秒级剧变) 和 CO2 (SGP30每N个周期才测一次) 不参与判断。
+#define SAMPLING_RATE_AIR_TEMP          0.2f    // 温室温度 ℃/min
+#define SAMPLING_RATE_AIR_HUMID         1.0f    // 温室湿度 %RH/min
+#define SAMPLING_RATE_SOIL_MOISTURE     0.5f    // 土壤含水率 %/min
+#define SAMPLING_RATE_SOIL_TEMP         0.2f    // 土壤温度 ℃/min
+
+#define SAMPLING_STABLE_PERCENT         25U     // 变化速率低于阈值的25%时视为稳定
+
+#define SAMPLING_BATTERY_LOW_PCT        50U     // 低于此电量，间隔 ×2
+#define SAMPLING_BATTERY_CRITICAL_PCT   20U     // 低于此电量，间隔 ×4
+
+/**
+ * @brief  根据本周期的采集结果更新采样间隔。
+ * @note   每个工作周期调用一次，在 Acquisition_Wait() 之后。
+ * @param  data:       本周期的采集结果。
+ * @param  valid_mask: 本周期成功读取的传感器掩码 (ACQ_SENSOR_xxx)，失败的传感器不参与判断。
+ * @retval 下一次休眠的时长 (秒)。
+ */
+uint16_t SamplingPolicy_Update(const InternalSensorProperties_t *data, uint8_t valid_mask);
+
+/**
+ * @brief  获取当前的采样间隔 (秒)，冷启动后为最短间隔。
+ */
+uint16_t SamplingPolicy_GetInterval(void);
+
+/**
+ * @brief  修改 g_DeviceConfig 中的最短/最长间隔 (不保存到Flash)。
+ * @retval true  - 参数有效，已修改。
+ * @retval false - 超出 [SAMPLING_LIMIT_MIN_S, SAMPLING_LIMIT_MAX_S] 或 min_s > max_s，配置未改变。
+ */
+bool SamplingPolicy_SetBounds(uint16_t min_s, uint16_t max_s);
+
+/**
+ * @brief  应用网关下发的传感器配置 (MSG_TYPE_CMD_SET_CONFIG 的载荷，格式见 lora_protocol.h)。
+ * @note   所有配置项一起校验，任何一项无效时整条命令被忽略。
+ * @retval true  - 配置已修改，调用者应调用 Config_Save() 保存。
+ * @retval false - 载荷无效或配置没有变化。
+ */
+bool SamplingPolicy_ApplyDownlink(const uint8_t *payload, uint8_t len);
+
+#endif // __SAMPLING_POLICY_H
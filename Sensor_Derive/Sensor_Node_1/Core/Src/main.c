@@ -47,6 +47,10 @@
 #include "key_handler.h"
 #include "state_manager.h"
 #include "cli_manager.h"
+#include "acquisition.h"
+#include "sampling_policy.h"
+#include "report_filter.h"
+#include "sample_log.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -56,7 +60,11 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
-
+// After each report the radio listens this long for a MSG_TYPE_CMD_SET_CONFIG from the gateway,
+// which answers a node's report right away when it has a pending downlink for it.
+#define DOWNLINK_RX_WINDOW_MS 400U
+// Logged samples requested by the gateway are sent at most this many frames per wake
+#define BACKFILL_FRAMES_PER_CYCLE 4U
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -70,7 +78,16 @@
 // LoRaé
 
 static LoRa myLoRa;
-static uint8_t lora_send_buffer[45];
+static uint8_t lora_send_buffer[LORA_HEADER_SIZE + sizeof(sensor_traced_payload_t) + LORA_CHECKSUM_SIZE];
+static uint8_t lora_rx_buffer[LORA_MAX_RAW_PACKET];
+static lora_parsed_message_t lora_downlink;
+static uint8_t lora_log_buffer[LORA_HEADER_SIZE + SAMPLE_LOG_BACKFILL_PER_FRAME * sizeof(sensor_log_record_t) + LORA_CHECKSUM_SIZE];
+static uint16_t lora_trace_id = 0; // 采样序号，随每帧的追踪尾部发出 (STOP2 期间SRAM保持，不会被清零)
+// Warm-wake state. SRAM is retained in STOP 2 and execution resumes after the WFI,
+// so these survive a sleep cycle and are only zero after a reset (cold boot).
+static bool s_warm_wake = false;            // true once a work cycle has ended in STOP 2
+static uint16_t s_lora_config_checksum = 0; // LoRa_configChecksum() taken after the radio was put to sleep
+static bool s_lora_ready = false;           // last LoRa_init succeeded (an absent radio must not be "retained")
 // äź ćĺ¨ć°ćŽçťćä˝ (volatileçĄŽäżĺ¨ä¸­ć­ĺä¸ťĺžŞçŻé´ĺŽĺ
 static volatile InternalSensorProperties_t sensor_data;
 
@@ -92,6 +109,10 @@ void Peripherals_DeInit(void);
 /** @brief ć§čĄä¸ćŹĄĺŽć´çć°ćŽééăćĺ
 ĺLoRaĺéćľç¨ */
 void Perform_Sensor_Transmission(void);
+/** @brief Listen for a configuration downlink right after a report */
+static void Receive_Downlink(void);
+/** @brief Send a few frames of logged samples requested by the gateway */
+static void Send_Backfill(void);
 
 // --- ćéŽäşäťśçĺč°ĺ˝ć° ---
 void on_key_long_press(void);
@@ -267,12 +288,13 @@ int main(void)
         // Suspend SysTick to prevent it from waking up the MCU
         HAL_SuspendTick();
 
-        // Set the RTC Wakeup timer to wake up after 60 seconds
-        if (HAL_RTCEx_SetWakeUpTimer_IT(&hrtc, 29, RTC_WAKEUPCLOCK_CK_SPRE_16BITS, 0) != HAL_OK)
+        // Set the RTC Wakeup timer (1 Hz) to the interval chosen by the sampling policy
+        uint16_t interval_s = SamplingPolicy_GetInterval();
+        if (HAL_RTCEx_SetWakeUpTimer_IT(&hrtc, interval_s - 1U, RTC_WAKEUPCLOCK_CK_SPRE_16BITS, 0) != HAL_OK)
         {
           Error_Handler();
         }
-        printf("RTC Wakeup timer has been set to 30 seconds.\r\n");
+        printf("RTC Wakeup timer has been set to %u seconds.\r\n", interval_s);
 
         // Enter STOP 2 mode, wait for interrupt (WFI)
         HAL_PWREx_EnterSTOP2Mode(PWR_STOPENTRY_WFI);
@@ -286,10 +308,9 @@ int main(void)
         HAL_ResumeTick();
         printf("\r\n--- Woke up from STOP 2 mode ---\r\n");
 
-        // Critical fix: After waking from deep sleep, all HAL-level peripherals must be re-initialized,
-        // as their clocks and power sources were mostly turned off in STOP mode.
-        MX_GPIO_Init();
-        MX_DMA_Init();
+        // Only the peripherals de-initialized in Peripherals_DeInit() have lost their state.
+        // GPIO (output levels and EXTI), DMA, CRC and RTC registers are retained in STOP 2
+        // and are left as they are.
         MX_SPI1_Init();
         MX_USART1_UART_Init();
         MX_ADC1_Init();
@@ -297,9 +318,7 @@ int main(void)
         MX_I2C2_Init();
         MX_I2C3_Init();
         MX_SPI2_Init();
-        MX_CRC_Init();
         MX_LPUART1_UART_Init();
-        // Note: RTC keeps running throughout the process and does not need re-initialization.
 
         // Reset the work cycle counter and re-initialize application-layer drivers
         // to start a new work cycle.
@@ -372,6 +391,12 @@ void Peripherals_DeInit(void)
 {
   printf("De-initializing peripherals...\r\n");
 
+  // Keep the radio in sleep mode: it draws well under 1uA there and keeps its registers,
+  // so the next wake can skip LoRa_init if the read-back checksum still matches.
+  LoRa_gotoMode(&myLoRa, SLEEP_MODE);
+  s_lora_config_checksum = LoRa_configChecksum(&myLoRa);
+  s_warm_wake = true;
+
   // De-init HAL drivers to save power and prevent bus issues
   HAL_SPI_DeInit(&hspi1);
   HAL_SPI_DeInit(&hspi2);
@@ -381,6 +406,9 @@ void Peripherals_DeInit(void)
   HAL_ADC_DeInit(&hadc1);
   HAL_UART_DeInit(&huart1);
   HAL_UART_DeInit(&hlpuart1);
+
+  // Cut power to the sensors and Flash while sleeping; the SGP30 baseline survives in RAM
+  HAL_GPIO_WritePin(DEV_PWR_CTRL_GPIO_Port, DEV_PWR_CTRL_Pin, GPIO_PIN_RESET);
 }
 
 void Peripherals_Init(void)
@@ -397,46 +425,27 @@ void Peripherals_Init(void)
 
   printf("Drivers power init start...\r\n");
   HAL_GPIO_WritePin(DEV_PWR_CTRL_GPIO_Port, DEV_PWR_CTRL_Pin, GPIO_PIN_SET);
-  HAL_Delay(500); // Give peripherals time to power up
+  HAL_Delay(10); // Give the Flash a moment to power up (sensor power-up times are handled by the acquisition scheduler)
   printf("Drivers power init ok!\r\n");
 
-  if (!sgp30_init())
+  if (s_warm_wake && Config_IsValid())
   {
-    printf("SGP30 init ok!\r\n");
+    // Woken from STOP 2: g_DeviceConfig and the SGP30 baseline are still in RAM, skip the Flash
+    printf("Warm wake, keeping the configuration in RAM.\r\n");
   }
-  else
+  else if (!W25QXX_Init())
   {
-    printf("SGP30 init err!\r\n");
-  }
-
-  if (Init_BH1750())
-  {
-    printf("BH1750 init ok!\r\n");
-  }
-  else
-  {
-    printf("BH1750 init err!\r\n");
-  }
-
-  SP3485_Init();
-  printf("SP3485 init ok!\r\n");
+    printf("W25QXX Flash init OK!\r\n");
 
-  printf("sgp30 wait air for init\r\n");
-  do
-  {
-    if (sgp30_read((uint16_t *)&sensor_data.co2Concentration, (uint16_t *)&sensor_data.vocConcentration) < 0)
+    // The SGP30 baseline and the sample log position survive STOP 2 in RAM. Only recover them after a
+    // cold boot: re-reading the log on a warm wake would move the time base and cancel an active backfill.
+    if (!s_warm_wake)
     {
-      printf("\r\n spg30 read failed");
+      // The SGP30 baseline must be in RAM before the acquisition starts
+      Acquisition_RestoreSgp30Baseline();
+      // Find the write position of the sample log
+      SampleLog_Init();
     }
-    HAL_Delay(200);
-  } while (sensor_data.vocConcentration == 0 && sensor_data.co2Concentration == 400);
-  printf("sgp30 air init End!\r\n");
-
-  Battery_Init();
-
-  if (!W25QXX_Init())
-  {
-    printf("W25QXX Flash init OK!\r\n");
 
     if (Config_Load())
     {
@@ -459,57 +468,63 @@ void Peripherals_Init(void)
     printf("Using default configuration as Flash is not available.\r\n");
   }
 
+  // Start all sensor conversions in parallel. They run while the LoRa module
+  // is being initialized below; Perform_Sensor_Transmission() collects the results.
+  Acquisition_Start((InternalSensorProperties_t *)&sensor_data);
+
   printf("----------------------------------------\r\n");
   printf("--- Device Configuration ---\r\n");
   printf("   Device ID:      0x%X\r\n", g_DeviceConfig.device_id);
   printf("   LoRa Frequency: %u MHz\r\n", g_DeviceConfig.lora_frequency);
   printf("----------------------------------------\r\n\r\n");
 
-  myLoRa = newLoRa();
-  myLoRa.CS_port = NSS_GPIO_Port;
-  myLoRa.CS_pin = NSS_Pin;
-  myLoRa.reset_port = RES_GPIO_Port;
-  myLoRa.reset_pin = RES_Pin;
-  myLoRa.DIO0_port = DIO0_GPIO_Port;
-  myLoRa.DIO0_pin = DIO0_Pin;
-  myLoRa.hSPIx = &hspi1;
-
-  myLoRa.frequency = g_DeviceConfig.lora_frequency;
-
-  uint16_t LoRa_status = LoRa_init(&myLoRa);
-  if (LoRa_status == LORA_OK)
+  if (s_warm_wake && s_lora_ready && LoRa_configChecksum(&myLoRa) == s_lora_config_checksum)
   {
-    printf("lora init ok!\r\n");
+    // The radio stayed in sleep mode with its registers intact, only wake it up
+    LoRa_gotoMode(&myLoRa, STNBY_MODE);
+    printf("lora config retained, init skipped\r\n");
   }
   else
   {
-    printf("lora init err!\r\n");
+    myLoRa = newLoRa();
+    myLoRa.CS_port = NSS_GPIO_Port;
+    myLoRa.CS_pin = NSS_Pin;
+    myLoRa.reset_port = RES_GPIO_Port;
+    myLoRa.reset_pin = RES_Pin;
+    myLoRa.DIO0_port = DIO0_GPIO_Port;
+    myLoRa.DIO0_pin = DIO0_Pin;
+    myLoRa.hSPIx = &hspi1;
+
+    myLoRa.frequency = g_DeviceConfig.lora_frequency;
+
+    uint16_t LoRa_status = LoRa_init(&myLoRa);
+    s_lora_ready = (LoRa_status == LORA_OK);
+    if (s_lora_ready)
+    {
+      printf("lora init ok!\r\n");
+    }
+    else
+    {
+      printf("lora init err!\r\n");
+    }
   }
 
-  HAL_Delay(1000);
+  (void)Acquisition_Poll(); // Advance any sensor steps that became due during the init above
 }
 
 void Perform_Sensor_Transmission(void)
 {
-  BH1750_GetDate((uint16_t *)&sensor_data.lightIntensity);
-  sgp30_read((uint16_t *)&sensor_data.co2Concentration, (uint16_t *)&sensor_data.vocConcentration);
-  SHT40_Read_RHData((double *)&sensor_data.greenhouseTemperature, (double *)&sensor_data.greenhouseHumidity);
-  Soil_Sensor_Full_Data_t soil_data;
-  SP3485_Read_Soil_Full_Data(0x01, &soil_data);
-  sensor_data.soilMoisture = soil_data.moisture;
-  sensor_data.soilTemperature = soil_data.temperature;
-  sensor_data.soilEc = soil_data.ec;
-  sensor_data.soilPh = soil_data.ph;
-  sensor_data.soilNitrogen = soil_data.nitrogen;
-  sensor_data.soilPhosphorus = soil_data.phosphorus;
-  sensor_data.soilPotassium = soil_data.potassium;
-  sensor_data.soilSalinity = soil_data.salinity;
-  sensor_data.soilTds = soil_data.tds;
-  sensor_data.soilFertility = soil_data.fertility;
-  sensor_data.common.batteryVoltage = Battery_GetVoltage();
-  sensor_data.common.batteryLevel = Battery_GetPercentage(sensor_data.common.batteryVoltage);
-
-  printf("    Read Success!   \r\n");
+  // 采集在 Peripherals_Init() 中已经开始 (与Flash、LoRa初始化重叠)，这里等待所有传感器完成
+  uint8_t valid_mask = Acquisition_Wait();
+  uint32_t acq_start_tick = Acquisition_GetStartTick(); // 采集开始时刻，用于追踪尾部中的 acq_age_ms
+
+  printf("    Read %s!   \r\n", (valid_mask == Acquisition_GetScheduledMask()) ? "Success" : "Partial");
+
+  // Every sample goes to the Flash log first, whether or not it is transmitted below
+  if (!SampleLog_Append((const InternalSensorProperties_t *)&sensor_data, valid_mask))
+  {
+    printf("Sample log: record not written\r\n");
+  }
 
   printf("Moisture:    %.1f %%\r\n", sensor_data.soilMoisture);
   printf("Temperature: %.1f C\r\n", sensor_data.soilTemperature);
@@ -528,14 +543,106 @@ void Perform_Sensor_Transmission(void)
   printf("Light:       %d lux\r\n", sensor_data.lightIntensity);
   printf("BatteryLvel: %d%%\r\n", sensor_data.common.batteryLevel);
 
-  sensor_data_payload_t sensor_lora_payload;
-  if (lora_model_create_sensor_payload((const InternalSensorProperties_t *)&sensor_data, &sensor_lora_payload))
+  // Report by exception: only transmit when a reading moved past its deadband or a heartbeat is due
+  ReportDecision_t decision = ReportFilter_Check((const InternalSensorProperties_t *)&sensor_data, SamplingPolicy_GetInterval());
+  sensor_traced_payload_t sensor_lora_payload;
+  if (decision == REPORT_FULL &&
+      lora_model_create_sensor_payload((const InternalSensorProperties_t *)&sensor_data, &sensor_lora_payload.data))
   {
-    int lora_data_len = generate_lora_frame(LORA_HOST_ADDRESS, DEVICE_TYPE_SENSOR_Internal, MSG_TYPE_REPORT_SENSOR, 0, (const uint8_t *)&sensor_lora_payload, sizeof(sensor_lora_payload), lora_send_buffer, sizeof(lora_send_buffer));
-    printf("lora_data_len:%d\r\n", lora_data_len);
+    // 追踪尾部：采样序号 (跳过0，0 在网关侧表示未追踪) 和采集开始至今的时长。
+    // 组帧后立即发送，调试打印放在发送之后，不计入该时长。
+    if (++lora_trace_id == 0)
+    {
+      lora_trace_id = 1;
+    }
+    sensor_lora_payload.trace.trace_id = lora_trace_id;
+    sensor_lora_payload.trace.acq_age_ms = HAL_GetTick() - acq_start_tick;
+
+    int lora_data_len = generate_lora_frame(LORA_HOST_ADDRESS, DEVICE_TYPE_SENSOR_Internal, MSG_TYPE_REPORT_SENSOR, ReportFilter_GetNextReportSeq(), (const uint8_t *)&sensor_lora_payload, sizeof(sensor_lora_payload), lora_send_buffer, sizeof(lora_send_buffer));
+    uint8_t lora_status = LoRa_transmit(&myLoRa, lora_send_buffer, lora_data_len, 3000);
+
+    // The gateway answers right after the uplink: open the RX window before the debug output below
+    if (lora_status)
+    {
+      ReportFilter_OnSent((const InternalSensorProperties_t *)&sensor_data);
+      Receive_Downlink();
+    }
+
+    printf("lora_data_len:%d (trace #%u, acquired %lu ms ago)\r\n", lora_data_len,
+           sensor_lora_payload.trace.trace_id, (unsigned long)sensor_lora_payload.trace.acq_age_ms);
     printf("\r\n");
     print_hex((char *)lora_send_buffer, lora_data_len);
-    printf("lora send status:%d\r\n", LoRa_transmit(&myLoRa, lora_send_buffer, lora_data_len, 3000));
+    printf("lora send status:%d\r\n", lora_status);
+  }
+  else if (decision == REPORT_HEARTBEAT)
+  {
+    // Readings unchanged since the last full report: tell the gateway we are alive and which report is current
+    sensor_heartbeat_payload_t heartbeat = {.report_seq = ReportFilter_GetReportSeq()};
+    int lora_data_len = generate_lora_frame(LORA_HOST_ADDRESS, DEVICE_TYPE_SENSOR_Internal, MSG_TYPE_HEARTBEAT, 0, (const uint8_t *)&heartbeat, sizeof(heartbeat), lora_send_buffer, sizeof(lora_send_buffer));
+    uint8_t lora_status = LoRa_transmit(&myLoRa, lora_send_buffer, lora_data_len, 3000);
+
+    if (lora_status)
+    {
+      ReportFilter_OnSent(NULL);
+      Receive_Downlink();
+    }
+    printf("heartbeat (report #%u) send status:%d\r\n", heartbeat.report_seq, lora_status);
+  }
+
+  Send_Backfill();
+
+  // Pick the next sleep interval from the rate of change and the battery level
+  (void)SamplingPolicy_Update((const InternalSensorProperties_t *)&sensor_data, valid_mask);
+}
+
+static void Receive_Downlink(void)
+{
+  uint32_t start = HAL_GetTick();
+
+  LoRa_startReceiving(&myLoRa);
+  while (HAL_GetTick() - start < DOWNLINK_RX_WINDOW_MS)
+  {
+    if (HAL_GPIO_ReadPin(DIO0_GPIO_Port, DIO0_Pin) == GPIO_PIN_SET) // DIO0 is mapped to RxDone
+    {
+      uint8_t len = LoRa_receive(&myLoRa, lora_rx_buffer, sizeof(lora_rx_buffer));
+      if (len > 0 && parse_lora_frame(lora_rx_buffer, len, &lora_downlink) == LORA_FRAME_OK &&
+          lora_downlink.target_addr == DEVICE_TYPE_SENSOR_Internal && lora_downlink.msg_type == MSG_TYPE_CMD_SET_CONFIG)
+      {
+        ReportFilter_ApplyDownlink(lora_downlink.payload, lora_downlink.payload_len);
+        SampleLog_ApplyDownlink(lora_downlink.payload, lora_downlink.payload_len);
+        if (SamplingPolicy_ApplyDownlink(lora_downlink.payload, lora_downlink.payload_len) && !Config_Save())
+        {
+          printf("Error: Failed to save the downlink configuration!\r\n");
+        }
+        break;
+      }
+    }
+    HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI); // Woken by the next SysTick
+  }
+  LoRa_gotoMode(&myLoRa, STNBY_MODE);
+}
+
+static void Send_Backfill(void)
+{
+  sensor_log_record_t records[SAMPLE_LOG_BACKFILL_PER_FRAME];
+
+  // Spread a long backfill over several cycles to bound the radio time per wake
+  for (uint8_t frame = 0; frame < BACKFILL_FRAMES_PER_CYCLE; frame++)
+  {
+    uint8_t count = SampleLog_ReadBackfill(records, SAMPLE_LOG_BACKFILL_PER_FRAME);
+    if (count == 0)
+    {
+      break;
+    }
+
+    int lora_data_len = generate_lora_frame(LORA_HOST_ADDRESS, DEVICE_TYPE_SENSOR_Internal, MSG_TYPE_REPORT_LOG, 0, (const uint8_t *)records, count * sizeof(records[0]), lora_log_buffer, sizeof(lora_log_buffer));
+    uint8_t lora_status = LoRa_transmit(&myLoRa, lora_log_buffer, lora_data_len, 3000);
+    printf("backfill of %u samples send status:%d\r\n", count, lora_status);
+    if (!lora_status)
+    {
+      break; // The same records are read again next cycle
+    }
+    SampleLog_CommitBackfill();
   }
 }
 /* USER CODE END 4 */
@@ -58,6 +58,7 @@
 /* USER CODE END 0 */
 
 /* External variables --------------------------------------------------------*/
+extern DMA_HandleTypeDef hdma_lpuart1_rx;
 extern DMA_HandleTypeDef hdma_usart1_rx;
 extern DMA_HandleTypeDef hdma_usart1_tx;
 extern UART_HandleTypeDef hlpuart1;
@@ -212,6 +213,7 @@ void DMA1_Channel2_3_IRQHandler(void)
 
   /* USER CODE END DMA1_Channel2_3_IRQn 0 */
   HAL_DMA_IRQHandler(&hdma_usart1_tx);
+  HAL_DMA_IRQHandler(&hdma_lpuart1_rx);
   /* USER CODE BEGIN DMA1_Channel2_3_IRQn 1 */
 
   /* USER CODE END DMA1_Channel2_3_IRQn 1 */
@@ -269,10 +271,18 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
         g_usart1_new_data_flag = true;
         g_usart1_rx_len = USART1_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(huart->hdmarx);
     }
-    else if(huart->Instance == LPUART1)
+    // LPUART1 (RS485) receives by DMA with IDLE detection, see HAL_UARTEx_RxEventCallback in usart.c
+}
+/**
+ * @brief  UART transmit complete callback.
+ * @param  huart: UART handle that triggered the interrupt.
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if(huart->Instance == LPUART1)
     {
-        // LPUART1 ??GPS???GPS?????????????
-        SP3485_UART_RxCpltCallback(huart);
+        // RS485 request sent: release the bus and start receiving the response
+        SP3485_UART_TxCpltCallback(huart);
     }
 }
 /**
@@ -286,6 +296,11 @@ void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
         // ??CLI?UART???????DMA??
         USART1_Start_DMA_Reception();
     }
+    else if(huart->Instance == LPUART1)
+    {
+        // A framing/noise error aborts the RS485 DMA reception; restart it
+        SP3485_UART_ErrorCallback(huart);
+    }
 }
 
 /**
@@ -21,7 +21,7 @@ uint32_t I2C_BH1750_Data_Read(uint8_t* pData, uint16_t size){
 	return status;
 }
 
-int BH1750_GetDate(uint16_t *light){
+int BH1750_StartMeasure(void){
 	uint8_t opecode;
 	opecode = 0x01;
 	if ( I2C_BH1750_Opecode_Write(&opecode, 1) != HAL_OK)
@@ -29,6 +29,10 @@ int BH1750_GetDate(uint16_t *light){
 	opecode = 0x10;
 	if ( I2C_BH1750_Opecode_Write(&opecode, 1) != HAL_OK)
 		return 0;
+	return 1;
+}
+
+int BH1750_ReadResult(uint16_t *light){
 	uint8_t DATA_BUF[8] = {0};
 	if ( I2C_BH1750_Data_Read(DATA_BUF, 2) != HAL_OK)
 		return 0;
@@ -37,3 +41,9 @@ int BH1750_GetDate(uint16_t *light){
 	*light = (uint16_t)dis_data/1.2;
 	return 1;
 }
+
+int BH1750_GetDate(uint16_t *light){
+	if ( !BH1750_StartMeasure() )
+		return 0;
+	return BH1750_ReadResult(light);
+}
@@ -13,9 +13,15 @@ extern "C" {
                               //ALT  ADDRESSŽӵʱַΪ0x46ӵԴʱַΪ0xB8
 
  
+#define BH1750_MEAS_TIME_MS  180  // ߷ֱģʽ (0x10) תʱ
+
 int Init_BH1750(void);
 int BH1750_GetDate(uint16_t *light);
 
+/* ȡ:  StartMeasureBH1750_MEAS_TIME_MS ֮ ReadResultڼI2CߺCPU */
+int BH1750_StartMeasure(void);
+int BH1750_ReadResult(uint16_t *light);
+
 
 #ifdef __cplusplus
 }
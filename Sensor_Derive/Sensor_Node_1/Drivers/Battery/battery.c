@@ -41,13 +41,28 @@ void Battery_Init(void)
  * @note  此函数通过测量VREFINT来动态校准VDDA，以获得精确的测量结果。
  */
 float Battery_GetVoltage(void)
+{
+    Battery_StartMeasure();
+    return Battery_ReadVoltage();
+}
+
+/**
+ * @brief 打开电池电压测量电路，不等待
+ */
+void Battery_BeginMeasure(void)
+{
+    HAL_GPIO_WritePin(BATVOL_CTRL_GPIO_Port, BATVOL_CTRL_Pin, GPIO_PIN_RESET);
+}
+
+/**
+ * @brief 采样电池电压 (测量电路须已稳定)，完成后关闭测量电路
+ */
+float Battery_ReadVoltage(void)
 {
     float vdda = 3.3f; // 默认值，如果VREFINT测量失败则使用
     uint32_t adc_sum = 0;
     const int sample_count = 10;
 
-    Battery_StartMeasure();
-
     // --- 1. 测量VREFINT以计算真实的VDDA电压 ---
     uint32_t vrefint_sum = 0;
     for (int i = 0; i < sample_count; i++)
@@ -113,8 +128,8 @@ uint8_t Battery_GetPercentage(float voltage)
  */
 static void Battery_StartMeasure(void)
 {
-    HAL_GPIO_WritePin(BATVOL_CTRL_GPIO_Port, BATVOL_CTRL_Pin, GPIO_PIN_RESET);
-    HAL_Delay(100); // 等待RC电路稳定
+    Battery_BeginMeasure();
+    HAL_Delay(BATTERY_SETTLE_TIME_MS); // 等待RC电路稳定
 }
 
 /**
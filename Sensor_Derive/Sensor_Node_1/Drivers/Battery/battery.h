@@ -8,6 +8,8 @@ extern "C" {
 #include "main.h"
 #include <stdbool.h>
 
+#define BATTERY_SETTLE_TIME_MS 100 // 打开测量电路后RC电路的稳定时间
+
 /**
  * @brief 初始化电池电压检测功能所需的GPIO
  * @note  此函数应在主程序的初始化部分调用一次
@@ -21,6 +23,18 @@ void Battery_Init(void);
  */
 float Battery_GetVoltage(void);
 
+/**
+ * @brief 打开电池电压测量电路，不等待RC电路稳定 (非阻塞测量的第一步)
+ * @note  至少 BATTERY_SETTLE_TIME_MS 之后再调用 Battery_ReadVoltage()
+ */
+void Battery_BeginMeasure(void);
+
+/**
+ * @brief 在测量电路已稳定的前提下采样电池电压，完成后关闭测量电路
+ * @return float 真实电池电压 (单位: V)
+ */
+float Battery_ReadVoltage(void);
+
 /**
  * @brief 根据真实电池电压估算电量百分比
  * @param voltage 当前的真实电池电压 (V)
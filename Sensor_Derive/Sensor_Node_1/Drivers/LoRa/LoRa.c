@@ -515,6 +515,37 @@ int LoRa_getRSSI(LoRa* _LoRa){
 	return -164 + read;
 }
 
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_configChecksum
+
+		description : read back the registers written by LoRa_init (and the current
+									operating mode) and fold them into a CRC-16. The SX127x keeps
+									its registers in sleep mode, so comparing the checksum taken
+									before a MCU low power mode with the one taken after wake-up
+									tells whether LoRa_init has to be run again.
+
+		arguments   :
+			LoRa* LoRa        --> LoRa object handler
+
+		returns     : CRC-16 (CCITT) of the configuration registers
+\* ----------------------------------------------------------------------------- */
+uint16_t LoRa_configChecksum(LoRa* _LoRa){
+	static const uint8_t regs[] = {
+		RegOpMode, RegFrMsb, RegFrMid, RegFrLsb, RegPaConfig, RegOcp, RegLna,
+		RegModemConfig1, RegModemConfig2, RegSymbTimeoutL, RegPreambleMsb,
+		RegPreambleLsb, RegModemConfig3, RegSyncWord, RegDioMapping1
+	};
+	uint16_t crc = 0xFFFF;
+
+	for(uint8_t i=0; i<sizeof(regs); i++){
+		crc ^= (uint16_t)LoRa_read(_LoRa, regs[i]) << 8;
+		for(uint8_t bit=0; bit<8; bit++){
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+		}
+	}
+	return crc;
+}
+
 /* ----------------------------------------------------------------------------- *\
 		name        : LoRa_init
 
@@ -90,25 +90,43 @@ int sgp30_soft_reset(void)
 
 int sgp30_init(void)
 {
-    uint8_t buf[2];
-
     if (sgp30_soft_reset() < 0)
         return -2;
 
     sgp30_delay_ms(50);
 
+    if (sgp30_iaq_init() < 0)
+        return -3;
+
+    return 0;
+}
+
+int sgp30_iaq_init(void)
+{
+    uint8_t buf[2];
+
     buf[0] = (SGP30_CMD_INIT_AIR_QUALITY & 0XFF00) >> 8;
     buf[1] = (SGP30_CMD_INIT_AIR_QUALITY & 0X00FF);
 
     if (sgp30_iic_write(SGP30_ADDR_WRITE, buf, 2) < 0)
-        return -3;
+        return -1;
 
     return 0;
 }
 
 int sgp30_read(uint16_t* CO2, uint16_t* TVOC)
 {
-    uint8_t buf[8] = {0};
+    if (sgp30_measure_start() < 0)
+        return -1;
+
+    sgp30_delay_ms(SGP30_MEASURE_TIME_MS);
+
+    return sgp30_measure_read(CO2, TVOC);
+}
+
+int sgp30_measure_start(void)
+{
+    uint8_t buf[2];
 
     buf[0] = (SGP30_CMD_MEASURE_AIR_QUALITY & 0XFF00) >> 8;
     buf[1] = (SGP30_CMD_MEASURE_AIR_QUALITY & 0X00FF);
@@ -116,7 +134,56 @@ int sgp30_read(uint16_t* CO2, uint16_t* TVOC)
     if (sgp30_iic_write(SGP30_ADDR_WRITE, buf, 2) < 0)
         return -1;
 
-    sgp30_delay_ms(10);
+    return 0;
+}
+
+int sgp30_get_baseline(uint16_t* co2eq_base, uint16_t* tvoc_base)
+{
+    uint8_t buf[6] = {0};
+
+    buf[0] = (SGP30_CMD_GET_IAQ_BASELINE & 0XFF00) >> 8;
+    buf[1] = (SGP30_CMD_GET_IAQ_BASELINE & 0X00FF);
+
+    if (sgp30_iic_write(SGP30_ADDR_WRITE, buf, 2) < 0)
+        return -1;
+
+    sgp30_delay_ms(SGP30_BASELINE_TIME_MS);
+
+    if (sgp30_iic_read(SGP30_ADDR_READ, buf, 6) < 0)
+        return -2;
+
+    if (sgp30_checksum(&buf[0], 2) != buf[2] || sgp30_checksum(&buf[3], 2) != buf[5])
+        return -3;
+
+    *co2eq_base = (buf[0] << 8) | buf[1];
+    *tvoc_base  = (buf[3] << 8) | buf[4];
+
+    return 0;
+}
+
+int sgp30_set_baseline(uint16_t co2eq_base, uint16_t tvoc_base)
+{
+    uint8_t buf[8];
+
+    buf[0] = (SGP30_CMD_SET_IAQ_BASELINE & 0XFF00) >> 8;
+    buf[1] = (SGP30_CMD_SET_IAQ_BASELINE & 0X00FF);
+    /* д˳෴TVOCCO2eq */
+    buf[2] = tvoc_base >> 8;
+    buf[3] = tvoc_base & 0XFF;
+    buf[4] = sgp30_checksum(&buf[2], 2);
+    buf[5] = co2eq_base >> 8;
+    buf[6] = co2eq_base & 0XFF;
+    buf[7] = sgp30_checksum(&buf[5], 2);
+
+    if (sgp30_iic_write(SGP30_ADDR_WRITE, buf, 8) < 0)
+        return -1;
+
+    return 0;
+}
+
+int sgp30_measure_read(uint16_t* CO2, uint16_t* TVOC)
+{
+    uint8_t buf[8] = {0};
 
     if (sgp30_iic_read(SGP30_ADDR_READ, buf, 6) < 0)
         return -2;
@@ -19,8 +19,33 @@
 /* ȡ */
 #define SGP30_CMD_GET_SERIAL_ID  0X3682
 
+/* ȡ/û */
+#define SGP30_CMD_GET_IAQ_BASELINE 0x2015
+#define SGP30_CMD_SET_IAQ_BASELINE 0x201E
+
+/* Measure_iaq ִʱ (ms) */
+#define SGP30_MEASURE_TIME_MS 12
+
+/* Get/Set_iaq_baseline ִʱ (ms) */
+#define SGP30_BASELINE_TIME_MS 10
+
+/* Init_air_quality ֮ĳʼ׶ (ms)ڼ Measure_iaq ̶ CO2=400ppmTVOC=0ppb
+   Ƿָ˻޹ */
+#define SGP30_INIT_PHASE_MS 15000
+
 int sgp30_init(void);
 int sgp30_read(uint16_t* CO2, uint16_t* TVOC);
+
+/* ӿ: ϵ (λ)  iaq_init֮ÿһ measure_start
+   SGP30_MEASURE_TIME_MS ֮ measure_read */
+int sgp30_iaq_init(void);
+int sgp30_measure_start(void);
+int sgp30_measure_read(uint16_t* CO2, uint16_t* TVOC);
+
+/* :  iaq_init ֮ set_baseline ָϴαĻߣ㷨Ӹû߼
+   ѧϰ (״ѧϰҪԼ12Сʱ)get_baseline Ϊ (SGP30_BASELINE_TIME_MS) */
+int sgp30_get_baseline(uint16_t* co2eq_base, uint16_t* tvoc_base);
+int sgp30_set_baseline(uint16_t co2eq_base, uint16_t tvoc_base);
 int sgp30_get_serial_id(uint8_t id[6]);
 int sgp30_soft_reset(void);
 
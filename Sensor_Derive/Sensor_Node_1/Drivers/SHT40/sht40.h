@@ -15,8 +15,14 @@ extern "C" {
 #define SHT40_READ_SERIAL_NUMBER 						0x89          //ȡΨһк
 #define SHT40_HEATER_200mW_1s 							0x39          //200mW1
 
+#define SHT40_MEAS_TIME_MS 10  // ߾ȲʱΪ8.3ms
+
 uint8_t SHT40_Read_RHData(double *temperature,double *humidity);
 
+/* ȡ:  StartMeasureSHT40_MEAS_TIME_MS ֮ ReadResult */
+uint8_t SHT40_StartMeasure(void);
+uint8_t SHT40_ReadResult(double *temperature,double *humidity);
+
 
 #ifdef __cplusplus
 }
@@ -20,13 +20,28 @@ extern CRC_HandleTypeDef hcrc;
 #define SOIL_REGISTER_START         0x0000
 #define SOIL_REGISTER_COUNT         4 // 读取 水分、温度、电导率、PH值
 
+// Modbus RTU 字符长度 (起始位+8数据位+校验位/第2停止位+停止位)，用于计算帧间隔
+#define MODBUS_CHAR_BITS                    11
+// 波特率高于19200时，Modbus规定帧间隔固定为1.75ms (向上取整)
+#define MODBUS_FAST_BAUD                    19200
+#define MODBUS_FAST_FRAME_GAP_MS            2
+
 // 驱动内部变量
-static uint8_t sp3485_rx_buffer[SP3485_RX_BUFFER_SIZE];
-static volatile uint8_t sp3485_rx_count = 0;
-static uint8_t uart_rx_byte; // UART中断接收的单字节缓冲区
+static uint8_t sp3485_rx_buffer[SP3485_RX_BUFFER_SIZE];     // DMA循环接收缓冲区
+static uint8_t sp3485_tx_buffer[8];                         // 问询帧 (中断发送期间必须保持有效)
+static volatile uint16_t sp3485_rx_count = 0;               // 最近一次IDLE事件时已接收的字节数
+static volatile uint32_t sp3485_bus_tick = 0;               // 最近一次总线活动 (发送完成/接收事件) 的时刻
+
+// 正在进行的问询 (SP3485_Start_Read_Holding_Registers 发出，SP3485_Poll_Read_Holding_Registers 收取)
+static uint8_t  pending_slave_addr;
+static uint16_t pending_num_regs;
+static uint32_t pending_start_time;
+static uint8_t  pending_expected_len;
 
 // 静态函数声明
 static void RS485_Set_Mode(uint8_t mode);
+static void Start_Reception(void);
+static uint32_t Frame_Gap_Ms(void);
 static uint16_t CRC16_MODBUS(const uint8_t* buf, uint8_t len);
 static void Print_Hex_Data(const char* title, const uint8_t* data, uint8_t len);
 
@@ -35,27 +50,49 @@ static void Print_Hex_Data(const char* title, const uint8_t* data, uint8_t len);
   */
 void SP3485_Init(void)
 {
+    HAL_UART_Abort(&SP3485_UART_HANDLE);
+    RS485_Set_Mode(0);
     sp3485_rx_count = 0;
     memset(sp3485_rx_buffer, 0, SP3485_RX_BUFFER_SIZE);
-    // 启动UART中断接收
-    HAL_UART_Receive_IT(&SP3485_UART_HANDLE, &uart_rx_byte, 1);
+    // 从STOP2唤醒后 SysTick 计数没有前进，不能据此判断帧间隔：视为总线已空闲足够长的时间
+    sp3485_bus_tick = HAL_GetTick() - Frame_Gap_Ms() - 1;
 }
 
 /**
-  * @brief UART接收完成回调函数，应在系统的HAL_UART_RxCpltCallback中调用
-  * @param huart 触发中断的UART句柄
+  * @brief UART接收事件回调函数 (IDLE线路或缓冲区写满)
   */
-void SP3485_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+void SP3485_UART_RxEventCallback(UART_HandleTypeDef *huart, uint16_t size)
 {
-    // 判断是否是本驱动关心的UART实例
     if (huart->Instance == SP3485_UART_HANDLE.Instance)
     {
-        if (sp3485_rx_count < SP3485_RX_BUFFER_SIZE)
-        {
-            sp3485_rx_buffer[sp3485_rx_count++] = uart_rx_byte;
-        }
-        // 重新启动UART中断接收
-        HAL_UART_Receive_IT(&SP3485_UART_HANDLE, &uart_rx_byte, 1);
+        sp3485_rx_count = size;
+        sp3485_bus_tick = HAL_GetTick();
+    }
+}
+
+/**
+  * @brief UART发送完成回调函数：问询帧已全部移出，释放总线并开始接收响应
+  */
+void SP3485_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == SP3485_UART_HANDLE.Instance)
+    {
+        RS485_Set_Mode(0);
+        sp3485_bus_tick = HAL_GetTick();
+        Start_Reception();
+    }
+}
+
+/**
+  * @brief UART错误回调函数
+  */
+void SP3485_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    // 发送期间出错时保持原状态，由超时处理；接收被中止时重新开始接收 (已收到的部分帧随之丢弃)
+    if (huart->Instance == SP3485_UART_HANDLE.Instance && huart->RxState == HAL_UART_STATE_READY &&
+        huart->gState == HAL_UART_STATE_READY)
+    {
+        Start_Reception();
     }
 }
 
@@ -69,49 +106,101 @@ void SP3485_UART_RxCpltCallback(UART_HandleTypeDef *huart)
   */
 uint8_t SP3485_Read_Holding_Registers(uint8_t slave_addr, uint16_t reg_addr, uint16_t num_regs, uint8_t* dest_buffer)
 {
-    uint8_t tx_buffer[8];
+    uint8_t status = SP3485_Start_Read_Holding_Registers(slave_addr, reg_addr, num_regs);
+    if (status != 0) {
+        return status;
+    }
+
+    while ((status = SP3485_Poll_Read_Holding_Registers(dest_buffer)) == SP3485_BUSY) {
+        // 发送完成、IDLE线路和SysTick中断都会唤醒CPU
+        HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+    }
+
+    return status;
+}
+
+/**
+  * @brief  (非阻塞) 发出读保持寄存器的问询帧，不等待响应
+  */
+uint8_t SP3485_Start_Read_Holding_Registers(uint8_t slave_addr, uint16_t reg_addr, uint16_t num_regs)
+{
     uint16_t crc_calc;
 
-    // 1. 构建问询帧
-    tx_buffer[0] = slave_addr;
-    tx_buffer[1] = MODBUS_FUNC_READ_HOLDING_REGISTERS;
-    tx_buffer[2] = (reg_addr >> 8) & 0xFF;
-    tx_buffer[3] = reg_addr & 0xFF;
-    tx_buffer[4] = (num_regs >> 8) & 0xFF;
-    tx_buffer[5] = num_regs & 0xFF;
-    crc_calc = CRC16_MODBUS(tx_buffer, 6);
-    tx_buffer[6] = crc_calc & 0xFF;
-    tx_buffer[7] = (crc_calc >> 8) & 0xFF;
-
-    // 2. 发送
+    if (num_regs * 2 + 5 > SP3485_RX_BUFFER_SIZE) {
+        return 1;
+    }
+
+    // 1. 中止未完成的问询，等待帧间隔 (3.5个字符时间)
+    HAL_UART_Abort(&SP3485_UART_HANDLE);
+    RS485_Set_Mode(0);
+    while (HAL_GetTick() - sp3485_bus_tick <= Frame_Gap_Ms()) {
+        HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+    }
+
+    // 2. 构建问询帧
+    sp3485_tx_buffer[0] = slave_addr;
+    sp3485_tx_buffer[1] = MODBUS_FUNC_READ_HOLDING_REGISTERS;
+    sp3485_tx_buffer[2] = (reg_addr >> 8) & 0xFF;
+    sp3485_tx_buffer[3] = reg_addr & 0xFF;
+    sp3485_tx_buffer[4] = (num_regs >> 8) & 0xFF;
+    sp3485_tx_buffer[5] = num_regs & 0xFF;
+    crc_calc = CRC16_MODBUS(sp3485_tx_buffer, 6);
+    sp3485_tx_buffer[6] = crc_calc & 0xFF;
+    sp3485_tx_buffer[7] = (crc_calc >> 8) & 0xFF;
+
+    pending_slave_addr   = slave_addr;
+    pending_num_regs     = num_regs;
+    pending_start_time   = HAL_GetTick();
+    pending_expected_len = 0;
+
+    // 3. 中断发送，发送完成 (TC) 后在 SP3485_UART_TxCpltCallback 中切换为接收
     sp3485_rx_count = 0;
     memset(sp3485_rx_buffer, 0, SP3485_RX_BUFFER_SIZE);
+    if (SP3485_DEBUG) { Print_Hex_Data("TX", sp3485_tx_buffer, sizeof(sp3485_tx_buffer)); }
     RS485_Set_Mode(1);
-    if (SP3485_DEBUG) { Print_Hex_Data("TX", tx_buffer, sizeof(tx_buffer)); }
-    HAL_UART_Transmit(&SP3485_UART_HANDLE, tx_buffer, sizeof(tx_buffer), 1000);
-    while (__HAL_UART_GET_FLAG(&SP3485_UART_HANDLE, UART_FLAG_TC) == RESET);
-    RS485_Set_Mode(0);
+    if (HAL_UART_Transmit_IT(&SP3485_UART_HANDLE, sp3485_tx_buffer, sizeof(sp3485_tx_buffer)) != HAL_OK) {
+        RS485_Set_Mode(0); // 之后按超时处理
+    }
 
-    // 3. 等待响应 (动态长度)
-    uint32_t start_time = HAL_GetTick();
-    uint8_t expected_len = 0;
-    while(1)
-    {
-        if (HAL_GetTick() - start_time > 2000) { if (SP3485_DEBUG) printf("UART Receive Timeout!\r\n"); return 1; }
-
-        if (expected_len == 0 && sp3485_rx_count >= 3) {
-            if (sp3485_rx_buffer[1] == (MODBUS_FUNC_READ_HOLDING_REGISTERS | 0x80)) {
-                expected_len = 5; // Modbus异常响应帧为5字节
-            } else {
-                expected_len = sp3485_rx_buffer[2] + 5; // 正常响应: Addr(1)+Func(1)+Len(1)+Data(N)+CRC(2)
-            }
+    return 0;
+}
+
+/**
+  * @brief  (非阻塞) 检查上一次问询的响应
+  */
+uint8_t SP3485_Poll_Read_Holding_Registers(uint8_t* dest_buffer)
+{
+    uint8_t slave_addr = pending_slave_addr;
+    uint16_t num_regs = pending_num_regs;
+    uint8_t expected_len = pending_expected_len;
+    uint16_t rx_count = sp3485_rx_count;
+    uint32_t bus_tick = sp3485_bus_tick;
+    uint16_t crc_calc;
+
+    // 3. 检查响应 (动态长度)，rx_count 在每次IDLE事件时更新
+    if (expected_len == 0 && rx_count >= 3) {
+        if (sp3485_rx_buffer[1] == (MODBUS_FUNC_READ_HOLDING_REGISTERS | 0x80)) {
+            expected_len = 5; // Modbus异常响应帧为5字节
+        } else {
+            expected_len = sp3485_rx_buffer[2] + 5; // 正常响应: Addr(1)+Func(1)+Len(1)+Data(N)+CRC(2)
         }
-        if (expected_len > 0 && sp3485_rx_count >= expected_len) {
-            break; // 收到完整帧
+        pending_expected_len = expected_len;
+    }
+    if (expected_len == 0 || rx_count < expected_len) {
+        // IDLE只表示静默了1个字符时间。DMA已经写入更多字节 (帧仍在继续) 时不判断帧结束；
+        // 否则从上一次IDLE起静默超过3.5个字符时间，说明帧已结束但不完整
+        bool receiving = SP3485_UART_HANDLE.RxState == HAL_UART_STATE_BUSY_RX &&
+                         SP3485_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(SP3485_UART_HANDLE.hdmarx) != rx_count;
+        if (rx_count > 0 && !receiving && HAL_GetTick() - bus_tick > Frame_Gap_Ms()) {
+            if (SP3485_DEBUG) { Print_Hex_Data("RX (incomplete)", sp3485_rx_buffer, rx_count); }
+            return 5;
         }
+        if (HAL_GetTick() - pending_start_time > SP3485_RESPONSE_TIMEOUT_MS) { if (SP3485_DEBUG) printf("UART Receive Timeout!\r\n"); return 1; }
+        return SP3485_BUSY; // 还未收到完整帧
     }
-    
-    if (SP3485_DEBUG) { Print_Hex_Data("RX", sp3485_rx_buffer, sp3485_rx_count); }
+
+    HAL_UART_AbortReceive(&SP3485_UART_HANDLE); // 帧已完整，停止接收直到下一次问询
+    if (SP3485_DEBUG) { Print_Hex_Data("RX", sp3485_rx_buffer, rx_count); }
 
     // 4. 校验
     if (sp3485_rx_buffer[0] != slave_addr || sp3485_rx_buffer[1] != MODBUS_FUNC_READ_HOLDING_REGISTERS) {
@@ -210,40 +299,45 @@ uint8_t SP3485_Read_Soil_Extended_Data(uint8_t slave_addr, Soil_Sensor_Extended_
   */
 uint8_t SP3485_Read_Soil_Full_Data(uint8_t slave_addr, Soil_Sensor_Full_Data_t *data)
 {
-    uint8_t status;
-
     // 第1步: 读取前9个连续的寄存器 (0x0000 - 0x0008)
-    uint8_t raw_data_part1[18];
-    status = SP3485_Read_Holding_Registers(slave_addr, 0x0000, 9, raw_data_part1);
+    uint8_t raw_data[SOIL_FULL_RAW_SIZE];
+    uint8_t status = SP3485_Read_Holding_Registers(slave_addr, SOIL_FULL_START, SOIL_FULL_REGS, raw_data);
     if (status != 0) {
         return status;
     }
 
-    // 第2步: 单独读取肥力寄存器 (0x000C)
-    uint8_t raw_data_part2[2];
-    status = SP3485_Read_Holding_Registers(slave_addr, 0x000C, 1, raw_data_part2);
+    // 第2步: 单独读取肥力寄存器 (0x000C)，跳过未定义的 0x0009 - 0x000B
+    status = SP3485_Read_Holding_Registers(slave_addr, SOIL_FULL_FERTILITY_REG, 1, &raw_data[SOIL_FULL_REGS * 2]);
     if (status != 0) {
         return status;
     }
 
-    // 全部成功，开始解析
+    SP3485_Parse_Soil_Full_Data(raw_data, data);
+
+    return 0; // 成功
+}
+
+/**
+  * @brief  (专用) 解析土壤传感器完整数据的原始寄存器值
+  */
+void SP3485_Parse_Soil_Full_Data(const uint8_t* raw_data, Soil_Sensor_Full_Data_t *data)
+{
+    const uint8_t* fertility = &raw_data[SOIL_FULL_REGS * 2];
     int16_t temp_val;
 
-    temp_val = (int16_t)((raw_data_part1[0] << 8) | raw_data_part1[1]);
+    temp_val = (int16_t)((raw_data[0] << 8) | raw_data[1]);
     data->moisture    = (float)temp_val / 10.0f;
-    temp_val = (int16_t)((raw_data_part1[2] << 8) | raw_data_part1[3]);
+    temp_val = (int16_t)((raw_data[2] << 8) | raw_data[3]);
     data->temperature = (float)temp_val / 10.0f;
-    data->ec          = (uint16_t)((raw_data_part1[4] << 8) | raw_data_part1[5]);
-    temp_val = (int16_t)((raw_data_part1[6] << 8) | raw_data_part1[7]);
+    data->ec          = (uint16_t)((raw_data[4] << 8) | raw_data[5]);
+    temp_val = (int16_t)((raw_data[6] << 8) | raw_data[7]);
     data->ph          = (float)temp_val / 10.0f;
-    data->nitrogen    = (uint16_t)((raw_data_part1[8] << 8) | raw_data_part1[9]);
-    data->phosphorus  = (uint16_t)((raw_data_part1[10] << 8) | raw_data_part1[11]);
-    data->potassium   = (uint16_t)((raw_data_part1[12] << 8) | raw_data_part1[13]);
-    data->salinity    = (uint16_t)((raw_data_part1[14] << 8) | raw_data_part1[15]);
-    data->tds         = (uint16_t)((raw_data_part1[16] << 8) | raw_data_part1[17]);
-    data->fertility   = (uint16_t)((raw_data_part2[0] << 8) | raw_data_part2[1]);
-
-    return 0; // 成功
+    data->nitrogen    = (uint16_t)((raw_data[8] << 8) | raw_data[9]);
+    data->phosphorus  = (uint16_t)((raw_data[10] << 8) | raw_data[11]);
+    data->potassium   = (uint16_t)((raw_data[12] << 8) | raw_data[13]);
+    data->salinity    = (uint16_t)((raw_data[14] << 8) | raw_data[15]);
+    data->tds         = (uint16_t)((raw_data[16] << 8) | raw_data[17]);
+    data->fertility   = (uint16_t)((fertility[0] << 8) | fertility[1]);
 }
 
 /**
@@ -301,6 +395,33 @@ static void RS485_Set_Mode(uint8_t mode)
     HAL_GPIO_WritePin(RS485_CTRL_GPIO_PORT, RS485_CTRL_GPIO_PIN, (mode == 1) ? GPIO_PIN_SET : GPIO_PIN_RESET);
 }
 
+/**
+  * @brief  启动DMA接收 (IDLE线路检测)
+  * @note   DMA为循环模式，IDLE事件后继续接收，帧中1~1.5个字符的停顿不会截断接收。
+  *         关闭半满中断，只在IDLE (及缓冲区写满) 时回调。
+  */
+static void Start_Reception(void)
+{
+    sp3485_rx_count = 0;
+    if (HAL_UARTEx_ReceiveToIdle_DMA(&SP3485_UART_HANDLE, sp3485_rx_buffer, SP3485_RX_BUFFER_SIZE) == HAL_OK) {
+        __HAL_DMA_DISABLE_IT(SP3485_UART_HANDLE.hdmarx, DMA_IT_HT);
+    }
+}
+
+/**
+  * @brief  Modbus RTU 帧间隔 (3.5个字符时间)
+  * @retval 帧间隔 (ms，向上取整)
+  */
+static uint32_t Frame_Gap_Ms(void)
+{
+    uint32_t baud = SP3485_UART_HANDLE.Init.BaudRate;
+    if (baud > MODBUS_FAST_BAUD) {
+        return MODBUS_FAST_FRAME_GAP_MS;
+    }
+    // 3.5 * 11位 * 1000ms / 波特率
+    return (35U * MODBUS_CHAR_BITS * 1000U + baud * 10U - 1U) / (baud * 10U);
+}
+
 /**
   * @brief  打印十六进制数据 (用于调试)
   */
@@ -9,7 +9,17 @@ extern "C" {
 
 // 宏定义，用于控制是否打印调试信息
 #define SP3485_DEBUG    0
-#define SP3485_RX_BUFFER_SIZE 32 // 接收缓冲区大小
+#define SP3485_RX_BUFFER_SIZE 32 // 接收缓冲区大小 (DMA循环接收)，一次最多读取 (32-5)/2 = 13 个寄存器
+#define SP3485_RESPONSE_TIMEOUT_MS 2000 // 发出问询帧后等待响应的超时时间
+#define SP3485_BUSY     0xFF    // SP3485_Poll_Read_Holding_Registers: 响应尚未收完
+
+// 土壤传感器完整数据 (10个值) 的寄存器: 0x0000~0x0008 为水分 ~ TDS，0x000C 为肥力。
+// 0x0009~0x000B 在说明书中没有定义，跨过它们的问询可能被传感器以异常码 0x02 拒绝，
+// 因此分两次问询读取。原始数据为9个寄存器之后紧跟肥力寄存器，共 SOIL_FULL_RAW_SIZE 字节。
+#define SOIL_FULL_START         0x0000
+#define SOIL_FULL_REGS          9
+#define SOIL_FULL_FERTILITY_REG 0x000C
+#define SOIL_FULL_RAW_SIZE      ((SOIL_FULL_REGS + 1) * 2)
 
 // 土壤传感器数据结构体
 typedef struct
@@ -71,10 +81,24 @@ typedef struct
 void SP3485_Init(void);
 
 /**
-  * @brief UART接收完成回调函数，应在系统的HAL_UART_RxCpltCallback中调用
+  * @brief UART接收事件回调函数 (DMA接收中检测到IDLE线路)，应在系统的HAL_UARTEx_RxEventCallback中调用
   * @param huart 触发中断的UART句柄
+  * @param size  本次接收已写入缓冲区的字节数
   */
-void SP3485_UART_RxCpltCallback(UART_HandleTypeDef *huart);
+void SP3485_UART_RxEventCallback(UART_HandleTypeDef *huart, uint16_t size);
+
+/**
+  * @brief UART发送完成回调函数 (问询帧最后一位已移出)，应在系统的HAL_UART_TxCpltCallback中调用
+  * @param huart 触发中断的UART句柄
+  */
+void SP3485_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+
+/**
+  * @brief UART错误回调函数，应在系统的HAL_UART_ErrorCallback中调用
+  * @note  HAL在帧错误/噪声错误时会中止DMA接收，这里重新启动接收。
+  * @param huart 触发中断的UART句柄
+  */
+void SP3485_UART_ErrorCallback(UART_HandleTypeDef *huart);
 
 /**
   * @brief  (通用) 读取一个或多个Modbus保持寄存器
@@ -83,9 +107,34 @@ void SP3485_UART_RxCpltCallback(UART_HandleTypeDef *huart);
   * @param  num_regs:   要读取的寄存器数量
   * @param  dest_buffer: 用于存放读取结果的缓冲区，大小必须 >= num_regs * 2
   * @retval 0: 成功, 其他: 失败
+  * @note   等待响应期间CPU睡眠 (WFI)，由SysTick或LPUART1/DMA中断唤醒。
   */
 uint8_t SP3485_Read_Holding_Registers(uint8_t slave_addr, uint16_t reg_addr, uint16_t num_regs, uint8_t* dest_buffer);
 
+/**
+  * @brief  (非阻塞) 发出读保持寄存器的问询帧，不等待响应
+  * @note   问询帧由UART中断发送，发送完成后切换为接收并启动DMA接收 (IDLE线路检测)，
+  *         之后调用 SP3485_Poll_Read_Holding_Registers 检查。同一时刻只能有一个未完成的问询，
+  *         新的问询会中止未完成的问询。
+  *         Modbus RTU 要求帧之间至少间隔3.5个字符时间：距离上一次总线活动不足该时间时，
+  *         在此睡眠 (WFI) 等到间隔满足 (4800bps下最多9ms)。
+  * @param  slave_addr: 从机地址
+  * @param  reg_addr:   要读取的寄存器起始地址
+  * @param  num_regs:   要读取的寄存器数量
+  * @retval 0: 已发出, 1: 响应超出接收缓冲区 (num_regs 过大)
+  */
+uint8_t SP3485_Start_Read_Holding_Registers(uint8_t slave_addr, uint16_t reg_addr, uint16_t num_regs);
+
+/**
+  * @brief  (非阻塞) 检查上一次问询的响应，收完整帧后校验并拷贝数据
+  * @note   响应开始后线路静默超过3.5个字符时间即认为帧已结束，不完整的帧立即返回错误，
+  *         不必等到 SP3485_RESPONSE_TIMEOUT_MS。
+  * @param  dest_buffer: 用于存放读取结果的缓冲区，大小必须 >= num_regs * 2
+  * @retval SP3485_BUSY: 尚未收完; 0: 成功; 1: 超时 (SP3485_RESPONSE_TIMEOUT_MS);
+  *         5: 帧不完整; 其他: 校验失败
+  */
+uint8_t SP3485_Poll_Read_Holding_Registers(uint8_t* dest_buffer);
+
 /**
   * @brief  (专用) 读取土壤传感器标准数据 (水分、温度、EC、PH)
   * @param  slave_addr: 从机地址
@@ -103,13 +152,20 @@ uint8_t SP3485_Read_Soil_Data(uint8_t slave_addr, Soil_Sensor_Data_t *data);
 uint8_t SP3485_Read_Soil_Extended_Data(uint8_t slave_addr, Soil_Sensor_Extended_Data_t *data);
 
 /**
-  * @brief  (专用) 读取土壤传感器完整数据 (10个值)
+  * @brief  (专用) 读取土壤传感器完整数据 (10个值)，分两次问询读取 (见 SOIL_FULL_xxx)
   * @param  slave_addr: 从机地址
   * @param  data:       用于存储解析后数据的结构体指针
   * @retval 0: 成功, 1: 失败
   */
 uint8_t SP3485_Read_Soil_Full_Data(uint8_t slave_addr, Soil_Sensor_Full_Data_t *data);
 
+/**
+  * @brief  (专用) 解析土壤传感器完整数据
+  * @param  raw_data: 从 SOIL_FULL_START 起 SOIL_FULL_REGS 个寄存器之后紧跟肥力寄存器的原始值 (SOIL_FULL_RAW_SIZE 字节)
+  * @param  data:     用于存储解析后数据的结构体指针
+  */
+void SP3485_Parse_Soil_Full_Data(const uint8_t* raw_data, Soil_Sensor_Full_Data_t *data);
+
 /**
   * @brief  (专用) 读取土壤传感器9项数据
   * @param  slave_addr: 从机地址
@@ -77,6 +77,22 @@ typedef struct
 
 } __attribute__((packed)) sensor_data_payload_t; // `__attribute__((packed))` 确保编译器以最紧凑的方式存储此结构体，不进行任何字节对齐填充，这对于跨平台和精确控制载荷大小至关重要。
 
+// --- 采样追踪尾部 ---
+// 追加在 MSG_TYPE_REPORT_SENSOR 的载荷之后，网关据此测量样本从采集到云端确认的端到端时延
+// (与网关 lora_protocol.h 中的定义一致；网关也接受不带尾部的帧)。
+typedef struct
+{
+    uint16_t trace_id;     // 采样序号 (每次采集加1，跳过0)
+    uint32_t acq_age_ms;   // 从开始采集到交给射频发送所经过的时长 (本机 HAL_GetTick 时钟)
+} __attribute__((packed)) lora_trace_trailer_t;
+
+// 带追踪尾部的传感器载荷，作为一个整体交给 generate_lora_frame
+typedef struct
+{
+    sensor_data_payload_t data;
+    lora_trace_trailer_t  trace;
+} __attribute__((packed)) sensor_traced_payload_t;
+
 // --- 函数声明 ---
 
 /**
@@ -68,7 +68,8 @@
 /* USER CODE BEGIN PV */
 // LoRa配置及发送缓冲区
 static LoRa myLoRa;
-static uint8_t lora_send_buffer[35];
+static uint8_t lora_send_buffer[LORA_HEADER_SIZE + sizeof(sensor_traced_payload_t) + LORA_CHECKSUM_SIZE];
+static uint16_t lora_trace_id = 0; // 采样序号，随每帧的追踪尾部发出 (STOP2 期间SRAM保持，不会被清零)
 // 传感器数据结构体 (volatile确保在中断和主循环间安全访问)
 static volatile ExternalSensorProperties_t sensor_data;
 
@@ -441,6 +442,8 @@ void Peripherals_Init(void)
 
 void Perform_Sensor_Transmission(void)
 {
+    uint32_t acq_start_tick = HAL_GetTick(); // 采集开始时刻，用于追踪尾部中的 acq_age_ms
+
     printf("\r\n--- Sensor Data Report (%d/4) ---\r\n", lora_transmission_count + 1);
 
     BMP280_t bmp280_data;
@@ -472,12 +475,23 @@ void Perform_Sensor_Transmission(void)
     printf("  Battery:          %u %% (%.2f V)\r\n", sensor_data.common.batteryLevel, sensor_data.common.batteryVoltage);
     printf("--------------------------\r\n");
   
-    sensor_data_payload_t sensor_lora_payload;
-    if(lora_model_create_sensor_payload((const ExternalSensorProperties_t *)&sensor_data,&sensor_lora_payload)){
+    sensor_traced_payload_t sensor_lora_payload;
+    if(lora_model_create_sensor_payload((const ExternalSensorProperties_t *)&sensor_data,&sensor_lora_payload.data)){
+      // 追踪尾部：采样序号 (跳过0，0 在网关侧表示未追踪) 和采集开始至今的时长。
+      // 组帧后立即发送，调试打印放在发送之后，不计入该时长。
+      if (++lora_trace_id == 0)
+      {
+        lora_trace_id = 1;
+      }
+      sensor_lora_payload.trace.trace_id = lora_trace_id;
+      sensor_lora_payload.trace.acq_age_ms = HAL_GetTick() - acq_start_tick;
+
       int lora_data_len = generate_lora_frame(LORA_HOST_ADDRESS,g_DeviceConfig.device_id,MSG_TYPE_REPORT_SENSOR,0,(const uint8_t*)&sensor_lora_payload,sizeof(sensor_lora_payload),lora_send_buffer,sizeof(lora_send_buffer));
-      printf("lora_data_len:%d\r\n",lora_data_len);
+      uint8_t lora_status = LoRa_transmit(&myLoRa,lora_send_buffer,lora_data_len,3000);
+      printf("lora_data_len:%d (trace #%u, acquired %lu ms ago)\r\n",lora_data_len,
+             sensor_lora_payload.trace.trace_id,(unsigned long)sensor_lora_payload.trace.acq_age_ms);
       print_hex((char *)lora_send_buffer, lora_data_len);
-      printf("lora send status:%d\r\n",LoRa_transmit(&myLoRa,lora_send_buffer,lora_data_len,3000));
+      printf("lora send status:%d\r\n",lora_status);
     }
 
     if (lora_transmission_count < 3)